@@ -58,6 +58,7 @@ namespace OpenSim {
 %ignore OpenSim::MocoMultibodyConstraint::getKinematicLevels;
 %ignore OpenSim::MocoConstraintInfo::getBounds;
 %ignore OpenSim::MocoConstraintInfo::setBounds;
+%ignore OpenSim::MocoProblemRep::createRepSharingModels;
 %ignore OpenSim::MocoProblemRep::getMultiplierInfos;
 
 %include <Moco/MocoConstraint.h>
@@ -218,6 +219,9 @@ namespace OpenSim {
 moco_unique_ptr(OpenSim::PositionMotion);
 %include <Moco/Components/PositionMotion.h>
 
+%ignore OpenSim::getNUMANodeCPUs;
+%ignore OpenSim::pinThreadToCPUs;
+%ignore OpenSim::getCurrentNUMANode;
 %include <Moco/MocoUtilities.h>
 %template(analyze) OpenSim::analyze<double>;
 %template(analyzeVec3) OpenSim::analyze<SimTK::Vec3>;
@@ -226,5 +230,6 @@ moco_unique_ptr(OpenSim::PositionMotion);
 %include <Moco/Components/ModelFactory.h>
 %include <Moco/Components/MultivariatePolynomialFunction.h>
 %include <Moco/Components/Bhargava2004Metabolics.h>
+%include <Moco/Components/JointReactions.h>
 
 %include <Moco/ModelOperators.h>
@@ -0,0 +1,434 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: MocoServer.cpp                                               *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "MocoServer.h"
+
+#include <Moco/MocoCasADiSolver/MocoCasADiSolver.h>
+#include <Moco/MocoStudy.h>
+#include <Moco/MocoUtilities.h>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+#include <OpenSim/Common/LogSink.h>
+#include <OpenSim/Common/Logger.h>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace OpenSim;
+
+#ifdef _WIN32
+
+MocoServer::MocoServer(std::string, int, int) {
+    OPENSIM_THROW(Exception, "opensim-moco serve requires UNIX sockets, which "
+                             "are not supported on this platform.");
+}
+MocoServer::~MocoServer() = default;
+void MocoServer::run() {}
+
+bool OpenSim::submitToMocoServer(
+        const std::string&, const std::string&, const std::string&) {
+    OPENSIM_THROW(Exception, "opensim-moco submit requires UNIX sockets, "
+                             "which are not supported on this platform.");
+}
+
+#else
+
+namespace {
+
+sockaddr_un createSocketAddress(const std::string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    OPENSIM_THROW_IF(socketPath.size() >= sizeof(address.sun_path), Exception,
+            "Socket path '{}' is too long.", socketPath);
+    std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+    return address;
+}
+
+/// Read newline-terminated lines from a socket.
+class LineReader {
+public:
+    explicit LineReader(int fd) : m_fd(fd) {}
+    /// Returns false if the peer closed the connection.
+    bool read(std::string& line) {
+        while (true) {
+            const auto newline = m_buffer.find('\n');
+            if (newline != std::string::npos) {
+                line = m_buffer.substr(0, newline);
+                m_buffer.erase(0, newline + 1);
+                return true;
+            }
+            char chunk[4096];
+            const ssize_t numRead = ::read(m_fd, chunk, sizeof(chunk));
+            if (numRead <= 0) return false;
+            m_buffer.append(chunk, numRead);
+        }
+    }
+
+private:
+    int m_fd;
+    std::string m_buffer;
+};
+
+std::string absolutePath(const std::string& path) {
+    return SimTK::Pathname::getAbsolutePathname(path);
+}
+
+std::string directoryOf(const std::string& path) {
+    bool dontApplySearchPath;
+    std::string directory, fileName, extension;
+    SimTK::Pathname::deconstructPathname(
+            path, dontApplySearchPath, directory, fileName, extension);
+    return directory;
+}
+
+} // anonymous namespace
+
+class MocoServer::Connection {
+public:
+    explicit Connection(int fd) : m_fd(fd) {}
+    ~Connection() { ::close(m_fd); }
+    int getFileDescriptor() const { return m_fd; }
+    /// Send a line to the client. Failures (e.g., the client disconnected) are
+    /// ignored, as the job should still finish.
+    void send(const std::string& line) {
+        std::string message = line;
+        // Messages may span multiple lines; keep the protocol line-based.
+        std::replace(message.begin(), message.end(), '\n', ' ');
+        message += '\n';
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t offset = 0;
+        while (offset < message.size()) {
+            const ssize_t numSent = ::send(m_fd, message.data() + offset,
+                    message.size() - offset, MSG_NOSIGNAL);
+            if (numSent <= 0) return;
+            offset += numSent;
+        }
+    }
+
+private:
+    int m_fd;
+    std::mutex m_mutex;
+};
+
+namespace {
+
+/// The connection of the job running on the current thread, if any. Log
+/// messages from this thread are forwarded to this connection. Messages logged
+/// from threads that CasADi creates (when evaluating the problem in parallel)
+/// are only printed by the server.
+thread_local std::function<void(const std::string&)> t_forwardLog;
+
+class ForwardingLogSink : public LogSink {
+protected:
+    void sinkImpl(const std::string& msg) override {
+        if (t_forwardLog) t_forwardLog(msg);
+    }
+};
+
+} // anonymous namespace
+
+MocoServer::MocoServer(std::string socketPath, int numJobs, int numThreads)
+        : m_socketPath(std::move(socketPath)), m_numJobs(numJobs) {
+    OPENSIM_THROW_IF(numJobs < 1, Exception,
+            "Expected the number of jobs to be at least 1, but got {}.",
+            numJobs);
+    OPENSIM_THROW_IF(numThreads < 1, Exception,
+            "Expected the number of threads to be at least 1, but got {}.",
+            numThreads);
+    m_threadsPerJob = std::max(1, numThreads / numJobs);
+
+    // Writing to a closed connection should not terminate the server.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    m_listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    OPENSIM_THROW_IF(m_listener < 0, Exception, "Could not create a socket.");
+    const auto address = createSocketAddress(m_socketPath);
+    // Remove a socket file left behind by a previous server, but never remove
+    // any other kind of file.
+    struct stat fileStatus;
+    if (::lstat(m_socketPath.c_str(), &fileStatus) == 0) {
+        if (!S_ISSOCK(fileStatus.st_mode)) {
+            ::close(m_listener);
+            OPENSIM_THROW(Exception,
+                    "Cannot create socket '{}': a file that is not a socket "
+                    "already exists at this path.",
+                    m_socketPath);
+        }
+        ::unlink(m_socketPath.c_str());
+    }
+    // Only the owner may connect: clients can make the server read and write
+    // files on their behalf. No client can connect before listen(), so
+    // restricting the permissions between bind() and listen() leaves no
+    // window in which the socket is accessible to others.
+    if (::bind(m_listener, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address)) < 0 ||
+            ::chmod(m_socketPath.c_str(), S_IRUSR | S_IWUSR) < 0 ||
+            ::listen(m_listener, SOMAXCONN) < 0) {
+        ::close(m_listener);
+        OPENSIM_THROW(Exception, "Could not listen on socket '{}'.",
+                m_socketPath);
+    }
+    Logger::addSink(std::make_shared<ForwardingLogSink>());
+}
+
+MocoServer::~MocoServer() {
+    requestShutdown();
+    for (auto& worker : m_workers) worker.join();
+    for (auto& entry : m_connections) {
+        if (entry.second.thread.joinable()) entry.second.thread.join();
+    }
+    ::unlink(m_socketPath.c_str());
+}
+
+void MocoServer::run() {
+    log_info("MocoServer listening on '{}' with {} job(s) of {} thread(s).",
+            m_socketPath, m_numJobs, m_threadsPerJob);
+    for (int i = 0; i < m_numJobs; ++i) {
+        m_workers.emplace_back(&MocoServer::work, this);
+    }
+    while (!m_shuttingDown) {
+        const int fd = ::accept(m_listener, nullptr, nullptr);
+        if (fd < 0) {
+            // The listener is shut down when a shutdown is requested.
+            if (m_shuttingDown) break;
+            continue;
+        }
+        // Each connection is served by its own thread; the jobs it submits
+        // share ownership of the connection. Once the thread is done with
+        // the connection, it is joined when the next client connects, so
+        // that a long-running server does not accumulate threads.
+        auto connection = std::make_shared<Connection>(fd);
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        reapConnections();
+        const int id = m_nextConnectionId++;
+        auto& entry = m_connections[id];
+        entry.connection = connection;
+        entry.thread = std::thread([this, id, connection]() {
+            serve(connection);
+            std::lock_guard<std::mutex> closedLock(m_connectionsMutex);
+            m_closedConnections.push_back(id);
+        });
+    }
+    // Finish the queued jobs, then disconnect the remaining clients.
+    for (auto& worker : m_workers) worker.join();
+    m_workers.clear();
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        for (auto& entry : m_connections) {
+            if (auto connection = entry.second.connection.lock()) {
+                ::shutdown(connection->getFileDescriptor(), SHUT_RDWR);
+            }
+            threads.push_back(std::move(entry.second.thread));
+        }
+    }
+    // The threads lock m_connectionsMutex as they finish.
+    for (auto& thread : threads) thread.join();
+    {
+        std::lock_guard<std::mutex> lock(m_connectionsMutex);
+        m_connections.clear();
+        m_closedConnections.clear();
+    }
+    log_info("MocoServer shut down.");
+}
+
+void MocoServer::serve(std::shared_ptr<Connection> connection) {
+    LineReader reader(connection->getFileDescriptor());
+    std::string line;
+    while (reader.read(line)) {
+        std::istringstream request(line);
+        std::string command;
+        request >> command;
+        if (command == "solve") {
+            Job job;
+            request >> job.setupFile >> job.solutionFile;
+            if (job.setupFile.empty()) {
+                connection->send("error Expected 'solve <omoco-file> "
+                                 "[<solution-file>]'.");
+                continue;
+            }
+            if (m_shuttingDown) {
+                connection->send("error The server is shutting down.");
+                continue;
+            }
+            job.id = m_nextJobId++;
+            job.connection = connection;
+            connection->send("accepted " + std::to_string(job.id));
+            {
+                std::lock_guard<std::mutex> lock(m_queueMutex);
+                m_queue.push_back(std::move(job));
+            }
+            m_queueCondition.notify_one();
+        } else if (command == "shutdown") {
+            requestShutdown();
+            return;
+        } else if (!command.empty()) {
+            connection->send("error Unrecognized request '" + command + "'.");
+        }
+    }
+}
+
+void MocoServer::reapConnections() {
+    for (const int id : m_closedConnections) {
+        const auto it = m_connections.find(id);
+        // The thread no longer needs m_connectionsMutex, so joining it here
+        // does not deadlock.
+        it->second.thread.join();
+        m_connections.erase(it);
+    }
+    m_closedConnections.clear();
+}
+
+void MocoServer::requestShutdown() {
+    if (m_shuttingDown.exchange(true)) return;
+    // Unblock accept() in run().
+    ::shutdown(m_listener, SHUT_RDWR);
+    ::close(m_listener);
+    m_queueCondition.notify_all();
+}
+
+void MocoServer::work() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCondition.wait(lock,
+                    [this] { return m_shuttingDown || !m_queue.empty(); });
+            // Finish queued jobs before shutting down.
+            if (m_queue.empty()) return;
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        t_forwardLog = [&job](const std::string& msg) {
+            job.connection->send("log " + msg);
+        };
+        try {
+            solve(job);
+        } catch (const std::exception& e) {
+            job.connection->send(std::string("error ") + e.what());
+        }
+        t_forwardLog = nullptr;
+    }
+}
+
+std::shared_ptr<MocoServer::CachedStudy> MocoServer::getStudy(
+        const std::string& setupFile) {
+    const std::string path = absolutePath(setupFile);
+    struct stat fileStatus;
+    OPENSIM_THROW_IF(::stat(path.c_str(), &fileStatus) != 0, Exception,
+            "File '{}' does not exist.", path);
+
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    auto& cached = m_cache[path];
+    if (!cached || cached->modificationTime != fileStatus.st_mtime) {
+        auto obj = std::unique_ptr<Object>(Object::makeObjectFromFile(path));
+        OPENSIM_THROW_IF(obj == nullptr, Exception,
+                "A problem occurred when trying to load file '{}'.", path);
+        auto* study = dynamic_cast<MocoStudy*>(obj.get());
+        OPENSIM_THROW_IF(!study, Exception,
+                "The provided file '{}' yields a '{}' but a MocoStudy was "
+                "expected.",
+                path, obj->getConcreteClassName());
+        obj.release();
+        auto entry = std::make_shared<CachedStudy>();
+        entry->modificationTime = fileStatus.st_mtime;
+        entry->study.reset(study);
+        // Process the model once, relative to the study's directory, and
+        // keep the processed model in memory.
+        auto& problem = entry->study->updProblem();
+        const auto& modelProcessor = problem.getPhase(0).getModelProcessor();
+        problem.setModelProcessor(modelProcessor.process(directoryOf(path)));
+        // The server writes the solution itself.
+        entry->study->set_write_solution("false");
+        cached = std::move(entry);
+    }
+    return cached;
+}
+
+void MocoServer::solve(const Job& job) {
+    const Stopwatch stopwatch;
+    auto cached = getStudy(job.setupFile);
+    std::lock_guard<std::mutex> lock(cached->mutex);
+    MocoStudy& study = *cached->study;
+    if (auto* casadiSolver =
+                    dynamic_cast<MocoCasADiSolver*>(&study.updSolver())) {
+        casadiSolver->set_parallel(m_threadsPerJob);
+    }
+    MocoSolution solution = study.solve();
+
+    std::string solutionFile = job.solutionFile;
+    if (solutionFile.empty()) {
+        const std::string prefix =
+                study.getName().empty() ? "MocoStudy" : study.getName();
+        solutionFile = directoryOf(absolutePath(job.setupFile)) + prefix +
+                       "_solution.sto";
+    }
+    const bool success = solution.success();
+    solution.unseal();
+    solution.write(solutionFile);
+    job.connection->send("solution " + solutionFile);
+    job.connection->send(fmt::format("done {} {} {}",
+            success ? "success" : "failure", solution.getObjective(),
+            solution.getStatus()));
+    log_info("Job {} ('{}') finished in {}.", job.id, job.setupFile,
+            stopwatch.getElapsedTimeFormatted());
+}
+
+bool OpenSim::submitToMocoServer(const std::string& socketPath,
+        const std::string& setupFile, const std::string& solutionFile) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    OPENSIM_THROW_IF(fd < 0, Exception, "Could not create a socket.");
+    const auto address = createSocketAddress(socketPath);
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address)) < 0) {
+        ::close(fd);
+        OPENSIM_THROW(Exception,
+                "Could not connect to a MocoServer at '{}'.", socketPath);
+    }
+    std::string request = "solve " + absolutePath(setupFile);
+    if (!solutionFile.empty()) request += " " + absolutePath(solutionFile);
+    request += '\n';
+    ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+
+    LineReader reader(fd);
+    std::string line;
+    bool success = false;
+    while (reader.read(line)) {
+        if (startsWith(line, "log ")) {
+            std::cout << line.substr(4) << std::endl;
+        } else {
+            std::cout << line << std::endl;
+            if (startsWith(line, "done ")) {
+                success = startsWith(line, "done success");
+                break;
+            }
+            if (startsWith(line, "error ")) break;
+        }
+    }
+    ::close(fd);
+    return success;
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef MOCO_MOCOSERVER_H
+#define MOCO_MOCOSERVER_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: MocoServer.h                                                 *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenSim {
+
+class MocoStudy;
+
+/// A long-running process that solves MocoStudy%s on request, so that
+/// clients (interactive tools, pipelines of many small problems) do not pay
+/// for process startup, plugin loading, and parsing for every solve.
+///
+/// The server listens on a local UNIX domain socket, which only the user
+/// running the server can connect to. Clients send one request per line:
+///   - `solve <omoco-file> [<solution-file>]`: solve the study. Paths should be
+///     absolute. The solution is written to `<solution-file>`, or to
+///     `<study-name>_solution.sto` next to the .omoco file.
+///   - `shutdown`: finish the queued studies and exit.
+///
+/// For each solve request, the server replies with the following lines:
+///   - `accepted <job-id>`
+///   - `log <message>`, for each message logged while solving.
+///   - `solution <solution-file>`
+///   - `done <success|failure> <objective> <status>`, or `error <message>` if
+///     the study could not be solved.
+///
+/// Studies are loaded once and kept in memory (with their models processed)
+/// until their .omoco file changes. The model is processed relative to the
+/// directory containing the .omoco file; other relative paths in the study
+/// (e.g., reference data) are relative to the server's working directory.
+/// Studies are solved by `numJobs` worker threads, and each CasADi solver is
+/// given `numThreads / numJobs` threads so that concurrent solves share the
+/// thread budget.
+class MocoServer {
+public:
+    MocoServer(std::string socketPath, int numJobs, int numThreads);
+    ~MocoServer();
+    /// Accept connections until a client requests a shutdown.
+    void run();
+
+private:
+    class Connection;
+    struct Job {
+        int id;
+        std::string setupFile;
+        std::string solutionFile;
+        std::shared_ptr<Connection> connection;
+    };
+    struct CachedStudy {
+        std::time_t modificationTime;
+        std::unique_ptr<MocoStudy> study;
+        // A study can only be solved by one job at a time.
+        std::mutex mutex;
+    };
+
+    void serve(std::shared_ptr<Connection> connection);
+    /// Join the threads of connections that have closed, and forget them.
+    /// The caller must hold m_connectionsMutex.
+    void reapConnections();
+    void work();
+    void solve(const Job& job);
+    std::shared_ptr<CachedStudy> getStudy(const std::string& setupFile);
+    void requestShutdown();
+
+    std::string m_socketPath;
+    int m_numJobs;
+    int m_threadsPerJob;
+    int m_listener = -1;
+
+    std::atomic<bool> m_shuttingDown{false};
+    std::atomic<int> m_nextJobId{0};
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueCondition;
+    std::deque<Job> m_queue;
+    std::vector<std::thread> m_workers;
+
+    struct ConnectionThread {
+        std::weak_ptr<Connection> connection;
+        std::thread thread;
+    };
+    std::mutex m_connectionsMutex;
+    int m_nextConnectionId = 0;
+    std::unordered_map<int, ConnectionThread> m_connections;
+    // Connections whose threads have finished serving them.
+    std::vector<int> m_closedConnections;
+
+    std::mutex m_cacheMutex;
+    std::unordered_map<std::string, std::shared_ptr<CachedStudy>> m_cache;
+};
+
+/// Send a request to a MocoServer to solve the study in `setupFile`, and print
+/// the replies until the study is solved. Returns true if the solver
+/// succeeded.
+bool submitToMocoServer(const std::string& socketPath,
+        const std::string& setupFile, const std::string& solutionFile);
+
+} // namespace OpenSim
+
+#endif // MOCO_MOCOSERVER_H
@@ -16,10 +16,15 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 #include <Moco/About.h>
+#include <Moco/MocoCasADiSolver/MocoCasADiSolver.h>
 #include <Moco/MocoProblem.h>
 #include <Moco/MocoStudy.h>
 #include <Moco/MocoUtilities.h>
+#include <algorithm>
 #include <iostream>
+#include <thread>
+
+#include "MocoServer.h"
 
 #include <OpenSim/Common/Object.h>
 #include <OpenSim/Common/LoadOpenSimLibrary.h>
@@ -49,6 +54,24 @@ Usage:
     state.
     You can provide a MocoStudy setup file (.omoco) instead of a model.
 
+  opensim-moco [--library=<path>] serve [--jobs=<n>] [--threads=<n>] <socket>
+    Run a server that solves MocoStudy files on request, keeping studies and
+    their models in memory between requests. Requests are received on the
+    provided UNIX socket path. At most <n> jobs (default: 1) are solved at a
+    time, and the jobs share a budget of <n> threads (default: all cores).
+    Use the submit command to send requests.
+
+  opensim-moco submit <socket> <.omoco-file> [<solution-file>]
+    Ask the server listening on the provided socket to run the MocoStudy in
+    the provided .omoco file, and print its progress.
+
+  opensim-moco [--library=<path>] replay [--threads=<n>] <.omoco-file> <trace-file>
+    Evaluate the callbacks recorded in a trace file (see the
+    callback_trace_file property of MocoCasADiSolver) with the MocoStudy in
+    the provided .omoco file, using <n> threads (default: 1), and print the
+    throughput and the distribution of the time per evaluation of each
+    callback. The MocoStudy must be the one that recorded the trace.
+
   Use the --library flag to load a plugin.
 
 )";
@@ -106,6 +129,16 @@ void visualize(std::string file, std::string trajectory_file) {
     }
 }
 
+void replay(std::string setupFile, std::string traceFile, int numThreads) {
+    MocoStudy study(setupFile);
+    auto* solver = dynamic_cast<MocoCasADiSolver*>(&study.updSolver());
+    OPENSIM_THROW_IF(!solver, Exception,
+            "Replaying a trace requires a MocoCasADiSolver, but the MocoStudy "
+            "in '{}' uses a '{}'.",
+            setupFile, study.updSolver().getConcreteClassName());
+    solver->resetProblem(study.getProblem());
+    solver->replayCallbackTrace(traceFile, numThreads);
+}
 
 int main(int argc, char* argv[]) {
 
@@ -154,6 +187,52 @@ int main(int argc, char* argv[]) {
             }
             run_tool(setupFile, visualize);
 
+        } else if (subcommand == "serve") {
+            int numJobs = 1;
+            int numThreads = (int)std::thread::hardware_concurrency();
+            std::string socketPath;
+            for (int iarg = 2 + offset; iarg < argc + offset; ++iarg) {
+                std::string arg(argv[iarg]);
+                if (startsWith(arg, "--jobs=")) {
+                    numJobs = std::stoi(arg.substr(arg.find("=") + 1));
+                } else if (startsWith(arg, "--threads=")) {
+                    numThreads = std::stoi(arg.substr(arg.find("=") + 1));
+                } else {
+                    OPENSIM_THROW_IF(!socketPath.empty(), Exception,
+                            "Incorrect number of arguments.");
+                    socketPath = arg;
+                }
+            }
+            OPENSIM_THROW_IF(socketPath.empty(), Exception,
+                    "Incorrect number of arguments.");
+            MocoServer server(socketPath, numJobs, std::max(1, numThreads));
+            server.run();
+
+        } else if (subcommand == "submit") {
+            OPENSIM_THROW_IF(argc < 4 || argc > 5, Exception,
+                    "Incorrect number of arguments.");
+            std::string solutionFile;
+            if (argc == 5) solutionFile = argv[4 + offset];
+            if (!submitToMocoServer(
+                        argv[2 + offset], argv[3 + offset], solutionFile)) {
+                return EXIT_FAILURE;
+            }
+
+        } else if (subcommand == "replay") {
+            int numThreads = 1;
+            std::vector<std::string> files;
+            for (int iarg = 2 + offset; iarg < argc + offset; ++iarg) {
+                std::string arg(argv[iarg]);
+                if (startsWith(arg, "--threads=")) {
+                    numThreads = std::stoi(arg.substr(arg.find("=") + 1));
+                } else {
+                    files.push_back(arg);
+                }
+            }
+            OPENSIM_THROW_IF(files.size() != 2, Exception,
+                    "Incorrect number of arguments.");
+            replay(files[0], files[1], numThreads);
+
         } else if (subcommand == "print-xml") {
             OPENSIM_THROW_IF(
                     argc != 2, Exception, "Incorrect number of arguments.");
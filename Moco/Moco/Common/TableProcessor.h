@@ -35,6 +35,20 @@ public:
     /// This function may or may not be provided with a model. If the operation
     /// requires a model and model == nullptr, an exception is thrown.
     virtual void operate(TimeSeriesTable& table, const Model* model) const = 0;
+    /// TableProcessor uses the two functions below to discard unneeded
+    /// columns and rows of the source table before applying the operators,
+    /// rather than after (see TableProcessor::process()).
+    /// If each column of the output of this operator depends only on the input
+    /// column with the same index, update `labels` to the column labels that
+    /// the operator produces from a table with the given column labels, and
+    /// return true. Otherwise, return false (the default).
+    virtual bool updateColumnLabels(std::vector<std::string>& /*labels*/,
+            const Model* /*model*/) const {
+        return false;
+    }
+    /// Return true if each row of the output of this operator depends only on
+    /// the input row with the same time. The default returns false.
+    virtual bool isRowwise() const { return false; }
 };
 
 /// This class describes a workflow for processing a table using
@@ -79,36 +93,58 @@ public:
     /// TableOperator%s that require it.
     TimeSeriesTable process(std::string relativeToDirectory,
             const Model* model = nullptr) const {
-        TimeSeriesTable table;
-        if (get_filepath().empty()) {
-            if (m_tableProvided) {
-                table = m_table;
-            } else {
-                OPENSIM_THROW_FRMOBJ(Exception, "No source table.");
-            }
-        } else {
-            OPENSIM_THROW_IF_FRMOBJ(m_tableProvided, Exception,
-                    "Expected either an in-memory table or a filepath, but "
-                    "both were provided.");
-            std::string path = get_filepath();
-            if (!relativeToDirectory.empty()) {
-                using SimTK::Pathname;
-                path = Pathname::
-                        getAbsolutePathnameUsingSpecifiedWorkingDirectory(
-                                relativeToDirectory, path);
+        TimeSeriesTable table = createSourceTable(relativeToDirectory);
+        applyOperators(table, model);
+        return table;
+    }
+    /// Same as above, but the returned table contains only the columns whose
+    /// labels (after applying the operators) are in `columnLabels`, and only
+    /// the rows needed to interpolate the table within [initialTime,
+    /// finalTime]: the rows in this time range and the nearest row outside of
+    /// this range on either side. If `columnLabels` is empty, all columns are
+    /// kept. Labels in `columnLabels` that are not in the table are ignored.
+    /// The columns are discarded before the degrees-to-radians conversion and
+    /// the operators if all the operators process columns independently (see
+    /// TableOperator::updateColumnLabels()); otherwise, the columns are
+    /// discarded at the end. Likewise, the rows are discarded first if all
+    /// the operators process rows independently (see
+    /// TableOperator::isRowwise()).
+    /// The discarded rows do not affect linear interpolation within the time
+    /// range, but they do affect splines fit to the whole table (e.g.,
+    /// GCVSplineSet); if you fit such splines, do not provide a time range.
+    TimeSeriesTable process(std::string relativeToDirectory,
+            const Model* model, const std::vector<std::string>& columnLabels,
+            double initialTime = -SimTK::Infinity,
+            double finalTime = SimTK::Infinity) const {
+        TimeSeriesTable table = createSourceTable(relativeToDirectory);
+        std::vector<std::string> labels = table.getColumnLabels();
+        bool columnwise = true;
+        bool rowwise = true;
+        for (int i = 0; i < getProperty_operators().size(); ++i) {
+            const auto& op = get_operators(i);
+            if (columnwise) {
+                columnwise = op.updateColumnLabels(labels, model);
+                OPENSIM_THROW_IF_FRMOBJ(
+                        labels.size() != table.getNumColumns(), Exception,
+                        "TableOperator '{}' changed the number of column "
+                        "labels.",
+                        op.getConcreteClassName());
             }
-            table = TimeSeriesTable(path);
+            rowwise = rowwise && op.isRowwise();
         }
-
-        if (model && table.hasTableMetaDataKey("inDegrees") &&
-                table.getTableMetaDataAsString("inDegrees") == "yes") {
-            OPENSIM_THROW_IF(
-                    !model->hasSystem(), ModelHasNoSystem, model->getName());
-            model->getSimbodyEngine().convertDegreesToRadians(table);
+        if (columnwise || rowwise) {
+            table = selectRowsAndColumns(table,
+                    columnwise ? columnLabels : std::vector<std::string>(),
+                    labels, rowwise ? initialTime : -SimTK::Infinity,
+                    rowwise ? finalTime : SimTK::Infinity);
         }
-
-        for (int i = 0; i < getProperty_operators().size(); ++i) {
-            get_operators(i).operate(table, model);
+        applyOperators(table, model);
+        if (!columnwise || !rowwise) {
+            table = selectRowsAndColumns(table,
+                    columnwise ? std::vector<std::string>() : columnLabels,
+                    table.getColumnLabels(),
+                    rowwise ? -SimTK::Infinity : initialTime,
+                    rowwise ? SimTK::Infinity : finalTime);
         }
         return table;
     }
@@ -145,6 +181,84 @@ public:
     }
 
 private:
+    TimeSeriesTable createSourceTable(
+            const std::string& relativeToDirectory) const {
+        if (get_filepath().empty()) {
+            OPENSIM_THROW_IF_FRMOBJ(
+                    !m_tableProvided, Exception, "No source table.");
+            return m_table;
+        }
+        OPENSIM_THROW_IF_FRMOBJ(m_tableProvided, Exception,
+                "Expected either an in-memory table or a filepath, but "
+                "both were provided.");
+        std::string path = get_filepath();
+        if (!relativeToDirectory.empty()) {
+            using SimTK::Pathname;
+            path = Pathname::getAbsolutePathnameUsingSpecifiedWorkingDirectory(
+                    relativeToDirectory, path);
+        }
+        return TimeSeriesTable(path);
+    }
+
+    /// Convert columns from degrees to radians (if the model is provided) and
+    /// apply the operators.
+    void applyOperators(TimeSeriesTable& table, const Model* model) const {
+        if (model && table.hasTableMetaDataKey("inDegrees") &&
+                table.getTableMetaDataAsString("inDegrees") == "yes") {
+            OPENSIM_THROW_IF(
+                    !model->hasSystem(), ModelHasNoSystem, model->getName());
+            model->getSimbodyEngine().convertDegreesToRadians(table);
+        }
+
+        for (int i = 0; i < getProperty_operators().size(); ++i) {
+            get_operators(i).operate(table, model);
+        }
+    }
+
+    /// Create a table with the columns of `table` whose entry in `labels` is
+    /// in `columnLabels` (all columns if `columnLabels` is empty) and the rows
+    /// needed to interpolate within [initialTime, finalTime]. The entries of
+    /// `labels` correspond to the columns of `table` but may differ from the
+    /// table's labels (e.g., the labels after applying the operators).
+    static TimeSeriesTable selectRowsAndColumns(const TimeSeriesTable& table,
+            const std::vector<std::string>& columnLabels,
+            const std::vector<std::string>& labels, double initialTime,
+            double finalTime) {
+        std::vector<int> columns;
+        for (int icol = 0; icol < (int)labels.size(); ++icol) {
+            if (columnLabels.empty() ||
+                    std::find(columnLabels.begin(), columnLabels.end(),
+                            labels[icol]) != columnLabels.end()) {
+                columns.push_back(icol);
+            }
+        }
+        // Keep the last row at or before the initial time and the first row
+        // at or after the final time.
+        const auto& times = table.getIndependentColumn();
+        auto begin = std::upper_bound(times.begin(), times.end(), initialTime);
+        if (begin != times.begin()) --begin;
+        auto end = std::lower_bound(begin, times.end(), finalTime);
+        if (end != times.end()) ++end;
+        const int rowBegin = (int)(begin - times.begin());
+        const int numRows = (int)(end - begin);
+        if (columns.size() == table.getNumColumns() &&
+                numRows == (int)table.getNumRows()) {
+            return table;
+        }
+
+        const auto& matrix = table.getMatrix();
+        SimTK::Matrix data(numRows, (int)columns.size());
+        std::vector<std::string> selectedLabels;
+        for (int k = 0; k < (int)columns.size(); ++k) {
+            data.updCol(k) = matrix.col(columns[k])(rowBegin, numRows);
+            selectedLabels.push_back(table.getColumnLabel(columns[k]));
+        }
+        TimeSeriesTable selected(
+                std::vector<double>(begin, end), data, selectedLabels);
+        selected.updTableMetaData() = table.getTableMetaData();
+        return selected;
+    }
+
     bool m_tableProvided = false;
     TimeSeriesTable m_table;
 };
@@ -171,6 +285,13 @@ public:
             table = filterLowpass(table, get_cutoff_frequency(), true);
         }
     }
+    bool updateColumnLabels(std::vector<std::string>&,
+            const Model*) const override {
+        return true;
+    }
+    /// Filtering uses neighboring rows, so the rows are independent only if
+    /// there is no filtering.
+    bool isRowwise() const override { return get_cutoff_frequency() == -1; }
 };
 
 /// Update table column labels to use post-4.0 state paths instead of pre-4.0
@@ -199,6 +320,13 @@ public:
         updateStateLabels40(*model, labels);
         table.setColumnLabels(labels);
     }
+    bool updateColumnLabels(std::vector<std::string>& labels,
+            const Model* model) const override {
+        if (!model) return false;
+        updateStateLabels40(*model, labels);
+        return true;
+    }
+    bool isRowwise() const override { return true; }
 };
 
 } // namespace OpenSim
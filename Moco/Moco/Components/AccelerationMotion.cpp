@@ -52,8 +52,8 @@ public:
                                      mobod, accel)) {}
 };
 
-void AccelerationMotion::setUDot(
-        SimTK::State& state, const SimTK::Vector& fullUDot) const {
+void AccelerationMotion::setUDot(SimTK::State& state,
+        const SimTK::Vector& fullUDot, bool onlyIfChanged) const {
 
     OPENSIM_THROW_IF(fullUDot.size() != state.getNU(), Exception,
             "Incorrect size for fullUDot.");
@@ -64,6 +64,18 @@ void AccelerationMotion::setUDot(
     for (int i = 0; i < matter.getNumBodies(); ++i) {
         auto& mobod = matter.getMobilizedBody(SimTK::MobilizedBodyIndex(i));
         int nu = mobod.getNumU(state);
+        if (onlyIfChanged) {
+            const auto& current =
+                    defaultSub.getDiscreteVariable(state, m_dvIndices[i])
+                            .getValue<SimTK::Vector>();
+            if (current.size() == nu &&
+                    std::equal(fullUDot.getContiguousScalarData() + offset,
+                            fullUDot.getContiguousScalarData() + offset + nu,
+                            current.getContiguousScalarData())) {
+                offset += nu;
+                continue;
+            }
+        }
         auto& value = defaultSub.updDiscreteVariable(state, m_dvIndices[i]);
         value.updValue<SimTK::Vector>() = fullUDot(offset, nu);
         offset += nu;
@@ -81,6 +93,8 @@ const SimTK::Vector& AccelerationMotion::getUDot(
 void AccelerationMotion::setEnabled(
         SimTK::State& state, bool enabled) const {
     for (auto& motion : m_motions) {
+        // Enabling or disabling a motion invalidates the Instance stage.
+        if (motion.isDisabled(state) != enabled) continue;
         if (enabled) {
             motion.enable(state);
         } else {
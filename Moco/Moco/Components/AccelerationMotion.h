@@ -47,12 +47,17 @@ public:
     AccelerationMotion() = default;
     AccelerationMotion(std::string name) { setName(std::move(name)); }
     /// Set the UDot vector. The vector must have size SimTK::State::getNU().
-    void setUDot(SimTK::State& state, const SimTK::Vector& fullUDot) const;
+    /// If onlyIfChanged is true, the discrete variable for a MobilizedBody is
+    /// updated (invalidating the Acceleration stage) only if its values
+    /// differ from those already in the state.
+    void setUDot(SimTK::State& state, const SimTK::Vector& fullUDot,
+            bool onlyIfChanged = false) const;
     /// Get the subset of UDots for the requested MobilizedBody.
     const SimTK::Vector& getUDot(const SimTK::State& state,
             SimTK::MobilizedBodyIndex mobodIdx) const;
     /// Use this to set whether the prescribed acceleration motion is used or
-    /// not.
+    /// not. This has no effect (and does not invalidate the state) if the
+    /// motion is already in the requested setting.
     void setEnabled(SimTK::State& state, bool enabled) const;
 protected:
 private:
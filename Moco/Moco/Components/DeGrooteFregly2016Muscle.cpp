@@ -189,23 +189,10 @@ void DeGrooteFregly2016Muscle::computeStateVariableDerivatives(
     // Activation dynamics.
     // --------------------
     if (!get_ignore_activation_dynamics()) {
-        const auto& activation = getActivation(s);
-        const auto& excitation = getControl(s);
-        static const double actTimeConst = get_activation_time_constant();
-        static const double deactTimeConst = get_deactivation_time_constant();
-        static const double tanhSteepness = 0.1;
-        //     f = 0.5 tanh(b(e - a))
-        //     z = 0.5 + 1.5a
-        // da/dt = [(f + 0.5)/(tau_a * z) + (-f + 0.5)*z/tau_d] * (e - a)
-        const SimTK::Real timeConstFactor = 0.5 + 1.5 * activation;
-        const SimTK::Real tempAct = 1.0 / (actTimeConst * timeConstFactor);
-        const SimTK::Real tempDeact = timeConstFactor / deactTimeConst;
-        const SimTK::Real f =
-                0.5 * tanh(tanhSteepness * (excitation - activation));
-        const SimTK::Real timeConst =
-                tempAct * (f + 0.5) + tempDeact * (-f + 0.5);
-        const SimTK::Real derivative = timeConst * (excitation - activation);
-        setStateVariableDerivativeValue(s, STATE_ACTIVATION_NAME, derivative);
+        const SimTK::Real& activation = getActivation(s);
+        const SimTK::Real& excitation = getControl(s);
+        setStateVariableDerivativeValue(s, STATE_ACTIVATION_NAME,
+                calcActivationDerivative(excitation, activation));
     }
 
     // Tendon compliance dynamics.
@@ -465,9 +452,7 @@ void DeGrooteFregly2016Muscle::calcMuscleLengthInfo(
     if (mli.tendonLength < get_tendon_slack_length()) {
         // TODO the Millard model sets fiber velocity to zero when the
         //       tendon is buckling, but this may create a discontinuity.
-        log_info("DeGrooteFregly2016Muscle '{}' is buckling (length < "
-                 "tendon_slack_length) at time {} s.",
-                getName(), s.getTime());
+        m_bucklingCounter.record(s.getTime());
     }
 }
 
@@ -493,9 +478,7 @@ void DeGrooteFregly2016Muscle::calcFiberVelocityInfo(
             fvi, normTendonForce, normTendonForceDerivative);
 
     if (fvi.normFiberVelocity < -1.0) {
-        log_info("DeGrooteFregly2016Muscle '{}' is exceeding maximum "
-                 "contraction velocity at time {} s.",
-                getName(), s.getTime());
+        m_exceedingMaxContractionVelocityCounter.record(s.getTime());
     }
 }
 
@@ -303,6 +303,24 @@ public:
     /// Output functions.
     SimTK::Vec2 getBoundsNormalizedTendonForce(const SimTK::State&) const
     { return {getMinNormalizedTendonForce(), getMaxNormalizedTendonForce()}; }
+    /// The number of times (and the first time) calcMuscleLengthInfo() found
+    /// the muscle buckling (length < tendon_slack_length). These events are
+    /// counted instead of logged because they can occur in every solver
+    /// callback; Moco solvers log a summary after solving.
+    const DiagnosticCounter& getBucklingCounter() const {
+        return m_bucklingCounter;
+    }
+    /// The number of times (and the first time) calcFiberVelocityInfo() found
+    /// the muscle exceeding its maximum contraction velocity.
+    const DiagnosticCounter& getExceedingMaxContractionVelocityCounter() const {
+        return m_exceedingMaxContractionVelocityCounter;
+    }
+    /// Reset the counters above. The counters are also reset when the muscle
+    /// is copied.
+    void resetDiagnosticCounters() const {
+        m_bucklingCounter.reset();
+        m_exceedingMaxContractionVelocityCounter.reset();
+    }
     /// @}
 
     /// @name Set methods.
@@ -331,13 +349,7 @@ public:
     /// property.
     SimTK::Real calcActiveForceLengthMultiplier(
             const SimTK::Real& normFiberLength) const {
-        const double& scale = get_active_force_width_scale();
-        // Shift the curve so its peak is at the origin, scale it
-        // horizontally, then shift it back so its peak is still at x = 1.0.
-        const double x = (normFiberLength - 1.0) / scale + 1.0;
-        return calcGaussianLikeCurve(x, b11, b21, b31, b41) +
-               calcGaussianLikeCurve(x, b12, b22, b32, b42) +
-               calcGaussianLikeCurve(x, b13, b23, b33, b43);
+        return calcActiveForceLengthMultiplierImpl(normFiberLength);
     }
 
     /// The derivative of the active force-length curve with respect to
@@ -363,10 +375,7 @@ public:
     /// Range: [0, 1.794]
     static SimTK::Real calcForceVelocityMultiplier(
             const SimTK::Real& normFiberVelocity) {
-        using SimTK::square;
-        const SimTK::Real tempV = d2 * normFiberVelocity + d3;
-        const SimTK::Real tempLogArg = tempV + sqrt(square(tempV) + 1.0);
-        return d1 * log(tempLogArg) + d4;
+        return calcForceVelocityMultiplierImpl(normFiberVelocity);
     }
 
     /// This is the inverse of the force-velocity multiplier function, and
@@ -393,15 +402,7 @@ public:
     /// 0 for lengths less than optimal fiber length.)
     SimTK::Real calcPassiveForceMultiplier(
             const SimTK::Real& normFiberLength) const {
-        if (get_ignore_passive_fiber_force()) return 0;
-
-        const double& e0 = get_passive_fiber_strain_at_one_norm_force();
-
-        const double offset =
-                exp(kPE * (m_minNormFiberLength - 1.0) / e0);
-        const double denom = exp(kPE) - offset;
-
-        return (exp(kPE * (normFiberLength - 1.0) / e0) - offset) / denom;
+        return calcPassiveForceMultiplierImpl(normFiberLength);
     }
 
     /// This is the derivative of the passive force-length curve with respect to
@@ -654,6 +655,65 @@ public:
     }
     /// @}
 
+    /// @name Generic scalar types
+    /// These functions evaluate the same equations as
+    /// computeStateVariableDerivatives() and computeActuation() for scalar
+    /// types other than SimTK::Real (e.g., casadi::SX), allowing solvers to
+    /// form symbolic expressions for the muscle dynamics and differentiate
+    /// them exactly. computeStateVariableDerivatives() and the curves above
+    /// use the same implementations. The scalar type must support arithmetic
+    /// with doubles and unqualified calls to exp(), log(), sqrt(), and tanh().
+    /// @{
+
+    /// The time derivative of activation.
+    ///     f = 0.5 tanh(b(e - a))
+    ///     z = 0.5 + 1.5a
+    /// da/dt = [(f + 0.5)/(tau_a * z) + (-f + 0.5)*z/tau_d] * (e - a)
+    template <typename T>
+    T calcActivationDerivative(const T& excitation, const T& activation) const {
+        using std::tanh;
+        const double tanhSteepness = 0.1;
+        const T timeConstFactor = 0.5 + 1.5 * activation;
+        const T tempAct =
+                1.0 / (get_activation_time_constant() * timeConstFactor);
+        const T tempDeact = timeConstFactor / get_deactivation_time_constant();
+        const T f = 0.5 * tanh(tanhSteepness * (excitation - activation));
+        const T timeConst = tempAct * (f + 0.5) + tempDeact * (-f + 0.5);
+        return timeConst * (excitation - activation);
+    }
+
+    /// The tension in the muscle-tendon unit (the force along the tendon),
+    /// assuming a rigid tendon (ignore_tendon_compliance must be true).
+    template <typename T>
+    T calcRigidTendonTension(const T& activation, const T& muscleTendonLength,
+            const T& muscleTendonVelocity) const {
+        using std::sqrt;
+        OPENSIM_THROW_IF_FRMOBJ(!get_ignore_tendon_compliance(), Exception,
+                "Expected ignore_tendon_compliance to be true.");
+        const T fiberLengthAlongTendon =
+                muscleTendonLength - get_tendon_slack_length();
+        const T fiberLength = sqrt(fiberLengthAlongTendon *
+                                           fiberLengthAlongTendon +
+                                   m_squareFiberWidth);
+        const T normFiberLength = fiberLength / get_optimal_fiber_length();
+        const T cosPennationAngle = fiberLengthAlongTendon / fiberLength;
+        const T normFiberVelocity = muscleTendonVelocity * cosPennationAngle /
+                                    m_maxContractionVelocityInMetersPerSecond;
+
+        const T activeForceLengthMult =
+                calcActiveForceLengthMultiplierImpl(normFiberLength);
+        const T forceVelocityMult =
+                calcForceVelocityMultiplierImpl(normFiberVelocity);
+        const T passiveForceMult =
+                calcPassiveForceMultiplierImpl(normFiberLength);
+
+        const T normFiberForce =
+                activation * activeForceLengthMult * forceVelocityMult +
+                passiveForceMult + get_fiber_damping() * normFiberVelocity;
+        return get_max_isometric_force() * normFiberForce * cosPennationAngle;
+    }
+    /// @}
+
     /// @name Utilities
     /// @{
 
@@ -720,8 +780,7 @@ private:
     static SimTK::Real calcGaussianLikeCurve(const SimTK::Real& x,
             const double& b1, const double& b2, const double& b3,
             const double& b4) {
-        using SimTK::square;
-        return b1 * exp(-0.5 * square(x - b2) / square(b3 + b4 * x));
+        return calcGaussianLikeCurveImpl(x, b1, b2, b3, b4);
     }
 
     /// The derivative of the curve defined in calcGaussianLikeCurve() with
@@ -736,6 +795,48 @@ private:
                cube(b3 + b4 * x);
     }
 
+    // Implementations of the curves for any scalar type, shared by the
+    // SimTK::Real functions and the generic scalar functions (see
+    // calcRigidTendonTension()).
+    template <typename T>
+    static T calcGaussianLikeCurveImpl(const T& x, const double& b1,
+            const double& b2, const double& b3, const double& b4) {
+        using std::exp;
+        const T num = x - b2;
+        const T den = b3 + b4 * x;
+        return b1 * exp(-0.5 * num * num / (den * den));
+    }
+    template <typename T>
+    T calcActiveForceLengthMultiplierImpl(const T& normFiberLength) const {
+        const double& scale = get_active_force_width_scale();
+        // Shift the curve so its peak is at the origin, scale it
+        // horizontally, then shift it back so its peak is still at x = 1.0.
+        const T x = (normFiberLength - 1.0) / scale + 1.0;
+        return calcGaussianLikeCurveImpl(x, b11, b21, b31, b41) +
+               calcGaussianLikeCurveImpl(x, b12, b22, b32, b42) +
+               calcGaussianLikeCurveImpl(x, b13, b23, b33, b43);
+    }
+    template <typename T>
+    static T calcForceVelocityMultiplierImpl(const T& normFiberVelocity) {
+        using std::log;
+        using std::sqrt;
+        const T tempV = d2 * normFiberVelocity + d3;
+        return d1 * log(tempV + sqrt(tempV * tempV + 1.0)) + d4;
+    }
+    template <typename T>
+    T calcPassiveForceMultiplierImpl(const T& normFiberLength) const {
+        using std::exp;
+        if (get_ignore_passive_fiber_force()) return T(0);
+
+        const double& e0 = get_passive_fiber_strain_at_one_norm_force();
+
+        const double offset =
+                std::exp(kPE * (m_minNormFiberLength - 1.0) / e0);
+        const double denom = std::exp(kPE) - offset;
+
+        return (exp(kPE * (normFiberLength - 1.0) / e0) - offset) / denom;
+    }
+
     enum StatusFromEstimateMuscleFiberState {
         Success_Converged,
         Warning_FiberAtLowerBound,
@@ -833,6 +934,10 @@ private:
     SimTK::Real m_kT = SimTK::NaN;
     bool m_isTendonDynamicsExplicit = true;
 
+    // Diagnostics, recorded while computing cache variables.
+    mutable DiagnosticCounter m_bucklingCounter;
+    mutable DiagnosticCounter m_exceedingMaxContractionVelocityCounter;
+
     // Indices for MuscleDynamicsInfo::userDefinedDynamicsExtras.
     constexpr static int m_mdi_passiveFiberElasticForce = 0;
     constexpr static int m_mdi_passiveFiberDampingForce = 1;
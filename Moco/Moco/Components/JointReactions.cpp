@@ -0,0 +1,114 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: JointReactions.cpp                                           *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "JointReactions.h"
+
+#include <OpenSim/Simulation/Model/Model.h>
+
+using namespace OpenSim;
+
+static const std::string MOBILIZER_REACTION_FORCES_NAME =
+        "mobilizer_reaction_forces";
+
+const SimTK::Vector_<SimTK::SpatialVec>&
+JointReactions::getMobilizerReactionForces(const SimTK::State& s) const {
+    if (!isCacheVariableValid(s, MOBILIZER_REACTION_FORCES_NAME)) {
+        auto& forces = updCacheVariableValue<SimTK::Vector_<SimTK::SpatialVec>>(
+                s, MOBILIZER_REACTION_FORCES_NAME);
+        const auto& matter = getModel().getMatterSubsystem();
+        forces.resize(matter.getNumBodies());
+        matter.calcMobilizerReactionForces(s, forces);
+        markCacheVariableValid(s, MOBILIZER_REACTION_FORCES_NAME);
+    }
+    return getCacheVariableValue<SimTK::Vector_<SimTK::SpatialVec>>(
+            s, MOBILIZER_REACTION_FORCES_NAME);
+}
+
+SimTK::SpatialVec JointReactions::calcReactionOnChildExpressedInGround(
+        const SimTK::State& s, const Joint& joint) const {
+    if (!isJointInTree(joint)) {
+        return joint.calcReactionOnChildExpressedInGround(s);
+    }
+    // The joint's child frame is the mobilizer's outboard (M) frame.
+    return getMobilizerReactionForces(
+            s)[joint.getChildFrame().getMobilizedBodyIndex()];
+}
+
+SimTK::SpatialVec JointReactions::calcReactionOnParentExpressedInGround(
+        const SimTK::State& s, const Joint& joint) const {
+    if (!isJointInTree(joint)) {
+        return joint.calcReactionOnParentExpressedInGround(s);
+    }
+    // The load on the parent is equal and opposite to the load on the child;
+    // shift the moment from the child frame origin to the parent frame
+    // origin.
+    const SimTK::SpatialVec onChild =
+            calcReactionOnChildExpressedInGround(s, joint);
+    const SimTK::Vec3 childToParent =
+            joint.getParentFrame().getPositionInGround(s) -
+            joint.getChildFrame().getPositionInGround(s);
+    return SimTK::SpatialVec(
+            -onChild[0] - (onChild[1] % childToParent), -onChild[1]);
+}
+
+SimTK::SpatialVec JointReactions::getReactionOnChildExpressedInGround(
+        const SimTK::State& s, const std::string& channel) const {
+    return calcReactionOnChildExpressedInGround(
+            s, *m_jointsByName.at(channel));
+}
+
+SimTK::SpatialVec JointReactions::getReactionOnParentExpressedInGround(
+        const SimTK::State& s, const std::string& channel) const {
+    return calcReactionOnParentExpressedInGround(
+            s, *m_jointsByName.at(channel));
+}
+
+void JointReactions::extendConnectToModel(Model& model) {
+    Super::extendConnectToModel(model);
+    m_jointsByName.clear();
+    auto& onChild = updOutput("reaction_on_child");
+    auto& onParent = updOutput("reaction_on_parent");
+    onChild.clearChannels();
+    onParent.clearChannels();
+    for (const auto& joint : model.getComponentList<Joint>()) {
+        if (m_jointsByName.count(joint.getName())) {
+            log_warn("JointReactions: ignoring joint '{}' because another "
+                     "joint has the same name.",
+                    joint.getAbsolutePathString());
+            continue;
+        }
+        m_jointsByName[joint.getName()].reset(&joint);
+        onChild.addChannel(joint.getName());
+        onParent.addChannel(joint.getName());
+    }
+}
+
+void JointReactions::extendAddToSystem(SimTK::MultibodySystem& system) const {
+    Super::extendAddToSystem(system);
+    addCacheVariable(MOBILIZER_REACTION_FORCES_NAME,
+            SimTK::Vector_<SimTK::SpatialVec>(), SimTK::Stage::Acceleration);
+}
+
+bool JointReactions::isJointInTree(const Joint& joint) const {
+    const auto childIndex = joint.getChildFrame().getMobilizedBodyIndex();
+    if (childIndex == SimTK::GroundIndex) return false;
+    const auto& mobod = getModel().getMatterSubsystem().getMobilizedBody(
+            childIndex);
+    return mobod.getParentMobilizedBody().getMobilizedBodyIndex() ==
+           joint.getParentFrame().getMobilizedBodyIndex();
+}
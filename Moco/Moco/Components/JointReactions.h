@@ -0,0 +1,93 @@
+#ifndef MOCO_JOINTREACTIONS_H
+#define MOCO_JOINTREACTIONS_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: JointReactions.h                                             *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Simulation/Model/ModelComponent.h>
+#include <OpenSim/Simulation/SimbodyEngine/Joint.h>
+
+#include "../osimMocoDLL.h"
+
+#include <unordered_map>
+
+namespace OpenSim {
+
+/// This component computes the reaction loads of all joints in the model at
+/// once and caches them in the state.
+/// Joint::calcReactionOnChildExpressedInGround() and
+/// Joint::calcReactionOnParentExpressedInGround() compute the mobilizer
+/// reaction forces for the entire multibody tree to return the loads for a
+/// single joint; using this component instead, the reaction forces for the
+/// tree are computed once per realized state, and all users (e.g., multiple
+/// MocoJointReactionGoal%s and the outputs of this component) read from the
+/// cache. If the problem contains a MocoJointReactionGoal, MocoProblemRep adds
+/// this component to the model (unless the model already contains one). To
+/// use the outputs in other problems, add the component to the model.
+///
+/// The loads are the same as those from the Joint methods: the reaction on the
+/// child (parent) frame is applied at the origin of the child (parent) frame
+/// and expressed in ground. The outputs `reaction_on_child` and
+/// `reaction_on_parent` have a channel for each joint, named by the joint's
+/// name.
+/// The state must be realized to SimTK::Stage::Acceleration.
+class OSIMMOCO_API JointReactions : public ModelComponent {
+    OpenSim_DECLARE_CONCRETE_OBJECT(JointReactions, ModelComponent);
+
+public:
+    OpenSim_DECLARE_LIST_OUTPUT(reaction_on_child, SimTK::SpatialVec,
+            getReactionOnChildExpressedInGround, SimTK::Stage::Acceleration);
+    OpenSim_DECLARE_LIST_OUTPUT(reaction_on_parent, SimTK::SpatialVec,
+            getReactionOnParentExpressedInGround, SimTK::Stage::Acceleration);
+
+    JointReactions() = default;
+    JointReactions(std::string name) { setName(std::move(name)); }
+
+    /// The reaction forces of all mobilizers (see
+    /// SimTK::SimbodyMatterSubsystem::calcMobilizerReactionForces()), indexed
+    /// by SimTK::MobilizedBodyIndex, applied at the origin of each
+    /// mobilizer's outboard frame and expressed in ground.
+    const SimTK::Vector_<SimTK::SpatialVec>& getMobilizerReactionForces(
+            const SimTK::State& s) const;
+
+    /// The joint must be part of the same model as this component.
+    SimTK::SpatialVec calcReactionOnChildExpressedInGround(
+            const SimTK::State& s, const Joint& joint) const;
+    /// @copydoc calcReactionOnChildExpressedInGround()
+    SimTK::SpatialVec calcReactionOnParentExpressedInGround(
+            const SimTK::State& s, const Joint& joint) const;
+
+    SimTK::SpatialVec getReactionOnChildExpressedInGround(
+            const SimTK::State& s, const std::string& channel) const;
+    SimTK::SpatialVec getReactionOnParentExpressedInGround(
+            const SimTK::State& s, const std::string& channel) const;
+
+private:
+    void extendConnectToModel(Model& model) override;
+    void extendAddToSystem(SimTK::MultibodySystem& system) const override;
+    /// Can the reaction on the joint's child frame be taken directly from
+    /// the mobilizer reaction forces? This is not the case if the joint was
+    /// reversed or replaced by a constraint when building the multibody tree.
+    bool isJointInTree(const Joint& joint) const;
+
+    std::unordered_map<std::string, SimTK::ReferencePtr<const Joint>>
+            m_jointsByName;
+};
+
+} // namespace OpenSim
+
+#endif // MOCO_JOINTREACTIONS_H
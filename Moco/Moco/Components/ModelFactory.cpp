@@ -206,6 +206,16 @@ void ModelFactory::replaceMusclesWithPathActuators(OpenSim::Model &model) {
 
 void ModelFactory::replaceJointWithWeldJoint(
         Model& model, const std::string& jointName) {
+    replaceJointWithWeldJointImpl(model, jointName, nullptr);
+}
+
+void ModelFactory::replaceJointWithWeldJoint(Model& model,
+        const std::string& jointName, const SimTK::Transform& X_FM) {
+    replaceJointWithWeldJointImpl(model, jointName, &X_FM);
+}
+
+void ModelFactory::replaceJointWithWeldJointImpl(Model& model,
+        const std::string& jointName, const SimTK::Transform* X_FM) {
     OPENSIM_THROW_IF(!model.getJointSet().hasComponent(jointName), Exception,
                      "Joint with name '" + jointName +
                      "' not found in the model JointSet.");
@@ -221,6 +231,18 @@ void ModelFactory::replaceJointWithWeldJoint(
     PhysicalOffsetFrame* child_offset = PhysicalOffsetFrame().safeDownCast(
             current_joint.getChildFrame().clone());
 
+    // The weld holds the child frame M' at X_FM' = I, so for the child body B
+    // to keep its pose, X_BM' = X_BM * ~X_FM.
+    if (X_FM) {
+        SimTK::Transform X_BM;
+        X_BM.updR().setRotationToBodyFixedXYZ(child_offset->get_orientation());
+        X_BM.updP() = child_offset->get_translation();
+        const SimTK::Transform X_BMnew = X_BM * ~*X_FM;
+        child_offset->set_translation(X_BMnew.p());
+        child_offset->set_orientation(
+                X_BMnew.R().convertRotationToBodyFixedXYZ());
+    }
+
     // Save the original names of the body frames (not the offset frames), so we
     // can find them when the new joint is created.
     parent_offset->finalizeConnections(model);
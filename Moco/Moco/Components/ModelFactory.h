@@ -76,6 +76,16 @@ public:
     static void replaceJointWithWeldJoint(
             Model& model, const std::string& jointName);
 
+    /// Replace a joint in the model with a WeldJoint that holds the joint's
+    /// child frame at the transform `X_FM` in the joint's parent frame (e.g.,
+    /// the transform for fixed values of the joint's coordinates). The new
+    /// joint keeps the parent frame's offset and moves the child frame's
+    /// offset accordingly.
+    /// @note This assumes the joint is in the JointSet and that the joint's
+    ///       connectees are PhysicalOffsetFrames.
+    static void replaceJointWithWeldJoint(Model& model,
+            const std::string& jointName, const SimTK::Transform& X_FM);
+
     /// Add CoordinateActuator%s for each unconstrained coordinate (e.g.,
     /// `! Coordinate::isConstrained()`) in the model, using the provided optimal
     /// force. Increasing the optimal force decreases the required control
@@ -92,6 +102,10 @@ public:
             bool skipCoordinatesWithExistingActuators = true);
 
     /// @}
+
+private:
+    static void replaceJointWithWeldJointImpl(Model& model,
+            const std::string& jointName, const SimTK::Transform* X_FM);
 };
 
 } // namespace OpenSim
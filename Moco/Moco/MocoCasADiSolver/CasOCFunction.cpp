@@ -20,6 +20,10 @@
 
 #include "CasOCProblem.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 using namespace CasOC;
 
 casadi::Sparsity calcJacobianSparsityWithPerturbation(const VectorDM& x0s,
@@ -74,34 +78,606 @@ casadi::Sparsity calcJacobianSparsityWithPerturbation(const VectorDM& x0s,
 }
 
 casadi::Sparsity Function::get_jacobian_sparsity() const {
-    using casadi::DM;
-    using casadi::Slice;
+    // Both CasADi and calcReusedJacobian() ask for the sparsity, so we
+    // detect it only once.
+    std::call_once(m_jacobianSparsityFlag, [this]() {
+        using casadi::DM;
+        using casadi::Slice;
 
-    auto function = [this](const casadi::DM& x, casadi::DM& y) {
-        // Split input into separate DMs.
-        std::vector<casadi::DM> in(this->n_in());
-        {
-            int offset = 0;
-            for (int iin = 0; iin < this->n_in(); ++iin) {
-                OPENSIM_THROW_IF(this->size2_in(iin) != 1, OpenSim::Exception,
-                        "Internal error.");
-                const auto size = this->size1_in(iin);
-                in[iin] = x(Slice(offset, offset + size));
-                offset += size;
+        auto function = [this](const casadi::DM& x, casadi::DM& y) {
+            // Split input into separate DMs.
+            std::vector<casadi::DM> in(this->n_in());
+            {
+                int offset = 0;
+                for (int iin = 0; iin < this->n_in(); ++iin) {
+                    OPENSIM_THROW_IF(this->size2_in(iin) != 1,
+                            OpenSim::Exception, "Internal error.");
+                    const auto size = this->size1_in(iin);
+                    in[iin] = x(Slice(offset, offset + size));
+                    offset += size;
+                }
             }
+
+            // Evaluate the function.
+            std::vector<casadi::DM> out = this->eval(in);
+
+            // Create output.
+            y = casadi::DM::veccat(out);
+        };
+
+        const VectorDM x0s = getSubsetPointsForSparsityDetection();
+
+        m_jacobianSparsity = calcJacobianSparsityWithPerturbation(
+                x0s, (int)this->nnz_out(), function);
+    });
+    return m_jacobianSparsity;
+}
+
+namespace CasOC {
+
+/// Forward derivatives of a CasOC::Function, for the "adaptive" finite
+/// difference scheme. The inputs are the nominal inputs, the nominal outputs,
+/// and the forward seeds of the function; the outputs are the forward
+/// sensitivities (see casadi::Function::forward()). Each seed direction is
+/// differenced with a single evaluation (forward) unless it perturbs an input
+/// that requires central differences.
+class FiniteDifferenceForward : public casadi::Callback {
+public:
+    FiniteDifferenceForward(const Function& function, casadi_int nfwd,
+            std::vector<std::string> inames, std::vector<std::string> onames)
+            : m_function(function), m_nfwd(nfwd), m_inames(std::move(inames)),
+              m_onames(std::move(onames)) {}
+    casadi_int get_n_in() override {
+        return 2 * m_function.n_in() + m_function.n_out();
+    }
+    casadi_int get_n_out() override { return m_function.n_out(); }
+    std::string get_name_in(casadi_int i) override { return m_inames.at(i); }
+    std::string get_name_out(casadi_int i) override {
+        return m_onames.at(i);
+    }
+    casadi::Sparsity get_sparsity_in(casadi_int i) override {
+        const casadi_int numIn = m_function.n_in();
+        const casadi_int numOut = m_function.n_out();
+        if (i < numIn) return m_function.sparsity_in(i);
+        if (i < numIn + numOut) return m_function.sparsity_out(i - numIn);
+        return casadi::Sparsity::repmat(
+                m_function.sparsity_in(i - numIn - numOut), 1, m_nfwd);
+    }
+    casadi::Sparsity get_sparsity_out(casadi_int i) override {
+        return casadi::Sparsity::repmat(m_function.sparsity_out(i), 1, m_nfwd);
+    }
+    VectorDM eval(const VectorDM& args) const override {
+        using casadi::DM;
+        using casadi::Slice;
+        const int numIn = (int)m_function.n_in();
+        const int numOut = (int)m_function.n_out();
+        const VectorDM x0(args.begin(), args.begin() + numIn);
+        const auto& fdSteps = m_function.estimateFiniteDifferenceSteps(x0);
+        VectorDM f0(numOut);
+        for (int io = 0; io < numOut; ++io) {
+            f0[io] = DM::densify(args[numIn + io]);
         }
 
-        // Evaluate the function.
-        std::vector<casadi::DM> out = this->eval(in);
+        // The inputs of a CasOC::Function are column vectors, so each
+        // column of a seed is one direction.
+        std::vector<VectorDM> sensitivities(numOut, VectorDM(m_nfwd));
+        VectorDM direction(numIn);
+        VectorDM x(numIn);
+        for (int idir = 0; idir < (int)m_nfwd; ++idir) {
+            // Choose the scheme and step size for this direction from the
+            // inputs that the direction perturbs.
+            bool central = false;
+            double step = std::numeric_limits<double>::infinity();
+            int j = 0;
+            for (int ii = 0; ii < numIn; ++ii) {
+                direction[ii] = DM::densify(
+                        args[numIn + numOut + ii](Slice(), idir));
+                for (int k = 0; k < direction[ii].numel(); ++k, ++j) {
+                    const double v = std::abs(direction[ii](k).scalar());
+                    if (v == 0) continue;
+                    if (fdSteps.central[j] && !central) {
+                        // Central differences take precedence; discard the
+                        // forward steps found so far.
+                        central = true;
+                        step = std::numeric_limits<double>::infinity();
+                    }
+                    if (fdSteps.central[j] == central) {
+                        step = std::min(step, fdSteps.steps[j] / v);
+                    }
+                }
+            }
+            if (std::isinf(step)) {
+                for (int io = 0; io < numOut; ++io) {
+                    sensitivities[io][idir] = DM::zeros(f0[io].size1(), 1);
+                }
+                continue;
+            }
+            for (int ii = 0; ii < numIn; ++ii) {
+                x[ii] = x0[ii] + step * direction[ii];
+            }
+            const VectorDM fPlus = m_function.eval(x);
+            if (central) {
+                for (int ii = 0; ii < numIn; ++ii) {
+                    x[ii] = x0[ii] - step * direction[ii];
+                }
+                const VectorDM fMinus = m_function.eval(x);
+                for (int io = 0; io < numOut; ++io) {
+                    sensitivities[io][idir] = (DM::densify(fPlus[io]) -
+                                                      DM::densify(fMinus[io])) /
+                                              (2 * step);
+                }
+            } else {
+                for (int io = 0; io < numOut; ++io) {
+                    sensitivities[io][idir] =
+                            (DM::densify(fPlus[io]) - f0[io]) / step;
+                }
+            }
+        }
 
-        // Create output.
-        y = casadi::DM::veccat(out);
-    };
+        VectorDM out(numOut);
+        for (int io = 0; io < numOut; ++io) {
+            out[io] = DM::project(
+                    DM::horzcat(sensitivities[io]), sparsity_out(io));
+        }
+        return out;
+    }
+
+private:
+    const Function& m_function;
+    casadi_int m_nfwd;
+    std::vector<std::string> m_inames;
+    std::vector<std::string> m_onames;
+};
+
+/// Forward derivatives of a CasOC::Function that reuses its Jacobians (see
+/// Function::calcReusedJacobian()). The inputs and outputs are the same as
+/// for FiniteDifferenceForward; the sensitivities are the products of the
+/// Jacobian with the seeds.
+class JacobianReuseForward : public FiniteDifferenceForward {
+public:
+    JacobianReuseForward(const Function& function, casadi_int nfwd,
+            std::vector<std::string> inames, std::vector<std::string> onames)
+            : FiniteDifferenceForward(function, nfwd, std::move(inames),
+                      std::move(onames)),
+              m_function(function) {}
+    VectorDM eval(const VectorDM& args) const override {
+        using casadi::DM;
+        using casadi::Slice;
+        const int numIn = (int)m_function.n_in();
+        const int numOut = (int)m_function.n_out();
+        VectorDM x0(numIn);
+        VectorDM seeds(numIn);
+        for (int ii = 0; ii < numIn; ++ii) {
+            x0[ii] = DM::densify(args[ii]);
+            seeds[ii] = DM::densify(args[numIn + numOut + ii]);
+        }
+        VectorDM f0(numOut);
+        for (int io = 0; io < numOut; ++io) {
+            f0[io] = DM::densify(args[numIn + io]);
+        }
+        const DM jacobian = m_function.calcReusedJacobian(
+                DM::veccat(x0), DM::veccat(f0));
+        const DM sensitivities =
+                DM::densify(DM::mtimes(jacobian, DM::vertcat(seeds)));
+
+        VectorDM out(numOut);
+        int offset = 0;
+        for (int io = 0; io < numOut; ++io) {
+            const int size = (int)m_function.nnz_out(io);
+            if (size == 0) {
+                out[io] = DM(sparsity_out(io));
+            } else {
+                out[io] = DM::project(
+                        sensitivities(Slice(offset, offset + size), Slice()),
+                        sparsity_out(io));
+            }
+            offset += size;
+        }
+        return out;
+    }
+
+private:
+    const Function& m_function;
+};
+
+} // namespace CasOC
+
+casadi::Function Function::get_forward(casadi_int nfwd,
+        const std::string& name, const std::vector<std::string>& inames,
+        const std::vector<std::string>& onames,
+        const casadi::Dict& opts) const {
+    std::unique_ptr<casadi::Callback> forward;
+    if (m_jacobianRefreshInterval > 1) {
+        forward = OpenSim::make_unique<JacobianReuseForward>(
+                *this, nfwd, inames, onames);
+    } else {
+        forward = OpenSim::make_unique<FiniteDifferenceForward>(
+                *this, nfwd, inames, onames);
+    }
+    casadi::Dict forwardOpts = opts;
+    // Second derivatives (e.g., for an exact Hessian) use finite differences
+    // of these forward derivatives.
+    forwardOpts["enable_fd"] = true;
+    forwardOpts["fd_method"] = "forward";
+    forward->construct(name, forwardOpts);
+    casadi::Function function = *forward;
+    std::lock_guard<std::mutex> lock(m_forwardFunctionsMutex);
+    m_forwardFunctions.push_back(std::move(forward));
+    return function;
+}
+
+const Function::FiniteDifferenceSteps& Function::estimateFiniteDifferenceSteps(
+        const VectorDM& inputs) const {
+    std::call_once(m_finiteDifferenceStepsFlag, [&]() {
+        using casadi::DM;
+        const double eps = std::numeric_limits<double>::epsilon();
+        // The largest acceptable error of a forward difference, relative to
+        // the magnitude of the derivative.
+        const double tolerance = 1e-6;
+
+        const DM x0 = DM::veccat(inputs);
+        const DM f0 = evalConcatenated(x0);
+        const int numInputs = (int)x0.numel();
+        const int numOutputs = (int)f0.numel();
+        auto& steps = m_finiteDifferenceSteps.steps;
+        auto& central = m_finiteDifferenceSteps.central;
+        steps.resize(numInputs);
+        central.resize(numInputs);
+        DM x = x0;
+        for (int j = 0; j < numInputs; ++j) {
+            const double xj = x0(j).scalar();
+            const double scale = 1 + std::abs(xj);
+            auto evaluateAt = [&](double perturbation) {
+                x(j) = xj + perturbation;
+                const DM f = evalConcatenated(x);
+                x(j) = xj;
+                return f;
+            };
+
+            // Estimate the noise in each output from the third differences
+            // of the output on a stencil small enough that the smooth part
+            // of the function is nearly linear (More and Wild, 2011,
+            // "Estimating computational noise").
+            const double delta = 1e-8 * scale;
+            std::vector<DM> stencil(7);
+            for (int k = 0; k < 7; ++k) {
+                stencil[k] = k == 3 ? f0 : evaluateAt((k - 3) * delta);
+            }
+
+            // Estimate the curvature and the derivative with a larger step.
+            const double probe = 1e-4 * scale;
+            const DM fPlus = evaluateAt(probe);
+            const DM fMinus = evaluateAt(-probe);
+
+            // For an output with noise e and curvature c, the best forward
+            // difference step is 2 sqrt(e / c), with an error of
+            // 2 sqrt(e c). The best central difference step is
+            // cbrt(3 e / d), where d is the magnitude of the third
+            // derivative, which we approximate as c / scale.
+            double forwardStep = std::numeric_limits<double>::infinity();
+            double centralStep = std::numeric_limits<double>::infinity();
+            bool useCentral = false;
+            for (int io = 0; io < numOutputs; ++io) {
+                double sumSquares = 0;
+                for (int k = 0; k < 4; ++k) {
+                    const double diff3 = stencil[k + 3].ptr()[io] -
+                                         3 * stencil[k + 2].ptr()[io] +
+                                         3 * stencil[k + 1].ptr()[io] -
+                                         stencil[k].ptr()[io];
+                    sumSquares += diff3 * diff3;
+                }
+                const double value = f0.ptr()[io];
+                // The factor 0.05 is (3!)^2 / 6!.
+                const double e = std::max(std::sqrt(0.05 * sumSquares / 4),
+                        eps * std::abs(value));
+                const double secondDiff = std::abs(
+                        fPlus.ptr()[io] - 2 * value + fMinus.ptr()[io]);
+                // Skip outputs whose curvature is lost in the noise.
+                if (!(secondDiff > 40 * e)) continue;
+                const double c = secondDiff / (probe * probe);
+                forwardStep = std::min(forwardStep, 2 * std::sqrt(e / c));
+                centralStep =
+                        std::min(centralStep, std::cbrt(3 * e * scale / c));
+                const double derivative =
+                        (fPlus.ptr()[io] - fMinus.ptr()[io]) / (2 * probe);
+                const double error = 2 * std::sqrt(e * c);
+                const double magnitude = std::max(std::abs(derivative),
+                        1e-6 * std::abs(value) / scale);
+                if (error > tolerance * magnitude) useCentral = true;
+            }
+            double step;
+            if (useCentral) {
+                step = std::isinf(centralStep) ? std::cbrt(eps) * scale
+                                               : centralStep;
+            } else {
+                step = std::isinf(forwardStep) ? std::sqrt(eps) * scale
+                                               : forwardStep;
+            }
+            steps[j] = std::min(std::max(step, 1e-10 * scale), 1e-2 * scale);
+            central[j] = useCentral;
+        }
+    });
+    return m_finiteDifferenceSteps;
+}
+
+VectorDM Function::splitInputs(const casadi::DM& x) const {
+    VectorDM in(n_in());
+    int offset = 0;
+    for (int iin = 0; iin < (int)n_in(); ++iin) {
+        const int size = (int)size1_in(iin);
+        in[iin] = x(casadi::Slice(offset, offset + size));
+        offset += size;
+    }
+    return in;
+}
+
+casadi::DM Function::evalConcatenated(const casadi::DM& x) const {
+    VectorDM out = eval(splitInputs(x));
+    for (auto& output : out) output = casadi::DM::densify(output);
+    return casadi::DM::veccat(out);
+}
+
+const casadi::Sparsity& Function::getReusedJacobianSparsity() const {
+    std::call_once(m_reusedJacobianSparsityFlag, [this]() {
+        m_reusedJacobianSparsity =
+                has_jacobian_sparsity()
+                        ? get_jacobian_sparsity()
+                        : casadi::Sparsity::dense(nnz_out(), nnz_in());
+        // Greedily assign each column to the first color whose columns share
+        // no rows with it.
+        const auto& sparsity = m_reusedJacobianSparsity;
+        const auto& colind = sparsity.colind();
+        const auto& row = sparsity.row();
+        std::vector<std::vector<bool>> rowsInColor;
+        for (int j = 0; j < (int)sparsity.size2(); ++j) {
+            if (colind[j] == colind[j + 1]) continue;
+            int color = 0;
+            for (; color < (int)rowsInColor.size(); ++color) {
+                bool shared = false;
+                for (auto k = colind[j]; k < colind[j + 1]; ++k) {
+                    if (rowsInColor[color][row[k]]) {
+                        shared = true;
+                        break;
+                    }
+                }
+                if (!shared) break;
+            }
+            if (color == (int)rowsInColor.size()) {
+                rowsInColor.emplace_back(sparsity.size1(), false);
+                m_reusedJacobianColors.emplace_back();
+            }
+            for (auto k = colind[j]; k < colind[j + 1]; ++k) {
+                rowsInColor[color][row[k]] = true;
+            }
+            m_reusedJacobianColors[color].push_back(j);
+        }
+    });
+    return m_reusedJacobianSparsity;
+}
+
+std::vector<double> Function::calcFiniteDifferenceJacobian(
+        const std::vector<double>& x, const std::vector<double>& f) const {
+    const auto& sparsity = getReusedJacobianSparsity();
+    const auto& colind = sparsity.colind();
+    const auto& row = sparsity.row();
+    const double eps = std::numeric_limits<double>::epsilon();
+    const std::string& scheme = getFiniteDifferenceScheme();
+    const FiniteDifferenceSteps* adaptiveSteps = nullptr;
+    if (scheme == "adaptive") {
+        adaptiveSteps = &estimateFiniteDifferenceSteps(
+                splitInputs(casadi::DM(x)));
+    }
+    const double sign = scheme == "backward" ? -1 : 1;
+
+    std::vector<double> nonzeros(sparsity.nnz(), 0);
+    std::vector<double> steps(x.size(), 0);
+    std::vector<double> perturbed = x;
+    for (const auto& color : m_reusedJacobianColors) {
+        // Perturb all columns of this color at once.
+        bool central = scheme == "central";
+        for (const int j : color) {
+            const double scale = 1 + std::abs(x[j]);
+            if (adaptiveSteps) {
+                steps[j] = adaptiveSteps->steps[j];
+                if (adaptiveSteps->central[j]) central = true;
+            } else {
+                steps[j] = (central ? std::cbrt(eps) : std::sqrt(eps)) * scale;
+            }
+        }
+        for (const int j : color) perturbed[j] = x[j] + sign * steps[j];
+        const casadi::DM fPlus = evalConcatenated(casadi::DM(perturbed));
+        casadi::DM fMinus;
+        if (central) {
+            for (const int j : color) perturbed[j] = x[j] - steps[j];
+            fMinus = evalConcatenated(casadi::DM(perturbed));
+        }
+        for (const int j : color) {
+            perturbed[j] = x[j];
+            for (auto k = colind[j]; k < colind[j + 1]; ++k) {
+                const auto i = row[k];
+                if (central) {
+                    nonzeros[k] = (fPlus.ptr()[i] - fMinus.ptr()[i]) /
+                                  (2 * steps[j]);
+                } else {
+                    nonzeros[k] = sign * (fPlus.ptr()[i] - f[i]) / steps[j];
+                }
+            }
+        }
+    }
+    return nonzeros;
+}
+
+namespace {
+/// The largest change in the inputs, relative to their magnitude, across
+/// which a Jacobian is updated instead of recomputed.
+const double reusedJacobianMaxStep = 0.05;
+/// Changes in the inputs smaller than this (relative to their magnitude) are
+/// too small to update the Jacobian without amplifying noise in the outputs;
+/// the Jacobian is reused as is.
+const double reusedJacobianMinStep = 1e-6;
+/// The largest error in the change of the outputs predicted by a Jacobian,
+/// relative to the change, for which the Jacobian is updated instead of
+/// recomputed.
+const double reusedJacobianMaxPredictionError = 0.1;
+
+/// The infinity norm of the difference between a and b, relative to the
+/// magnitude of a. We stop once the distance exceeds `bound`.
+double calcRelativeDistance(const std::vector<double>& a,
+        const std::vector<double>& b, double bound) {
+    double distance = 0;
+    for (int i = 0; i < (int)a.size() && distance <= bound; ++i) {
+        distance = std::max(
+                distance, std::abs(b[i] - a[i]) / (1 + std::abs(a[i])));
+    }
+    return distance;
+}
+
+/// Update the nonzeros of a Jacobian with Schubert's sparse Broyden update,
+/// so that the Jacobian maps the change in the inputs, s, to the change in
+/// the outputs, y, while changing each row of the Jacobian as little as
+/// possible. Returns false (without updating) if the Jacobian predicts y too
+/// poorly; scale is the magnitude of the outputs.
+bool updateJacobianBroyden(const casadi::Sparsity& sparsity,
+        const std::vector<double>& s, const std::vector<double>& y,
+        double scale, std::vector<double>& nonzeros) {
+    const auto& colind = sparsity.colind();
+    const auto& row = sparsity.row();
+    std::vector<double> residual = y;
+    std::vector<double> rowSumSquares(y.size(), 0);
+    for (int j = 0; j < (int)s.size(); ++j) {
+        for (auto k = colind[j]; k < colind[j + 1]; ++k) {
+            residual[row[k]] -= nonzeros[k] * s[j];
+            rowSumSquares[row[k]] += s[j] * s[j];
+        }
+    }
+    double error = 0;
+    double change = 0;
+    for (int i = 0; i < (int)y.size(); ++i) {
+        error = std::max(error, std::abs(residual[i]));
+        change = std::max(change, std::abs(y[i]));
+    }
+    const double eps = std::numeric_limits<double>::epsilon();
+    if (error > reusedJacobianMaxPredictionError * change +
+                        std::sqrt(eps) * scale) {
+        return false;
+    }
+    for (int j = 0; j < (int)s.size(); ++j) {
+        for (auto k = colind[j]; k < colind[j + 1]; ++k) {
+            const auto i = row[k];
+            if (rowSumSquares[i] > 0) {
+                nonzeros[k] += residual[i] * s[j] / rowSumSquares[i];
+            }
+        }
+    }
+    return true;
+}
+} // namespace
+
+casadi::DM Function::calcReusedJacobian(
+        const casadi::DM& inputs, const casadi::DM& outputs) const {
+    const auto& sparsity = getReusedJacobianSparsity();
+    const std::vector<double> x = casadi::DM::densify(inputs).nonzeros();
+    const std::vector<double> f = casadi::DM::densify(outputs).nonzeros();
+
+    // Find the Jacobian kept for the point nearest to x. Neighboring mesh
+    // points may be closer to each other than to their own points from the
+    // previous iterate, so each kept Jacobian is used by only one point per
+    // pass over the points.
+    std::shared_ptr<ReusedJacobian> nearest;
+    double distance = std::numeric_limits<double>::infinity();
+    ReusedJacobian previous;
+    bool close = false;
+    {
+        std::lock_guard<std::mutex> lock(m_reusedJacobiansMutex);
+        for (const auto& entry : m_reusedJacobians) {
+            if (entry->inputs == x) {
+                // CasADi may request several batches of forward derivatives
+                // at the same point.
+                entry->lastUse = m_reusedJacobianClock;
+                return casadi::DM(sparsity, entry->nonzeros);
+            }
+        }
+        ++m_reusedJacobianClock;
+        // Once every kept Jacobian has been used, a new pass begins.
+        if (std::all_of(m_reusedJacobians.begin(), m_reusedJacobians.end(),
+                    [](const std::shared_ptr<ReusedJacobian>& entry) {
+                        return entry->claimed;
+                    })) {
+            for (const auto& entry : m_reusedJacobians) {
+                entry->claimed = false;
+            }
+        }
+        for (const auto& entry : m_reusedJacobians) {
+            if (entry->claimed) continue;
+            const double d = calcRelativeDistance(entry->inputs, x, distance);
+            if (d < distance) {
+                distance = d;
+                nearest = entry;
+            }
+        }
+        close = nearest && distance <= reusedJacobianMaxStep;
+        if (close) {
+            nearest->claimed = true;
+            previous = *nearest;
+        }
+    }
 
-    const VectorDM x0s = getSubsetPointsForSparsityDetection();
+    ReusedJacobian updated;
+    updated.inputs = x;
+    updated.outputs = f;
+    updated.claimed = true;
+    bool recompute = !close ||
+                     previous.numUpdates + 1 >= m_jacobianRefreshInterval;
+    if (!recompute) {
+        updated.nonzeros = previous.nonzeros;
+        updated.numUpdates = previous.numUpdates + 1;
+        if (distance >= reusedJacobianMinStep) {
+            std::vector<double> s(x.size());
+            for (int j = 0; j < (int)x.size(); ++j) {
+                s[j] = x[j] - previous.inputs[j];
+            }
+            std::vector<double> y(f.size());
+            double scale = 1;
+            for (int i = 0; i < (int)f.size(); ++i) {
+                y[i] = f[i] - previous.outputs[i];
+                scale = std::max(scale, 1 + std::abs(f[i]));
+            }
+            recompute = !updateJacobianBroyden(
+                    sparsity, s, y, scale, updated.nonzeros);
+        }
+    }
+    if (recompute) {
+        updated.nonzeros = calcFiniteDifferenceJacobian(x, f);
+        updated.numUpdates = 0;
+    }
 
-    return calcJacobianSparsityWithPerturbation(
-            x0s, (int)this->nnz_out(), function);
+    {
+        std::lock_guard<std::mutex> lock(m_reusedJacobiansMutex);
+        updated.lastUse = m_reusedJacobianClock;
+        // Replace the entry we started from, if it is still kept; otherwise,
+        // keep a new entry.
+        const auto it = std::find(
+                m_reusedJacobians.begin(), m_reusedJacobians.end(), nearest);
+        if (close && it != m_reusedJacobians.end()) {
+            **it = updated;
+        } else {
+            m_reusedJacobians.push_back(
+                    std::make_shared<ReusedJacobian>(updated));
+        }
+        // Forget the Jacobians of points that have not been visited for two
+        // passes over the kept points.
+        const long long maxAge = 2 * (long long)m_reusedJacobians.size();
+        const long long clock = m_reusedJacobianClock;
+        m_reusedJacobians.erase(
+                std::remove_if(m_reusedJacobians.begin(),
+                        m_reusedJacobians.end(),
+                        [clock, maxAge](const std::shared_ptr<ReusedJacobian>&
+                                        entry) {
+                            return clock - entry->lastUse > maxAge;
+                        }),
+                m_reusedJacobians.end());
+    }
+    return casadi::DM(sparsity, updated.nonzeros);
 }
 
 void Function::constructFunction(const Problem* casProblem,
@@ -110,6 +686,7 @@ void Function::constructFunction(const Problem* casProblem,
                 pointsForSparsityDetection) {
     m_casProblem = casProblem;
     m_finite_difference_scheme = finiteDiffScheme;
+    m_jacobianRefreshInterval = casProblem->getJacobianRefreshInterval();
     m_fullPointsForSparsityDetection = pointsForSparsityDetection;
     casadi::Dict opts;
     setCommonOptions(opts);
@@ -150,6 +727,14 @@ VectorDM CostIntegrand::eval(const VectorDM& args) const {
     return out;
 }
 
+VectorDM CostIntegrandResiduals::eval(const VectorDM& args) const {
+    Problem::ContinuousInput input{args.at(0).scalar(), args.at(1), args.at(2),
+            args.at(3), args.at(4), args.at(5)};
+    VectorDM out{casadi::DM(sparsity_out(0))};
+    m_casProblem->calcCostIntegrandResiduals(m_index, input, out.at(0));
+    return out;
+}
+
 VectorDM EndpointConstraintIntegrand::eval(const VectorDM& args) const {
     Problem::ContinuousInput input{args.at(0).scalar(), args.at(1), args.at(2),
                                    args.at(3), args.at(4), args.at(5)};
@@ -159,7 +744,7 @@ VectorDM EndpointConstraintIntegrand::eval(const VectorDM& args) const {
     return out;
 }
 
-casadi::Sparsity Endpoint::get_sparsity_in(casadi_int i) {
+casadi::Sparsity Endpoints::get_sparsity_in(casadi_int i) {
     if (i == 0) {
         return casadi::Sparsity::dense(1, 1);
     } else if (i == 1) {
@@ -183,26 +768,90 @@ casadi::Sparsity Endpoint::get_sparsity_in(casadi_int i) {
     } else if (i == 10) {
         return casadi::Sparsity::dense(m_casProblem->getNumParameters(), 1);
     } else if (i == 11) {
-        return casadi::Sparsity::dense(1, 1);
+        return casadi::Sparsity::dense(m_numIntegrals, 1);
     } else {
         return casadi::Sparsity(0, 0);
     }
 }
-VectorDM Cost::eval(const VectorDM& args) const {
+VectorDM Endpoints::eval(const VectorDM& args) const {
+    // Each goal's integral is provided separately in args.at(11).
+    const double integral = std::numeric_limits<double>::quiet_NaN();
     Problem::CostInput input{args.at(0).scalar(), args.at(1), args.at(2),
             args.at(3), args.at(4), args.at(5).scalar(), args.at(6), args.at(7),
-            args.at(8), args.at(9), args.at(10), args.at(11).scalar()};
+            args.at(8), args.at(9), args.at(10), integral};
     VectorDM out{casadi::DM(sparsity_out(0))};
-    m_casProblem->calcCost(m_index, input, out.at(0));
+    m_casProblem->calcEndpoints(input, args.at(11), out.at(0));
     return out;
 }
-VectorDM EndpointConstraint::eval(const VectorDM& args) const {
-    Problem::CostInput input{args.at(0).scalar(), args.at(1), args.at(2),
-            args.at(3), args.at(4), args.at(5).scalar(), args.at(6), args.at(7),
-            args.at(8), args.at(9), args.at(10), args.at(11).scalar()};
-    VectorDM out{casadi::DM(sparsity_out(0))};
-    m_casProblem->calcEndpointConstraint(m_index, input, out.at(0));
-    return out;
+
+casadi::Function Endpoints::get_forward(casadi_int nfwd,
+        const std::string& name, const std::vector<std::string>& inames,
+        const std::vector<std::string>& onames,
+        const casadi::Dict& opts) const {
+    // The steps of the "adaptive" scheme are estimated numerically for each
+    // input, and reused Jacobians are stored per point; neither fits the
+    // symbolic perturbations below, so these derivatives are computed
+    // serially by Function::get_forward().
+    if (m_parallelism.second <= 1 || hasOwnForwardDerivatives()) {
+        return Function::get_forward(nfwd, name, inames, onames, opts);
+    }
+    using casadi::MX;
+    using casadi::Slice;
+    // The inputs to the forward function are the nominal inputs, the nominal
+    // outputs, and the forward seeds (one column per direction).
+    std::vector<MX> nominalIn(n_in());
+    std::vector<MX> seeds(n_in());
+    for (casadi_int i = 0; i < n_in(); ++i) {
+        nominalIn[i] = MX::sym(inames[i], sparsity_in(i));
+        seeds[i] = MX::sym(inames[n_in() + n_out() + i],
+                casadi::Sparsity::dense(size1_in(i), nfwd));
+    }
+    const MX nominalOut = MX::sym(inames[n_in()], sparsity_out(0));
+
+    // Perturb the inputs along each seed direction, and evaluate all perturbed
+    // points with a single mapped call so that they are spread across threads.
+    const std::string scheme = getFiniteDifferenceScheme();
+    const double eps = std::numeric_limits<double>::epsilon();
+    std::vector<double> signs;
+    double step;
+    if (scheme == "central") {
+        signs = {1, -1};
+        step = std::cbrt(eps);
+    } else if (scheme == "backward") {
+        signs = {-1};
+        step = std::sqrt(eps);
+    } else {
+        signs = {1};
+        step = std::sqrt(eps);
+    }
+    std::vector<MX> perturbedIn(n_in());
+    for (casadi_int i = 0; i < n_in(); ++i) {
+        std::vector<MX> columns;
+        for (const auto& sign : signs) {
+            columns.push_back(MX::repmat(nominalIn[i], 1, nfwd) +
+                              sign * step * seeds[i]);
+        }
+        perturbedIn[i] = MX::horzcat(columns);
+    }
+    const auto mapped = map((casadi_int)signs.size() * nfwd,
+            m_parallelism.first, m_parallelism.second);
+    const MX perturbedOut = mapped(perturbedIn).at(0);
+
+    MX forward;
+    if (signs.size() == 2) {
+        const int n = (int)nfwd;
+        forward = (perturbedOut(Slice(), Slice(0, n)) -
+                          perturbedOut(Slice(), Slice(n, 2 * n))) /
+                  (2 * step);
+    } else {
+        forward = signs[0] * (perturbedOut - MX::repmat(nominalOut, 1, nfwd)) /
+                  step;
+    }
+
+    std::vector<MX> forwardIn = nominalIn;
+    forwardIn.push_back(nominalOut);
+    forwardIn.insert(forwardIn.end(), seeds.begin(), seeds.end());
+    return casadi::Function(name, forwardIn, {forward}, inames, onames, opts);
 }
 
 template <bool CalcKCErrors>
@@ -290,6 +939,62 @@ VectorDM VelocityCorrection::eval(const VectorDM& args) const {
     return out;
 }
 
+casadi::Sparsity IntervalIntegration::get_sparsity_in(casadi_int i) {
+    if (i == 0 || i == 1) {
+        return casadi::Sparsity::dense(1, 1);
+    } else if (i == 2) {
+        return casadi::Sparsity::dense(m_casProblem->getNumStates(), 1);
+    } else if (i == 3) {
+        return casadi::Sparsity::dense(m_casProblem->getNumControls(), 1);
+    } else if (i == 4) {
+        return casadi::Sparsity::dense(m_casProblem->getNumParameters(), 1);
+    } else {
+        return casadi::Sparsity(0, 0);
+    }
+}
+
+casadi::Sparsity IntervalIntegration::get_sparsity_out(casadi_int i) {
+    if (i == 0) {
+        return casadi::Sparsity::dense(m_casProblem->getNumStates(), 1);
+    } else {
+        return casadi::Sparsity(0, 0);
+    }
+}
+
+VectorDM IntervalIntegration::eval(const VectorDM& args) const {
+    Problem::IntervalInput input{args.at(0).scalar(), args.at(1).scalar(),
+            args.at(2), args.at(3), args.at(4)};
+    VectorDM out{casadi::DM(sparsity_out(0))};
+    m_casProblem->calcIntervalIntegration(input, out[0]);
+    return out;
+}
+
+casadi::Sparsity PathGeometry::get_sparsity_out(casadi_int i) {
+    const int numActuators = m_casProblem->getNumSymbolicActuators();
+    if (i == 0 || i == 1) {
+        return casadi::Sparsity::dense(numActuators, 1);
+    } else if (i == 2) {
+        return casadi::Sparsity::dense(
+                m_casProblem->getNumMultibodyDynamicsEquations() *
+                        numActuators,
+                1);
+    } else {
+        return casadi::Sparsity(0, 0);
+    }
+}
+
+VectorDM PathGeometry::eval(const VectorDM& args) const {
+    Problem::ContinuousInput input{args.at(0).scalar(), args.at(1), args.at(2),
+            args.at(3), args.at(4), args.at(5)};
+    VectorDM out((int)n_out());
+    for (casadi_int i = 0; i < n_out(); ++i) {
+        out[i] = casadi::DM(sparsity_out(i));
+    }
+    Problem::PathGeometryOutput output{out[0], out[1], out[2]};
+    m_casProblem->calcPathGeometry(input, output);
+    return out;
+}
+
 template <bool CalcKCErrors>
 casadi::Sparsity MultibodySystemImplicit<CalcKCErrors>::get_sparsity_out(
         casadi_int i) {
@@ -22,6 +22,8 @@
 
 #include <OpenSim/Common/Exception.h>
 
+#include <mutex>
+
 namespace CasOC {
 
 class Problem;
@@ -37,14 +39,28 @@ public:
                     pointsForSparsityDetection);
     void setCommonOptions(casadi::Dict& opts) {
         // Compute the derivatives of this function using finite differences.
-        opts["enable_fd"] = true;
-        opts["fd_method"] = getFiniteDifferenceScheme();
+        // With the "adaptive" scheme or when reusing Jacobians, we provide
+        // the forward derivatives ourselves (see get_forward()).
+        opts["enable_fd"] = !hasOwnForwardDerivatives();
+        if (getFiniteDifferenceScheme() != "adaptive") {
+            opts["fd_method"] = getFiniteDifferenceScheme();
+        }
         // Using "forward", iterations are 10x faster but problems are less
         // likely to converge.
     }
-    std::string getFiniteDifferenceScheme() {
+    std::string getFiniteDifferenceScheme() const {
         return m_finite_difference_scheme;
     }
+    /// See Problem::getJacobianRefreshInterval().
+    int getJacobianRefreshInterval() const {
+        return m_jacobianRefreshInterval;
+    }
+    /// Do we compute the forward derivatives of this function ourselves
+    /// instead of letting CasADi use finite differences?
+    bool hasOwnForwardDerivatives() const {
+        return getFiniteDifferenceScheme() == "adaptive" ||
+               m_jacobianRefreshInterval > 1;
+    }
     casadi_int get_n_in() override { return 6; }
     std::string get_name_in(casadi_int i) override {
         switch (i) {
@@ -63,6 +79,49 @@ public:
     }
     casadi::Sparsity get_jacobian_sparsity() const override;
 
+    /// With the "adaptive" finite difference scheme, forward derivatives are
+    /// computed with a step size for each scalar input, and with forward
+    /// differences for inputs where they are accurate and central differences
+    /// elsewhere. The step sizes and schemes are chosen once, at the first
+    /// point at which derivatives are requested, from estimates of the noise
+    /// and curvature of the function (see estimateFiniteDifferenceSteps()).
+    /// When reusing Jacobians (getJacobianRefreshInterval() > 1), forward
+    /// derivatives are products of the seeds with the Jacobian from
+    /// calcReusedJacobian().
+    bool has_forward(casadi_int /*nfwd*/) const override {
+        return hasOwnForwardDerivatives();
+    }
+    casadi::Function get_forward(casadi_int nfwd, const std::string& name,
+            const std::vector<std::string>& inames,
+            const std::vector<std::string>& onames,
+            const casadi::Dict& opts) const override;
+
+    /// For the "adaptive" finite difference scheme: the step size for each
+    /// scalar input (inputs are concatenated), and whether central
+    /// differences are used for the input. The step sizes are estimated at
+    /// `inputs` the first time this function is called.
+    struct FiniteDifferenceSteps {
+        std::vector<double> steps;
+        std::vector<bool> central;
+    };
+    const FiniteDifferenceSteps& estimateFiniteDifferenceSteps(
+            const VectorDM& inputs) const;
+
+    /// When reusing Jacobians: the Jacobian of the concatenated outputs with
+    /// respect to the concatenated inputs at `inputs`, whose (concatenated,
+    /// dense) outputs are `outputs`. The Jacobian has the sparsity pattern of
+    /// get_jacobian_sparsity() (dense if !has_jacobian_sparsity()). We keep
+    /// the Jacobians of recently-visited points (e.g., the mesh points), and
+    /// start from the one nearest to `inputs` that no other point has used
+    /// in the current pass over the points: if `inputs` is close to that
+    /// point and the Jacobian there predicts the change in the outputs well,
+    /// the Jacobian is corrected with Schubert's sparse Broyden update;
+    /// otherwise, or if the Jacobian has been updated
+    /// getJacobianRefreshInterval() - 1 times already, the Jacobian is
+    /// recomputed with finite differences.
+    casadi::DM calcReusedJacobian(
+            const casadi::DM& inputs, const casadi::DM& outputs) const;
+
 protected:
     const Problem* m_casProblem;
 
@@ -87,10 +146,54 @@ private:
                 fullPoint.at(parameters)});
     }
 
+    /// Split concatenated inputs into the inputs of this function.
+    VectorDM splitInputs(const casadi::DM& x) const;
+    /// Evaluate this function at concatenated inputs, and concatenate the
+    /// (dense) outputs.
+    casadi::DM evalConcatenated(const casadi::DM& x) const;
+    /// The sparsity of the Jacobian used by calcReusedJacobian(), and a
+    /// partition of its columns into groups (colors) in which no two columns
+    /// share a row, so that each group can be perturbed at once.
+    const casadi::Sparsity& getReusedJacobianSparsity() const;
+    /// Compute the nonzeros of the Jacobian at concatenated inputs `x`, with
+    /// concatenated outputs `f`, using finite differences.
+    std::vector<double> calcFiniteDifferenceJacobian(
+            const std::vector<double>& x, const std::vector<double>& f) const;
+
     std::string m_finite_difference_scheme = "central";
+    int m_jacobianRefreshInterval = 1;
 
     std::shared_ptr<const std::vector<VariablesDM>>
             m_fullPointsForSparsityDetection;
+
+    mutable std::once_flag m_finiteDifferenceStepsFlag;
+    mutable FiniteDifferenceSteps m_finiteDifferenceSteps;
+    /// CasADi does not own the callbacks returned by get_forward(), so we
+    /// hold onto them here.
+    mutable std::mutex m_forwardFunctionsMutex;
+    mutable std::vector<std::unique_ptr<casadi::Callback>> m_forwardFunctions;
+
+    mutable std::once_flag m_jacobianSparsityFlag;
+    mutable casadi::Sparsity m_jacobianSparsity;
+    mutable std::once_flag m_reusedJacobianSparsityFlag;
+    mutable casadi::Sparsity m_reusedJacobianSparsity;
+    mutable std::vector<std::vector<int>> m_reusedJacobianColors;
+    /// A Jacobian kept for reuse, and the point at which it applies.
+    struct ReusedJacobian {
+        std::vector<double> inputs;
+        std::vector<double> outputs;
+        std::vector<double> nonzeros;
+        /// The number of Broyden updates since the Jacobian was computed
+        /// with finite differences.
+        int numUpdates = 0;
+        /// The value of m_reusedJacobianClock when the entry was last used.
+        long long lastUse = 0;
+        /// Has a point used this entry in the current pass over the points?
+        bool claimed = false;
+    };
+    mutable std::mutex m_reusedJacobiansMutex;
+    mutable std::vector<std::shared_ptr<ReusedJacobian>> m_reusedJacobians;
+    mutable long long m_reusedJacobianClock = 0;
 };
 
 class PathConstraint : public Function {
@@ -162,18 +265,57 @@ public:
     VectorDM eval(const VectorDM& args) const override;
 };
 
-/// This function takes initial states/controls, final states/controls, and an
-/// integral.
-class Endpoint : public Function {
+/// This invokes CasOC::Problem::calcCostIntegrandResiduals(), and is used to
+/// construct a Gauss-Newton approximation of the Hessian.
+class CostIntegrandResiduals : public Function {
 public:
     void constructFunction(const Problem* casProblem, const std::string& name,
-            int index,
-            int numEquations,
-            const std::string& finiteDiffScheme,
+            int index, int numResiduals, const std::string& finiteDiffScheme,
             std::shared_ptr<const std::vector<VariablesDM>>
-            pointsForSparsityDetection) {
+                    pointsForSparsityDetection) {
         m_index = index;
-        m_numEquations = numEquations;
+        m_numResiduals = numResiduals;
+        Function::constructFunction(
+                casProblem, name, finiteDiffScheme, pointsForSparsityDetection);
+    }
+    casadi_int get_n_out() override final { return 1; }
+    std::string get_name_out(casadi_int i) override final {
+        switch (i) {
+        case 0: return "residuals";
+        default: OPENSIM_THROW(OpenSim::Exception, "Internal error.");
+        }
+    }
+    casadi::Sparsity get_sparsity_out(casadi_int i) override final {
+        if (i == 0) {
+            return casadi::Sparsity::dense(m_numResiduals, 1);
+        } else
+            return casadi::Sparsity(0, 0);
+    }
+    VectorDM eval(const VectorDM& args) const override;
+
+private:
+    int m_index = -1;
+    int m_numResiduals = -1;
+};
+
+/// This function takes initial states/controls, final states/controls, and the
+/// integrals of all costs and endpoint constraints, and computes the outputs
+/// of all costs followed by the outputs of all endpoint constraints. Computing
+/// all endpoint goals in one function lets the problem realize the initial and
+/// final states once for all goals (see CasOC::Problem::calcEndpoints()).
+/// If numThreads > 1, the finite differences of this function are evaluated in
+/// parallel.
+class Endpoints : public Function {
+public:
+    void constructFunction(const Problem* casProblem, const std::string& name,
+            int numIntegrals, int numOutputs,
+            const std::string& finiteDiffScheme,
+            std::shared_ptr<const std::vector<VariablesDM>>
+                    pointsForSparsityDetection,
+            std::pair<std::string, int> parallelism) {
+        m_numIntegrals = numIntegrals;
+        m_numOutputs = numOutputs;
+        m_parallelism = std::move(parallelism);
         Function::constructFunction(
                 casProblem, name, finiteDiffScheme, pointsForSparsityDetection);
     }
@@ -191,7 +333,7 @@ public:
         case 8: return "final_multipliers";
         case 9: return "final_derivatives";
         case 10: return "parameters";
-        case 11: return "integral";
+        case 11: return "integrals";
         default: OPENSIM_THROW(OpenSim::Exception, "Internal error.");
         }
     }
@@ -199,22 +341,36 @@ public:
     casadi_int get_n_out() override final { return 1; }
     std::string get_name_out(casadi_int i) override final {
         switch (i) {
-        case 0: return "value";
+        case 0: return "values";
         default: OPENSIM_THROW(OpenSim::Exception, "Internal error.");
         }
     }
     casadi::Sparsity get_sparsity_out(casadi_int i) override final {
         if (i == 0)
-            return casadi::Sparsity::dense(m_numEquations, 1);
+            return casadi::Sparsity::dense(m_numOutputs, 1);
         else
             return casadi::Sparsity(0, 0);
     }
+    VectorDM eval(const VectorDM& args) const override;
+    /// When running with multiple threads, we supply our own finite
+    /// difference derivatives so that the perturbed evaluations are
+    /// distributed across threads; otherwise, CasADi evaluates them serially.
+    /// With the "adaptive" scheme or when reusing Jacobians,
+    /// Function::get_forward() evaluates them serially, even with multiple
+    /// threads.
+    bool has_forward(casadi_int nfwd) const override {
+        return m_parallelism.second > 1 || Function::has_forward(nfwd);
+    }
+    casadi::Function get_forward(casadi_int nfwd, const std::string& name,
+            const std::vector<std::string>& inames,
+            const std::vector<std::string>& onames,
+            const casadi::Dict& opts) const override;
     /// The endpoint input is not simply a subset of the NLP variables; the
-    /// endpoint function also depends on an integral, computed from an
-    /// integrand function and using a transcription's quadrature scheme.
-    /// Ideally, the value for the integral would be computed properly from the
-    /// provided point, but applying the integrand function and quadrature
-    /// scheme here is complicated. For simplicity, we provide the integral as
+    /// endpoint function also depends on integrals, computed from integrand
+    /// functions and using a transcription's quadrature scheme.
+    /// Ideally, the value for the integrals would be computed properly from
+    /// the provided point, but applying the integrand functions and quadrature
+    /// scheme here is complicated. For simplicity, we provide the integrals as
     /// 0.
     casadi::DM getSubsetPoint(const VariablesDM& fullPoint) const override {
         using casadi::Slice;
@@ -228,27 +384,15 @@ public:
                 fullPoint.at(multipliers)(Slice(), -1),
                 fullPoint.at(derivatives)(Slice(), -1),
                 fullPoint.at(parameters),
-                // TODO: We should find a way to actually compute the integral
-                // from fullPoint. Or, make the integral an optimization
-                // variable.
-                casadi::DM::zeros(1, 1)});
+                // TODO: We should find a way to actually compute the integrals
+                // from fullPoint. Or, make the integrals optimization
+                // variables.
+                casadi::DM::zeros(m_numIntegrals, 1)});
     }
-protected:
-    int m_index = -1;
-    int m_numEquations = -1;
-};
-
-/// This invokes CasOC::Problem::calcCost().
-class Cost : public Endpoint {
-public:
-    VectorDM eval(const VectorDM& args) const override;
-};
-
-/// This invokes CasOC::Problem::calcEndpointConstraint().
-class EndpointConstraint : public Endpoint {
-public:
-    VectorDM eval(const VectorDM& args) const override;
-
+private:
+    int m_numIntegrals = -1;
+    int m_numOutputs = -1;
+    std::pair<std::string, int> m_parallelism{"serial", 1};
 };
 
 /// This function should compute forward dynamics (explicit multibody dynamics),
@@ -297,6 +441,57 @@ public:
     casadi::DM getSubsetPoint(const VariablesDM& fullPoint) const override;
 };
 
+/// This function integrates the explicit multibody system across a single
+/// shooting interval, holding the controls constant at their values at the
+/// start of the interval. This is used by the multiple shooting transcription.
+/// Derivatives are computed with finite differences, so the integration must be
+/// a smooth function of the inputs (e.g., use a fixed number of steps).
+class IntervalIntegration : public Function {
+public:
+    casadi_int get_n_in() override final { return 5; }
+    casadi_int get_n_out() override final { return 1; }
+    std::string get_name_in(casadi_int i) override final {
+        switch (i) {
+        case 0: return "initial_time";
+        case 1: return "final_time";
+        case 2: return "states";
+        case 3: return "controls";
+        case 4: return "parameters";
+        default: OPENSIM_THROW(OpenSim::Exception, "Internal error.");
+        }
+    }
+    std::string get_name_out(casadi_int i) override final {
+        switch (i) {
+        case 0: return "final_states";
+        default: OPENSIM_THROW(OpenSim::Exception, "Internal error.");
+        }
+    }
+    casadi::Sparsity get_sparsity_in(casadi_int i) override final;
+    casadi::Sparsity get_sparsity_out(casadi_int i) override final;
+    /// The final states of an integration generally depend on all of the
+    /// inputs, so we do not spend integrations on detecting sparsity.
+    bool has_jacobian_sparsity() const override final { return false; }
+    VectorDM eval(const VectorDM& args) const override;
+};
+
+/// This function computes the length, lengthening speed, and generalized
+/// forces per unit tension of the paths of the problem's symbolic actuators
+/// (see Problem::setSymbolicActuators()).
+class PathGeometry : public Function {
+public:
+    casadi_int get_n_out() override final { return 3; }
+    std::string get_name_out(casadi_int i) override final {
+        switch (i) {
+        case 0: return "lengths";
+        case 1: return "lengthening_speeds";
+        case 2: return "generalized_forces";
+        default: OPENSIM_THROW(OpenSim::Exception, "Internal error.");
+        }
+    }
+    casadi::Sparsity get_sparsity_out(casadi_int i) override final;
+    VectorDM eval(const VectorDM& args) const override;
+};
+
 template <bool CalcKCErrors>
 class MultibodySystemImplicit : public Function {
     casadi_int get_n_out() override final { return 4; }
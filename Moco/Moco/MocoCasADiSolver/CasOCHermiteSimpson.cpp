@@ -54,53 +54,42 @@ void HermiteSimpson::calcDefectsImpl(const casadi::MX& x,
         const casadi::MX& xdot, casadi::MX& defects) const {
     // For more information, see doxygen documentation for the class.
 
-    const int NS = m_problem.getNumStates();
+    // All mesh intervals are handled at once using strided slices of the
+    // grid (mesh points are at even grid indices, midpoints at odd indices),
+    // so the size of the MX graph does not grow with the number of mesh
+    // intervals.
+    const int N = m_numGridPoints;
+    const Slice time_i(0, N - 1, 2);
+    const Slice time_mid(1, N, 2);
+    const Slice time_ip1(2, N, 2);
 
-    int time_i;
-    int time_mid;
-    int time_ip1;
-    for (int imesh = 0; imesh < m_numMeshIntervals; ++imesh) {
-        time_i = 2 * imesh; // Needed for defects and path constraints.
+    const auto h = MX::repmat(
+            MX::reshape(m_times(time_ip1) - m_times(time_i), 1,
+                    m_numMeshIntervals),
+            x.rows(), 1);
+    const auto x_i = x(Slice(), time_i);
+    const auto x_mid = x(Slice(), time_mid);
+    const auto x_ip1 = x(Slice(), time_ip1);
+    const auto xdot_i = xdot(Slice(), time_i);
+    const auto xdot_mid = xdot(Slice(), time_mid);
+    const auto xdot_ip1 = xdot(Slice(), time_ip1);
 
-        // We enforce defect constraints on a mesh interval basis, so add
-        // constraints until the number of mesh intervals is reached.
-        time_mid = 2 * imesh + 1;
-        time_ip1 = 2 * imesh + 2;
-
-        const auto h = m_times(time_ip1) - m_times(time_i);
-        const auto x_i = x(Slice(), time_i);
-        const auto x_mid = x(Slice(), time_mid);
-        const auto x_ip1 = x(Slice(), time_ip1);
-        const auto xdot_i = xdot(Slice(), time_i);
-        const auto xdot_mid = xdot(Slice(), time_mid);
-        const auto xdot_ip1 = xdot(Slice(), time_ip1);
-
-        // Hermite interpolant defects.
-        defects(Slice(0, NS), imesh) =
-                x_mid - 0.5 * (x_ip1 + x_i) - (h / 8.0) * (xdot_i - xdot_ip1);
-
-        // Simpson integration defects.
-        defects(Slice(NS, 2 * NS), imesh) =
-                x_ip1 - x_i - (h / 6.0) * (xdot_ip1 + 4.0 * xdot_mid + xdot_i);
-    }
+    defects = MX::vertcat({
+            // Hermite interpolant defects.
+            x_mid - 0.5 * (x_ip1 + x_i) - (h / 8.0) * (xdot_i - xdot_ip1),
+            // Simpson integration defects.
+            x_ip1 - x_i - (h / 6.0) * (xdot_ip1 + 4.0 * xdot_mid + xdot_i)});
 }
 
 void HermiteSimpson::calcInterpolatingControlsImpl(
         const casadi::MX& controls, casadi::MX& interpControls) const {
     if (m_problem.getNumControls() &&
             m_solver.getInterpolateControlMidpoints()) {
-        int time_i;
-        int time_mid;
-        int time_ip1;
-        for (int imesh = 0; imesh < m_numMeshIntervals; ++imesh) {
-            time_i = 2 * imesh;
-            time_mid = 2 * imesh + 1;
-            time_ip1 = 2 * imesh + 2;
-            const auto c_i = controls(Slice(), time_i);
-            const auto c_mid = controls(Slice(), time_mid);
-            const auto c_ip1 = controls(Slice(), time_ip1);
-            interpControls(Slice(), imesh) = c_mid - 0.5 * (c_ip1 + c_i);
-        }
+        const int N = m_numGridPoints;
+        const auto c_i = controls(Slice(), Slice(0, N - 1, 2));
+        const auto c_mid = controls(Slice(), Slice(1, N, 2));
+        const auto c_ip1 = controls(Slice(), Slice(2, N, 2));
+        interpControls = c_mid - 0.5 * (c_ip1 + c_i);
     }
 }
 
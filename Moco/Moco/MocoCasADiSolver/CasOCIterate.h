@@ -70,10 +70,19 @@ struct Iterate {
 /// This struct is used to return a solution to a problem. Use `stats`
 /// to check if the problem converged.
 using ObjectiveBreakdown = std::vector<std::pair<std::string, double>>;
+/// The variables of each sensitivity iterate are the derivatives of the
+/// solution's variables (and times) with respect to a single quantity.
+using Sensitivities = std::vector<std::pair<std::string, Iterate>>;
 struct Solution : public Iterate {
     casadi::Dict stats;
     double objective;
     ObjectiveBreakdown objective_breakdown;
+    /// Derivatives with respect to a factor scaling each objective term, at a
+    /// factor of 1 (see Solver::setComputeSensitivities()).
+    Sensitivities objective_term_sensitivities;
+    /// Derivatives with respect to the value of each parameter whose lower
+    /// and upper bounds are equal.
+    Sensitivities parameter_sensitivities;
 };
 
 } // namespace CasOC
@@ -0,0 +1,52 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: CasOCMultipleShooting.cpp                                    *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "CasOCMultipleShooting.h"
+
+using casadi::DM;
+using casadi::MX;
+using casadi::Slice;
+
+namespace CasOC {
+
+DM MultipleShooting::createQuadratureCoefficientsImpl() const {
+
+    // The grid points are the mesh points (the shooting interval endpoints).
+    const int numMeshPoints = m_numGridPoints;
+    const DM meshIntervals = m_grid(Slice(1, numMeshPoints)) -
+                             m_grid(Slice(0, numMeshPoints - 1));
+    DM quadCoeffs(numMeshPoints, 1);
+    quadCoeffs(Slice(0, numMeshPoints - 1)) = 0.5 * meshIntervals;
+    quadCoeffs(Slice(1, numMeshPoints)) += 0.5 * meshIntervals;
+
+    return quadCoeffs;
+}
+
+DM MultipleShooting::createMeshIndicesImpl() const {
+    return DM::ones(1, m_numGridPoints);
+}
+
+void MultipleShooting::calcDefectsImpl(const casadi::MX& x,
+        const casadi::MX& /*xdot*/, casadi::MX& defects) const {
+    // Continuity defects: the states at the start of each interval must equal
+    // the states obtained by integrating across the previous interval.
+    const auto finalStates =
+            evalOnMeshIntervals(m_problem.getIntervalIntegration()).at(0);
+    defects = x(Slice(), Slice(1, m_numGridPoints)) - finalStates;
+}
+
+} // namespace CasOC
@@ -0,0 +1,65 @@
+#ifndef MOCO_CASOCMULTIPLESHOOTING_H
+#define MOCO_CASOCMULTIPLESHOOTING_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: CasOCMultipleShooting.h                                      *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "CasOCTranscription.h"
+
+namespace CasOC {
+
+/// Enforce the differential equations in the problem using direct multiple
+/// shooting. The mesh intervals are shooting intervals: the explicit multibody
+/// system is integrated across each interval (see
+/// Problem::calcIntervalIntegration()) from the states at the start of the
+/// interval, with the controls held at their values at the start of the
+/// interval, and the defects require the integrated states to match the
+/// states at the start of the next interval. The integrations for all
+/// intervals are independent and are evaluated in parallel. The integral in
+/// the objective function is approximated by trapezoidal quadrature.
+///
+/// Derivatives of the integrations are computed with finite differences.
+/// This scheme supports only explicit dynamics without kinematic constraints
+/// or implicit auxiliary dynamics.
+class MultipleShooting : public Transcription {
+public:
+    MultipleShooting(const Solver& solver, const Problem& problem)
+            : Transcription(solver, problem) {
+        OPENSIM_THROW_IF(problem.isDynamicsModeImplicit(), OpenSim::Exception,
+                "Multiple shooting requires explicit dynamics mode.");
+        OPENSIM_THROW_IF(problem.getNumKinematicConstraintEquations(),
+                OpenSim::Exception,
+                "Kinematic constraints not supported with multiple shooting.");
+        OPENSIM_THROW_IF(problem.getNumAuxiliaryResidualEquations(),
+                OpenSim::Exception,
+                "Implicit auxiliary dynamics not supported with multiple "
+                "shooting.");
+        createVariablesAndSetBounds(m_solver.getMesh(),
+                m_problem.getNumStates());
+    }
+
+private:
+    casadi::DM createQuadratureCoefficientsImpl() const override;
+    casadi::DM createMeshIndicesImpl() const override;
+
+    void calcDefectsImpl(const casadi::MX& x, const casadi::MX& xdot,
+            casadi::MX& defects) const override;
+};
+
+} // namespace CasOC
+
+#endif // MOCO_CASOCMULTIPLESHOOTING_H
@@ -47,4 +47,34 @@ Problem::createKinematicConstraintEquationNamesImpl() const {
     return names;
 }
 
+void Problem::calcEndpoints(const CostInput& input, const casadi::DM& integrals,
+        casadi::DM& values) const {
+    using casadi::Slice;
+    auto goalInput = [&input](const double& integral) -> CostInput {
+        return {input.initial_time, input.initial_states,
+                input.initial_controls, input.initial_multipliers,
+                input.initial_derivatives, input.final_time, input.final_states,
+                input.final_controls, input.final_multipliers,
+                input.final_derivatives, input.parameters, integral};
+    };
+    int igoal = 0;
+    int ioutput = 0;
+    for (int ic = 0; ic < getNumCosts(); ++ic) {
+        const int numOutputs = m_costInfos[ic].num_outputs;
+        const double integral = integrals(igoal++).scalar();
+        casadi::DM cost(numOutputs, 1);
+        calcCost(ic, goalInput(integral), cost);
+        values(Slice(ioutput, ioutput + numOutputs)) = cost;
+        ioutput += numOutputs;
+    }
+    for (int iec = 0; iec < (int)m_endpointConstraintInfos.size(); ++iec) {
+        const int numOutputs = m_endpointConstraintInfos[iec].num_outputs;
+        const double integral = integrals(igoal++).scalar();
+        casadi::DM constraint(numOutputs, 1);
+        calcEndpointConstraint(iec, goalInput(integral), constraint);
+        values(Slice(ioutput, ioutput + numOutputs)) = constraint;
+        ioutput += numOutputs;
+    }
+}
+
 } // namespace CasOC
@@ -80,31 +80,38 @@ struct ParameterInfo {
     Bounds bounds;
 };
 
+/// The endpoint portion of all costs and endpoint constraints is computed by a
+/// single function; see Problem::getEndpoints().
 struct EndpointInfo {
     EndpointInfo(std::string name, int num_outputs,
-            std::unique_ptr<Integrand> ifunc, std::unique_ptr<Endpoint> efunc)
+            std::unique_ptr<Integrand> ifunc)
             : name(std::move(name)), num_outputs(num_outputs),
-              integrand_function(std::move(ifunc)),
-              endpoint_function(std::move(efunc)) {}
+              integrand_function(std::move(ifunc)) {}
     std::string name;
     int num_outputs;
     std::unique_ptr<Integrand> integrand_function;
-    std::unique_ptr<Endpoint> endpoint_function;
 };
 
 struct CostInfo : EndpointInfo {
     CostInfo(std::string name, int num_outputs,
-            std::unique_ptr<Integrand> ifunc, std::unique_ptr<Endpoint> efunc)
-            : EndpointInfo(std::move(name), num_outputs, std::move(ifunc),
-                      std::move(efunc)) {}
+            std::unique_ptr<Integrand> ifunc, int num_residuals,
+            double residual_scale,
+            std::unique_ptr<CostIntegrandResiduals> rfunc)
+            : EndpointInfo(std::move(name), num_outputs, std::move(ifunc)),
+              num_residuals(num_residuals), residual_scale(residual_scale),
+              residual_function(std::move(rfunc)) {}
+    /// If num_residuals > 0, the integrand is the sum of squares of the
+    /// residuals, and the cost is residual_scale times the integral.
+    int num_residuals;
+    double residual_scale;
+    std::unique_ptr<CostIntegrandResiduals> residual_function;
 };
 
 struct EndpointConstraintInfo : EndpointInfo {
     EndpointConstraintInfo(std::string name, int num_outputs,
-            std::unique_ptr<Integrand> ifunc, std::unique_ptr<Endpoint> efunc,
-            casadi::DM lowerBounds, casadi::DM upperBounds)
-            : EndpointInfo(std::move(name), num_outputs, std::move(ifunc),
-                      std::move(efunc)),
+            std::unique_ptr<Integrand> ifunc, casadi::DM lowerBounds,
+            casadi::DM upperBounds)
+            : EndpointInfo(std::move(name), num_outputs, std::move(ifunc)),
               lowerBounds(std::move(lowerBounds)),
               upperBounds(std::move(upperBounds)) {}
     // The number of rows in these bounds must be num_outputs.
@@ -114,12 +121,15 @@ struct EndpointConstraintInfo : EndpointInfo {
 
 /// The number outputs in the function must match the size of
 /// lowerBounds and upperBounds.
+/// If symbolic_function is not null, the constraint is evaluated with this
+/// function instead of with calcPathConstraint() and `function` is null.
 struct PathConstraintInfo {
     std::string name;
     int size() const { return (int)lowerBounds.numel(); }
     casadi::DM lowerBounds;
     casadi::DM upperBounds;
     std::unique_ptr<PathConstraint> function;
+    casadi::Function symbolic_function;
 };
 
 class Solver;
@@ -151,6 +161,13 @@ public:
         const casadi::DM& parameters;
         const double& integral;
     };
+    struct IntervalInput {
+        const double& initial_time;
+        const double& final_time;
+        const casadi::DM& states;
+        const casadi::DM& controls;
+        const casadi::DM& parameters;
+    };
     struct MultibodySystemExplicitOutput {
         casadi::DM& multibody_derivatives;
         casadi::DM& auxiliary_derivatives;
@@ -163,6 +180,11 @@ public:
         casadi::DM& auxiliary_residuals;
         casadi::DM& kinematic_constraint_errors;
     };
+    struct PathGeometryOutput {
+        casadi::DM& lengths;
+        casadi::DM& lengthening_speeds;
+        casadi::DM& generalized_forces;
+    };
 
 protected:
     /// @name Interface for the user building the problem.
@@ -244,17 +266,27 @@ protected:
     void addParameter(std::string name, Bounds bounds) {
         m_paramInfos.push_back({std::move(name), std::move(bounds)});
     }
-    /// Add a cost term to the problem.
-    void addCost(std::string name, int numIntegrals, int numOutputs) {
+    /// Add a cost term to the problem. If numResiduals > 0, the cost's
+    /// integrand is the sum of squares of residuals computed by
+    /// calcCostIntegrandResiduals(), and the cost is residualScale times the
+    /// integral.
+    void addCost(std::string name, int numIntegrals, int numOutputs,
+            int numResiduals = 0, double residualScale = 1) {
         OPENSIM_THROW_IF(numIntegrals < 0 || numIntegrals > 1,
                 OpenSim::Exception, "numIntegrals must be 0 or 1.");
+        OPENSIM_THROW_IF(numResiduals && !numIntegrals, OpenSim::Exception,
+                "Residuals require an integral.");
         std::unique_ptr<CostIntegrand> integrand_function;
         if (numIntegrals) {
             integrand_function = OpenSim::make_unique<CostIntegrand>();
         }
+        std::unique_ptr<CostIntegrandResiduals> residual_function;
+        if (numResiduals) {
+            residual_function = OpenSim::make_unique<CostIntegrandResiduals>();
+        }
         m_costInfos.emplace_back(std::move(name), numOutputs,
-                std::move(integrand_function),
-                OpenSim::make_unique<Cost>());
+                std::move(integrand_function), numResiduals, residualScale,
+                std::move(residual_function));
     }
     /// Add an endpoint constraint to the problem.
     void addEndpointConstraint(
@@ -274,8 +306,7 @@ protected:
         }
         m_endpointConstraintInfos.emplace_back(std::move(name),
                 (int)bounds.size(), std::move(integrand_function),
-                OpenSim::make_unique<EndpointConstraint>(), std::move(lower),
-                std::move(upper));
+                std::move(lower), std::move(upper));
     }
     /// The size of bounds must match the number of outputs in the function.
     /// Use variadic template arguments to pass arguments to the constructor of
@@ -288,7 +319,29 @@ protected:
             upper(ibound, 0) = bounds[ibound].upper;
         }
         m_pathInfos.push_back({std::move(name), std::move(lower),
-                std::move(upper), OpenSim::make_unique<PathConstraint>()});
+                std::move(upper), OpenSim::make_unique<PathConstraint>(),
+                casadi::Function()});
+    }
+    /// Add a path constraint that depends only on time and controls and is
+    /// expressed symbolically. The function must have inputs "time" (1 x 1)
+    /// and "controls" (num_controls x 1) and one output with the same number
+    /// of rows as bounds. The transcription evaluates this function at all
+    /// mesh points at once, and the derivatives of the constraint are exact
+    /// and require no calls to calcPathConstraint().
+    void addPathConstraint(std::string name, std::vector<Bounds> bounds,
+            casadi::Function symbolicFunction) {
+        OPENSIM_THROW_IF(symbolicFunction.n_in() != 2 ||
+                                 symbolicFunction.n_out() != 1 ||
+                                 symbolicFunction.size1_out(0) !=
+                                         (casadi_int)bounds.size(),
+                OpenSim::Exception,
+                "Expected the symbolic function for path constraint '{}' to "
+                "have 2 inputs and 1 output with {} rows.",
+                name, bounds.size());
+        addPathConstraint(std::move(name), std::move(bounds));
+        auto& info = m_pathInfos.back();
+        info.function.reset();
+        info.symbolic_function = std::move(symbolicFunction);
     }
     void setDynamicsMode(std::string dynamicsMode) {
         OPENSIM_THROW_IF(
@@ -301,6 +354,27 @@ protected:
         m_auxiliaryDerivativeNames = names;
         m_numAuxiliaryResiduals = (int)names.size();
     }
+    /// Provide the dynamics of path actuators as a symbolic function rather
+    /// than through the multibody system functions; only the geometry of the
+    /// actuators' paths is computed numerically (see calcPathGeometry()).
+    /// This is only supported in implicit dynamics mode, and the actuators'
+    /// forces must be excluded from calcMultibodySystemImplicit().
+    /// The `dynamics` function has inputs (auxiliary states, controls,
+    /// lengths, lengthening speeds) and outputs (tensions, auxiliary
+    /// derivatives), all column vectors for a single time point. The
+    /// auxiliary derivatives replace those from the multibody system for the
+    /// auxiliary states given by `auxiliaryStateIndices`.
+    void setSymbolicActuators(int numActuators, casadi::Function dynamics,
+            std::vector<int> auxiliaryStateIndices) {
+        OPENSIM_THROW_IF(dynamics.n_in() != 4 || dynamics.n_out() != 2,
+                OpenSim::Exception,
+                "Expected the symbolic actuator dynamics function to have 4 "
+                "inputs and 2 outputs.");
+        m_numSymbolicActuators = numActuators;
+        m_symbolicActuatorDynamics = std::move(dynamics);
+        m_symbolicActuatorAuxiliaryStateIndices =
+                std::move(auxiliaryStateIndices);
+    }
 
 public:
     /// Kinematic constraint errors should be ordered as so:
@@ -319,14 +393,46 @@ public:
             const casadi::DM& parameters,
             casadi::DM& velocity_correction) const = 0;
 
+    /// Integrate the explicit multibody system from `initial_time` to
+    /// `final_time`, holding the controls constant, and store the resulting
+    /// states in `final_states`. Only required for multiple shooting.
+    virtual void calcIntervalIntegration(const IntervalInput& /*input*/,
+            casadi::DM& /*final_states*/) const {
+        OPENSIM_THROW(OpenSim::Exception,
+                "This problem does not support integrating across intervals.");
+    }
+
+    /// Compute the length and lengthening speed of each symbolic actuator's
+    /// path, and the generalized forces that a unit tension in each path
+    /// applies to the multibody system (stacked by actuator). Only required
+    /// if setSymbolicActuators() was used.
+    virtual void calcPathGeometry(const ContinuousInput& /*input*/,
+            PathGeometryOutput& /*output*/) const {
+        OPENSIM_THROW(OpenSim::Exception,
+                "This problem does not support symbolic actuators.");
+    }
+
     virtual void calcCostIntegrand(int /*costIndex*/,
             const ContinuousInput& /*input*/, double& /*integrand*/) const {}
+    /// Only invoked for costs added with residuals (see addCost()).
+    virtual void calcCostIntegrandResiduals(int /*costIndex*/,
+            const ContinuousInput& /*input*/,
+            casadi::DM& /*residuals*/) const {}
     virtual void calcCost(int /*costIndex*/, const CostInput& /*input*/,
             casadi::DM& /*cost*/) const {}
     virtual void calcEndpointConstraintIntegrand(int /*index*/,
             const ContinuousInput& /*input*/, double& /*integrand*/) const {}
     virtual void calcEndpointConstraint(int /*index*/,
             const CostInput& /*input*/, casadi::DM& /*values*/) const {}
+    /// Compute the endpoint values of all costs (in order) followed by those
+    /// of all endpoint constraints. `integrals` contains the integral for each
+    /// cost followed by the integral for each endpoint constraint (NaN for
+    /// goals without an integral); `input.integral` is not used. The default
+    /// implementation invokes calcCost() and calcEndpointConstraint(); override
+    /// this to share work (e.g., realizing the initial and final states)
+    /// across goals.
+    virtual void calcEndpoints(const CostInput& input,
+            const casadi::DM& integrals, casadi::DM& values) const;
     virtual void calcPathConstraint(int /*constraintIndex*/,
             const ContinuousInput& /*input*/,
             casadi::DM& /*path_constraint*/) const {}
@@ -381,33 +487,56 @@ public:
         return it;
     }
 
+    /// The parallelism is used to evaluate the finite differences of the
+    /// endpoints function; see Solver::setParallelism(). See
+    /// Solver::setJacobianRefreshInterval() for jacobianRefreshInterval.
+    /// With multiple shooting (see multipleShooting), the explicit dynamics
+    /// are only integrated across intervals, so the multibody system
+    /// functions are replaced by the interval integration function.
     void initialize(const std::string& finiteDiffScheme,
             std::shared_ptr<const std::vector<VariablesDM>>
-                    pointsForSparsityDetection) const {
+                    pointsForSparsityDetection,
+            std::pair<std::string, int> parallelism,
+            int jacobianRefreshInterval, bool multipleShooting) const {
         auto* mutThis = const_cast<Problem*>(this);
+        mutThis->m_jacobianRefreshInterval = jacobianRefreshInterval;
 
+        {
+            const int numEndpointGoals =
+                    getNumCosts() + (int)m_endpointConstraintInfos.size();
+            int numOutputs = 0;
+            for (const auto& info : m_costInfos) numOutputs += info.num_outputs;
+            for (const auto& info : m_endpointConstraintInfos) {
+                numOutputs += info.num_outputs;
+            }
+            mutThis->m_endpointsFunc = nullptr;
+            if (numOutputs) {
+                mutThis->m_endpointsFunc = OpenSim::make_unique<Endpoints>();
+                mutThis->m_endpointsFunc->constructFunction(this, "endpoints",
+                        numEndpointGoals, numOutputs, finiteDiffScheme,
+                        pointsForSparsityDetection, std::move(parallelism));
+            }
+        }
         {
             int index = 0;
             for (const auto& costInfo : mutThis->m_costInfos) {
-                costInfo.endpoint_function->constructFunction(this,
-                        "cost_" + costInfo.name + "_endpoint", index,
-                        costInfo.num_outputs, finiteDiffScheme,
-                        pointsForSparsityDetection);
                 if (costInfo.integrand_function) {
                     costInfo.integrand_function->constructFunction(this,
                             "cost_" + costInfo.name + "_integrand", index,
                             finiteDiffScheme, pointsForSparsityDetection);
                 }
+                if (costInfo.residual_function) {
+                    costInfo.residual_function->constructFunction(this,
+                            "cost_" + costInfo.name + "_residuals", index,
+                            costInfo.num_residuals, finiteDiffScheme,
+                            pointsForSparsityDetection);
+                }
                 ++index;
             }
         }
         {
             int index = 0;
             for (const auto& info : mutThis->m_endpointConstraintInfos) {
-                info.endpoint_function->constructFunction(this,
-                        "endpoint_constraint_" + info.name + "_endpoint", index,
-                        info.num_outputs, finiteDiffScheme,
-                        pointsForSparsityDetection);
                 if (info.integrand_function) {
                     info.integrand_function->constructFunction(this,
                             "endpoint_constraint_" + info.name + "_integrand", index,
@@ -419,6 +548,10 @@ public:
         {
             int index = 0;
             for (const auto& pathInfo : mutThis->m_pathInfos) {
+                if (!pathInfo.function) {
+                    ++index;
+                    continue;
+                }
                 pathInfo.function->constructFunction(this,
                         "path_constraint_" + pathInfo.name, index,
                         (int)pathInfo.lowerBounds.size1(), finiteDiffScheme,
@@ -444,6 +577,12 @@ public:
                     ->constructFunction(this,
                             "implicit_multibody_system_ignoring_constraints",
                             finiteDiffScheme, pointsForSparsityDetection);
+        } else if (multipleShooting) {
+            mutThis->m_intervalIntegrationFunc =
+                    OpenSim::make_unique<IntervalIntegration>();
+            mutThis->m_intervalIntegrationFunc->constructFunction(this,
+                    "interval_integration", finiteDiffScheme,
+                    pointsForSparsityDetection);
         } else {
             mutThis->m_multibodyFunc =
                     OpenSim::make_unique<MultibodySystemExplicit<true>>();
@@ -458,6 +597,15 @@ public:
                     pointsForSparsityDetection);
         }
 
+        if (m_numSymbolicActuators) {
+            OPENSIM_THROW_IF(m_dynamicsMode != "implicit", OpenSim::Exception,
+                    "Symbolic actuators require implicit dynamics mode.");
+            mutThis->m_pathGeometryFunc = OpenSim::make_unique<PathGeometry>();
+            mutThis->m_pathGeometryFunc->constructFunction(this,
+                    "path_geometry", finiteDiffScheme,
+                    pointsForSparsityDetection);
+        }
+
         if (m_enforceConstraintDerivatives) {
             mutThis->m_velocityCorrectionFunc =
                     OpenSim::make_unique<VelocityCorrection>();
@@ -467,6 +615,13 @@ public:
         }
     }
 
+    /// The number of Jacobian evaluations across which each Function reuses
+    /// its finite difference Jacobians (see
+    /// Solver::setJacobianRefreshInterval()).
+    int getJacobianRefreshInterval() const {
+        return m_jacobianRefreshInterval;
+    }
+
     /// @name Interface for CasOC::Transcription.
     /// @{
     // TODO: Skip over empty slots for quaternions.
@@ -493,6 +648,13 @@ public:
     }
     int getNumAuxiliaryStates() const { return m_numAuxiliaryStates; }
     int getNumCosts() const { return (int)m_costInfos.size(); }
+    int getNumSymbolicActuators() const { return m_numSymbolicActuators; }
+    const casadi::Function& getSymbolicActuatorDynamics() const {
+        return m_symbolicActuatorDynamics;
+    }
+    const std::vector<int>& getSymbolicActuatorAuxiliaryStateIndices() const {
+        return m_symbolicActuatorAuxiliaryStateIndices;
+    }
     bool isPrescribedKinematics() const { return m_prescribedKinematics; }
     /// If the coordinates are prescribed, then the number of multibody dynamics
     /// equations is not the same as the number of speeds.
@@ -570,6 +732,10 @@ public:
     const std::vector<PathConstraintInfo>& getPathConstraintInfos() const {
         return m_pathInfos;
     }
+    /// Get a function that computes the endpoint values of all costs and
+    /// endpoint constraints (see calcEndpoints()). This is only available if
+    /// the costs and endpoint constraints have at least one output.
+    const casadi::Function& getEndpoints() const { return *m_endpointsFunc; }
     /// Get a function to the full multibody system (i.e. including kinematic
     /// constraints errors).
     const casadi::Function& getMultibodySystem() const {
@@ -589,6 +755,14 @@ public:
     const casadi::Function& getVelocityCorrection() const {
         return *m_velocityCorrectionFunc;
     }
+    /// Get a function that integrates the explicit multibody system across a
+    /// shooting interval (see calcIntervalIntegration()).
+    const casadi::Function& getIntervalIntegration() const {
+        return *m_intervalIntegrationFunc;
+    }
+    const casadi::Function& getPathGeometry() const {
+        return *m_pathGeometryFunc;
+    }
     const casadi::Function& getImplicitMultibodySystem() const {
         return *m_implicitMultibodyFunc;
     }
@@ -629,6 +803,7 @@ private:
     std::vector<CostInfo> m_costInfos;
     std::vector<EndpointConstraintInfo> m_endpointConstraintInfos;
     std::vector<PathConstraintInfo> m_pathInfos;
+    std::unique_ptr<Endpoints> m_endpointsFunc;
     std::unique_ptr<MultibodySystemExplicit<true>> m_multibodyFunc;
     std::unique_ptr<MultibodySystemExplicit<false>>
             m_multibodyFuncIgnoringConstraints;
@@ -636,6 +811,12 @@ private:
     std::unique_ptr<MultibodySystemImplicit<false>>
             m_implicitMultibodyFuncIgnoringConstraints;
     std::unique_ptr<VelocityCorrection> m_velocityCorrectionFunc;
+    std::unique_ptr<IntervalIntegration> m_intervalIntegrationFunc;
+    int m_numSymbolicActuators = 0;
+    casadi::Function m_symbolicActuatorDynamics;
+    std::vector<int> m_symbolicActuatorAuxiliaryStateIndices;
+    std::unique_ptr<PathGeometry> m_pathGeometryFunc;
+    int m_jacobianRefreshInterval = 1;
 };
 
 } // namespace CasOC
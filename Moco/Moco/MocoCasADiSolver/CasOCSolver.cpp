@@ -17,6 +17,7 @@
 
 #include "../MocoUtilities.h"
 #include "CasOCHermiteSimpson.h"
+#include "CasOCMultipleShooting.h"
 #include "CasOCProblem.h"
 #include "CasOCTranscription.h"
 #include "CasOCTrapezoidal.h"
@@ -31,6 +32,9 @@ std::unique_ptr<Transcription> Solver::createTranscription() const {
         transcription = OpenSim::make_unique<Trapezoidal>(*this, m_problem);
     } else if (m_transcriptionScheme == "hermite-simpson") {
         transcription = OpenSim::make_unique<HermiteSimpson>(*this, m_problem);
+    } else if (m_transcriptionScheme == "multiple-shooting") {
+        transcription =
+                OpenSim::make_unique<MultipleShooting>(*this, m_problem);
     } else {
         OPENSIM_THROW(Exception, "Unknown transcription scheme '{}'.",
                 m_transcriptionScheme);
@@ -87,7 +91,9 @@ Solution Solver::solve(const Iterate& guess) const {
     }
     m_problem.initialize(m_finite_difference_scheme,
             std::const_pointer_cast<const std::vector<VariablesDM>>(
-                    pointsForSparsityDetection));
+                    pointsForSparsityDetection),
+            getParallelism(), m_jacobian_refresh_interval,
+            m_transcriptionScheme == "multiple-shooting");
     return transcription->solve(guess);
 }
 
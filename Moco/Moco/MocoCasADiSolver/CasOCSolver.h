@@ -124,6 +124,21 @@ public:
         return m_finite_difference_scheme;
     }
 
+    /// If greater than 1, each CasOC::Function keeps the finite difference
+    /// Jacobians it computes, and updates them with sparse Broyden
+    /// corrections from the changes in its outputs between iterates instead
+    /// of recomputing them. A Jacobian is recomputed after this many
+    /// evaluations, or sooner if the iterate changed too much or the
+    /// previous Jacobian predicted the change in the outputs poorly.
+    /// @note Default is 1 (recompute the Jacobians at every evaluation).
+    void setJacobianRefreshInterval(int interval) {
+        m_jacobian_refresh_interval = interval;
+    }
+    /// @copydoc setJacobianRefreshInterval()
+    int getJacobianRefreshInterval() const {
+        return m_jacobian_refresh_interval;
+    }
+
     void setCallbackInterval(int callbackInterval) {
         m_callbackInterval = callbackInterval;
     }
@@ -144,6 +159,31 @@ public:
     }
     std::string getWriteSparsity() const { return m_write_sparsity; }
 
+    /// If true, after solving, compute the derivatives of the optimal
+    /// variables with respect to a scale factor on each objective term and
+    /// with respect to the value of each parameter variable with equal lower
+    /// and upper bounds. These are stored in the Solution.
+    void setComputeSensitivities(bool tf) { m_computeSensitivities = tf; }
+    bool getComputeSensitivities() const { return m_computeSensitivities; }
+
+    /// If true, provide the optimization solver with a Gauss-Newton
+    /// approximation of the Hessian of the Lagrangian: the Hessian of each cost
+    /// with residuals (see Problem::addCost()) is approximated as 2 J^T J,
+    /// where J is the Jacobian of the residuals, the exact Hessian is used for
+    /// the remaining objective terms, and the curvature of the constraints is
+    /// neglected. The optimization solver must be told to use the exact
+    /// Hessian.
+    void setGaussNewtonHessian(bool tf) { m_gaussNewtonHessian = tf; }
+    bool getGaussNewtonHessian() const { return m_gaussNewtonHessian; }
+
+    /// If true, scale the variables, constraints, and objective of the NLP
+    /// before passing it to the optimization solver. Each variable is scaled
+    /// to [0, 1] using its bounds (or by the magnitude of the guess if its
+    /// bounds are not finite), and the constraints and objective are scaled
+    /// using their gradients at the guess. The solution is unscaled.
+    void setAutomaticScaling(bool tf) { m_automaticScaling = tf; }
+    bool getAutomaticScaling() const { return m_automaticScaling; }
+
     /// Use this to tell CasADi to evaluate differential-algebraic equations,
     /// path constraints, integrands, etc. in parallel across grid points.
     /// "parallelism" is passed on directly to
@@ -187,8 +227,12 @@ private:
     Bounds m_implicitMultibodyAccelerationBounds;
     Bounds m_implicitAuxiliaryDerivativeBounds;
     std::string m_finite_difference_scheme = "central";
+    int m_jacobian_refresh_interval = 1;
     std::string m_sparsity_detection = "none";
     std::string m_write_sparsity;
+    bool m_computeSensitivities = false;
+    bool m_gaussNewtonHessian = false;
+    bool m_automaticScaling = false;
     int m_callbackInterval = 0;
     int m_sparsity_detection_random_count = 3;
     std::string m_parallelism = "serial";
@@ -59,7 +59,8 @@ public:
     std::vector<DM> eval(const std::vector<DM>& args) const override {
         if (m_callbackInterval > 0 && evalCount % m_callbackInterval == 0) {
             Iterate iterate = m_problem.createIterate<Iterate>();
-            iterate.variables = m_transcription.expandVariables(args.at(0));
+            iterate.variables = m_transcription.expandVariables(
+                    m_transcription.unscaleVariables(args.at(0)));
             iterate.times =
                     m_transcription.createTimes(iterate.variables[initial_time],
                             iterate.variables[final_time]);
@@ -169,6 +170,20 @@ void Transcription::createVariablesAndSetBounds(const casadi::DM& grid,
     m_meshIndices = makeTimeIndices(meshIndicesVector);
     m_meshInteriorIndices =
             makeTimeIndices(meshInteriorIndicesVector);
+    {
+        // Column j of this map is the column of [mesh values, mesh interior
+        // values] that holds the value at grid point j.
+        std::vector<int> meshAndInteriorToGridVector(m_numGridPoints);
+        for (int i = 0; i < (int)meshIndicesVector.size(); ++i) {
+            meshAndInteriorToGridVector[meshIndicesVector[i]] = i;
+        }
+        for (int i = 0; i < (int)meshInteriorIndicesVector.size(); ++i) {
+            meshAndInteriorToGridVector[meshInteriorIndicesVector[i]] =
+                    m_numMeshPoints + i;
+        }
+        m_meshAndInteriorToGrid =
+                makeTimeIndices(meshAndInteriorToGridVector);
+    }
 
     // Set variable bounds.
     // --------------------
@@ -251,6 +266,8 @@ void Transcription::createVariablesAndSetBounds(const casadi::DM& grid,
 }
 
 void Transcription::transcribe() {
+    m_inputsOnTrajectory.clear();
+    m_timesOnTrajectory.clear();
 
     // Cost.
     // =====
@@ -265,11 +282,8 @@ void Transcription::transcribe() {
             "Problems with differing numbers of coordinates and speeds are "
             "not supported (e.g., quaternions).");
 
-    // TODO: Does creating all this memory have efficiency implications
-    //        in CasADi?
-    // Initialize memory for state derivatives and defects.
-    // ----------------------------------------------------
-    m_xdot = MX(NS, m_numGridPoints);
+    // Initialize memory for defects.
+    // ------------------------------
     m_constraints.defects = MX(casadi::Sparsity::dense(
             m_numDefectsPerMeshInterval, m_numMeshIntervals));
     m_constraintsLowerBounds.defects =
@@ -277,19 +291,15 @@ void Transcription::transcribe() {
     m_constraintsUpperBounds.defects =
             DM::zeros(m_numDefectsPerMeshInterval, m_numMeshIntervals);
 
-    // Initialize memory for implicit multibody residuals.
-    // ---------------------------------------------------
-    m_constraints.multibody_residuals = MX(casadi::Sparsity::dense(
-            m_numMultibodyResiduals, m_numGridPoints));
+    // Bounds for implicit multibody residuals.
+    // ----------------------------------------
     m_constraintsLowerBounds.multibody_residuals =
             DM::zeros(m_numMultibodyResiduals, m_numGridPoints);
     m_constraintsUpperBounds.multibody_residuals =
             DM::zeros(m_numMultibodyResiduals, m_numGridPoints);
 
-    // Initialize memory for implicit auxiliary residuals.
-    // ---------------------------------------------------
-    m_constraints.auxiliary_residuals = MX(casadi::Sparsity::dense(
-            m_numAuxiliaryResiduals, m_numGridPoints));
+    // Bounds for implicit auxiliary residuals.
+    // ----------------------------------------
     m_constraintsLowerBounds.auxiliary_residuals =
             DM::zeros(m_numAuxiliaryResiduals, m_numGridPoints);
     m_constraintsUpperBounds.auxiliary_residuals =
@@ -308,10 +318,24 @@ void Transcription::transcribe() {
     m_constraintsUpperBounds.kinematic = casadi::DM::repmat(
             kcBounds.upper, numKinematicConstraints, m_numMeshPoints);
 
+    // The state derivatives and residuals are assembled from whole blocks
+    // (concatenations of mapped function outputs) rather than by sliced
+    // assignment into preallocated matrices; each sliced assignment adds a
+    // node to the MX graph that references the entire matrix, which becomes
+    // expensive for large meshes.
+    // Combine values computed at the mesh points and at the mesh interior
+    // points into a single matrix ordered by grid point using a single
+    // column permutation.
+    auto combineMeshAndInterior = [&](const MX& meshValues,
+                                          const MX& interiorValues) -> MX {
+        if (!m_numMeshInteriorPoints) return meshValues;
+        return MX::horzcat({meshValues, interiorValues})(
+                Slice(), m_meshAndInteriorToGrid);
+    };
+
     // qdot
     // ----
-    const MX u = m_vars[states](Slice(NQ, NQ + NU), Slice());
-    m_xdot(Slice(0, NQ), Slice()) = u;
+    MX qdot = m_vars[states](Slice(NQ, NQ + NU), Slice());
 
     if (m_problem.getEnforceConstraintDerivatives() &&
             m_numMeshInteriorPoints &&
@@ -329,84 +353,130 @@ void Transcription::transcribe() {
                 m_meshInteriorIndices);
         const auto uCorr = velocityCorrOut.at(0);
 
-        m_xdot(Slice(0, NQ), m_meshInteriorIndices) += uCorr;
+        qdot += combineMeshAndInterior(MX(NQ, m_numMeshPoints), uCorr);
     }
 
     // udot, zdot, residual, kcerr
     // ---------------------------
+    // When the model has kinematic constraints, we must treat grid points
+    // differently, as kinematic constraints are computed for only some
+    // grid points. When the model does *not* have kinematic constraints,
+    // the DAE is the same for all grid points, so we evaluate it once over
+    // the entire grid.
+    const bool evalOnEntireGrid =
+            !numKinematicConstraints || !m_numMeshInteriorPoints;
+    std::vector<Var> inputs{states, controls, multipliers, derivatives};
+    MX udot;
+    MX zdot;
     if (m_problem.isDynamicsModeImplicit()) {
         // udot.
-        const MX w = m_vars[derivatives](Slice(0, m_problem.getNumSpeeds()),
+        udot = m_vars[derivatives](Slice(0, m_problem.getNumSpeeds()),
                 Slice());
-        m_xdot(Slice(NQ, NQ + NU), Slice()) = w;
-
-        std::vector<Var> inputs{states, controls, multipliers, derivatives};
-
-        // When the model has kinematic constraints, we must treat grid points
-        // differently, as kinematic constraints are computed for only some
-        // grid points. When the model does *not* have kinematic constraints,
-        // the DAE is the same for all grid points, but the evaluation is still
-        // done separately to keep implementation general.
 
-        // residual, zdot, kcerr
-        // Points where we compute algebraic constraints.
-        {
+        if (evalOnEntireGrid) {
             const auto out =
+                    evalOnTrajectory(m_problem.getImplicitMultibodySystem(),
+                            inputs, m_gridIndices);
+            m_constraints.multibody_residuals = out.at(0);
+            zdot = out.at(1);
+            m_constraints.auxiliary_residuals = out.at(2);
+            if (numKinematicConstraints) m_constraints.kinematic = out.at(3);
+        } else {
+            // Points where we compute algebraic constraints.
+            const auto outMesh =
                     evalOnTrajectory(m_problem.getImplicitMultibodySystem(),
                             inputs, m_meshIndices);
-            m_constraints.multibody_residuals(Slice(), m_meshIndices) =
-                    out.at(0);
-            // zdot.
-            m_xdot(Slice(NQ + NU, NS), m_meshIndices) = out.at(1);
-            m_constraints.auxiliary_residuals(Slice(), m_meshIndices) =
-                    out.at(2);
-            m_constraints.kinematic = out.at(3);
-        }
-
-        // Points where we ignore algebraic constraints.
-        if (m_numMeshInteriorPoints) {
-            const auto out = evalOnTrajectory(
+            // Points where we ignore algebraic constraints.
+            const auto outInterior = evalOnTrajectory(
                     m_problem.getImplicitMultibodySystemIgnoringConstraints(),
                     inputs, m_meshInteriorIndices);
-            m_constraints.multibody_residuals(Slice(), m_meshInteriorIndices) =
-                    out.at(0);
-            // zdot.
-            m_xdot(Slice(NQ + NU, NS), m_meshInteriorIndices) =
-                    out.at(1);
-            m_constraints.auxiliary_residuals(Slice(), m_meshInteriorIndices) =
-                    out.at(2);
+            m_constraints.multibody_residuals =
+                    combineMeshAndInterior(outMesh.at(0), outInterior.at(0));
+            zdot = combineMeshAndInterior(outMesh.at(1), outInterior.at(1));
+            m_constraints.auxiliary_residuals =
+                    combineMeshAndInterior(outMesh.at(2), outInterior.at(2));
+            m_constraints.kinematic = outMesh.at(3);
         }
 
-    } else { // Explicit dynamics mode.
-        std::vector<Var> inputs{states, controls, multipliers, derivatives};
+        // Symbolic actuators.
+        // The multibody system excludes the forces from these actuators;
+        // only their path geometry is computed numerically, and their
+        // tensions and dynamics are CasADi expressions with exact
+        // derivatives.
+        const int numSymbolicActuators = m_problem.getNumSymbolicActuators();
+        if (numSymbolicActuators) {
+            const auto geometry = evalOnTrajectory(
+                    m_problem.getPathGeometry(), inputs, m_gridIndices);
+            const auto symbolicOut =
+                    m_problem.getSymbolicActuatorDynamics()
+                            .map(m_numGridPoints)(std::vector<MX>{
+                                    m_vars[states](Slice(NQ + NU, NS),
+                                            Slice()),
+                                    m_vars[controls], geometry.at(0),
+                                    geometry.at(1)});
+            const MX& tensions = symbolicOut.at(0);
+            const int numEquations = m_numMultibodyResiduals;
+            for (int ia = 0; ia < numSymbolicActuators; ++ia) {
+                m_constraints.multibody_residuals -=
+                        geometry.at(2)(Slice(ia * numEquations,
+                                               (ia + 1) * numEquations),
+                                Slice()) *
+                        MX::repmat(tensions(ia, Slice()), numEquations, 1);
+            }
 
+            // Replace the rows of zdot for the symbolic auxiliary
+            // derivatives with a single row permutation.
+            const auto& zIndices =
+                    m_problem.getSymbolicActuatorAuxiliaryStateIndices();
+            if (!zIndices.empty()) {
+                const int NZ = m_problem.getNumAuxiliaryStates();
+                casadi::Matrix<casadi_int> rows(NZ, 1);
+                for (int iz = 0; iz < NZ; ++iz) { rows(iz) = iz; }
+                for (int i = 0; i < (int)zIndices.size(); ++i) {
+                    rows(zIndices[i]) = NZ + i;
+                }
+                zdot = MX::vertcat({zdot, symbolicOut.at(1)})(rows, Slice());
+            }
+        }
+
+    } else { // Explicit dynamics mode.
         // udot, zdot, kcerr.
-        // Points where we compute algebraic constraints.
-        {
+        if (m_solver.getTranscriptionScheme() == "multiple-shooting") {
+            // The defects come from integrating across each interval, so the
+            // state derivatives at the grid points are not needed. Multiple
+            // shooting supports neither kinematic constraints nor implicit
+            // auxiliary dynamics.
+            udot = MX(NU, m_numGridPoints);
+            zdot = MX(NS - NQ - NU, m_numGridPoints);
+            m_constraints.auxiliary_residuals =
+                    MX(m_numAuxiliaryResiduals, m_numGridPoints);
+        } else if (evalOnEntireGrid) {
             // Evaluate the multibody system function and get udot
             // (speed derivatives) and zdot (auxiliary derivatives).
             const auto out = evalOnTrajectory(
+                    m_problem.getMultibodySystem(), inputs, m_gridIndices);
+            udot = out.at(0);
+            zdot = out.at(1);
+            m_constraints.auxiliary_residuals = out.at(2);
+            if (numKinematicConstraints) m_constraints.kinematic = out.at(3);
+        } else {
+            // Points where we compute algebraic constraints.
+            const auto outMesh = evalOnTrajectory(
                     m_problem.getMultibodySystem(), inputs, m_meshIndices);
-            m_xdot(Slice(NQ, NQ + NU), m_meshIndices) = out.at(0);
-            m_xdot(Slice(NQ + NU, NS), m_meshIndices) = out.at(1);
-            m_constraints.auxiliary_residuals(Slice(), m_meshIndices) =
-                    out.at(2);
-            m_constraints.kinematic = out.at(3);
-        }
-
-        // Points where we ignore algebraic constraints.
-        if (m_numMeshInteriorPoints) {
-            const auto out = evalOnTrajectory(
+            // Points where we ignore algebraic constraints.
+            const auto outInterior = evalOnTrajectory(
                     m_problem.getMultibodySystemIgnoringConstraints(), inputs,
                     m_meshInteriorIndices);
-            m_xdot(Slice(NQ, NQ + NU), m_meshInteriorIndices) =
-                    out.at(0);
-            m_xdot(Slice(NQ + NU, NS), m_meshInteriorIndices) =
-                    out.at(1);
-            m_constraints.auxiliary_residuals(Slice(), m_meshInteriorIndices) =
-                    out.at(2);
+            udot = combineMeshAndInterior(outMesh.at(0), outInterior.at(0));
+            zdot = combineMeshAndInterior(outMesh.at(1), outInterior.at(1));
+            m_constraints.auxiliary_residuals =
+                    combineMeshAndInterior(outMesh.at(2), outInterior.at(2));
+            m_constraints.kinematic = outMesh.at(3);
         }
+        m_constraints.multibody_residuals = MX(casadi::Sparsity::dense(
+                m_numMultibodyResiduals, m_numGridPoints));
     }
+    m_xdot = MX::vertcat({qdot, udot, zdot});
 
     // Calculate defects.
     // ------------------
@@ -416,6 +486,9 @@ void Transcription::transcribe() {
     // ----------------
     // The individual path constraint functions are passed to CasADi to
     // maximize CasADi's ability to take derivatives efficiently.
+    // Path constraints expressed symbolically depend only on time and
+    // controls; they are evaluated at all mesh points at once without any
+    // callbacks.
     int numPathConstraints = (int)m_problem.getPathConstraintInfos().size();
     m_constraints.path.resize(numPathConstraints);
     m_constraintsLowerBounds.path.resize(numPathConstraints);
@@ -423,9 +496,19 @@ void Transcription::transcribe() {
     for (int ipc = 0; ipc < (int)m_constraints.path.size(); ++ipc) {
         const auto& info = m_problem.getPathConstraintInfos()[ipc];
         // TODO: Is it sufficiently general to apply these to mesh points?
-        const auto out = evalOnTrajectory(*info.function,
-                {states, controls, multipliers, derivatives}, m_meshIndices);
-        m_constraints.path[ipc] = out.at(0);
+        if (!info.symbolic_function.is_null()) {
+            m_constraints.path[ipc] =
+                    info.symbolic_function.map(m_numMeshPoints)(
+                                    std::vector<MX>{m_times(m_meshIndices),
+                                            m_vars[controls](Slice(),
+                                                    m_meshIndices)})
+                            .at(0);
+        } else {
+            const auto out = evalOnTrajectory(*info.function,
+                    {states, controls, multipliers, derivatives},
+                    m_meshIndices);
+            m_constraints.path[ipc] = out.at(0);
+        }
         m_constraintsLowerBounds.path[ipc] =
                 casadi::DM::repmat(info.lowerBounds, 1, m_numMeshPoints);
         m_constraintsUpperBounds.path[ipc] =
@@ -448,6 +531,87 @@ void Transcription::transcribe() {
 void Transcription::setObjectiveAndEndpointConstraints() {
     DM quadCoeffs = this->createQuadratureCoefficients();
 
+    // Integrals.
+    // ----------
+    // Here, we include evaluations of the integrands of all costs and endpoint
+    // constraints into the symbolic expression graph for the integrals. We are
+    // *not* numerically evaluating the integrands here--that occurs when the
+    // function by casadi::nlpsol() is evaluated. All integrands are stacked
+    // into a single function so that the trajectory is mapped over only once,
+    // instead of once per cost or constraint.
+    std::vector<const casadi::Function*> integrandFunctions;
+    for (const auto& info : m_problem.getCostInfos()) {
+        if (info.integrand_function) {
+            integrandFunctions.push_back(info.integrand_function.get());
+        }
+    }
+    for (const auto& info : m_problem.getEndpointConstraintInfos()) {
+        if (info.integrand_function) {
+            integrandFunctions.push_back(info.integrand_function.get());
+        }
+    }
+    MX integrals;
+    if (!integrandFunctions.empty()) {
+        const std::vector<Var> inputs{
+                states, controls, multipliers, derivatives};
+        MX integrandTraj;
+        if (integrandFunctions.size() == 1) {
+            integrandTraj = evalOnTrajectory(
+                    *integrandFunctions.front(), inputs, m_gridIndices)
+                                    .at(0);
+        } else {
+            const MXVector pointIn = integrandFunctions.front()->mx_in();
+            MXVector pointOut;
+            for (const auto* integrandFunction : integrandFunctions) {
+                pointOut.push_back((*integrandFunction)(pointIn).at(0));
+            }
+            const casadi::Function integrandsFunc("integrands", pointIn,
+                    {MX::vertcat(pointOut)});
+            integrandTraj =
+                    evalOnTrajectory(integrandsFunc, inputs, m_gridIndices)
+                            .at(0);
+        }
+        integrals = m_duration * MX::mtimes(integrandTraj, quadCoeffs);
+    }
+    int iintegral = 0;
+
+    // Endpoints.
+    // ----------
+    // The endpoint values of all costs and endpoint constraints are computed
+    // by a single function so that the problem can share work across goals.
+    const auto& costInfos = m_problem.getCostInfos();
+    const auto& endpointConstraintInfos =
+            m_problem.getEndpointConstraintInfos();
+    MXVector goalIntegrals;
+    for (const auto& info : costInfos) {
+        goalIntegrals.push_back(info.integrand_function
+                                        ? integrals(iintegral++)
+                                        : MX::nan(1, 1));
+    }
+    for (const auto& info : endpointConstraintInfos) {
+        goalIntegrals.push_back(info.integrand_function
+                                        ? integrals(iintegral++)
+                                        : MX::nan(1, 1));
+    }
+    int numEndpointOutputs = 0;
+    for (const auto& info : costInfos) numEndpointOutputs += info.num_outputs;
+    for (const auto& info : endpointConstraintInfos) {
+        numEndpointOutputs += info.num_outputs;
+    }
+    MX endpointValues;
+    if (numEndpointOutputs) {
+        const MXVector endpointsIn{m_vars[initial_time],
+                m_vars[states](Slice(), 0), m_vars[controls](Slice(), 0),
+                m_vars[multipliers](Slice(), 0),
+                m_vars[derivatives](Slice(), 0), m_vars[final_time],
+                m_vars[states](Slice(), -1), m_vars[controls](Slice(), -1),
+                m_vars[multipliers](Slice(), -1),
+                m_vars[derivatives](Slice(), -1), m_vars[parameters],
+                MX::vertcat(goalIntegrals)};
+        endpointValues = m_problem.getEndpoints()(endpointsIn).at(0);
+    }
+    int ioutput = 0;
+
     // Objective.
     // ----------
     m_objectiveTermNames.clear();
@@ -476,38 +640,34 @@ void Transcription::setObjectiveAndEndpointConstraints() {
     m_objectiveTerms = MX::zeros((int)m_objectiveTermNames.size(), 1);
 
     int iterm = 0;
-    for (int ic = 0; ic < m_problem.getNumCosts(); ++ic) {
-        const auto& info = m_problem.getCostInfos()[ic];
-
-        MX integral;
-        if (info.integrand_function) {
-            // Here, we include evaluations of the integral cost
-            // integrand into the symbolic expression graph for the integral
-            // cost. We are *not* numerically evaluating the integral cost
-            // integrand here--that occurs when the function by casadi::nlpsol()
-            // is evaluated.
-            MX integrandTraj = evalOnTrajectory(*info.integrand_function,
-                    {states, controls, multipliers, derivatives}, m_gridIndices)
-                    .at(0);
+    for (const auto& info : costInfos) {
+        m_objectiveTerms(iterm++) = casadi::MX::sum1(endpointValues(
+                Slice(ioutput, ioutput + info.num_outputs)));
+        ioutput += info.num_outputs;
+    }
 
-            integral = m_duration * dot(quadCoeffs.T(), integrandTraj);
-        } else {
-            integral = MX::nan(1, 1);
+    // Express least-squares costs as residuals for the Gauss-Newton Hessian.
+    // The cost is residual_scale * duration * sum_k quadCoeffs_k |r_k|^2, so
+    // each residual vector r_k is scaled by
+    // sqrt(residual_scale * duration * quadCoeffs_k).
+    m_objectiveResiduals.assign(m_objectiveTermNames.size(), MX());
+    if (m_solver.getGaussNewtonHessian()) {
+        const DM sqrtQuadCoeffs = sqrt(quadCoeffs).T();
+        for (int ic = 0; ic < (int)costInfos.size(); ++ic) {
+            const auto& info = costInfos[ic];
+            // A negative scale (e.g., a negative weight) cannot be expressed
+            // as a sum of squares.
+            if (!info.residual_function || info.residual_scale < 0) continue;
+            const MX residualTraj =
+                    evalOnTrajectory(*info.residual_function,
+                            {states, controls, multipliers, derivatives},
+                            m_gridIndices)
+                            .at(0);
+            const MX factors =
+                    sqrt(info.residual_scale * m_duration) * sqrtQuadCoeffs;
+            m_objectiveResiduals[ic] = MX::vec(
+                    residualTraj * MX::repmat(factors, info.num_residuals, 1));
         }
-
-        MXVector costOut;
-        info.endpoint_function->call(
-                {m_vars[initial_time], m_vars[states](Slice(), 0),
-                 m_vars[controls](Slice(), 0),
-                 m_vars[multipliers](Slice(), 0),
-                 m_vars[derivatives](Slice(), 0), m_vars[final_time],
-                 m_vars[states](Slice(), -1),
-                 m_vars[controls](Slice(), -1),
-                 m_vars[multipliers](Slice(), -1),
-                 m_vars[derivatives](Slice(), -1), m_vars[parameters],
-                 integral},
-                costOut);
-        m_objectiveTerms(iterm++) = casadi::MX::sum1(costOut.at(0));
     }
 
     // Minimize Lagrange multipliers if specified by the solver.
@@ -553,41 +713,178 @@ void Transcription::setObjectiveAndEndpointConstraints() {
     m_constraintsLowerBounds.endpoint.resize(numEndpointConstraints);
     m_constraintsUpperBounds.endpoint.resize(numEndpointConstraints);
     for (int iec = 0; iec < (int)m_constraints.endpoint.size(); ++iec) {
-        const auto& info = m_problem.getEndpointConstraintInfos()[iec];
-
-        MX integral;
-        if (info.integrand_function) {
-            MX integrandTraj = evalOnTrajectory(*info.integrand_function,
-                    {states, controls, multipliers, derivatives}, m_gridIndices)
-                                       .at(0);
+        const auto& info = endpointConstraintInfos[iec];
+        m_constraints.endpoint[iec] =
+                endpointValues(Slice(ioutput, ioutput + info.num_outputs));
+        ioutput += info.num_outputs;
+        m_constraintsLowerBounds.endpoint[iec] = info.lowerBounds;
+        m_constraintsUpperBounds.endpoint[iec] = info.upperBounds;
+    }
+}
 
-            integral = m_duration * dot(quadCoeffs.T(), integrandTraj);
+casadi::Function Transcription::createGaussNewtonHessian(const MX& x,
+        const MX& objectiveScales, casadi_int numConstraints) const {
+    const auto p = objectiveScales.is_empty() ? MX::sym("p", 0, 1)
+                                              : objectiveScales;
+    const auto lam_f = MX::sym("lam_f");
+    const auto lam_g = MX::sym("lam_g", numConstraints);
+    const auto numVariables = x.numel();
+
+    // Least-squares terms contribute 2 J^T J (J is the Jacobian of the
+    // residuals); the remaining terms contribute their exact Hessian. The
+    // curvature of the constraints is neglected, so lam_g is unused.
+    MX hessian = MX(numVariables, numVariables);
+    MX otherObjective = 0;
+    bool hasOtherTerms = false;
+    for (int iterm = 0; iterm < (int)m_objectiveResiduals.size(); ++iterm) {
+        const MX termScale = objectiveScales.is_empty()
+                                     ? MX(1)
+                                     : objectiveScales(iterm);
+        const auto& residuals = m_objectiveResiduals[iterm];
+        if (residuals.is_empty()) {
+            otherObjective += termScale * m_objectiveTerms(iterm);
+            hasOtherTerms = true;
         } else {
-            integral = MX::nan(1, 1);
+            const MX jac = MX::jacobian(residuals, x);
+            hessian += 2 * termScale * MX::mtimes(jac.T(), jac);
         }
+    }
+    if (hasOtherTerms) hessian += MX::hessian(otherObjective, x);
+
+    // If the NLP is scaled, the Hessian is with respect to the scaled
+    // variables xs, where x = scales * xs + offsets.
+    MX xNLP = x;
+    if (!m_variableScales.is_empty()) {
+        xNLP = MX::sym("x_scaled", numVariables);
+        const casadi::Function unscaledHessian(
+                "hessian_unscaled", {x, p}, {hessian});
+        const MX hessianAtX =
+                unscaledHessian(MXVector{unscaleVariables(xNLP), p}).at(0);
+        const DM scales = DM::diag(m_variableScales);
+        hessian = m_objectiveScale *
+                  MX::mtimes(MX::mtimes(scales, hessianAtX), scales);
+    }
 
-        MXVector endpointOut;
-        info.endpoint_function->call(
-                {m_vars[initial_time], m_vars[states](Slice(), 0),
-                        m_vars[controls](Slice(), 0),
-                        m_vars[multipliers](Slice(), 0),
-                        m_vars[derivatives](Slice(), 0), m_vars[final_time],
-                        m_vars[states](Slice(), -1),
-                        m_vars[controls](Slice(), -1),
-                        m_vars[multipliers](Slice(), -1),
-                        m_vars[derivatives](Slice(), -1), m_vars[parameters],
-                        integral},
-                endpointOut);
-        m_constraints.endpoint[iec] = endpointOut.at(0);
-        m_constraintsLowerBounds.endpoint[iec] = info.lowerBounds;
-        m_constraintsUpperBounds.endpoint[iec] = info.upperBounds;
+    return casadi::Function("nlp_hess_l", {xNLP, p, lam_f, lam_g},
+            {triu(lam_f * hessian)}, {"x", "p", "lam_f", "lam_g"},
+            {"hess_gamma_x_x"});
+}
+
+void Transcription::calcScaling(const MX& x, const MX& objectiveScales,
+        const MX& objective, const MX& g, const VariablesDM& guess,
+        const DM& objectiveScalesValue) {
+    const auto inf = std::numeric_limits<double>::infinity();
+
+    // Variables.
+    // ----------
+    // Each row of each variable (e.g., a state across all grid points) is
+    // scaled to [0, 1] using the range of its bounds. Variables without finite
+    // bounds are scaled by the magnitude of the guess.
+    VariablesDM scales;
+    VariablesDM offsets;
+    for (const auto& kv : m_vars) {
+        const Var key = kv.first;
+        const auto numRows = kv.second.rows();
+        const auto numColumns = kv.second.columns();
+        const std::vector<double> lower =
+                DM::densify(m_lowerBounds.at(key)).nonzeros();
+        const std::vector<double> upper =
+                DM::densify(m_upperBounds.at(key)).nonzeros();
+        const std::vector<double> guessValues =
+                DM::densify(guess.at(key)).nonzeros();
+        scales[key] = DM::ones(numRows, numColumns);
+        offsets[key] = DM::zeros(numRows, numColumns);
+        for (casadi_int irow = 0; irow < numRows; ++irow) {
+            double rowLower = inf;
+            double rowUpper = -inf;
+            double guessMagnitude = 0;
+            for (casadi_int icol = 0; icol < numColumns; ++icol) {
+                const auto index = icol * numRows + irow;
+                rowLower = std::min(rowLower, lower[index]);
+                rowUpper = std::max(rowUpper, upper[index]);
+                if (std::isfinite(guessValues[index])) {
+                    guessMagnitude = std::max(
+                            guessMagnitude, std::abs(guessValues[index]));
+                }
+            }
+            if (std::isfinite(rowLower) && std::isfinite(rowUpper) &&
+                    rowUpper > rowLower) {
+                scales[key](irow, Slice()) = rowUpper - rowLower;
+                offsets[key](irow, Slice()) = rowLower;
+            } else if (guessMagnitude > 0) {
+                scales[key](irow, Slice()) = guessMagnitude;
+            }
+        }
+    }
+    m_variableScales = flattenVariables(scales);
+    m_variableOffsets = flattenVariables(offsets);
+
+    // Constraints and objective.
+    // --------------------------
+    // Use the derivatives with respect to the scaled variables at the guess.
+    // Each row of each constraint (e.g., a defect across all mesh intervals)
+    // is divided by the largest magnitude of its gradient.
+    const casadi::Function derivativesFunc("scaling_derivatives",
+            {x, objectiveScales},
+            {MX::jacobian(g, x), MX::gradient(objective, x)});
+    const auto derivatives = derivativesFunc(
+            casadi::DMVector{flattenVariables(guess), objectiveScalesValue});
+    const auto& variableScales = m_variableScales.nonzeros();
+    const DM jacobian = derivatives.at(0);
+    std::vector<casadi_int> jacRows;
+    std::vector<casadi_int> jacColumns;
+    jacobian.sparsity().get_triplet(jacRows, jacColumns);
+    const auto& jacValues = jacobian.nonzeros();
+    std::vector<double> gradientNorms(g.numel(), 0);
+    for (int inz = 0; inz < (int)jacValues.size(); ++inz) {
+        const double value =
+                std::abs(jacValues[inz] * variableScales[jacColumns[inz]]);
+        if (!std::isfinite(value)) continue;
+        auto& norm = gradientNorms[jacRows[inz]];
+        norm = std::max(norm, value);
+    }
+    // Large scale factors would hide constraint violations from the solver's
+    // convergence test, so the factors are limited to [1e-3, 1e3].
+    auto calcScale = [](double norm) {
+        if (norm == 0) return 1.0;
+        return std::min(std::max(1.0 / norm, 1e-3), 1e3);
+    };
+    auto scaleRows = [&](DM& constraint) {
+        for (casadi_int irow = 0; irow < constraint.rows(); ++irow) {
+            const double norm = double(DM::mmax(constraint(irow, Slice())));
+            constraint(irow, Slice()) = calcScale(norm);
+        }
+    };
+    auto constraintScales = expandConstraints(DM(gradientNorms));
+    scaleRows(constraintScales.defects);
+    scaleRows(constraintScales.multibody_residuals);
+    scaleRows(constraintScales.auxiliary_residuals);
+    scaleRows(constraintScales.kinematic);
+    for (auto& endpoint : constraintScales.endpoint) scaleRows(endpoint);
+    for (auto& path : constraintScales.path) scaleRows(path);
+    scaleRows(constraintScales.interp_controls);
+    m_constraintScales = flattenConstraints(constraintScales);
+
+    // As in IPOPT's gradient-based scaling, the objective is only scaled down.
+    const DM gradient = derivatives.at(1);
+    double gradientNorm = 0;
+    const auto& gradValues = gradient.nonzeros();
+    std::vector<casadi_int> gradRows;
+    std::vector<casadi_int> gradColumns;
+    gradient.sparsity().get_triplet(gradRows, gradColumns);
+    for (int inz = 0; inz < (int)gradValues.size(); ++inz) {
+        const double value =
+                std::abs(gradValues[inz] * variableScales[gradRows[inz]]);
+        if (std::isfinite(value)) gradientNorm = std::max(gradientNorm, value);
     }
+    m_objectiveScale = std::min(calcScale(gradientNorm), 1.0);
 }
 
 Solution Transcription::solve(const Iterate& guessOrig) {
 
     // Define the NLP.
     // ---------------
+    const OpenSim::Stopwatch transcriptionStopwatch;
     transcribe();
 
     // Resample the guess.
@@ -647,17 +944,81 @@ Solution Transcription::solve(const Iterate& guessOrig) {
             m_solver.getCallbackInterval());
     options["iteration_callback"] = callback;
 
-    // The inputs to nlpsol() are symbolic (casadi::MX).
-    casadi::MXDict nlp;
-    nlp.emplace(std::make_pair("x", x));
     // The objective symbolic variable holds an expression graph including
     // all the calculations performed on the variables x.
     casadi::MX objective = MX::sum1(m_objectiveTerms);
     if (m_objectiveTerms.numel() == 0) {
         objective = 0;
     }
-    nlp.emplace(std::make_pair("f", objective));
-    nlp.emplace(std::make_pair("g", g));
+    // To compute sensitivities with respect to the weight on each objective
+    // term, scale each term by an NLP parameter whose nominal value is 1.
+    const bool computeSensitivities = m_solver.getComputeSensitivities();
+    const casadi_int numObjectiveTerms = m_objectiveTerms.numel();
+    MX objectiveScales = MX::sym("p", 0, 1);
+    if (computeSensitivities && numObjectiveTerms) {
+        objectiveScales = MX::sym("objective_scales", numObjectiveTerms);
+        objective = MX::dot(objectiveScales, m_objectiveTerms);
+    }
+    // Record the cost of building the NLP so that it can be reported with the
+    // solution; this excludes the construction of the solver itself (which
+    // includes computing derivative sparsity patterns).
+    const double transcriptionTime = transcriptionStopwatch.getElapsedTime();
+    const casadi_int transcriptionNumNodes =
+            casadi::Function("nlp_graph", {x, objectiveScales}, {objective, g})
+                    .n_nodes();
+
+    // The inputs and outputs of nlpFunc are numeric (casadi::DM).
+    casadi::DMDict nlpInput{{"x0", flattenVariables(guess.variables)},
+            {"lbx", flattenVariables(m_lowerBounds)},
+            {"ubx", flattenVariables(m_upperBounds)},
+            {"lbg", flattenConstraints(m_constraintsLowerBounds)},
+            {"ubg", flattenConstraints(m_constraintsUpperBounds)}};
+    if (computeSensitivities && numObjectiveTerms) {
+        nlpInput["p"] = casadi::DM::ones(numObjectiveTerms, 1);
+    }
+
+    // Scale the NLP.
+    // --------------
+    m_variableScales = DM();
+    m_variableOffsets = DM();
+    m_constraintScales = DM();
+    m_objectiveScale = 1;
+    if (m_solver.getAutomaticScaling()) {
+        calcScaling(x, objectiveScales, objective, g, guess.variables,
+                nlpInput.count("p") ? nlpInput.at("p") : DM(0, 1));
+    }
+    if (m_solver.getGaussNewtonHessian()) {
+        options["hess_lag"] =
+                createGaussNewtonHessian(x, objectiveScales, numConstraints);
+    }
+    // The solver sees the scaled variables xs = (x - offsets) / scales, the
+    // scaled constraints, and the scaled objective.
+    auto xNLP = x;
+    auto gNLP = g;
+    auto objectiveNLP = objective;
+    if (!m_variableScales.is_empty()) {
+        xNLP = MX::sym("x_scaled", numVariables);
+        const casadi::Function unscaledFunc(
+                "nlp_unscaled", {x, objectiveScales}, {objective, g});
+        const auto unscaledOut =
+                unscaledFunc(MXVector{unscaleVariables(xNLP), objectiveScales});
+        objectiveNLP = m_objectiveScale * unscaledOut.at(0);
+        gNLP = m_constraintScales * unscaledOut.at(1);
+        nlpInput["x0"] = scaleVariables(nlpInput.at("x0"));
+        nlpInput["lbx"] = scaleVariables(nlpInput.at("lbx"));
+        nlpInput["ubx"] = scaleVariables(nlpInput.at("ubx"));
+        nlpInput["lbg"] = m_constraintScales * nlpInput.at("lbg");
+        nlpInput["ubg"] = m_constraintScales * nlpInput.at("ubg");
+    }
+
+    // The inputs to nlpsol() are symbolic (casadi::MX).
+    casadi::MXDict nlp;
+    nlp.emplace(std::make_pair("x", xNLP));
+    if (computeSensitivities && numObjectiveTerms) {
+        nlp.emplace(std::make_pair("p", objectiveScales));
+    }
+    nlp.emplace(std::make_pair("f", objectiveNLP));
+    nlp.emplace(std::make_pair("g", gNLP));
     if (!m_solver.getWriteSparsity().empty()) {
         const auto prefix = m_solver.getWriteSparsity();
         auto gradient = casadi::MX::gradient(nlp["f"], nlp["x"]);
@@ -665,7 +1026,7 @@ Solution Transcription::solve(const Iterate& guessOrig) {
                 prefix + "_objective_gradient_sparsity.mtx");
         auto hessian = casadi::MX::hessian(nlp["f"], nlp["x"]);
         hessian.sparsity().to_file(prefix + "_objective_Hessian_sparsity.mtx");
-        auto lagrangian = objective +
+        auto lagrangian = nlp["f"] +
                           casadi::MX::dot(casadi::MX::ones(nlp["g"].sparsity()),
                                   nlp["g"]);
         auto hessian_lagr = casadi::MX::hessian(lagrangian, nlp["x"]);
@@ -680,20 +1041,14 @@ Solution Transcription::solve(const Iterate& guessOrig) {
 
     // Run the optimization (evaluate the CasADi NLP function).
     // --------------------------------------------------------
-    // The inputs and outputs of nlpFunc are numeric (casadi::DM).
-    const casadi::DMDict nlpResult =
-            nlpFunc(casadi::DMDict{{"x0", flattenVariables(guess.variables)},
-                    {"lbx", flattenVariables(m_lowerBounds)},
-                    {"ubx", flattenVariables(m_upperBounds)},
-                    {"lbg", flattenConstraints(m_constraintsLowerBounds)},
-                    {"ubg", flattenConstraints(m_constraintsUpperBounds)}});
+    const casadi::DMDict nlpResult = nlpFunc(nlpInput);
 
     // Create a CasOC::Solution.
     // -------------------------
     Solution solution = m_problem.createIterate<Solution>();
-    const auto finalVariables = nlpResult.at("x");
+    const auto finalVariables = unscaleVariables(nlpResult.at("x"));
     solution.variables = expandVariables(finalVariables);
-    solution.objective = nlpResult.at("f").scalar();
+    solution.objective = nlpResult.at("f").scalar() / m_objectiveScale;
 
     casadi::DMVector finalVarsDMV{finalVariables};
     casadi::Function objectiveFunc("objective", {x}, {m_objectiveTerms});
@@ -704,10 +1059,23 @@ Solution Transcription::solve(const Iterate& guessOrig) {
     solution.times = createTimes(
             solution.variables[initial_time], solution.variables[final_time]);
     solution.stats = nlpFunc.stats();
+    solution.stats["transcription_time"] = transcriptionTime;
+    solution.stats["transcription_num_nodes"] = transcriptionNumNodes;
 
     // Print breakdown of objective.
     printObjectiveBreakdown(solution, objectiveOut[0]);
 
+    if (computeSensitivities && solution.stats.at("success")) {
+        // The solver's constraint multipliers are for the scaled constraints
+        // and objective.
+        DM lamG = nlpResult.at("lam_g");
+        if (!m_variableScales.is_empty()) {
+            lamG = m_constraintScales * lamG / m_objectiveScale;
+        }
+        calcSensitivities(x, objectiveScales, objective, g, finalVariables,
+                lamG, solution);
+    }
+
     if (!solution.stats.at("success")) {
 
         // For some reason, nlpResult.at("g") is all 0. So we calculate the
@@ -720,6 +1088,182 @@ Solution Transcription::solve(const Iterate& guessOrig) {
     return solution;
 }
 
+void Transcription::calcSensitivities(const MX& x, const MX& objectiveScales,
+        const MX& objective, const MX& g, const DM& xOpt, const DM& lamG,
+        Solution& solution) const {
+    // Post-optimal sensitivity analysis. If the active set does not change,
+    // the KKT conditions at the solution,
+    //     grad_x f + J_A^T lambda_A + E_B^T nu_B = 0,
+    //     g_A(x) = (bounds of g_A),  E_B x = (bounds of x_B),
+    // hold for nearby values of the objective term scale factors and of the
+    // fixed parameters, where A are the active constraints, B are the
+    // variables at a bound, J_A is the Jacobian of g_A, and E_B selects the
+    // variables in B. Differentiating these conditions gives one linear system
+    // for all derivatives,
+    //     [H    J_A^T  E_B^T] [dx     ]   [-d(grad_x f)]
+    //     [J_A  0      0    ] [dlambda] = [ 0          ]
+    //     [E_B  0      0    ] [dnu    ]   [ d(bounds)  ],
+    // where H is the Hessian of the Lagrangian. We factorize the KKT matrix
+    // once and solve for all right-hand sides together; this costs about as
+    // much as one iteration of the optimizer. If the matrix is singular (see
+    // below), solution.stats["sensitivities_success"] is false and no
+    // sensitivities are returned.
+    const casadi_int numObjectiveTerms = m_objectiveTerms.numel();
+    const casadi_int numVariables = x.numel();
+    const casadi_int numConstraints = g.numel();
+
+    // Derivatives at the solution.
+    // ----------------------------
+    const MX lam = MX::sym("lam_g", numConstraints);
+    const MX lagrangian = objective + MX::dot(lam, g);
+    const casadi::Function derivativesFunc("sensitivity_derivatives",
+            {x, objectiveScales, lam},
+            {MX::hessian(lagrangian, x), MX::jacobian(g, x),
+                    MX::jacobian(m_objectiveTerms, x)});
+    const auto derivatives = derivativesFunc(casadi::DMVector{xOpt,
+            casadi::DM::ones(objectiveScales.numel(), 1), lamG});
+    const DM& hessian = derivatives.at(0);
+    const DM& constraintJacobian = derivatives.at(1);
+    const DM& termGradients = derivatives.at(2);
+
+    // Active set.
+    // -----------
+    auto isActive = [](double value, double lower, double upper) {
+        const double tol = 1e-6;
+        return lower == upper ||
+               value - lower <= tol * std::max(1.0, std::abs(lower)) ||
+               upper - value <= tol * std::max(1.0, std::abs(upper));
+    };
+    const DM lbx = flattenVariables(m_lowerBounds);
+    const DM ubx = flattenVariables(m_upperBounds);
+    std::vector<casadi_int> activeBounds;
+    for (casadi_int iv = 0; iv < numVariables; ++iv) {
+        if (isActive(xOpt(iv).scalar(), lbx(iv).scalar(), ubx(iv).scalar())) {
+            activeBounds.push_back(iv);
+        }
+    }
+    const DM lbg = flattenConstraints(m_constraintsLowerBounds);
+    const DM ubg = flattenConstraints(m_constraintsUpperBounds);
+    const DM gOpt =
+            casadi::Function("constraints", {x}, {g})(casadi::DMVector{xOpt})
+                    .at(0);
+    std::vector<casadi_int> activeConstraints;
+    for (casadi_int ic = 0; ic < numConstraints; ++ic) {
+        if (isActive(gOpt(ic).scalar(), lbg(ic).scalar(), ubg(ic).scalar())) {
+            activeConstraints.push_back(ic);
+        }
+    }
+
+    // Only parameters whose bounds are equal are at a bound regardless of the
+    // solution; the derivative with respect to their value is the derivative
+    // with respect to their bounds. Free parameters are skipped.
+    casadi_int paramOffset = 0;
+    for (const auto& key : getSortedVarKeys(m_vars)) {
+        if (key == parameters) break;
+        paramOffset += m_vars.at(key).numel();
+    }
+    std::vector<casadi_int> fixedParameters;
+    for (casadi_int ip = 0; ip < m_problem.getNumParameters(); ++ip) {
+        const casadi_int iv = paramOffset + ip;
+        if (lbx(iv).scalar() == ubx(iv).scalar()) {
+            fixedParameters.push_back(ip);
+        }
+    }
+
+    // Active constraints that involve only variables at a bound (e.g., an
+    // equality constraint on a variable whose bounds are also equal) are
+    // linear combinations of the rows for those bounds, and would make the
+    // KKT matrix singular.
+    {
+        std::vector<bool> isAtBound(numVariables, false);
+        for (const auto& iv : activeBounds) isAtBound[iv] = true;
+        const DM activeRows = constraintJacobian(activeConstraints, Slice());
+        const casadi::Sparsity& sparsity = activeRows.sparsity();
+        std::vector<bool> isDependent(activeConstraints.size(), true);
+        for (casadi_int iv = 0; iv < numVariables; ++iv) {
+            if (isAtBound[iv]) continue;
+            for (casadi_int k = sparsity.colind(iv);
+                    k < sparsity.colind(iv + 1); ++k) {
+                if (activeRows.nonzeros()[k] != 0) {
+                    isDependent[sparsity.row(k)] = false;
+                }
+            }
+        }
+        std::vector<casadi_int> independentConstraints;
+        for (casadi_int ic = 0; ic < (casadi_int)activeConstraints.size();
+                ++ic) {
+            if (!isDependent[ic]) {
+                independentConstraints.push_back(activeConstraints[ic]);
+            }
+        }
+        activeConstraints = std::move(independentConstraints);
+    }
+
+    // KKT system.
+    // -----------
+    const casadi_int numActiveConstraints =
+            (casadi_int)activeConstraints.size();
+    const casadi_int numActiveBounds = (casadi_int)activeBounds.size();
+    DM boundSelection(numActiveBounds, numVariables);
+    for (casadi_int ib = 0; ib < numActiveBounds; ++ib) {
+        boundSelection(ib, activeBounds[ib]) = 1;
+    }
+    const DM activeJacobian = DM::vertcat(
+            {constraintJacobian(activeConstraints, Slice()), boundSelection});
+    const casadi_int numActive = numActiveConstraints + numActiveBounds;
+    // Other dependent active rows (e.g., from a degenerate active set) and a
+    // Hessian that is singular on the null space of the active rows (e.g.,
+    // from finite differences) also make the KKT matrix singular, so we
+    // regularize it slightly, as interior point methods do.
+    const double regularization =
+            1e-10 * std::max(1.0, DM::norm_inf(hessian).scalar());
+    const DM kkt = DM::blockcat(
+            hessian + regularization * DM::eye(numVariables),
+            activeJacobian.T(), activeJacobian,
+            -regularization * DM::eye(numActive));
+
+    const casadi_int numColumns =
+            numObjectiveTerms + (casadi_int)fixedParameters.size();
+    DM rhs(numVariables + numActive, numColumns);
+    if (numObjectiveTerms) {
+        rhs(Slice(0, numVariables), Slice(0, numObjectiveTerms)) =
+                -termGradients.T();
+    }
+    for (casadi_int ifp = 0; ifp < (casadi_int)fixedParameters.size(); ++ifp) {
+        const casadi_int iv = paramOffset + fixedParameters[ifp];
+        const auto it =
+                std::find(activeBounds.begin(), activeBounds.end(), iv);
+        rhs(numVariables + numActiveConstraints +
+                        std::distance(activeBounds.begin(), it),
+                numObjectiveTerms + ifp) = 1;
+    }
+    const DM kktSolution = DM::solve(kkt, rhs, "qr", casadi::Dict());
+    solution.objective_term_sensitivities.clear();
+    solution.parameter_sensitivities.clear();
+    solution.stats["sensitivities_success"] = kktSolution.is_regular();
+    if (!kktSolution.is_regular()) return;
+
+    auto createSensitivity = [&](casadi_int column) {
+        Iterate sensitivity = solution;
+        sensitivity.variables = expandVariables(casadi::DM::densify(
+                kktSolution(Slice(0, numVariables), column)));
+        // The times are linear in the initial and final time.
+        sensitivity.times =
+                createTimes(sensitivity.variables.at(initial_time),
+                        sensitivity.variables.at(final_time));
+        return sensitivity;
+    };
+    for (casadi_int it = 0; it < numObjectiveTerms; ++it) {
+        solution.objective_term_sensitivities.emplace_back(
+                m_objectiveTermNames[it], createSensitivity(it));
+    }
+    for (casadi_int ifp = 0; ifp < (casadi_int)fixedParameters.size(); ++ifp) {
+        solution.parameter_sensitivities.emplace_back(
+                solution.parameter_names[fixedParameters[ifp]],
+                createSensitivity(numObjectiveTerms + ifp));
+    }
+}
+
 void Transcription::printConstraintValues(const Iterate& it,
         const Constraints<casadi::DM>& constraints,
         std::ostream& stream) const {
@@ -1185,18 +1729,46 @@ casadi::MXVector Transcription::evalOnTrajectory(
 
     // Assemble input.
     // Add 1 for time input and 1 for parameters input.
+    // Inputs on the entire grid are the variables themselves; inputs on a
+    // subset of the grid are sliced once and reused across calls so that
+    // repeated evaluations (costs, path constraints, etc.) share the same
+    // nodes in the MX graph.
+    const bool onGrid = &timeIndices == &m_gridIndices;
     MXVector mxIn(inputs.size() + 2);
-    mxIn[0] = m_times(timeIndices);
+    if (onGrid) {
+        mxIn[0] = m_times;
+    } else {
+        auto it = m_timesOnTrajectory.find(&timeIndices);
+        if (it == m_timesOnTrajectory.end()) {
+            it = m_timesOnTrajectory
+                         .emplace(&timeIndices, m_times(timeIndices))
+                         .first;
+        }
+        mxIn[0] = it->second;
+    }
     for (int i = 0; i < (int)inputs.size(); ++i) {
-        if (inputs[i] == multibody_states) {
-            const auto NQ = m_problem.getNumCoordinates();
-            const auto NU = m_problem.getNumSpeeds();
-            mxIn[i + 1] = m_vars.at(states)(Slice(0, NQ + NU), timeIndices);
-        } else if (inputs[i] == slacks) {
+        if (inputs[i] == slacks) {
             mxIn[i + 1] = m_vars.at(inputs[i]);
-        } else {
-            mxIn[i + 1] = m_vars.at(inputs[i])(Slice(), timeIndices);
+            continue;
+        }
+        if (onGrid && inputs[i] != multibody_states) {
+            mxIn[i + 1] = m_vars.at(inputs[i]);
+            continue;
         }
+        const auto key = std::make_pair(inputs[i], &timeIndices);
+        auto it = m_inputsOnTrajectory.find(key);
+        if (it == m_inputsOnTrajectory.end()) {
+            MX input;
+            if (inputs[i] == multibody_states) {
+                const auto NQ = m_problem.getNumCoordinates();
+                const auto NU = m_problem.getNumSpeeds();
+                input = m_vars.at(states)(Slice(0, NQ + NU), timeIndices);
+            } else {
+                input = m_vars.at(inputs[i])(Slice(), timeIndices);
+            }
+            it = m_inputsOnTrajectory.emplace(key, input).first;
+        }
+        mxIn[i + 1] = it->second;
     }
     if (&timeIndices == &m_gridIndices) {
         mxIn[mxIn.size() - 1] = m_paramsTrajGrid;
@@ -1223,4 +1795,24 @@ casadi::MXVector Transcription::evalOnTrajectory(
     }*/
 }
 
+casadi::MXVector Transcription::evalOnMeshIntervals(
+        const casadi::Function& intervalFunction) const {
+    OPENSIM_THROW_IF(m_numMeshInteriorPoints, OpenSim::Exception,
+            "Internal error.");
+    auto parallelism = m_solver.getParallelism();
+    const auto trajFunc = intervalFunction.map(
+            m_numMeshIntervals, parallelism.first, parallelism.second);
+
+    const int N = m_numGridPoints;
+    MXVector mxIn{
+            MX::reshape(m_times(Slice(0, N - 1)), 1, m_numMeshIntervals),
+            MX::reshape(m_times(Slice(1, N)), 1, m_numMeshIntervals),
+            m_vars.at(states)(Slice(), Slice(0, N - 1)),
+            m_vars.at(controls)(Slice(), Slice(0, N - 1)),
+            MX::repmat(m_vars.at(parameters), 1, m_numMeshIntervals)};
+    MXVector mxOut;
+    trajFunc.call(mxIn, mxOut);
+    return mxOut;
+}
+
 } // namespace CasOC
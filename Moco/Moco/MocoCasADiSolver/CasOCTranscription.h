@@ -79,6 +79,13 @@ protected:
             const std::vector<Var>& inputs,
             const casadi::Matrix<casadi_int>& timeIndices) const;
 
+    /// Evaluate a function over each mesh interval. The inputs to the
+    /// function are the times at the start and end of the interval, the
+    /// states and controls at the start of the interval, and the parameters.
+    /// This requires that the grid has no mesh interior points.
+    casadi::MXVector evalOnMeshIntervals(
+            const casadi::Function& intervalFunction) const;
+
     template <typename TRow, typename TColumn>
     void setVariableBounds(Var var, const TRow& rowIndices,
             const TColumn& columnIndices, const Bounds& bounds) {
@@ -104,6 +111,41 @@ protected:
         std::vector<T> path;
         T interp_controls;
     };
+    /// Fill in the sensitivities of the (successful) solution; see
+    /// Solver::setComputeSensitivities(). `x`, `objectiveScales` and `g` are
+    /// the (unscaled) NLP variables, objective term scale factors, and
+    /// constraints; `xOpt` and `lamG` are the (unscaled) optimal variables and
+    /// constraint multipliers.
+    void calcSensitivities(const casadi::MX& x,
+            const casadi::MX& objectiveScales, const casadi::MX& objective,
+            const casadi::MX& g, const casadi::DM& xOpt,
+            const casadi::DM& lamG, Solution& solution) const;
+    /// Create the function for the Hessian of the Lagrangian passed to
+    /// nlpsol() as "hess_lag"; see Solver::setGaussNewtonHessian().
+    /// `objectiveScales` is empty unless each objective term is scaled by an
+    /// NLP parameter.
+    casadi::Function createGaussNewtonHessian(const casadi::MX& x,
+            const casadi::MX& objectiveScales, casadi_int numConstraints) const;
+    /// Compute m_variableScales, m_variableOffsets, m_constraintScales, and
+    /// m_objectiveScale from the bounds and from the derivatives of the
+    /// constraints and objective at the guess; see
+    /// Solver::setAutomaticScaling().
+    void calcScaling(const casadi::MX& x, const casadi::MX& objectiveScales,
+            const casadi::MX& objective, const casadi::MX& g,
+            const VariablesDM& guess, const casadi::DM& objectiveScalesValue);
+    /// Convert unscaled variables into the variables seen by the
+    /// optimization solver.
+    casadi::DM scaleVariables(const casadi::DM& x) const {
+        if (m_variableScales.is_empty()) return x;
+        return (x - m_variableOffsets) / m_variableScales;
+    }
+    /// Convert the variables seen by the optimization solver into unscaled
+    /// variables.
+    template <typename T>
+    T unscaleVariables(const T& xScaled) const {
+        if (m_variableScales.is_empty()) return xScaled;
+        return T(m_variableScales) * xScaled + T(m_variableOffsets);
+    }
     void printConstraintValues(const Iterate& it,
             const Constraints<casadi::DM>& constraints,
             std::ostream& stream = std::cout) const;
@@ -138,11 +180,32 @@ private:
     casadi::Matrix<casadi_int> m_gridIndices;
     casadi::Matrix<casadi_int> m_meshIndices;
     casadi::Matrix<casadi_int> m_meshInteriorIndices;
+    casadi::Matrix<casadi_int> m_meshAndInteriorToGrid;
 
     casadi::MX m_xdot; // State derivatives.
 
+    // Inputs to evalOnTrajectory() that have already been sliced to a subset
+    // of the grid, keyed by the time indices used for slicing.
+    mutable std::map<std::pair<Var, const casadi::Matrix<casadi_int>*>,
+            casadi::MX>
+            m_inputsOnTrajectory;
+    mutable std::map<const casadi::Matrix<casadi_int>*, casadi::MX>
+            m_timesOnTrajectory;
+
     casadi::MX m_objectiveTerms;
     std::vector<std::string> m_objectiveTermNames;
+    // For each objective term, residuals whose sum of squares is the term, or
+    // an empty MX if the term is not expressed as residuals. Only populated
+    // when using a Gauss-Newton Hessian.
+    std::vector<casadi::MX> m_objectiveResiduals;
+
+    // The solver's variables are (x - m_variableOffsets) / m_variableScales,
+    // and its constraints and objective are multiplied by m_constraintScales
+    // and m_objectiveScale. These are empty (and 1) if the NLP is not scaled.
+    casadi::DM m_variableScales;
+    casadi::DM m_variableOffsets;
+    casadi::DM m_constraintScales;
+    double m_objectiveScale = 1;
 
     Constraints<casadi::MX> m_constraints;
     Constraints<casadi::DM> m_constraintsLowerBounds;
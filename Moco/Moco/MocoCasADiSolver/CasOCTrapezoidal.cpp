@@ -43,19 +43,23 @@ DM Trapezoidal::createMeshIndicesImpl() const {
 void Trapezoidal::calcDefectsImpl(
         const casadi::MX& x, const casadi::MX& xdot, casadi::MX& defects) const {
 
-    // We have arranged the code this way so that all constraints at a given
-    // mesh point are grouped together (organizing the sparsity of the Jacobian
-    // this way might have benefits for sparse linear algebra).
-    for (int itime = 0; itime < m_numMeshIntervals; ++itime) {
-        const auto h = m_times(itime + 1) - m_times(itime);
-        const auto x_i = x(Slice(), itime);
-        const auto x_ip1 = x(Slice(), itime + 1);
-        const auto xdot_i = xdot(Slice(), itime);
-        const auto xdot_ip1 = xdot(Slice(), itime + 1);
-
-        // Trapezoidal defects.
-        defects(Slice(), itime) = x_ip1 - (x_i + 0.5 * h * (xdot_ip1 + xdot_i));
-    }
+    // The defects for all mesh intervals are formed as a single block
+    // expression (rather than one sliced assignment per interval), which keeps
+    // the number of nodes in the MX graph independent of the number of mesh
+    // intervals. Column i of the defects still holds the constraints for mesh
+    // interval i.
+    const int N = m_numGridPoints;
+    const auto h = MX::repmat(MX::reshape(m_times(Slice(1, N)) -
+                                                  m_times(Slice(0, N - 1)),
+                                      1, m_numMeshIntervals),
+            x.rows(), 1);
+    const auto x_i = x(Slice(), Slice(0, N - 1));
+    const auto x_ip1 = x(Slice(), Slice(1, N));
+    const auto xdot_i = xdot(Slice(), Slice(0, N - 1));
+    const auto xdot_ip1 = xdot(Slice(), Slice(1, N));
+
+    // Trapezoidal defects.
+    defects = x_ip1 - (x_i + 0.5 * h * (xdot_ip1 + xdot_i));
 }
 
 } // namespace CasOC
@@ -18,10 +18,17 @@
 
 #include "MocoCasADiSolver.h"
 
+#include "../Components/DeGrooteFregly2016Muscle.h"
+#include "../MocoGoal/MocoControlGoal.h"
+#include "../MocoGoal/MocoOutputGoal.h"
+#include "../MocoStudy.h"
 #include "../MocoUtilities.h"
 #include "CasOCSolver.h"
 #include "MocoCasOCProblem.h"
+#include <algorithm>
 #include <casadi/casadi.hpp>
+#include <cmath>
+#include <set>
 
 using casadi::Callback;
 using casadi::Dict;
@@ -39,8 +46,22 @@ void MocoCasADiSolver::constructProperties() {
     constructProperty_optim_sparsity_detection("none");
     constructProperty_optim_write_sparsity("");
     constructProperty_optim_finite_difference_scheme("central");
+    constructProperty_optim_automatic_scaling(false);
+    constructProperty_optim_jacobian_refresh_interval(1);
     constructProperty_parallel();
+    constructProperty_share_model_across_threads(false);
+    constructProperty_numa_aware_parallelism(false);
+    constructProperty_symbolic_muscle_dynamics(false);
+    constructProperty_multiple_shooting_integrator_steps(10);
+    constructProperty_compute_sensitivities(false);
+    constructProperty_num_time_windows(1);
+    constructProperty_time_window_overlap(0.25);
+    constructProperty_time_window_concurrency(1);
+    constructProperty_time_window_max_iterations(5);
+    constructProperty_time_window_tolerance(1e-3);
+    constructProperty_reduce_problem(false);
     constructProperty_output_interval(0);
+    constructProperty_callback_trace_file("");
 
     constructProperty_minimize_implicit_multibody_accelerations(false);
     constructProperty_implicit_multibody_accelerations_weight(1.0);
@@ -49,12 +70,13 @@ void MocoCasADiSolver::constructProperties() {
 }
 
 MocoTrajectory MocoCasADiSolver::createGuess(const std::string& type) const {
-    OPENSIM_THROW_IF_FRMOBJ(
-            type != "bounds" && type != "random" && type != "time-stepping",
+    OPENSIM_THROW_IF_FRMOBJ(type != "bounds" && type != "random" &&
+                                    type != "time-stepping" &&
+                                    type != "equilibrium",
             Exception,
             "Unexpected guess type '" + type +
-                    "'; supported types are 'bounds', 'random', and "
-                    "'time-stepping'.");
+                    "'; supported types are 'bounds', 'random', "
+                    "'time-stepping', and 'equilibrium'.");
 
     if (type == "time-stepping") { return createGuessTimeStepping(); }
 
@@ -67,6 +89,11 @@ MocoTrajectory MocoCasADiSolver::createGuess(const std::string& type) const {
     } else if (type == "random") {
         return convertToMocoTrajectory(
                 casSolver->createRandomIterateWithinBounds());
+    } else if (type == "equilibrium") {
+        return createGuessEquilibrium(
+                convertToMocoTrajectory(
+                        casSolver->createInitialGuessFromBounds()),
+                casProblem->getProblemReps());
     } else {
         OPENSIM_THROW(Exception, "Internal error.");
     }
@@ -124,8 +151,7 @@ const MocoTrajectory& MocoCasADiSolver::getGuess() const {
     return m_guessToUse.getRef();
 }
 
-std::unique_ptr<MocoCasOCProblem> MocoCasADiSolver::createCasOCProblem() const {
-    const auto& problemRep = getProblemRep();
+int MocoCasADiSolver::getNumThreads() const {
     int parallel = 1;
     int parallelEV = getMocoParallelEnvironmentVariable();
     if (getProperty_parallel().size()) {
@@ -133,14 +159,29 @@ std::unique_ptr<MocoCasOCProblem> MocoCasADiSolver::createCasOCProblem() const {
     } else if (parallelEV != -1) {
         parallel = parallelEV;
     }
-    int numThreads;
     if (parallel == 0) {
-        numThreads = 1;
+        return 1;
     } else if (parallel == 1) {
-        numThreads = std::thread::hardware_concurrency();
+        return std::thread::hardware_concurrency();
     } else {
-        numThreads = parallel;
+        return parallel;
     }
+}
+
+std::unique_ptr<MocoCasOCProblem> MocoCasADiSolver::createCasOCProblem() const {
+    return createCasOCProblem(getNumThreads());
+}
+
+std::unique_ptr<MocoCasOCProblem> MocoCasADiSolver::createCasOCProblem(
+        int numThreads) const {
+    return createCasOCProblem(numThreads,
+            get_numa_aware_parallelism() ? getNUMANodeCPUs()
+                                         : std::vector<std::vector<int>>());
+}
+
+std::unique_ptr<MocoCasOCProblem> MocoCasADiSolver::createCasOCProblem(
+        int numThreads, std::vector<std::vector<int>> numaNodeCPUs) const {
+    const auto& problemRep = getProblemRep();
 
     checkPropertyInSet(
             *this, getProperty_multibody_dynamics_mode(), {"explicit", "implicit"});
@@ -149,13 +190,61 @@ std::unique_ptr<MocoCasOCProblem> MocoCasADiSolver::createCasOCProblem() const {
                 "Prescribed kinematics (PositionMotion) requires implicit "
                 "dynamics mode.");
     }
+    OPENSIM_THROW_IF(get_symbolic_muscle_dynamics() &&
+                             get_multibody_dynamics_mode() != "implicit",
+            Exception,
+            "Symbolic muscle dynamics requires implicit dynamics mode.");
+    // With prescribed kinematics, the multibody residuals come from the
+    // PositionMotion rather than from the optimizer's accelerations, so the
+    // symbolic muscle tensions cannot be subtracted from them.
+    OPENSIM_THROW_IF(get_symbolic_muscle_dynamics() &&
+                             problemRep.isPrescribedKinematics(),
+            Exception,
+            "Symbolic muscle dynamics is not supported with prescribed "
+            "kinematics (PositionMotion).");
+    // The symbolic muscle equations have no tendon compliance dynamics.
+    if (get_symbolic_muscle_dynamics()) {
+        for (const auto& muscle :
+                problemRep.getModelBase()
+                        .getComponentList<DeGrooteFregly2016Muscle>()) {
+            OPENSIM_THROW_IF(muscle.get_appliesForce() &&
+                                     !muscle.get_ignore_tendon_compliance(),
+                    Exception,
+                    "Symbolic muscle dynamics supports only rigid tendons, "
+                    "but muscle '{}' has ignore_tendon_compliance set to "
+                    "false.",
+                    muscle.getAbsolutePathString());
+        }
+    }
+
+    if (get_share_model_across_threads()) {
+        OPENSIM_THROW_IF(problemRep.getNumParameters(), Exception,
+                "Sharing the model across threads requires a problem without "
+                "MocoParameters.");
+        auto checkGoal = [](const MocoGoal& goal) {
+            OPENSIM_THROW_IF(dynamic_cast<const MocoOutputGoal*>(&goal),
+                    Exception,
+                    "Sharing the model across threads is not supported with "
+                    "MocoOutputGoal, but goal '{}' is a MocoOutputGoal.",
+                    goal.getName());
+        };
+        for (int i = 0; i < problemRep.getNumCosts(); ++i) {
+            checkGoal(problemRep.getCostByIndex(i));
+        }
+        for (int i = 0; i < problemRep.getNumEndpointConstraints(); ++i) {
+            checkGoal(problemRep.getEndpointConstraintByIndex(i));
+        }
+    }
 
     const auto& model = problemRep.getModelBase();
     OPENSIM_THROW_IF(!model.getMatterSubsystem().getUseEulerAngles(
                              model.getWorkingState()),
             Exception, "Quaternions are not supported.");
+    auto jar = createProblemRepJar(
+            numThreads, get_share_model_across_threads(), numaNodeCPUs);
     return OpenSim::make_unique<MocoCasOCProblem>(*this, problemRep,
-            createProblemRepJar(numThreads), get_multibody_dynamics_mode());
+            std::move(jar), get_multibody_dynamics_mode(),
+            std::move(numaNodeCPUs));
 }
 
 std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
@@ -167,7 +256,16 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
     Dict solverOptions;
     checkPropertyInSet(*this, getProperty_optim_solver(), {"ipopt", "snopt"});
     checkPropertyInSet(*this, getProperty_transcription_scheme(),
-            {"trapezoidal", "hermite-simpson"});
+            {"trapezoidal", "hermite-simpson", "multiple-shooting"});
+    if (get_transcription_scheme() == "multiple-shooting") {
+        OPENSIM_THROW_IF(get_multibody_dynamics_mode() != "explicit",
+                Exception,
+                "Multiple shooting requires the 'explicit' "
+                "multibody_dynamics_mode.");
+        checkPropertyInRangeOrSet(*this,
+                getProperty_multiple_shooting_integrator_steps(), 1,
+                std::numeric_limits<int>::max(), {});
+    }
     OPENSIM_THROW_IF(casProblem.getNumKinematicConstraintEquations() != 0 &&
                              get_transcription_scheme() == "trapezoidal",
             OpenSim::Exception,
@@ -222,8 +320,20 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
         } else if (get_optim_ipopt_print_level() != -1) {
             solverOptions["print_level"] = get_optim_ipopt_print_level();
         }
-        solverOptions["hessian_approximation"] =
-                get_optim_hessian_approximation();
+        checkPropertyInSet(*this, getProperty_optim_hessian_approximation(),
+                {"limited-memory", "exact", "gauss-newton"});
+        if (get_optim_hessian_approximation() == "gauss-newton") {
+            // IPOPT uses the Hessian that we provide.
+            solverOptions["hessian_approximation"] = "exact";
+            casSolver->setGaussNewtonHessian(true);
+        } else {
+            solverOptions["hessian_approximation"] =
+                    get_optim_hessian_approximation();
+        }
+        // Our scaling replaces IPOPT's gradient-based scaling.
+        if (get_optim_automatic_scaling()) {
+            solverOptions["nlp_scaling_method"] = "none";
+        }
 
         if (get_optim_max_iterations() != -1)
             solverOptions["max_iter"] = get_optim_max_iterations();
@@ -251,11 +361,30 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
     casSolver->setSparsityDetectionRandomCount(3);
 
     casSolver->setWriteSparsity(get_optim_write_sparsity());
+    casSolver->setComputeSensitivities(get_compute_sensitivities());
+    casSolver->setAutomaticScaling(get_optim_automatic_scaling());
 
     checkPropertyInSet(*this, getProperty_optim_finite_difference_scheme(),
-            {"central", "forward", "backward"});
+            {"central", "forward", "backward", "adaptive"});
     casSolver->setFiniteDifferenceScheme(get_optim_finite_difference_scheme());
 
+    checkPropertyInRangeOrSet(*this,
+            getProperty_optim_jacobian_refresh_interval(), 1,
+            std::numeric_limits<int>::max(), {});
+    if (get_optim_jacobian_refresh_interval() > 1) {
+        OPENSIM_THROW_IF_FRMOBJ(get_optim_solver() == "ipopt" &&
+                                        get_optim_hessian_approximation() ==
+                                                "exact",
+                Exception,
+                "Jacobian reuse (optim_jacobian_refresh_interval > 1) is not "
+                "supported with an exact Hessian.");
+        OPENSIM_THROW_IF_FRMOBJ(get_compute_sensitivities(), Exception,
+                "Jacobian reuse (optim_jacobian_refresh_interval > 1) is not "
+                "supported with compute_sensitivities.");
+    }
+    casSolver->setJacobianRefreshInterval(
+            get_optim_jacobian_refresh_interval());
+
     casSolver->setCallbackInterval(get_output_interval());
 
     Dict pluginOptions;
@@ -310,6 +439,12 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
 }
 
 MocoSolution MocoCasADiSolver::solveImpl() const {
+    if (get_num_time_windows() > 1) return solveTimeWindows();
+    if (get_reduce_problem()) {
+        MocoSolution solution;
+        if (solveReducedProblem(solution)) return solution;
+    }
+
     const Stopwatch stopwatch;
 
     if (get_verbosity()) {
@@ -324,6 +459,9 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
     if (get_verbosity()) {
         log_info("Number of threads: {}", casProblem->getJarSize());
     }
+    if (!get_callback_trace_file().empty()) {
+        casProblem->recordCallbackTrace(get_callback_trace_file());
+    }
 
     MocoTrajectory guess = getGuess();
     CasOC::Iterate casGuess;
@@ -333,17 +471,12 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
         casGuess = convertToCasOCIterate(guess);
     }
 
-    // Temporarily disable printing of negative muscle force warnings so the
-    // log isn't flooded while computing finite differences.
-    Logger::Level origLoggerLevel = Logger::getLevel();
-    Logger::setLevel(Logger::Level::Warn);
-    CasOC::Solution casSolution;
-    try {
-        casSolution = casSolver->solve(casGuess);
-    } catch (...) {
-        OpenSim::Logger::setLevel(origLoggerLevel);
-    }
-    OpenSim::Logger::setLevel(origLoggerLevel);
+    // Components count events (e.g., muscles buckling) instead of logging
+    // them from the callbacks, and we report the counts once, below.
+    const auto models = casProblem->getModels();
+    resetDiagnostics(models);
+    CasOC::Solution casSolution = casSolver->solve(casGuess);
+    if (get_verbosity()) logDiagnostics(models);
 
     MocoSolution mocoSolution =
             convertToMocoTrajectory<MocoSolution>(casSolution);
@@ -399,8 +532,65 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
             casSolution.stats.at("iter_count"), SimTK::nsToSec(elapsed),
             casSolution.objective_breakdown);
 
+    if (get_compute_sensitivities() && mocoSolution &&
+            casSolution.stats.count("sensitivities_success") &&
+            !casSolution.stats.at("sensitivities_success").to_bool()) {
+        log_warn("Could not compute the sensitivities of the solution: the "
+                 "KKT matrix at the solution is singular (e.g., because of "
+                 "dependent active constraints). The solution has no "
+                 "sensitivities.");
+    } else if (get_compute_sensitivities() && mocoSolution) {
+        // The sensitivity iterates hold derivatives of the times, so we
+        // convert them using the solution's times (slack variables are
+        // interpolated in time) and then set the derivatives of the times.
+        auto convertSensitivity = [&casSolution](CasOC::Iterate sensitivity) {
+            const SimTK::Vector timeSensitivity =
+                    convertToSimTKVector(sensitivity.times);
+            sensitivity.times = casSolution.times;
+            MocoTrajectory trajectory = convertToMocoTrajectory(sensitivity);
+            trajectory.setTime(timeSensitivity);
+            return trajectory;
+        };
+        // The objective terms are scaled by factors with a nominal value of
+        // 1, and each goal's term already includes the goal's weight.
+        // Therefore, the derivative with respect to the weight is the
+        // derivative with respect to the scale factor divided by the weight.
+        const auto& problemRep = getProblemRep();
+        std::map<std::string, double> weights;
+        for (int ic = 0; ic < problemRep.getNumCosts(); ++ic) {
+            const auto& cost = problemRep.getCostByIndex(ic);
+            weights[cost.getName()] = cost.getWeight();
+        }
+        std::vector<std::pair<std::string, MocoTrajectory>> goalWeights;
+        for (const auto& term : casSolution.objective_term_sensitivities) {
+            // Skip terms added by the solver and goals with zero weight.
+            if (!weights.count(term.first) || weights.at(term.first) == 0) {
+                continue;
+            }
+            CasOC::Iterate sensitivity = term.second;
+            for (auto& var : sensitivity.variables) {
+                var.second /= weights.at(term.first);
+            }
+            sensitivity.times /= weights.at(term.first);
+            goalWeights.emplace_back(
+                    term.first, convertSensitivity(std::move(sensitivity)));
+        }
+        std::vector<std::pair<std::string, MocoTrajectory>> parameters;
+        for (const auto& param : casSolution.parameter_sensitivities) {
+            parameters.emplace_back(
+                    param.first, convertSensitivity(param.second));
+        }
+        setSolutionSensitivities(
+                mocoSolution, std::move(goalWeights), std::move(parameters));
+    }
+
     if (get_verbosity()) {
         log_info(std::string(72, '-'));
+        log_info("Transcription time: {}.",
+                stopwatch.formatNs(SimTK::secToNs(
+                        (double)casSolution.stats.at("transcription_time"))));
+        log_info("Transcription MX graph nodes: {}.",
+                (casadi_int)casSolution.stats.at("transcription_num_nodes"));
         log_info("Elapsed real time: {}.", stopwatch.formatNs(elapsed));
         log_info(getMocoFormattedDateTime(false, "%c"));
         if (mocoSolution) {
@@ -413,3 +603,612 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
     }
     return mocoSolution;
 }
+
+namespace {
+/// Insert `suffix` before the extension (if any) of the file name in `path`.
+std::string appendToFileStem(
+        const std::string& path, const std::string& suffix) {
+    const auto slash = path.find_last_of("/\\");
+    const auto dot = path.rfind('.');
+    if (dot == std::string::npos ||
+            (slash != std::string::npos && dot < slash)) {
+        return path + suffix;
+    }
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+
+/// Evaluate the costs of `problem` on `trajectory`, whose columns are in the
+/// order of the problem's variables. The integrals are computed with the
+/// trapezoidal rule over the times in the trajectory.
+std::vector<std::pair<std::string, double>> calcObjectiveBreakdown(
+        const CasOC::Problem& problem, const MocoTrajectory& trajectory) {
+    const SimTK::Vector& time = trajectory.getTime();
+    const int numTimes = time.size();
+    auto toDM = [](const SimTK::Matrix& matrix, int row) {
+        DM values(matrix.ncol(), 1);
+        for (int ic = 0; ic < matrix.ncol(); ++ic) {
+            values(ic) = matrix(row, ic);
+        }
+        return values;
+    };
+    std::vector<DM> states(numTimes);
+    std::vector<DM> controls(numTimes);
+    std::vector<DM> multipliers(numTimes);
+    std::vector<DM> derivatives(numTimes);
+    for (int it = 0; it < numTimes; ++it) {
+        states[it] = toDM(trajectory.getStatesTrajectory(), it);
+        controls[it] = toDM(trajectory.getControlsTrajectory(), it);
+        multipliers[it] = toDM(trajectory.getMultipliersTrajectory(), it);
+        derivatives[it] = toDM(trajectory.getDerivativesTrajectory(), it);
+    }
+    const SimTK::RowVector& simtkParameters = trajectory.getParameters();
+    DM parameters(simtkParameters.size(), 1);
+    for (int ip = 0; ip < simtkParameters.size(); ++ip) {
+        parameters(ip) = simtkParameters[ip];
+    }
+
+    std::vector<std::pair<std::string, double>> breakdown;
+    const auto& costInfos = problem.getCostInfos();
+    for (int ic = 0; ic < (int)costInfos.size(); ++ic) {
+        double integral = 0;
+        if (costInfos[ic].integrand_function) {
+            std::vector<double> integrand(numTimes);
+            for (int it = 0; it < numTimes; ++it) {
+                problem.calcCostIntegrand(ic,
+                        {time[it], states[it], controls[it], multipliers[it],
+                                derivatives[it], parameters},
+                        integrand[it]);
+            }
+            for (int it = 1; it < numTimes; ++it) {
+                integral += 0.5 * (time[it] - time[it - 1]) *
+                            (integrand[it] + integrand[it - 1]);
+            }
+        }
+        const int last = numTimes - 1;
+        DM cost(costInfos[ic].num_outputs, 1);
+        problem.calcCost(ic,
+                {time[0], states[0], controls[0], multipliers[0],
+                        derivatives[0], time[last], states[last],
+                        controls[last], multipliers[last], derivatives[last],
+                        parameters, integral},
+                cost);
+        breakdown.emplace_back(costInfos[ic].name, DM::sum1(cost).scalar());
+    }
+    return breakdown;
+}
+} // namespace
+
+MocoSolution MocoCasADiSolver::solveTimeWindows() const {
+    const Stopwatch stopwatch;
+    const auto& problemRep = getProblemRep();
+    const int numWindows = get_num_time_windows();
+    const double overlap = get_time_window_overlap();
+    OPENSIM_THROW_IF_FRMOBJ(overlap <= 0 || overlap > 0.5, Exception,
+            "Expected time_window_overlap to be in (0, 0.5], but it is {}.",
+            overlap);
+    checkPropertyInRangeOrSet(*this, getProperty_time_window_concurrency(), 1,
+            numWindows, {});
+    checkPropertyInRangeOrSet(*this, getProperty_time_window_max_iterations(),
+            1, std::numeric_limits<int>::max(), {});
+    OPENSIM_THROW_IF_FRMOBJ(!getProperty_mesh().empty(), Exception,
+            "Time windows require a uniform mesh (num_mesh_intervals); the "
+            "mesh property is not supported.");
+    // Each window is a separate problem, so goals must be integrals that can
+    // be split across windows.
+    OPENSIM_THROW_IF_FRMOBJ(problemRep.getNumEndpointConstraints(), Exception,
+            "Time windows do not support endpoint constraints.");
+    for (const auto& name : problemRep.createCostNames()) {
+        const auto& cost = problemRep.getCost(name);
+        const auto* controlGoal = dynamic_cast<const MocoControlGoal*>(&cost);
+        const auto* outputGoal = dynamic_cast<const MocoOutputGoal*>(&cost);
+        const bool dividesByDisplacement =
+                (controlGoal && controlGoal->getDivideByDisplacement()) ||
+                (outputGoal && outputGoal->getDivideByDisplacement());
+        OPENSIM_THROW_IF_FRMOBJ(
+                !cost.getNumIntegrals() || dividesByDisplacement, Exception,
+                "Time windows only support goals that are integrals over the "
+                "phase, but goal '{}' depends on the initial or final state.",
+                name);
+    }
+    OPENSIM_THROW_IF_FRMOBJ(get_compute_sensitivities(), Exception,
+            "Time windows do not support computing sensitivities.");
+    const auto initialTimeBounds = problemRep.getTimeInitialBounds();
+    const auto finalTimeBounds = problemRep.getTimeFinalBounds();
+    OPENSIM_THROW_IF_FRMOBJ(!initialTimeBounds.isEquality() ||
+                                    !finalTimeBounds.isEquality(),
+            Exception, "Time windows require fixed initial and final times.");
+
+    // Each window consists of a core, which contributes to the final
+    // solution, and overlaps with the neighboring cores.
+    const double initialTime = initialTimeBounds.getLower();
+    const double finalTime = finalTimeBounds.getLower();
+    const double coreDuration = (finalTime - initialTime) / numWindows;
+    std::vector<double> coreStarts(numWindows + 1);
+    std::vector<double> windowStarts(numWindows);
+    std::vector<double> windowEnds(numWindows);
+    for (int iw = 0; iw <= numWindows; ++iw) {
+        coreStarts[iw] = initialTime + iw * coreDuration;
+    }
+    coreStarts[numWindows] = finalTime;
+    for (int iw = 0; iw < numWindows; ++iw) {
+        windowStarts[iw] = std::max(
+                initialTime, coreStarts[iw] - overlap * coreDuration);
+        windowEnds[iw] = std::min(
+                finalTime, coreStarts[iw + 1] + overlap * coreDuration);
+    }
+
+    // Each window gets a share of the mesh intervals proportional to its
+    // duration.
+    std::vector<int> numMeshIntervals(numWindows);
+    for (int iw = 0; iw < numWindows; ++iw) {
+        numMeshIntervals[iw] = std::max(1,
+                (int)std::ceil(get_num_mesh_intervals() *
+                               (windowEnds[iw] - windowStarts[iw]) /
+                               (finalTime - initialTime)));
+    }
+
+    const auto stateNames = problemRep.createStateInfoNames();
+    const auto parameterNames = problemRep.createParameterNames();
+    const MocoTrajectory& guess = getGuess();
+    std::vector<MocoSolution> windowSolutions(numWindows);
+    std::vector<bool> windowSucceeded(numWindows, false);
+    std::vector<bool> windowSolved(numWindows, false);
+
+    // The states at the given time from the latest solution of a window, or
+    // an empty vector if the window has not been solved.
+    auto calcStates = [&](int iw, double time) {
+        SimTK::Vector states;
+        if (!windowSolved[iw]) return states;
+        const auto& solution = windowSolutions[iw];
+        states.resize((int)stateNames.size());
+        const SimTK::Vector newTime(1, time);
+        for (int is = 0; is < (int)stateNames.size(); ++is) {
+            states[is] = interpolate(solution.getTime(),
+                    SimTK::Vector(solution.getState(stateNames[is])),
+                    newTime)[0];
+        }
+        return states;
+    };
+
+    // Solve a window whose states are fixed to the provided values (if not
+    // empty) at the start and end of the window.
+    auto solveWindow = [&](int iw, int numThreads,
+                               const SimTK::Vector& initialStates,
+                               const SimTK::Vector& finalStates) {
+        MocoStudy study;
+        study.set_write_solution("false");
+        MocoProblem& problem = study.updProblem();
+        problem = getProblem();
+        problem.setTimeBounds(windowStarts[iw], windowEnds[iw]);
+        for (int is = 0; is < (int)stateNames.size(); ++is) {
+            const auto& info = problemRep.getStateInfo(stateNames[is]);
+            // Only the first window starts at the initial time.
+            MocoInitialBounds initialBounds = info.getInitialBounds();
+            if (initialStates.size()) {
+                initialBounds = MocoInitialBounds(initialStates[is]);
+            } else if (iw != 0) {
+                initialBounds = MocoInitialBounds();
+            }
+            MocoFinalBounds finalBounds = info.getFinalBounds();
+            if (finalStates.size()) {
+                finalBounds = MocoFinalBounds(finalStates[is]);
+            } else if (iw != numWindows - 1) {
+                finalBounds = MocoFinalBounds();
+            }
+            problem.setStateInfo(stateNames[is], info.getBounds(),
+                    initialBounds, finalBounds);
+        }
+
+        auto& solver = study.initCasADiSolver();
+        solver = *this;
+        solver.set_num_time_windows(1);
+        solver.set_num_mesh_intervals(numMeshIntervals[iw]);
+        // A value of 1 for 'parallel' means using all cores.
+        solver.set_parallel(numThreads > 1 ? numThreads : 0);
+        solver.set_verbosity(0);
+        // Windows may be solved concurrently, so each window writes its own
+        // diagnostic files.
+        const std::string windowSuffix = fmt::format("_window{}", iw);
+        if (!get_callback_trace_file().empty()) {
+            solver.set_callback_trace_file(appendToFileStem(
+                    get_callback_trace_file(), windowSuffix));
+        }
+        if (!get_optim_write_sparsity().empty()) {
+            solver.set_optim_write_sparsity(
+                    get_optim_write_sparsity() + windowSuffix);
+        }
+        // The intermediate trajectories are named by the time at which the
+        // solve started, which the windows would share.
+        solver.set_output_interval(0);
+        if (windowSolved[iw]) {
+            solver.setGuess(windowSolutions[iw]);
+        } else if (!guess.empty()) {
+            MocoTrajectory windowGuess = guess;
+            windowGuess.resample(createVectorLinspace(
+                    numMeshIntervals[iw] + 1, windowStarts[iw],
+                    windowEnds[iw]));
+            solver.setGuess(std::move(windowGuess));
+        } else {
+            solver.clearGuess();
+        }
+        return study.solve();
+    };
+
+    if (get_verbosity()) {
+        log_info(std::string(72, '='));
+        log_info("MocoCasADiSolver starting (time windows).");
+        log_info(getMocoFormattedDateTime(false, "%c"));
+        log_info(std::string(72, '-'));
+        getProblemRep().printDescription();
+        log_info("Number of time windows: {}.", numWindows);
+    }
+
+    // Overlapping Schwarz iterations: the states at the start of each window
+    // are fixed to the latest solution of the preceding window, and (after
+    // the first iteration) the states at the end of each window are fixed
+    // to the latest solution of the following window. Windows in the same
+    // batch are solved concurrently, using their neighbors' solutions from
+    // the previous iteration.
+    const int concurrency = get_time_window_concurrency();
+    const int threadsPerWindow = std::max(1, getNumThreads() / concurrency);
+    double mismatch = SimTK::Infinity;
+    int iteration = 0;
+    int numSolverIterations = 0;
+    while (iteration < get_time_window_max_iterations()) {
+        for (int first = 0; first < numWindows; first += concurrency) {
+            const int end = std::min(numWindows, first + concurrency);
+            std::vector<SimTK::Vector> initialStates(end - first);
+            std::vector<SimTK::Vector> finalStates(end - first);
+            for (int iw = first; iw < end; ++iw) {
+                if (iw > 0) {
+                    initialStates[iw - first] =
+                            calcStates(iw - 1, windowStarts[iw]);
+                }
+                if (iw < numWindows - 1) {
+                    finalStates[iw - first] =
+                            calcStates(iw + 1, windowEnds[iw]);
+                }
+            }
+            std::vector<MocoSolution> batch(end - first);
+            std::vector<std::exception_ptr> errors(end - first);
+            std::vector<std::thread> threads;
+            for (int iw = first; iw < end; ++iw) {
+                threads.emplace_back([&, iw]() {
+                    try {
+                        batch[iw - first] = solveWindow(iw, threadsPerWindow,
+                                initialStates[iw - first],
+                                finalStates[iw - first]);
+                    } catch (...) {
+                        errors[iw - first] = std::current_exception();
+                    }
+                });
+            }
+            for (auto& thread : threads) thread.join();
+            for (const auto& error : errors) {
+                if (error) std::rethrow_exception(error);
+            }
+            for (int iw = first; iw < end; ++iw) {
+                windowSucceeded[iw] = batch[iw - first].success();
+                windowSolutions[iw] = std::move(batch[iw - first].unseal());
+                windowSolved[iw] = true;
+                numSolverIterations += windowSolutions[iw].getNumIterations();
+            }
+        }
+        ++iteration;
+
+        // The largest difference between the states of neighboring windows
+        // at the boundaries between cores, and between the parameters of
+        // neighboring windows.
+        mismatch = 0;
+        for (int iw = 1; iw < numWindows; ++iw) {
+            const SimTK::Vector difference =
+                    calcStates(iw, coreStarts[iw]) -
+                    calcStates(iw - 1, coreStarts[iw]);
+            mismatch = std::max(mismatch, SimTK::max(difference.abs()));
+            if (!parameterNames.empty()) {
+                const SimTK::RowVector parameterDifference =
+                        windowSolutions[iw].getParameters() -
+                        windowSolutions[iw - 1].getParameters();
+                mismatch = std::max(
+                        mismatch, SimTK::max(parameterDifference.abs()));
+            }
+        }
+        if (get_verbosity()) {
+            log_info("Time window iteration {}: boundary mismatch {}.",
+                    iteration, mismatch);
+        }
+        if (mismatch <= get_time_window_tolerance()) break;
+    }
+
+    // Stitch together the cores of the windows.
+    const auto& first = windowSolutions[0];
+    std::vector<std::pair<int, int>> rows;
+    for (int iw = 0; iw < numWindows; ++iw) {
+        const auto& time = windowSolutions[iw].getTime();
+        for (int it = 0; it < time.size(); ++it) {
+            const bool inCore =
+                    time[it] >= coreStarts[iw] &&
+                    (time[it] < coreStarts[iw + 1] ||
+                            (iw == numWindows - 1 && it == time.size() - 1));
+            if (inCore) rows.emplace_back(iw, it);
+        }
+    }
+    const int numRows = (int)rows.size();
+    SimTK::Vector time(numRows);
+    SimTK::Matrix states(numRows, first.getNumStates());
+    SimTK::Matrix controls(numRows, first.getNumControls());
+    SimTK::Matrix multipliers(numRows, first.getNumMultipliers());
+    SimTK::Matrix derivatives(numRows, first.getNumDerivatives());
+    SimTK::Matrix slacks(numRows, (int)first.getSlackNames().size());
+    for (int ir = 0; ir < numRows; ++ir) {
+        const auto& solution = windowSolutions[rows[ir].first];
+        const int it = rows[ir].second;
+        time[ir] = solution.getTime()[it];
+        states.updRow(ir) = solution.getStatesTrajectory().row(it);
+        controls.updRow(ir) = solution.getControlsTrajectory().row(it);
+        multipliers.updRow(ir) = solution.getMultipliersTrajectory().row(it);
+        derivatives.updRow(ir) = solution.getDerivativesTrajectory().row(it);
+        slacks.updRow(ir) = solution.getSlacksTrajectory().row(it);
+    }
+    // Once the windows agree, their parameters are equal (up to the
+    // tolerance); use their average.
+    SimTK::RowVector parameters(first.getNumParameters(), 0.0);
+    for (const auto& windowSolution : windowSolutions) {
+        parameters += windowSolution.getParameters();
+    }
+    parameters *= 1.0 / numWindows;
+    MocoSolution solution(time, first.getStateNames(), first.getControlNames(),
+            first.getMultiplierNames(), first.getDerivativeNames(),
+            first.getParameterNames(), states, controls, multipliers,
+            derivatives, parameters);
+    for (int is = 0; is < slacks.ncol(); ++is) {
+        solution.appendSlack(
+                first.getSlackNames()[is], SimTK::Vector(slacks.col(is)));
+    }
+
+    const bool converged = mismatch <= get_time_window_tolerance();
+    const bool success =
+            converged && std::all_of(windowSucceeded.begin(),
+                                 windowSucceeded.end(), [](bool b) { return b; });
+    // The windows' objectives count the overlaps more than once, so evaluate
+    // the goals on the stitched trajectory instead.
+    const auto objectiveBreakdown =
+            calcObjectiveBreakdown(*createCasOCProblem(1), solution);
+    double objective = 0;
+    for (const auto& term : objectiveBreakdown) objective += term.second;
+    std::string status;
+    if (!converged) {
+        status = fmt::format("Time windows did not converge (boundary "
+                             "mismatch {} after {} iterations).",
+                mismatch, iteration);
+    } else if (!success) {
+        status = "The solver failed for at least one time window.";
+    } else {
+        status = fmt::format(
+                "Time windows converged after {} iterations.", iteration);
+    }
+    const long long elapsed = stopwatch.getElapsedTimeInNs();
+    setSolutionStats(solution, success, objective, status,
+            numSolverIterations, SimTK::nsToSec(elapsed), objectiveBreakdown);
+
+    if (get_verbosity()) {
+        log_info(std::string(72, '-'));
+        log_info("Elapsed real time: {}.", stopwatch.formatNs(elapsed));
+        if (success) {
+            log_info("MocoCasADiSolver succeeded!");
+        } else {
+            log_warn("MocoCasADiSolver did NOT succeed:");
+            log_warn("  {}", status);
+        }
+        log_info(std::string(72, '='));
+    }
+    return solution;
+}
+
+namespace {
+/// The names and columns of `trajectory` whose names are not in `removed`,
+/// with the names in `renamed` replaced.
+MocoTrajectory::NamesAndData<SimTK::Matrix> selectColumns(
+        const std::vector<std::string>& names, const SimTK::Matrix& trajectory,
+        const std::set<std::string>& removed,
+        const std::map<std::string, std::string>& renamed = {}) {
+    MocoTrajectory::NamesAndData<SimTK::Matrix> selected;
+    std::vector<int> columns;
+    for (int i = 0; i < (int)names.size(); ++i) {
+        if (removed.count(names[i])) continue;
+        const auto it = renamed.find(names[i]);
+        selected.first.push_back(it == renamed.end() ? names[i] : it->second);
+        columns.push_back(i);
+    }
+    selected.second.resize(trajectory.nrow(), (int)columns.size());
+    for (int i = 0; i < (int)columns.size(); ++i) {
+        selected.second.updCol(i) = trajectory.col(columns[i]);
+    }
+    return selected;
+}
+} // namespace
+
+bool MocoCasADiSolver::solveReducedProblem(MocoSolution& solution) const {
+    const Stopwatch stopwatch;
+    if (get_compute_sensitivities()) {
+        log_warn("Problem reduction does not support computing "
+                 "sensitivities; solving the original problem.");
+        return false;
+    }
+
+    MocoStudy study;
+    study.set_write_solution("false");
+    MocoProblem& reducedProblem = study.updProblem();
+    MocoProblemRep::ProblemReduction reduction;
+    try {
+        reduction = getProblemRep().createReducedProblem(reducedProblem);
+    } catch (const std::exception& e) {
+        log_warn("Could not reduce the problem; solving the original "
+                 "problem. {}",
+                e.what());
+        return false;
+    }
+    if (reduction.weldedJoints.empty()) {
+        if (get_verbosity()) {
+            log_info("No joints can be welded; solving the original problem.");
+        }
+        return false;
+    }
+
+    std::set<std::string> removedStates;
+    std::set<std::string> removedDerivatives;
+    for (const auto& coord : reduction.removedCoordinates) {
+        removedStates.insert(coord.first + "/value");
+        removedStates.insert(coord.first + "/speed");
+        removedDerivatives.insert(coord.first + "/accel");
+    }
+    const std::set<std::string> removedMultipliers(
+            reduction.removedMultipliers.begin(),
+            reduction.removedMultipliers.end());
+    if (get_verbosity()) {
+        log_info("Problem reduction: welded joints {}, removing {} states and "
+                 "{} Lagrange multipliers.",
+                fmt::join(reduction.weldedJoints, ", "), removedStates.size(),
+                removedMultipliers.size());
+    }
+
+    auto& solver = study.initCasADiSolver();
+    solver = *this;
+    solver.set_reduce_problem(false);
+    const MocoTrajectory& guess = getGuess();
+    if (guess.empty()) {
+        solver.clearGuess();
+    } else {
+        std::map<std::string, MocoTrajectory::NamesAndData<SimTK::Matrix>>
+                variables;
+        variables["states"] = selectColumns(guess.getStateNames(),
+                guess.getStatesTrajectory(), removedStates);
+        variables["controls"] = selectColumns(guess.getControlNames(),
+                guess.getControlsTrajectory(), {});
+        variables["multipliers"] = selectColumns(guess.getMultiplierNames(),
+                guess.getMultipliersTrajectory(), removedMultipliers,
+                reduction.reducedMultiplierNames);
+        variables["derivatives"] = selectColumns(guess.getDerivativeNames(),
+                guess.getDerivativesTrajectory(), removedDerivatives);
+        solver.setGuess(MocoTrajectory(guess.getTime(), variables,
+                {guess.getParameterNames(), guess.getParameters()}));
+    }
+    MocoSolution reduced = study.solve();
+    reduced.unseal();
+
+    // Map the solution back: the welded coordinates keep their fixed values.
+    // The columns are in the order of this problem's variables.
+    const auto casProblem = createCasOCProblem(1);
+    const auto names = casProblem->createIterate();
+    std::map<std::string, double> fixedValues;
+    for (const auto& coord : reduction.removedCoordinates) {
+        fixedValues[coord.first + "/value"] = coord.second;
+        fixedValues[coord.first + "/speed"] = 0;
+        fixedValues[coord.first + "/accel"] = 0;
+    }
+    const int numTimes = reduced.getNumTimes();
+    SimTK::Matrix states(numTimes, (int)names.state_names.size());
+    for (int is = 0; is < (int)names.state_names.size(); ++is) {
+        const auto& name = names.state_names[is];
+        const auto fixed = fixedValues.find(name);
+        if (fixed == fixedValues.end()) {
+            states.updCol(is) = reduced.getState(name);
+        } else {
+            states.updCol(is) = fixed->second;
+        }
+    }
+
+    std::vector<std::string> derivativeNames;
+    if (reduced.getNumDerivatives()) derivativeNames = names.derivative_names;
+    SimTK::Matrix derivatives(numTimes, (int)derivativeNames.size());
+    for (int id = 0; id < (int)derivativeNames.size(); ++id) {
+        const auto& name = derivativeNames[id];
+        const auto fixed = fixedValues.find(name);
+        if (fixed == fixedValues.end()) {
+            derivatives.updCol(id) = reduced.getDerivative(name);
+        } else {
+            derivatives.updCol(id) = fixed->second;
+        }
+    }
+
+    const auto& multiplierNames = names.multiplier_names;
+    SimTK::Matrix multipliers(numTimes, (int)multiplierNames.size());
+    for (int im = 0; im < (int)multiplierNames.size(); ++im) {
+        const auto it =
+                reduction.reducedMultiplierNames.find(multiplierNames[im]);
+        if (it == reduction.reducedMultiplierNames.end()) {
+            multipliers.updCol(im) = SimTK::NaN;
+        } else {
+            multipliers.updCol(im) = reduced.getMultiplier(it->second);
+        }
+    }
+
+    solution = MocoSolution(reduced.getTime(), names.state_names,
+            reduced.getControlNames(), multiplierNames, derivativeNames,
+            reduced.getParameterNames(), states,
+            reduced.getControlsTrajectory(), multipliers, derivatives,
+            reduced.getParameters());
+
+    // The reduced problem's goals do not see the removed states (e.g., a
+    // MocoSumSquaredStateGoal), so evaluate this problem's goals on the
+    // mapped-back trajectory. The multipliers of the removed constraints are
+    // unknown (NaN); terms that depend on constraint forces keep their value
+    // from the reduced problem, whose dynamics are the same.
+    auto objectiveBreakdown = calcObjectiveBreakdown(*casProblem, solution);
+    double objective = 0;
+    for (auto& term : objectiveBreakdown) {
+        if (!std::isfinite(term.second)) {
+            term.second = reduced.getObjectiveTerm(term.first);
+        }
+        objective += term.second;
+    }
+    setSolutionStats(solution, reduced.success(), objective,
+            reduced.getStatus(), reduced.getNumIterations(),
+            SimTK::nsToSec(stopwatch.getElapsedTimeInNs()),
+            objectiveBreakdown);
+    return true;
+}
+
+void MocoCasADiSolver::replayCallbackTrace(
+        const std::string& traceFile, int numThreads) const {
+    OPENSIM_THROW_IF_FRMOBJ(numThreads < 1, Exception,
+            "Expected numThreads to be at least 1, but got {}.", numThreads);
+    const MocoCasOCTrace trace = MocoCasOCTrace::read(traceFile);
+    auto casProblem = createCasOCProblem(numThreads);
+    const auto times = trace.replay(*casProblem, numThreads);
+
+    const auto& records = trace.getRecords();
+    const double duration = SimTK::nsToSec(times.duration);
+    log_info("Replayed {} evaluations from '{}' with {} thread(s) in {}: "
+             "{:.1f} evaluations per second.",
+            records.size(), traceFile, numThreads,
+            Stopwatch::formatNs(times.duration),
+            duration > 0 ? records.size() / duration : 0.0);
+
+    std::vector<std::vector<long long>> latencies(
+            MocoCasOCTrace::NumCallbacks);
+    for (int i = 0; i < (int)records.size(); ++i) {
+        latencies[static_cast<int>(records[i].callback)].push_back(
+                times.latencies[i]);
+    }
+    log_info("{:<30} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9}", "callback (us)",
+            "count", "mean", "p50", "p90", "p99", "max");
+    for (int icb = 0; icb < MocoCasOCTrace::NumCallbacks; ++icb) {
+        auto& values = latencies[icb];
+        if (values.empty()) continue;
+        std::sort(values.begin(), values.end());
+        const int count = (int)values.size();
+        // Nearest-rank percentiles.
+        auto percentile = [&](double p) {
+            const int rank = (int)std::ceil(p * count);
+            return 1e-3 * values[std::max(rank, 1) - 1];
+        };
+        double sum = 0;
+        for (const auto& value : values) sum += value;
+        log_info("{:<30} {:>9} {:>9.1f} {:>9.1f} {:>9.1f} {:>9.1f} {:>9.1f}",
+                MocoCasOCTrace::getCallbackName(
+                        static_cast<MocoCasOCTrace::Callback>(icb)),
+                count, 1e-3 * sum / count, percentile(0.5), percentile(0.9),
+                percentile(0.99), 1e-3 * values.back());
+    }
+}
@@ -62,6 +62,174 @@ class MocoCasOCProblem;
 /// slower than "forward" (tested on exampleSlidingMass). Sometimes, problems
 /// may struggle to converge with "forward".
 ///
+/// The "adaptive" scheme chooses a step size for each input of each function
+/// evaluated with finite differences (e.g., the multibody dynamics), and uses
+/// forward differences for inputs where they are accurate and central
+/// differences only where they are not. The step sizes and schemes are chosen
+/// once, at the first point at which derivatives are needed (typically the
+/// initial guess), by estimating the noise and curvature of the function
+/// along each input; this costs about 9 function evaluations per input.
+/// This scheme requires fewer function evaluations per Jacobian than
+/// "central" while keeping most of its accuracy.
+///
+/// Jacobian reuse
+/// ==============
+/// By default, the finite difference Jacobians of the problem's functions
+/// (e.g., the multibody dynamics at each mesh point) are recomputed at every
+/// iteration, even when the iterate barely changes. If
+/// `optim_jacobian_refresh_interval` is greater than 1, each function keeps
+/// the Jacobians it computed at recently-visited points and, at a nearby
+/// point, corrects the Jacobian with a sparse Broyden update from the
+/// observed change in the function's outputs instead of recomputing it. A
+/// Jacobian is recomputed with finite differences after it has been updated
+/// `optim_jacobian_refresh_interval - 1` times, or sooner if the point moved
+/// too far or the Jacobian predicted the change in the outputs poorly. This
+/// reduces the number of model evaluations per iteration, at the cost of
+/// less accurate derivatives, which may increase the number of iterations.
+/// Jacobian reuse cannot be used with an exact Hessian or with
+/// `compute_sensitivities`.
+///
+/// Automatic scaling
+/// =================
+/// The variables of a MocoProblem have very different magnitudes (e.g.,
+/// joint angles, speeds, activations in [0, 1], and Lagrange multipliers in
+/// the hundreds), as do the defects and path constraints. Badly scaled
+/// problems can take many more iterations to solve. If
+/// `optim_automatic_scaling` is true, each variable is scaled to [0, 1] using
+/// the range of its bounds across the mesh; variables without finite bounds
+/// are scaled by the largest magnitude of the guess. Each constraint (e.g., a
+/// defect) is then divided by the largest magnitude of its gradient with
+/// respect to the scaled variables at the guess, and the objective is scaled
+/// down if its gradient is larger than 1. The same scale factor is used
+/// across the mesh for each variable and constraint. The solution is
+/// unscaled, so scaling is not visible in the results. With IPOPT, this
+/// replaces IPOPT's own gradient-based scaling. Because the scaling depends
+/// on the guess, a poor guess can produce a poor scaling.
+///
+/// Gauss-Newton Hessian
+/// ====================
+/// If `optim_hessian_approximation` is 'gauss-newton', the Hessian of the
+/// objective is approximated from the Jacobians of the residuals of
+/// least-squares goals (e.g., MocoStateTrackingGoal, MocoMarkerTrackingGoal,
+/// and MocoControlGoal with an exponent of 2): for an integral of squared
+/// residuals r, the Hessian is approximated by 2 J^T J, where J is the
+/// Jacobian of r. This approximation requires only first derivatives, is
+/// positive semidefinite, and is accurate near solutions with small
+/// residuals. Goals that are not least-squares contribute their exact
+/// Hessians, and the curvature of the constraints is neglected. This is useful
+/// for tracking problems, for which the limited-memory approximation
+/// converges slowly and the exact Hessian is expensive.
+///
+/// Symbolic muscle dynamics
+/// ========================
+/// By default, muscle forces and muscle activation dynamics are computed
+/// inside the model and differentiated with finite differences along with
+/// the rest of the multibody system. If `symbolic_muscle_dynamics` is true,
+/// the tensions and activation dynamics of DeGrooteFregly2016Muscle%s are
+/// instead expressed symbolically in CasADi, and only the muscle-tendon
+/// lengths, lengthening speeds, and moment arms (generalized forces per unit
+/// tension) are computed from the model. The derivatives of the muscle
+/// equations are then exact. This requires the 'implicit'
+/// multibody_dynamics_mode and a problem without MocoParameter%s (muscle
+/// properties are read when the problem is created). Tendon compliance
+/// (fiber-tendon equilibrium) is not supported: the solver throws an
+/// exception if any DeGrooteFregly2016Muscle that applies force has
+/// ignore_tendon_compliance set to false. Within the solver's model, the muscles do not apply
+/// forces (their actuation is overridden to zero), so goals and constraints
+/// that depend on muscles only through the forces they apply to the
+/// multibody system (e.g., MocoJointReactionGoal) do not see the muscle
+/// forces.
+///
+/// Multiple shooting
+/// =================
+/// In addition to the 'trapezoidal' and 'hermite-simpson' transcription
+/// schemes, this solver supports 'multiple-shooting'. The mesh intervals
+/// become shooting intervals: the multibody system is integrated across each
+/// interval (with a fixed-step Runge-Kutta-Merson integrator taking
+/// `multiple_shooting_integrator_steps` steps), and the integrated states must
+/// match the states at the start of the next interval. Controls are held
+/// constant across each interval at their value at the start of the interval.
+/// The integrations of the intervals are independent and are evaluated in
+/// parallel, and their derivatives are computed with finite differences.
+/// Multiple shooting requires the 'explicit' multibody dynamics mode and does
+/// not support kinematic constraints or components with implicit auxiliary
+/// dynamics. Each integration is far more expensive than a single evaluation
+/// of the dynamics, so this scheme is useful primarily for stiff or
+/// long-duration problems that require fine meshes with collocation.
+///
+/// Sensitivities
+/// =============
+/// If `compute_sensitivities` is true, after a successful solve, the solver
+/// computes the derivatives of the solution with respect to the weight of each
+/// cost goal and with respect to each MocoParameter whose lower and upper
+/// bounds are equal (see MocoSolution::getSensitivityToGoalWeight() and
+/// MocoSolution::predictSolution()). The derivatives come from the optimality
+/// (KKT) conditions at the solution, assuming the active set does not change:
+/// the solver factorizes the KKT matrix once and solves it for all goals and
+/// parameters, which costs about as much as one iteration. The predicted
+/// solutions are useful as fast approximations to the solutions of nearby
+/// problems (e.g., when sweeping goal weights) and as initial guesses for
+/// solving them.
+///
+/// Time windows
+/// ============
+/// The memory required to factorize the KKT matrix of the optimization problem
+/// grows faster than the number of mesh intervals, so long-duration problems
+/// (e.g., tracking many strides) can exhaust the available memory. If
+/// `num_time_windows` is greater than 1, the time horizon is split into
+/// windows with equal-duration cores, and each window extends into its
+/// neighbors' cores by `time_window_overlap`. The windows are solved as
+/// separate problems with proportionally fewer mesh intervals: the states at
+/// the start of a window are fixed to the latest solution of the preceding
+/// window, and the states at the end of a window are fixed to the latest
+/// solution of the following window (after the first pass). Passes over the
+/// windows are repeated until the states of neighboring windows agree at the
+/// boundaries between cores (`time_window_tolerance`), and the solution is
+/// formed from the cores of the windows. `time_window_concurrency` windows
+/// are solved at the same time, sharing the solver's threads. This requires
+/// fixed initial and final times and a uniform mesh. Every goal must be a cost
+/// that integrates over the phase and does not otherwise depend on the
+/// initial or final state (e.g., is not divided by the displacement);
+/// endpoint constraints are not supported. Each window solves for the
+/// MocoParameter%s, and the windows must also agree on their values. The
+/// reported objective is evaluated on the stitched solution, with integrals
+/// computed by the trapezoidal rule. Each window writes its own diagnostic
+/// files: `_window<index>` is appended to the `callback_trace_file` (before
+/// its extension) and to the `optim_write_sparsity` prefix, and
+/// `output_interval` is ignored.
+///
+/// Problem reduction
+/// =================
+/// Models often lock coordinates (or prescribe them with a Constant function)
+/// to hold joints fixed, but the optimization problem still contains the
+/// states of these coordinates, the constraints that fix them, and the
+/// constraints' Lagrange multipliers. If `reduce_problem` is true, joints
+/// whose coordinates are all fixed this way are replaced with WeldJoint%s at
+/// the fixed pose (see MocoProblemRep::createReducedProblem()), the smaller
+/// problem is solved, and its solution is mapped back to the original
+/// problem: the states of the welded coordinates are constant, their
+/// accelerations are zero, and the Lagrange multipliers of the removed
+/// constraints are NaN, as the reduced problem does not solve for the loads
+/// that hold the welded joints. The objective is that of the original
+/// problem's goals evaluated on the mapped-back solution (with the
+/// trapezoidal rule); goals that depend on the missing constraint loads keep
+/// their value from the reduced problem. The solution does not contain slack
+/// variables. If the problem cannot be reduced (e.g., a goal refers to a
+/// welded coordinate), the original problem is solved.
+///
+/// Callback traces
+/// ===============
+/// To benchmark changes to model components or to threading without running
+/// the optimizer, set `callback_trace_file` to record the inputs of every
+/// evaluation of the multibody system, path geometry, integrands, and path
+/// constraints during a solve (see MocoCasOCTrace). Endpoint goals and
+/// constraints, and the interval integration of multiple shooting, are not
+/// recorded. Then, evaluate the same inputs again with replayCallbackTrace()
+/// (or `opensim-moco replay`), which reports the throughput and the
+/// distribution of the time per evaluation for each callback. Traces are
+/// large: each evaluation stores all of the continuous variables. With time
+/// windows, each window writes its own trace (see Time windows).
+///
 /// Parallelization
 /// ===============
 /// By default, CasADi evaluate the integral cost integrand and the
@@ -82,6 +250,26 @@ class MocoCasOCProblem;
 /// the solving of your multiple problems using your system (e.g., invoke the
 /// opensim-moco command-line tool in multiple Terminals or Command Prompts).
 ///
+/// By default, each thread uses its own copy of the model, so memory usage
+/// and the time to set up the problem grow with the number of threads. For
+/// problems without MocoParameter%s, the model is not modified while solving,
+/// and you can set the `share_model_across_threads` property to true so that
+/// all threads use a single copy of the model and each thread has only its
+/// own SimTK::State objects. This requires that the model's components do not
+/// store intermediate results outside of the SimTK::State. MocoOutputGoal is
+/// not supported in this mode, as an Output stores its value in the Output
+/// itself.
+///
+/// On machines with multiple NUMA nodes (e.g., multiple sockets), accessing
+/// memory on another node is slower than accessing memory on the local node.
+/// If you set the `numa_aware_parallelism` property to true, the models and
+/// states used by the threads are distributed evenly across the NUMA nodes,
+/// and each of CasADi's worker threads is pinned to the node on which it first
+/// evaluates the problem and uses a model and state on that node. This works
+/// with `share_model_across_threads`, in which case each node has its own copy
+/// of the model. This is currently only supported on Linux, and has no effect
+/// on machines with a single NUMA node.
+///
 /// Note that the `parallel` property overrides the environment variable,
 /// allowing more granular control over parallelization. However, the
 /// parallelization setting does not logically belong as a property, as it does
@@ -127,7 +315,19 @@ public:
             "empty (default) to not write such files.");
     OpenSim_DECLARE_PROPERTY(optim_finite_difference_scheme, std::string,
             "The finite difference scheme CasADi will use to calculate problem "
-            "derivatives (default: 'central').");
+            "derivatives: 'central' (default), 'forward', 'backward', or "
+            "'adaptive'. With 'adaptive', the perturbed evaluations of "
+            "endpoint goals are not spread across threads.");
+    OpenSim_DECLARE_PROPERTY(optim_automatic_scaling, bool,
+            "Scale the variables using their bounds (or the guess), and the "
+            "constraints and objective using their gradients at the guess, "
+            "before passing the problem to the optimization solver "
+            "(default: false).");
+    OpenSim_DECLARE_PROPERTY(optim_jacobian_refresh_interval, int,
+            "Recompute the finite difference Jacobian of each function at a "
+            "point at least every this many evaluations, and update it with "
+            "sparse Broyden corrections in between; 1 (default) recomputes "
+            "the Jacobians at every evaluation.");
 
     OpenSim_DECLARE_OPTIONAL_PROPERTY(parallel, int,
             "Evaluate integral costs and the differential-algebraic "
@@ -135,11 +335,59 @@ public:
             "0: not parallel; 1: use all cores (default); greater than 1: use"
             "this number of threads. This overrides the OPENSIM_MOCO_PARALLEL "
             "environment variable.");
+    OpenSim_DECLARE_PROPERTY(share_model_across_threads, bool,
+            "If evaluating in parallel, use a single copy of the model for "
+            "all threads, each with its own SimTK::State objects; requires a "
+            "problem without MocoParameters (default: false).");
+    OpenSim_DECLARE_PROPERTY(numa_aware_parallelism, bool,
+            "If evaluating in parallel on a machine with multiple NUMA nodes, "
+            "allocate the model copies and states for the threads on each "
+            "node and pin the threads to their nodes; ignored on machines "
+            "with a single node (default: false).");
+    OpenSim_DECLARE_PROPERTY(symbolic_muscle_dynamics, bool,
+            "Express the tension and activation dynamics of "
+            "DeGrooteFregly2016Muscles symbolically so that their derivatives "
+            "are exact; requires implicit multibody dynamics. Tendon "
+            "compliance is not supported: all DeGrooteFregly2016Muscles must "
+            "have ignore_tendon_compliance set to true (default: false).");
+    OpenSim_DECLARE_PROPERTY(multiple_shooting_integrator_steps, int,
+            "If the transcription scheme is 'multiple-shooting', the number "
+            "of fixed integrator steps taken across each mesh interval "
+            "(default: 10).");
+    OpenSim_DECLARE_PROPERTY(compute_sensitivities, bool,
+            "After solving, compute the derivatives of the solution with "
+            "respect to the weights of the cost goals and the values of the "
+            "fixed parameters (default: false).");
+    OpenSim_DECLARE_PROPERTY(num_time_windows, int,
+            "Split the time horizon into this number of overlapping windows "
+            "and solve them separately to bound memory usage; 1 (default) "
+            "solves the whole horizon at once.");
+    OpenSim_DECLARE_PROPERTY(time_window_overlap, double,
+            "The overlap between neighboring time windows, as a fraction of "
+            "the duration of a window's core, in (0, 0.5] (default: 0.25).");
+    OpenSim_DECLARE_PROPERTY(time_window_concurrency, int,
+            "The number of time windows to solve at the same time (default: "
+            "1). Peak memory usage grows with this number.");
+    OpenSim_DECLARE_PROPERTY(time_window_max_iterations, int,
+            "The maximum number of passes over the time windows (default: "
+            "5).");
+    OpenSim_DECLARE_PROPERTY(time_window_tolerance, double,
+            "Time windows have converged when the states of neighboring "
+            "windows differ by at most this amount at the boundaries between "
+            "windows (default: 1e-3).");
+    OpenSim_DECLARE_PROPERTY(reduce_problem, bool,
+            "Replace joints whose coordinates are all locked or prescribed "
+            "with a Constant function with WeldJoints before solving, and map "
+            "the solution back to the original problem (default: false).");
     OpenSim_DECLARE_PROPERTY(output_interval, int,
             "Write intermediate trajectories to file. 0, the default, "
             "indicates no intermediate trajectories are saved, 1 indicates "
             "each iteration is saved, 5 indicates every fifth iteration is "
             "saved, etc.");
+    OpenSim_DECLARE_PROPERTY(callback_trace_file, std::string,
+            "Record the inputs of the evaluations of the problem's continuous "
+            "functions during the solve to this binary file, for use with "
+            "replayCallbackTrace(); empty (default) to not record.");
 
     OpenSim_DECLARE_PROPERTY(minimize_implicit_multibody_accelerations, bool,
             "Minimize the integral of the squared acceleration continuous "
@@ -171,6 +419,12 @@ public:
     /// - **random**: values are randomly generated within the bounds.
     /// - **time-stepping**: see MocoSolver::createGuessTimeStepping().
     ///   NOTE: This option does not yet work well for this solver.
+    /// - **equilibrium**: starts from the **bounds** guess, then fills in
+    ///   speeds from splined coordinate values, steady-state activations,
+    ///   equilibrium fiber lengths (or tendon forces), and consistent Lagrange
+    ///   multipliers; see MocoSolver::createGuessEquilibrium(). This guess
+    ///   often reduces the number of iterations for muscle-driven problems
+    ///   solved without a guess.
     /// @note Calling this method does *not* set an initial guess to be used
     /// in the solver; you must call setGuess() or setGuessFile() for that.
     /// @precondition You must have called resetProblem().
@@ -203,6 +457,15 @@ public:
 
     /// @}
 
+    /// Evaluate the callbacks recorded in the trace file (see
+    /// `callback_trace_file`) with this solver's problem, which must be the
+    /// problem that recorded the trace, distributing the evaluations across
+    /// numThreads threads. This logs the throughput and, for each callback,
+    /// the distribution of the time per evaluation.
+    /// @precondition You must have called resetProblem().
+    void replayCallbackTrace(
+            const std::string& traceFile, int numThreads = 1) const;
+
     /// @cond
     /// This is used to generate a warning.
     void setRunningInPython(bool value) const { m_runningInPython = value; }
@@ -211,7 +474,24 @@ public:
 protected:
     MocoSolution solveImpl() const override;
 
+    /// The number of threads to use, based on the `parallel` property and
+    /// the OPENSIM_MOCO_PARALLEL environment variable.
+    int getNumThreads() const;
+    /// Solve the problem with time windows (see num_time_windows).
+    MocoSolution solveTimeWindows() const;
+    /// Solve the problem with fixed joints welded (see reduce_problem). This
+    /// returns false, without solving, if no joint can be welded or if the
+    /// problem cannot be reduced.
+    bool solveReducedProblem(MocoSolution& solution) const;
+
     std::unique_ptr<MocoCasOCProblem> createCasOCProblem() const;
+    /// Create a problem with a MocoProblemRep for each of numThreads threads.
+    std::unique_ptr<MocoCasOCProblem> createCasOCProblem(int numThreads) const;
+    /// Same as above, but distribute the MocoProblemReps across the NUMA
+    /// nodes with the given CPUs (see getNUMANodeCPUs()), regardless of the
+    /// `numa_aware_parallelism` property.
+    std::unique_ptr<MocoCasOCProblem> createCasOCProblem(int numThreads,
+            std::vector<std::vector<int>> numaNodeCPUs) const;
     std::unique_ptr<CasOC::Solver> createCasOCSolver(
             const MocoCasOCProblem&) const;
 
@@ -18,8 +18,12 @@
 
 #include "MocoCasOCProblem.h"
 
+#include "../MocoControlBoundConstraint.h"
 #include "MocoCasADiSolver.h"
 
+#include <OpenSim/Common/Constant.h>
+#include <OpenSim/Common/LinearFunction.h>
+
 using namespace OpenSim;
 
 thread_local SimTK::Vector_<SimTK::SpatialVec>
@@ -30,13 +34,34 @@ thread_local SimTK::Vector MocoCasOCProblem::m_pvaerr;
 MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
         const MocoProblemRep& problemRep,
         std::unique_ptr<ThreadsafeJar<const MocoProblemRep>> jar,
-        std::string dynamicsMode)
+        std::string dynamicsMode,
+        std::vector<std::vector<int>> numaNodeCPUs)
         : m_jar(std::move(jar)),
           m_paramsRequireInitSystem(
                   mocoCasADiSolver.get_parameters_require_initsystem()),
+          m_multipleShootingIntegratorSteps(
+                  mocoCasADiSolver.get_multiple_shooting_integrator_steps()),
+          m_shareModel(mocoCasADiSolver.get_share_model_across_threads()),
+          m_numaNodeCPUs(std::move(numaNodeCPUs)),
+          m_mainThreadId(std::this_thread::get_id()),
           m_formattedTimeString(getMocoFormattedDateTime(true)) {
 
     setDynamicsMode(dynamicsMode);
+    // Record the node on which MocoSolver::createProblemRepJar() placed each
+    // MocoProblemRep.
+    if (m_numaNodeCPUs.size() > 1) {
+        std::vector<std::pair<std::unique_ptr<const MocoProblemRep>, int>>
+                reps;
+        while (m_jar->size()) {
+            int node;
+            auto rep = m_jar->take(0, node);
+            reps.emplace_back(std::move(rep), node);
+        }
+        for (auto& rep : reps) {
+            m_repNodes[rep.first.get()] = rep.second;
+            m_jar->leave(std::move(rep.first), rep.second);
+        }
+    }
     const auto& model = problemRep.getModelBase();
 
     // Ensure the model does not have user-provided controllers.
@@ -55,8 +80,9 @@ MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
         setPrescribedKinematics(true, model.getWorkingState().getNU());
     }
 
+    std::unordered_map<int, int> yIndexMap;
     auto stateNames =
-            problemRep.createStateVariableNamesInSystemOrder(m_yIndexMap);
+            problemRep.createStateVariableNamesInSystemOrder(yIndexMap);
     setTimeBounds(convertBounds(problemRep.getTimeInitialBounds()),
             convertBounds(problemRep.getTimeFinalBounds()));
     for (const auto& stateName : stateNames) {
@@ -72,6 +98,12 @@ MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
                 convertBounds(info.getInitialBounds()),
                 convertBounds(info.getFinalBounds()));
     }
+    for (int isv = 0; isv < getNumCoordinates(); ++isv) {
+        m_coordinateYIndices.push_back(yIndexMap.at(isv));
+        if (m_coordinateYIndices.back() != isv) {
+            m_coordinateYIndicesAreContiguous = false;
+        }
+    }
 
     auto controlNames =
             createControlNamesFromModel(model, m_modelControlIndices);
@@ -224,7 +256,9 @@ MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
         const auto costNames = problemRep.createCostNames();
         for (const auto& name : costNames) {
             const auto& cost = problemRep.getCost(name);
-            addCost(name, cost.getNumIntegrals(), cost.getNumOutputs());
+            addCost(name, cost.getNumIntegrals(), cost.getNumOutputs(),
+                    cost.getNumIntegrandResiduals(),
+                    cost.getResidualCostScale());
         }
     }
     {
@@ -247,10 +281,180 @@ MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
         for (const auto& bounds : pathCon.getConstraintInfo().getBounds()) {
             casBounds.push_back(convertBounds(bounds));
         }
-        addPathConstraint(name, casBounds);
+        auto symbolic = createSymbolicPathConstraint(pathCon, controlNames);
+        if (symbolic.is_null()) {
+            addPathConstraint(name, casBounds);
+        } else {
+            addPathConstraint(name, casBounds, std::move(symbolic));
+        }
+    }
+
+    if (mocoCasADiSolver.get_symbolic_muscle_dynamics()) {
+        setSymbolicMuscleDynamics(problemRep, stateNames, controlNames);
+    }
+
+    m_applyOnlyChangedInputs =
+            getNumParameters() == 0 || m_paramsRequireInitSystem;
+
+    // Select the callbacks specialized for the shape of this problem.
+    if (getNumAuxiliaryResidualEquations() ||
+            !m_coordinateYIndicesAreContiguous) {
+        setCallbackShape<GeneralShape>();
+    } else if (getNumMultipliers()) {
+        setCallbackShape<ConstrainedShape>();
+    } else if (getNumAccelerations()) {
+        setCallbackShape<UnconstrainedImplicitShape>();
+    } else {
+        setCallbackShape<UnconstrainedExplicitShape>();
     }
 
     m_fileDeletionThrower = OpenSim::make_unique<FileDeletionThrower>(
             fmt::format("delete_this_to_stop_optimization_{}_{}.txt",
                     problemRep.getName(), m_formattedTimeString));
 }
+
+casadi::Function MocoCasOCProblem::createSymbolicPathConstraint(
+        const MocoPathConstraint& pathCon,
+        const std::vector<std::string>& controlNames) const {
+    // Currently, only MocoControlBoundConstraints with constant or linear
+    // bounds depend on nothing more than time and controls.
+    const auto* controlBound =
+            dynamic_cast<const MocoControlBoundConstraint*>(&pathCon);
+    if (!controlBound || !pathCon.getConstraintInfo().getNumEquations()) {
+        return {};
+    }
+    using casadi::SX;
+    const SX time = SX::sym("time");
+    const SX controls = SX::sym("controls", getNumControls());
+    auto calcBound = [&time](const Function& function, SX& bound) -> bool {
+        if (dynamic_cast<const Constant*>(&function)) {
+            bound = function.calcValue(SimTK::Vector(1, 0.0));
+            return true;
+        }
+        if (const auto* linear =
+                        dynamic_cast<const LinearFunction*>(&function)) {
+            bound = linear->getSlope() * time + linear->getIntercept();
+            return true;
+        }
+        return false;
+    };
+    SX lower;
+    SX upper;
+    if (controlBound->hasLowerBound() &&
+            !calcBound(controlBound->getLowerBound(), lower)) {
+        return {};
+    }
+    if (controlBound->hasUpperBound() &&
+            !calcBound(controlBound->getUpperBound(), upper)) {
+        return {};
+    }
+
+    // The errors are ordered as in
+    // MocoControlBoundConstraint::calcPathConstraintErrorsImpl().
+    std::vector<SX> errors;
+    for (const auto& path : controlBound->getControlPaths()) {
+        auto it = std::find(controlNames.begin(), controlNames.end(), path);
+        if (it == controlNames.end()) return {};
+        const SX control = controls(int(it - controlNames.begin()));
+        if (controlBound->hasLowerBound()) errors.push_back(control - lower);
+        if (controlBound->hasUpperBound()) errors.push_back(control - upper);
+    }
+    return casadi::Function("path_constraint_" + pathCon.getName(),
+            {time, controls}, {SX::vertcat(errors)}, {"time", "controls"},
+            {"errors"});
+}
+
+void MocoCasOCProblem::setSymbolicMuscleDynamics(
+        const MocoProblemRep& problemRep,
+        const std::vector<std::string>& stateNames,
+        const std::vector<std::string>& controlNames) {
+    OPENSIM_THROW_IF(!isDynamicsModeImplicit(), Exception,
+            "Symbolic muscle dynamics requires implicit dynamics mode.");
+    OPENSIM_THROW_IF(getNumParameters(), Exception,
+            "Symbolic muscle dynamics is not supported with MocoParameters.");
+
+    // Auxiliary states are ordered as in the system's Z vector.
+    std::vector<std::string> auxStateNames;
+    for (int is = getNumCoordinates() + getNumSpeeds();
+            is < (int)stateNames.size(); ++is) {
+        auxStateNames.push_back(stateNames[is]);
+    }
+    auto indexOf = [](const std::vector<std::string>& names,
+                           const std::string& name) {
+        auto it = std::find(names.begin(), names.end(), name);
+        return it == names.end() ? -1 : (int)(it - names.begin());
+    };
+
+    using casadi::SX;
+    const SX auxStates = SX::sym("auxiliary_states", getNumAuxiliaryStates());
+    const SX controls = SX::sym("controls", getNumControls());
+    std::vector<const DeGrooteFregly2016Muscle*> muscles;
+    for (const auto& muscle : problemRep.getModelDisabledConstraints()
+                                      .getComponentList<
+                                              DeGrooteFregly2016Muscle>()) {
+        // MocoCasADiSolver rejects muscles with compliant tendons.
+        if (!muscle.get_appliesForce()) continue;
+        muscles.push_back(&muscle);
+    }
+    const int numMuscles = (int)muscles.size();
+    const SX lengths = SX::sym("lengths", numMuscles);
+    const SX speeds = SX::sym("lengthening_speeds", numMuscles);
+    std::vector<SX> tensions;
+    std::vector<SX> activationDerivatives;
+    std::vector<int> activationIndices;
+    for (int im = 0; im < numMuscles; ++im) {
+        const auto& muscle = *muscles[im];
+        const auto path = muscle.getAbsolutePathString();
+        const int controlIndex = indexOf(controlNames, path);
+        OPENSIM_THROW_IF(controlIndex == -1, Exception,
+                "Could not find the control for muscle '{}'.", path);
+        const SX excitation = controls(controlIndex);
+        SX activation = excitation;
+        if (!muscle.get_ignore_activation_dynamics()) {
+            const int zIndex = indexOf(auxStateNames,
+                    path + "/" +
+                            DeGrooteFregly2016Muscle::getActivationStateName());
+            OPENSIM_THROW_IF(zIndex == -1, Exception,
+                    "Could not find the activation state for muscle '{}'.",
+                    path);
+            activation = auxStates(zIndex);
+            activationDerivatives.push_back(
+                    muscle.calcActivationDerivative(excitation, activation));
+            activationIndices.push_back(zIndex);
+        }
+        tensions.push_back(muscle.calcRigidTendonTension(
+                activation, SX(lengths(im)), SX(speeds(im))));
+        m_symbolicMusclePaths.push_back(path);
+    }
+    if (!numMuscles) return;
+
+    casadi::Function dynamics("symbolic_muscle_dynamics",
+            {auxStates, controls, lengths, speeds},
+            {SX::vertcat(tensions), SX::vertcat(activationDerivatives)},
+            {"auxiliary_states", "controls", "lengths", "lengthening_speeds"},
+            {"tensions", "auxiliary_derivatives"});
+    setSymbolicActuators(numMuscles, dynamics, activationIndices);
+
+    // In every copy of the model used by the callbacks, override the muscles'
+    // actuation to zero so that the multibody system excludes the muscle
+    // forces; these are added symbolically by the transcription.
+    std::vector<std::unique_ptr<const MocoProblemRep>> reps;
+    while (m_jar->size()) reps.push_back(m_jar->take());
+    for (const auto& rep : reps) {
+        const auto& model = rep->getModelDisabledConstraints();
+        auto& repMuscles = m_symbolicMuscles[rep.get()];
+        for (const auto& path : m_symbolicMusclePaths) {
+            repMuscles.push_back(
+                    &model.getComponent<DeGrooteFregly2016Muscle>(path));
+        }
+        for (int istate = 0; istate < 2; ++istate) {
+            auto& state = rep->updStateDisabledConstraints(istate);
+            for (const auto* muscle : repMuscles) {
+                muscle->overrideActuation(state, true);
+                muscle->setOverrideActuation(state, 0);
+            }
+            model.getSystem().realizeModel(state);
+        }
+    }
+    for (auto& rep : reps) leaveProblemRep(std::move(rep));
+}
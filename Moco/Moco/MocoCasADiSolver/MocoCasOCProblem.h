@@ -19,12 +19,18 @@
  * -------------------------------------------------------------------------- */
 
 #include "../Components/AccelerationMotion.h"
+#include "../Components/DeGrooteFregly2016Muscle.h"
 #include "../Components/DiscreteController.h"
 #include "../Components/DiscreteForces.h"
 #include "../MocoBounds.h"
 #include "../MocoProblemRep.h"
 #include "CasOCProblem.h"
 #include "MocoCasADiSolver.h"
+#include "MocoCasOCTrace.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
 
 namespace OpenSim {
 
@@ -40,13 +46,57 @@ inline CasOC::Bounds convertBounds(const MocoFinalBounds& mb) {
     return {mb.getLower(), mb.getUpper()};
 }
 
+namespace detail {
+/// Transpose the column-major `nrow` x `ncol` matrix `in` into the
+/// column-major `ncol` x `nrow` matrix `out`. The matrix is processed in
+/// square blocks so that both the reads and the writes stay within cache;
+/// trajectories are tall and narrow (or short and wide), and a naive
+/// transpose would touch a new cache line for nearly every element.
+inline void transposeBlocked(
+        const double* in, int nrow, int ncol, double* out) {
+    constexpr int blockSize = 32;
+    for (int jb = 0; jb < ncol; jb += blockSize) {
+        const int jend = std::min(jb + blockSize, ncol);
+        for (int ib = 0; ib < nrow; ib += blockSize) {
+            const int iend = std::min(ib + blockSize, nrow);
+            for (int j = jb; j < jend; ++j) {
+                for (int i = ib; i < iend; ++i) {
+                    out[j + (size_t)i * ncol] = in[i + (size_t)j * nrow];
+                }
+            }
+        }
+    }
+}
+/// Does the matrix store its elements contiguously in column-major order?
+/// This holds for any matrix SimTK allocates itself, but not necessarily for
+/// views (e.g., transposed or strided blocks).
+inline bool isContiguousColumnMajor(const SimTK::Matrix& m) {
+    if (!m.hasContiguousData()) return false;
+    if (m.nrow() <= 1 || m.ncol() <= 1) return true;
+    return &m(1, 0) == &m(0, 0) + 1 && &m(0, 1) == &m(0, 0) + m.nrow();
+}
+/// Returns `dm` if it is dense, and a dense copy otherwise, so that the
+/// data can be accessed contiguously (column-major) through ptr().
+inline casadi::DM densified(const casadi::DM& dm) {
+    return dm.is_dense() ? dm : casadi::DM::densify(dm);
+}
+} // namespace detail
+
 /// This converts a SimTK::Matrix to a casadi::DM matrix, transposing the
 /// data in the process.
 inline casadi::DM convertToCasADiDMTranspose(const SimTK::Matrix& simtkMatrix) {
-    casadi::DM out(simtkMatrix.ncol(), simtkMatrix.nrow());
-    for (int irow = 0; irow < simtkMatrix.nrow(); ++irow) {
+    casadi::DM out(casadi::Sparsity::dense(simtkMatrix.ncol(),
+            simtkMatrix.nrow()));
+    if (detail::isContiguousColumnMajor(simtkMatrix)) {
+        detail::transposeBlocked(simtkMatrix.getContiguousScalarData(),
+                simtkMatrix.nrow(), simtkMatrix.ncol(), out.ptr());
+    } else {
+        double* outData = out.ptr();
         for (int icol = 0; icol < simtkMatrix.ncol(); ++icol) {
-            out(icol, irow) = simtkMatrix(irow, icol);
+            for (int irow = 0; irow < simtkMatrix.nrow(); ++irow) {
+                outData[icol + (size_t)irow * simtkMatrix.ncol()] =
+                        simtkMatrix(irow, icol);
+            }
         }
     }
     return out;
@@ -54,7 +104,11 @@ inline casadi::DM convertToCasADiDMTranspose(const SimTK::Matrix& simtkMatrix) {
 
 template <typename T> casadi::DM convertToCasADiDMTemplate(const T& simtk) {
     casadi::DM out(casadi::Sparsity::dense(simtk.size(), 1));
-    std::copy_n(simtk.getContiguousScalarData(), simtk.size(), out.ptr());
+    if (simtk.hasContiguousData()) {
+        std::copy_n(simtk.getContiguousScalarData(), simtk.size(), out.ptr());
+    } else {
+        for (int i = 0; i < simtk.size(); ++i) out.ptr()[i] = simtk[i];
+    }
     return out;
 }
 /// This converts a SimTK::RowVector to a casadi::DM column vector.
@@ -105,21 +159,21 @@ VectorType convertToSimTKVector(const casadi::DM& casVector) {
             Exception,
             "casVector should be 1-dimensional, but has size {} x {}.",
             casVector.rows(), casVector.columns());
-    VectorType simtkVector((int)casVector.numel());
-    for (int i = 0; i < casVector.numel(); ++i) {
-        simtkVector[i] = double(casVector(i));
-    }
+    const casadi::DM dense = detail::densified(casVector);
+    VectorType simtkVector((int)dense.numel());
+    std::copy_n(dense.ptr(), dense.numel(),
+            simtkVector.updContiguousScalarData());
     return simtkVector;
 }
 
 /// This converts a casadi::DM matrix to a
 /// SimTK::Matrix, transposing the data in the process.
 inline SimTK::Matrix convertToSimTKMatrix(const casadi::DM& casMatrix) {
-    SimTK::Matrix simtkMatrix((int)casMatrix.columns(), (int)casMatrix.rows());
-    for (int irow = 0; irow < casMatrix.rows(); ++irow) {
-        for (int icol = 0; icol < casMatrix.columns(); ++icol) {
-            simtkMatrix(icol, irow) = double(casMatrix(irow, icol));
-        }
+    const casadi::DM dense = detail::densified(casMatrix);
+    SimTK::Matrix simtkMatrix((int)dense.columns(), (int)dense.rows());
+    if (simtkMatrix.nelt()) {
+        detail::transposeBlocked(dense.ptr(), (int)dense.rows(),
+                (int)dense.columns(), simtkMatrix.updContiguousScalarData());
     }
     return simtkMatrix;
 }
@@ -195,15 +249,96 @@ public:
     MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
             const MocoProblemRep& mocoProblemRep,
             std::unique_ptr<ThreadsafeJar<const MocoProblemRep>> jar,
-            std::string dynamicsMode);
+            std::string dynamicsMode,
+            std::vector<std::vector<int>> numaNodeCPUs = {});
 
     int getJarSize() const { return (int)m_jar->size(); }
+    /// The index of the NUMA node on which `rep` (one of the MocoProblemReps
+    /// in the jar) was placed when the jar was created, or 0 if the reps were
+    /// not placed on NUMA nodes.
+    int getProblemRepNode(const MocoProblemRep& rep) const {
+        const auto it = m_repNodes.find(&rep);
+        return it == m_repNodes.end() ? 0 : it->second;
+    }
+    /// The MocoProblemReps in the jar, for work outside of the callbacks (e.g.,
+    /// MocoSolver::createGuessEquilibrium()). The jar keeps ownership. This
+    /// must not be called while the callbacks are running, and the reps must
+    /// not be used once the callbacks run again.
+    std::vector<const MocoProblemRep*> getProblemReps() const {
+        std::vector<std::unique_ptr<const MocoProblemRep>> reps;
+        while (m_jar->size()) reps.push_back(m_jar->take());
+        std::vector<const MocoProblemRep*> pointers;
+        for (const auto& rep : reps) pointers.push_back(rep.get());
+        for (auto& rep : reps) leaveProblemRep(std::move(rep));
+        return pointers;
+    }
+    /// The models used by the callbacks: the models of each MocoProblemRep in
+    /// the jar. A model appears more than once if the MocoProblemReps share
+    /// models. This must not be called while the callbacks are running.
+    std::vector<const Model*> getModels() const {
+        std::vector<std::unique_ptr<const MocoProblemRep>> reps;
+        while (m_jar->size()) reps.push_back(m_jar->take());
+        std::vector<const Model*> models;
+        for (const auto& rep : reps) {
+            models.push_back(&rep->getModelBase());
+            models.push_back(&rep->getModelDisabledConstraints());
+        }
+        for (auto& rep : reps) leaveProblemRep(std::move(rep));
+        return models;
+    }
+    /// Record the inputs of the continuous callbacks to the given file from
+    /// now on (see MocoCasOCTrace).
+    void recordCallbackTrace(const std::string& fileName) {
+        m_traceWriter =
+                OpenSim::make_unique<MocoCasOCTraceWriter>(fileName, *this);
+    }
 
 private:
+    /// The callbacks below are instantiated for a few common problem shapes
+    /// so that these shapes do not pay, on every call, for branches on
+    /// variables that they do not have. A false flag means the feature is
+    /// known to be absent and its code is omitted from the instantiation; a
+    /// true flag means the feature may be present and is checked at run time.
+    /// The shape is selected once in the constructor (see setCallbackShape()).
+    /// - Multipliers: Lagrange multipliers for kinematic constraints.
+    /// - Accelerations: udot from the optimizer (implicit multibody dynamics
+    ///   without prescribed kinematics).
+    /// - AuxiliaryResiduals: auxiliary dynamics in implicit form.
+    /// - CoordinateGaps: slots in Simbody's Q vector without a coordinate
+    ///   (e.g., from quaternions), requiring the coordinates to be scattered.
+    template <bool Multipliers, bool Accelerations, bool AuxiliaryResiduals,
+            bool CoordinateGaps>
+    struct CallbackShape {
+        static constexpr bool multipliers = Multipliers;
+        static constexpr bool accelerations = Accelerations;
+        static constexpr bool auxiliaryResiduals = AuxiliaryResiduals;
+        static constexpr bool coordinateGaps = CoordinateGaps;
+    };
+    using GeneralShape = CallbackShape<true, true, true, true>;
+    /// Explicit multibody dynamics, or prescribed kinematics.
+    using UnconstrainedExplicitShape =
+            CallbackShape<false, false, false, false>;
+    using UnconstrainedImplicitShape = CallbackShape<false, true, false, false>;
+    using ConstrainedShape = CallbackShape<true, true, false, false>;
+
     void calcMultibodySystemExplicit(const ContinuousInput& input,
             bool calcKCErrors,
             MultibodySystemExplicitOutput& output) const override {
-        auto mocoProblemRep = m_jar->take();
+        recordCallback(MocoCasOCTrace::Callback::MultibodySystemExplicit,
+                calcKCErrors, input);
+        (this->*m_calcMultibodySystemExplicit)(input, calcKCErrors, output);
+    }
+    void calcMultibodySystemImplicit(const ContinuousInput& input,
+            bool calcKCErrors,
+            MultibodySystemImplicitOutput& output) const override {
+        recordCallback(MocoCasOCTrace::Callback::MultibodySystemImplicit,
+                calcKCErrors, input);
+        (this->*m_calcMultibodySystemImplicit)(input, calcKCErrors, output);
+    }
+    template <typename Shape>
+    void calcMultibodySystemExplicitImpl(const ContinuousInput& input,
+            bool calcKCErrors, MultibodySystemExplicitOutput& output) const {
+        auto mocoProblemRep = takeProblemRep();
 
         const auto& modelBase = mocoProblemRep->getModelBase();
         auto& simtkStateBase = mocoProblemRep->updStateBase();
@@ -213,18 +348,18 @@ private:
         auto& simtkStateDisabledConstraints =
                 mocoProblemRep->updStateDisabledConstraints();
 
-        applyInput(SimTK::Stage::Acceleration, input.time, input.states,
-                input.controls, input.multipliers, input.derivatives,
-                input.parameters, mocoProblemRep);
+        applyInputImpl<Shape>(SimTK::Stage::Acceleration, input.time,
+                input.states, input.controls, input.multipliers,
+                input.derivatives, input.parameters, mocoProblemRep);
 
         // Compute the accelerations.
         modelDisabledConstraints.realizeAcceleration(
                 simtkStateDisabledConstraints);
 
         // Compute kinematic constraint errors if they exist.
-        if (getNumMultipliers() && calcKCErrors) {
+        if (Shape::multipliers && getNumMultipliers() && calcKCErrors) {
             calcKinematicConstraintErrors(modelBase, simtkStateBase,
-                    simtkStateDisabledConstraints,
+                    simtkStateDisabledConstraints.getUDot(),
                     output.kinematic_constraint_errors);
         }
 
@@ -237,15 +372,17 @@ private:
                 output.auxiliary_derivatives.ptr());
 
         // Copy auxiliary residuals to output.
-        copyImplicitResidualsToOutput(*mocoProblemRep,
-                simtkStateDisabledConstraints, output.auxiliary_residuals);
+        if (Shape::auxiliaryResiduals) {
+            copyImplicitResidualsToOutput(*mocoProblemRep,
+                    simtkStateDisabledConstraints, output.auxiliary_residuals);
+        }
 
-        m_jar->leave(std::move(mocoProblemRep));
+        leaveProblemRep(std::move(mocoProblemRep));
     }
-    void calcMultibodySystemImplicit(const ContinuousInput& input,
-            bool calcKCErrors,
-            MultibodySystemImplicitOutput& output) const override {
-        auto mocoProblemRep = m_jar->take();
+    template <typename Shape>
+    void calcMultibodySystemImplicitImpl(const ContinuousInput& input,
+            bool calcKCErrors, MultibodySystemImplicitOutput& output) const {
+        auto mocoProblemRep = takeProblemRep();
 
         // Original model and its associated state. These are used to calculate
         // kinematic constraint forces and errors.
@@ -259,9 +396,46 @@ private:
         auto& simtkStateDisabledConstraints =
                 mocoProblemRep->updStateDisabledConstraints();
 
-        applyInput(SimTK::Stage::Acceleration, input.time, input.states,
-                input.controls, input.multipliers, input.derivatives,
-                input.parameters, mocoProblemRep);
+        const SimTK::SimbodyMatterSubsystem& matterDisabledConstraints =
+                modelDisabledConstraints.getMatterSubsystem();
+        SimTK::Vector simtkResidual((int)output.multibody_residuals.rows(),
+                output.multibody_residuals.ptr(), true);
+
+        // If there are no auxiliary states, the residual depends only on the
+        // applied forces, which are available at Stage::Dynamics. In this
+        // case, we use inverse dynamics with the udot from the optimizer
+        // rather than prescribing udot with the AccelerationMotion and
+        // realizing to Stage::Acceleration. Auxiliary state derivatives are
+        // only available at Stage::Acceleration, and with prescribed
+        // kinematics, udot is determined by the PositionMotion.
+        if (Shape::accelerations && !getNumAuxiliaryStates() &&
+                !isPrescribedKinematics()) {
+            applyInputImpl<Shape>(SimTK::Stage::Dynamics, input.time,
+                    input.states, input.controls, input.multipliers,
+                    input.derivatives, input.parameters, mocoProblemRep);
+            modelDisabledConstraints.realizeDynamics(
+                    simtkStateDisabledConstraints);
+            const SimTK::Vector udot(getNumAccelerations(),
+                    input.derivatives.ptr(), true);
+            if (Shape::multipliers && getNumMultipliers() && calcKCErrors) {
+                calcKinematicConstraintErrors(modelBase, simtkStateBase, udot,
+                        output.kinematic_constraint_errors);
+            }
+            const auto& system = modelDisabledConstraints.getMultibodySystem();
+            matterDisabledConstraints.calcResidualForce(
+                    simtkStateDisabledConstraints,
+                    system.getMobilityForces(simtkStateDisabledConstraints,
+                            SimTK::Stage::Dynamics),
+                    system.getRigidBodyForces(simtkStateDisabledConstraints,
+                            SimTK::Stage::Dynamics),
+                    udot, SimTK::Vector(), simtkResidual);
+            leaveProblemRep(std::move(mocoProblemRep));
+            return;
+        }
+
+        applyInputImpl<Shape>(SimTK::Stage::Acceleration, input.time,
+                input.states, input.controls, input.multipliers,
+                input.derivatives, input.parameters, mocoProblemRep);
 
         modelDisabledConstraints.realizeAcceleration(
                 simtkStateDisabledConstraints);
@@ -271,16 +445,12 @@ private:
         // but must make sure the prescribedKinematics already obey the
         // constraints. This is simple at the q and u level (using assemble()),
         // but what do we do for the acceleration level?
-        if (getNumMultipliers() && calcKCErrors) {
+        if (Shape::multipliers && getNumMultipliers() && calcKCErrors) {
             calcKinematicConstraintErrors(modelBase, simtkStateBase,
-                    simtkStateDisabledConstraints,
+                    simtkStateDisabledConstraints.getUDot(),
                     output.kinematic_constraint_errors);
         }
 
-        const SimTK::SimbodyMatterSubsystem& matterDisabledConstraints =
-                modelDisabledConstraints.getMatterSubsystem();
-        SimTK::Vector simtkResidual((int)output.multibody_residuals.rows(),
-                output.multibody_residuals.ptr(), true);
         matterDisabledConstraints.findMotionForces(
                 simtkStateDisabledConstraints, simtkResidual);
 
@@ -290,17 +460,19 @@ private:
                 output.auxiliary_derivatives.ptr());
 
         // Copy auxiliary residuals to output.
-        copyImplicitResidualsToOutput(*mocoProblemRep,
-                simtkStateDisabledConstraints, output.auxiliary_residuals);
+        if (Shape::auxiliaryResiduals) {
+            copyImplicitResidualsToOutput(*mocoProblemRep,
+                    simtkStateDisabledConstraints, output.auxiliary_residuals);
+        }
 
-        m_jar->leave(std::move(mocoProblemRep));
+        leaveProblemRep(std::move(mocoProblemRep));
     }
     void calcVelocityCorrection(const double& time,
             const casadi::DM& multibody_states, const casadi::DM& slacks,
             const casadi::DM& parameters,
             casadi::DM& velocity_correction) const override {
         if (isPrescribedKinematics()) return;
-        auto mocoProblemRep = m_jar->take();
+        auto mocoProblemRep = takeProblemRep();
 
         const auto& modelBase = mocoProblemRep->getModelBase();
         auto& simtkStateBase = mocoProblemRep->updStateBase();
@@ -328,11 +500,96 @@ private:
                 velocity_correction.ptr(), true);
         matterBase.multiplyByGTranspose(simtkStateBase, gamma, qdotCorr);
 
-        m_jar->leave(std::move(mocoProblemRep));
+        leaveProblemRep(std::move(mocoProblemRep));
+    }
+    void calcIntervalIntegration(const IntervalInput& input,
+            casadi::DM& final_states) const override {
+        auto mocoProblemRep = takeProblemRep();
+
+        const auto& modelDisabledConstraints =
+                mocoProblemRep->getModelDisabledConstraints();
+        auto& simtkStateDisabledConstraints =
+                mocoProblemRep->updStateDisabledConstraints();
+
+        // The controls are held in the DiscreteController's discrete
+        // variable, so they remain constant throughout the integration.
+        static const casadi::DM empty;
+        applyInput(SimTK::Stage::Acceleration, input.initial_time,
+                input.states, input.controls, empty, empty, input.parameters,
+                mocoProblemRep);
+
+        // Use a fixed step size so that the final states are a smooth
+        // function of the inputs, as required for finite differences.
+        SimTK::RungeKuttaMersonIntegrator integrator(
+                modelDisabledConstraints.getSystem());
+        integrator.setFixedStepSize(
+                (input.final_time - input.initial_time) /
+                m_multipleShootingIntegratorSteps);
+        SimTK::TimeStepper timeStepper(
+                modelDisabledConstraints.getSystem(), integrator);
+        timeStepper.initialize(simtkStateDisabledConstraints);
+        timeStepper.stepTo(input.final_time);
+        const auto& finalState = integrator.getState();
+
+        // Copy the final state to the output, skipping empty slots in Q.
+        const auto& q = finalState.getQ();
+        for (int isv = 0; isv < getNumCoordinates(); ++isv) {
+            final_states(isv) = q[m_coordinateYIndices[isv]];
+        }
+        const auto& u = finalState.getU();
+        std::copy_n(u.getContiguousScalarData(), getNumSpeeds(),
+                final_states.ptr() + getNumCoordinates());
+        const auto& z = finalState.getZ();
+        std::copy_n(z.getContiguousScalarData(), getNumAuxiliaryStates(),
+                final_states.ptr() + getNumCoordinates() + getNumSpeeds());
+
+        leaveProblemRep(std::move(mocoProblemRep));
+    }
+    void calcPathGeometry(const ContinuousInput& input,
+            PathGeometryOutput& output) const override {
+        recordCallback(MocoCasOCTrace::Callback::PathGeometry, 0, input);
+        auto mocoProblemRep = takeProblemRep();
+
+        applyInput(SimTK::Stage::Velocity, input.time, input.states,
+                input.controls, input.multipliers, input.derivatives,
+                input.parameters, mocoProblemRep);
+        const auto& modelDisabledConstraints =
+                mocoProblemRep->getModelDisabledConstraints();
+        auto& simtkStateDisabledConstraints =
+                mocoProblemRep->updStateDisabledConstraints();
+        modelDisabledConstraints.realizeVelocity(simtkStateDisabledConstraints);
+
+        // The generalized forces from a unit tension in each path are the
+        // moment arms of the path.
+        const auto& matter = modelDisabledConstraints.getMatterSubsystem();
+        const int numEquations = getNumMultibodyDynamicsEquations();
+        SimTK::Vector_<SimTK::SpatialVec> bodyForces(matter.getNumBodies());
+        SimTK::Vector mobilityForces(numEquations);
+        const auto& muscles = m_symbolicMuscles.at(mocoProblemRep.get());
+        for (int im = 0; im < (int)muscles.size(); ++im) {
+            const auto& muscle = *muscles[im];
+            output.lengths(im) = muscle.getLength(simtkStateDisabledConstraints);
+            output.lengthening_speeds(im) =
+                    muscle.getLengtheningSpeed(simtkStateDisabledConstraints);
+            bodyForces.setToZero();
+            mobilityForces.setToZero();
+            muscle.getGeometryPath().addInEquivalentForces(
+                    simtkStateDisabledConstraints, 1.0, bodyForces,
+                    mobilityForces);
+            SimTK::Vector generalizedForces(numEquations,
+                    output.generalized_forces.ptr() + im * numEquations, true);
+            matter.multiplyBySystemJacobianTranspose(
+                    simtkStateDisabledConstraints, bodyForces,
+                    generalizedForces);
+            generalizedForces += mobilityForces;
+        }
+
+        leaveProblemRep(std::move(mocoProblemRep));
     }
     void calcCostIntegrand(int index, const ContinuousInput& input,
             double& integrand) const override {
-        auto mocoProblemRep = m_jar->take();
+        recordCallback(MocoCasOCTrace::Callback::CostIntegrand, index, input);
+        auto mocoProblemRep = takeProblemRep();
 
         const auto& mocoCost = mocoProblemRep->getCostByIndex(index);
         const auto stageDep = mocoCost.getStageDependency();
@@ -352,11 +609,40 @@ private:
         integrand = mocoCost.calcIntegrand(
                 {input.time, simtkStateDisabledConstraints, rawControls});
 
-        m_jar->leave(std::move(mocoProblemRep));
+        leaveProblemRep(std::move(mocoProblemRep));
+    }
+    void calcCostIntegrandResiduals(int index, const ContinuousInput& input,
+            casadi::DM& residuals) const override {
+        recordCallback(MocoCasOCTrace::Callback::CostIntegrandResiduals,
+                index, input);
+        auto mocoProblemRep = takeProblemRep();
+
+        const auto& mocoCost = mocoProblemRep->getCostByIndex(index);
+        const auto stageDep = mocoCost.getStageDependency();
+
+        applyInput(stageDep, input.time, input.states, input.controls,
+                input.multipliers, input.derivatives, input.parameters,
+                mocoProblemRep);
+
+        auto& simtkStateDisabledConstraints =
+                mocoProblemRep->updStateDisabledConstraints();
+
+        const auto& discreteController =
+                mocoProblemRep->getDiscreteControllerDisabledConstraints();
+        const auto& rawControls = discreteController.getDiscreteControls(
+                simtkStateDisabledConstraints);
+
+        SimTK::Vector simtkResiduals(
+                (int)residuals.rows(), residuals.ptr(), true);
+        mocoCost.calcIntegrandResiduals(
+                {input.time, simtkStateDisabledConstraints, rawControls},
+                simtkResiduals);
+
+        leaveProblemRep(std::move(mocoProblemRep));
     }
     void calcCost(int index, const CostInput& input,
             casadi::DM& cost) const override {
-        auto mocoProblemRep = m_jar->take();
+        auto mocoProblemRep = takeProblemRep();
 
         const auto& mocoCost = mocoProblemRep->getCostByIndex(index);
         const auto stageDep = mocoCost.getStageDependency();
@@ -391,12 +677,14 @@ private:
                         input.integral},
                 simtkCost);
 
-        m_jar->leave(std::move(mocoProblemRep));
+        leaveProblemRep(std::move(mocoProblemRep));
     }
 
     void calcEndpointConstraintIntegrand(int index,
             const ContinuousInput& input, double& integrand) const override {
-        auto mocoProblemRep = m_jar->take();
+        recordCallback(MocoCasOCTrace::Callback::EndpointConstraintIntegrand,
+                index, input);
+        auto mocoProblemRep = takeProblemRep();
 
         const auto& mocoEC =
                 mocoProblemRep->getEndpointConstraintByIndex(index);
@@ -417,11 +705,11 @@ private:
         integrand = mocoEC.calcIntegrand(
                 {input.time, simtkStateDisabledConstraints, rawControls});
 
-        m_jar->leave(std::move(mocoProblemRep));
+        leaveProblemRep(std::move(mocoProblemRep));
     }
     void calcEndpointConstraint(int index, const CostInput& input,
             casadi::DM& values) const override {
-        auto mocoProblemRep = m_jar->take();
+        auto mocoProblemRep = takeProblemRep();
 
         const auto& mocoEC =
                 mocoProblemRep->getEndpointConstraintByIndex(index);
@@ -457,37 +745,108 @@ private:
                         input.integral},
                 simtkValues);
 
-        m_jar->leave(std::move(mocoProblemRep));
+        leaveProblemRep(std::move(mocoProblemRep));
+    }
+
+    /// Apply the input to the initial and final states once (at the greatest
+    /// stage dependency of all endpoint goals), and evaluate all costs and
+    /// endpoint constraints on those states, so that realizations are shared
+    /// among the goals.
+    void calcEndpoints(const CostInput& input, const casadi::DM& integrals,
+            casadi::DM& values) const override {
+        auto mocoProblemRep = takeProblemRep();
+
+        const int numCosts = mocoProblemRep->getNumCosts();
+        const int numEndpointConstraints =
+                mocoProblemRep->getNumEndpointConstraints();
+        SimTK::Stage stageDep = SimTK::Stage::Topology;
+        for (int ic = 0; ic < numCosts; ++ic) {
+            stageDep = std::max(stageDep,
+                    mocoProblemRep->getCostByIndex(ic).getStageDependency());
+        }
+        for (int iec = 0; iec < numEndpointConstraints; ++iec) {
+            stageDep = std::max(stageDep,
+                    mocoProblemRep->getEndpointConstraintByIndex(iec)
+                            .getStageDependency());
+        }
+
+        applyInput(stageDep, input.initial_time, input.initial_states,
+                input.initial_controls, input.initial_multipliers,
+                input.initial_derivatives, input.parameters, mocoProblemRep, 0);
+
+        auto& simtkStateDisabledConstraintsInitial =
+                mocoProblemRep->updStateDisabledConstraints(0);
+
+        applyInput(stageDep, input.final_time, input.final_states,
+                input.final_controls, input.final_multipliers,
+                input.final_derivatives, input.parameters, mocoProblemRep, 1);
+
+        auto& simtkStateDisabledConstraintsFinal =
+                mocoProblemRep->updStateDisabledConstraints(1);
+
+        const auto& discreteController =
+                mocoProblemRep->getDiscreteControllerDisabledConstraints();
+        const auto& rawControlsInitial = discreteController.getDiscreteControls(
+                simtkStateDisabledConstraintsInitial);
+        const auto& rawControlsFinal = discreteController.getDiscreteControls(
+                simtkStateDisabledConstraintsFinal);
+
+        // The goals write directly into their portion of the output.
+        int igoal = 0;
+        int ioutput = 0;
+        auto calcGoal = [&](const MocoGoal& mocoGoal, int numOutputs) {
+            SimTK::Vector simtkValues(
+                    numOutputs, values.ptr() + ioutput, true);
+            mocoGoal.calcGoal(
+                    {input.initial_time, simtkStateDisabledConstraintsInitial,
+                            rawControlsInitial, input.final_time,
+                            simtkStateDisabledConstraintsFinal,
+                            rawControlsFinal, integrals(igoal++).scalar()},
+                    simtkValues);
+            ioutput += numOutputs;
+        };
+        for (int ic = 0; ic < numCosts; ++ic) {
+            calcGoal(mocoProblemRep->getCostByIndex(ic),
+                    getCostInfos()[ic].num_outputs);
+        }
+        for (int iec = 0; iec < numEndpointConstraints; ++iec) {
+            calcGoal(mocoProblemRep->getEndpointConstraintByIndex(iec),
+                    getEndpointConstraintInfos()[iec].num_outputs);
+        }
+
+        leaveProblemRep(std::move(mocoProblemRep));
     }
 
     void calcPathConstraint(int constraintIndex, const ContinuousInput& input,
             casadi::DM& path_constraint) const override {
-        auto mocoProblemRep = m_jar->take();
-        // Not all path constraints require realizing to Acceleration. We could
-        // add a stage dependency for path constraints, but we have yet to
-        // conduct profiling to indicate that such an optimization is necessary.
-        applyInput(SimTK::Stage::Acceleration,
-                input.time, input.states, input.controls, input.multipliers,
-                input.derivatives, input.parameters, mocoProblemRep);
+        recordCallback(MocoCasOCTrace::Callback::PathConstraint,
+                constraintIndex, input);
+        auto mocoProblemRep = takeProblemRep();
+        // Only prepare the state up to the stage that the path constraint
+        // depends on; for example, constraints on positions do not require
+        // setting the accelerations or computing constraint forces.
+        const auto& mocoPathCon =
+                mocoProblemRep->getPathConstraintByIndex(constraintIndex);
+        applyInput(mocoPathCon.getStageDependency(), input.time, input.states,
+                input.controls, input.multipliers, input.derivatives,
+                input.parameters, mocoProblemRep);
         auto& simtkStateDisabledConstraints =
                 mocoProblemRep->updStateDisabledConstraints();
 
         // Compute path constraint errors.
-        const auto& mocoPathCon =
-                mocoProblemRep->getPathConstraintByIndex(constraintIndex);
         SimTK::Vector errors(
                 (int)path_constraint.rows(), path_constraint.ptr(), true);
         mocoPathCon.calcPathConstraintErrors(
                 simtkStateDisabledConstraints, errors);
 
-        m_jar->leave(std::move(mocoProblemRep));
+        leaveProblemRep(std::move(mocoProblemRep));
     }
     std::vector<std::string>
     createKinematicConstraintEquationNamesImpl() const override {
-        auto mocoProblemRep = m_jar->take();
+        auto mocoProblemRep = takeProblemRep();
         const auto names = mocoProblemRep->getKinematicConstraintEquationNames(
                 getEnforceConstraintDerivatives());
-        m_jar->leave(std::move(mocoProblemRep));
+        leaveProblemRep(std::move(mocoProblemRep));
         return names;
     }
     void intermediateCallbackImpl() const override {
@@ -502,6 +861,22 @@ private:
     }
 
 private:
+    /// If the path constraint depends only on time and controls (e.g., a
+    /// MocoControlBoundConstraint with Constant or LinearFunction bounds),
+    /// create a symbolic function of time and controls for the constraint
+    /// errors (see CasOC::Problem::addPathConstraint()). Otherwise, return a
+    /// null function, and the constraint is evaluated by
+    /// calcPathConstraint().
+    casadi::Function createSymbolicPathConstraint(
+            const MocoPathConstraint& pathCon,
+            const std::vector<std::string>& controlNames) const;
+    /// Express the tension and activation dynamics of the model's
+    /// DeGrooteFregly2016Muscles symbolically (see CasOC::Problem::
+    /// setSymbolicActuators()), and override the muscles' actuation to zero
+    /// in the models used by the callbacks.
+    void setSymbolicMuscleDynamics(const MocoProblemRep& problemRep,
+            const std::vector<std::string>& stateNames,
+            const std::vector<std::string>& controlNames);
     /// Apply parameters to properties in the models returned by
     /// `mocoProblemRep.getModelBase()` and
     /// `mocoProblemRep.getModelDisabledConstraints()`.
@@ -518,27 +893,79 @@ private:
     /// slots in Simbody's Y vector.
     /// It's fine for the size of `states` to be less than the size of Y; only
     /// the first states.size1() values are copied.
+    /// Writing to the state invalidates the cache at and above the stage of
+    /// the written variable (Time, Position for q, Velocity for u, Dynamics
+    /// for auxiliary states). To avoid recomputing kinematics when, for
+    /// example, a finite difference perturbation changes only a control or an
+    /// activation, we only write the groups of variables whose values differ
+    /// from those already in `simtkState` (see m_applyOnlyChangedInputs).
+    template <typename Shape = GeneralShape>
     void convertStatesToSimTKState(SimTK::Stage stageDep, const double& time,
             const casadi::DM& states, const Model& model,
             SimTK::State& simtkState, bool copyAuxStates) const {
         if (stageDep >= SimTK::Stage::Time) {
-            simtkState.setTime(time);
+            const bool force = !m_applyOnlyChangedInputs;
+            bool kinematicsChanged = false;
+            if (force || simtkState.getTime() != time) {
+                simtkState.setTime(time);
+                kinematicsChanged = true;
+            }
             // Assign the generalized coordinates. We know we have NU
             // generalized speeds because we do not yet support quaternions.
-            for (int isv = 0; isv < getNumCoordinates(); ++isv) {
-                simtkState.updQ()[m_yIndexMap.at(isv)] = *(states.ptr() + isv);
+            const double* q = states.ptr();
+            const int numQ = getNumCoordinates();
+            if (!Shape::coordinateGaps || m_coordinateYIndicesAreContiguous) {
+                if (force || !std::equal(q, q + numQ,
+                                     simtkState.getQ()
+                                             .getContiguousScalarData())) {
+                    std::copy_n(q, numQ,
+                            simtkState.updQ().updContiguousScalarData());
+                    kinematicsChanged = true;
+                }
+            } else {
+                bool qChanged = force;
+                if (!qChanged) {
+                    const auto& simtkQ = simtkState.getQ();
+                    for (int isv = 0; isv < numQ; ++isv) {
+                        if (simtkQ[m_coordinateYIndices[isv]] != q[isv]) {
+                            qChanged = true;
+                            break;
+                        }
+                    }
+                }
+                if (qChanged) {
+                    auto& simtkQ = simtkState.updQ();
+                    for (int isv = 0; isv < numQ; ++isv) {
+                        simtkQ[m_coordinateYIndices[isv]] = q[isv];
+                    }
+                    kinematicsChanged = true;
+                }
+            }
+            const double* u = states.ptr() + getNumCoordinates();
+            if (force || !std::equal(u, u + getNumSpeeds(),
+                                 simtkState.getU().getContiguousScalarData())) {
+                std::copy_n(u, getNumSpeeds(),
+                        simtkState.updU().updContiguousScalarData());
+                kinematicsChanged = true;
             }
-            std::copy_n(states.ptr() + getNumCoordinates(), getNumSpeeds(),
-                    simtkState.updY().updContiguousScalarData() +
-                            simtkState.getNQ());
             if (copyAuxStates) {
-                std::copy_n(states.ptr() + getNumCoordinates() + getNumSpeeds(),
-                        getNumAuxiliaryStates(),
-                        simtkState.updY().updContiguousScalarData() +
-                                simtkState.getNQ() + simtkState.getNU());
+                const double* z =
+                        states.ptr() + getNumCoordinates() + getNumSpeeds();
+                const int numZ = getNumAuxiliaryStates();
+                if (force || !std::equal(z, z + numZ,
+                                     simtkState.getZ()
+                                             .getContiguousScalarData())) {
+                    std::copy_n(z, numZ,
+                            simtkState.updZ().updContiguousScalarData());
+                }
+            }
+            // Prescribing motion requires that time is updated. If time and
+            // kinematics are unchanged and the state is still realized to
+            // Position, the prescribed values are already in the state.
+            if (kinematicsChanged ||
+                    simtkState.getSystemStage() < SimTK::Stage::Position) {
+                model.getSystem().prescribe(simtkState);
             }
-            // Prescribing motion requires that time is updated.
-            model.getSystem().prescribe(simtkState);
         }
     }
 
@@ -548,19 +975,34 @@ private:
     /// copied over, we likely are going to compute forces with the resulting
     /// state, and so we should also copy over the auxiliary states; we pass
     /// true for the copyAuxStates parameter of convertStatesToSimTKState().
+    template <typename Shape = GeneralShape>
     void convertStatesControlsToSimTKState(SimTK::Stage stageDep,
             const double& time,
             const casadi::DM& states, const casadi::DM& controls,
             const Model& model, SimTK::State& simtkState,
             const DiscreteController& discreteController) const {
         if (stageDep >= SimTK::Stage::Model) {
-            convertStatesToSimTKState(
+            convertStatesToSimTKState<Shape>(
                     stageDep, time, states, model, simtkState, true);
-            SimTK::Vector& simtkControls =
-                    discreteController.updDiscreteControls(simtkState);
-            for (int ic = 0; ic < getNumControls(); ++ic) {
-                simtkControls[m_modelControlIndices[ic]] =
-                        *(controls.ptr() + ic);
+            bool controlsChanged = !m_applyOnlyChangedInputs;
+            if (!controlsChanged) {
+                const SimTK::Vector& simtkControls =
+                        discreteController.getDiscreteControls(simtkState);
+                for (int ic = 0; ic < getNumControls(); ++ic) {
+                    if (simtkControls[m_modelControlIndices[ic]] !=
+                            *(controls.ptr() + ic)) {
+                        controlsChanged = true;
+                        break;
+                    }
+                }
+            }
+            if (controlsChanged) {
+                SimTK::Vector& simtkControls =
+                        discreteController.updDiscreteControls(simtkState);
+                for (int ic = 0; ic < getNumControls(); ++ic) {
+                    simtkControls[m_modelControlIndices[ic]] =
+                            *(controls.ptr() + ic);
+                }
             }
         }
     }
@@ -573,6 +1015,16 @@ private:
             const casadi::DM& parameters,
             const std::unique_ptr<const MocoProblemRep>& mocoProblemRep,
             int stateDisConIndex = 0) const {
+        (this->*m_applyInput)(stageDep, time, states, controls, multipliers,
+                derivatives, parameters, mocoProblemRep, stateDisConIndex);
+    }
+    template <typename Shape>
+    void applyInputImpl(SimTK::Stage stageDep, const double& time,
+            const casadi::DM& states, const casadi::DM& controls,
+            const casadi::DM& multipliers, const casadi::DM& derivatives,
+            const casadi::DM& parameters,
+            const std::unique_ptr<const MocoProblemRep>& mocoProblemRep,
+            int stateDisConIndex) const {
         // Original model and its associated state. These are used to calculate
         // kinematic constraint forces and errors.
         const auto& modelBase = mocoProblemRep->getModelBase();
@@ -590,11 +1042,13 @@ private:
             applyParametersToModelProperties(parameters, *mocoProblemRep);
         }
 
-        if (stageDep >= SimTK::Stage::Acceleration && getNumAccelerations()) {
+        if (Shape::accelerations && stageDep >= SimTK::Stage::Acceleration &&
+                getNumAccelerations()) {
             auto& accel = mocoProblemRep->getAccelerationMotion();
             accel.setEnabled(simtkStateDisabledConstraints, true);
             SimTK::Vector udot(getNumAccelerations(), derivatives.ptr(), true);
-            accel.setUDot(simtkStateDisabledConstraints, udot);
+            accel.setUDot(simtkStateDisabledConstraints, udot,
+                    m_applyOnlyChangedInputs);
         }
 
         // Set discrete variables that represent state derivatives in implicit
@@ -606,33 +1060,41 @@ private:
         // for the discrete variables to be available at SimTK::Stage::Model
         // also. Lastly, goals might be a direct function of these state
         // derivatives.
-        if (stageDep >= SimTK::Stage::Model &&
+        if (Shape::auxiliaryResiduals && stageDep >= SimTK::Stage::Model &&
                 getNumAuxiliaryResidualEquations()) {
             const auto& implicitRefs =
                     mocoProblemRep->getImplicitComponentReferencePtrs();
             const int numAccels = getNumAccelerations();
             for (int i = 0; i < (int)implicitRefs.size(); ++i) {
                 const auto& comp = implicitRefs[i].second.getRef();
+                const double value = *(derivatives.ptr() + numAccels + i);
+                if (m_applyOnlyChangedInputs &&
+                        comp.getDiscreteVariableValue(
+                                simtkStateDisabledConstraints,
+                                implicitRefs[i].first) == value) {
+                    continue;
+                }
                 comp.setDiscreteVariableValue(simtkStateDisabledConstraints,
-                        implicitRefs[i].first,
-                        *(derivatives.ptr() + numAccels + i));
+                        implicitRefs[i].first, value);
             }
         }
 
-        convertStatesControlsToSimTKState(stageDep, time, states, controls,
-                modelDisabledConstraints, simtkStateDisabledConstraints,
+        convertStatesControlsToSimTKState<Shape>(stageDep, time, states,
+                controls, modelDisabledConstraints,
+                simtkStateDisabledConstraints,
                 mocoProblemRep->getDiscreteControllerDisabledConstraints());
 
         // If enabled constraints exist in the model, compute constraint forces
         // based on Lagrange multipliers. This also updates the associated
         // discrete variables in the state.
-        if (stageDep >= SimTK::Stage::Dynamics && getNumMultipliers()) {
+        if (Shape::multipliers && stageDep >= SimTK::Stage::Dynamics &&
+                getNumMultipliers()) {
             // The base model is used only to compute constraint forces, so
             // we only need to update it if there are kinematic constraints.
             // We pass copyAuxStates as false: we use the base model for its
             // constraint Jacobian, which depends only on kinematics and cannot
             // depend on auxiliary states.
-            convertStatesToSimTKState(
+            convertStatesToSimTKState<Shape>(
                     stageDep, time, states, modelBase, simtkStateBase, false);
             calcKinematicConstraintForces(multipliers, simtkStateBase,
                     modelBase, mocoProblemRep->getConstraintForces(),
@@ -661,9 +1123,10 @@ private:
                 m_constraintMobilityForces, m_constraintBodyForces);
     }
 
+    /// The acceleration-level errors are computed with `udot`, which is
+    /// typically from the model with disabled constraints.
     void calcKinematicConstraintErrors(const Model& modelBase,
-            const SimTK::State& stateBase,
-            const SimTK::State& simtkStateDisabledConstraints,
+            const SimTK::State& stateBase, const SimTK::Vector& udot,
             casadi::DM& kinematic_constraint_errors) const {
 
         // If all kinematics are prescribed, we assume that the prescribed
@@ -689,8 +1152,8 @@ private:
             // since we cannot use (nor do we have available) udot computed
             // from the original model.
             const auto& matter = modelBase.getMatterSubsystem();
-            matter.calcConstraintAccelerationErrors(stateBase,
-                    simtkStateDisabledConstraints.getUDot(), m_pvaerr);
+            matter.calcConstraintAccelerationErrors(
+                    stateBase, udot, m_pvaerr);
         } else {
             m_pvaerr = SimTK::NaN;
         }
@@ -731,11 +1194,52 @@ private:
                 kinematic_constraint_errors.ptr() + qerr.size() + uerrSize);
     }
 
+    /// Take a MocoProblemRep from the jar. If the MocoProblemReps were placed
+    /// on NUMA nodes (see MocoSolver::createProblemRepJar()), we prefer one on
+    /// the calling thread's node, and we pin each of CasADi's worker threads,
+    /// once, to the node on which it first calls this function so that it
+    /// stays close to its memory. We do not pin the thread that created this
+    /// object, as it belongs to the user.
+    std::unique_ptr<const MocoProblemRep> takeProblemRep() const {
+        if (m_numaNodeCPUs.size() <= 1) return m_jar->take();
+        const int node = getCurrentNUMANode(m_numaNodeCPUs);
+        thread_local bool pinned = false;
+        if (!pinned && std::this_thread::get_id() != m_mainThreadId) {
+            pinThreadToCPUs(m_numaNodeCPUs[node]);
+            pinned = true;
+        }
+        return m_jar->take(node);
+    }
+    /// Return a MocoProblemRep to the jar, keyed by the node on which it was
+    /// placed.
+    void leaveProblemRep(std::unique_ptr<const MocoProblemRep> rep) const {
+        const int node = getProblemRepNode(*rep);
+        m_jar->leave(std::move(rep), node);
+    }
+
+    void recordCallback(MocoCasOCTrace::Callback callback, int index,
+            const ContinuousInput& input) const {
+        if (m_traceWriter) m_traceWriter->record(callback, index, input);
+    }
+
+    /// Use the callbacks instantiated for the given shape.
+    template <typename Shape> void setCallbackShape() {
+        m_applyInput = &MocoCasOCProblem::applyInputImpl<Shape>;
+        m_calcMultibodySystemExplicit =
+                &MocoCasOCProblem::calcMultibodySystemExplicitImpl<Shape>;
+        m_calcMultibodySystemImplicit =
+                &MocoCasOCProblem::calcMultibodySystemImplicitImpl<Shape>;
+    }
+
     void copyImplicitResidualsToOutput(const MocoProblemRep& mocoProblemRep,
             const SimTK::State& state, casadi::DM& auxiliary_residuals) const {
         if (getNumAuxiliaryResidualEquations()) {
             const auto& residualOutputs =
                     mocoProblemRep.getImplicitResidualReferencePtrs();
+            // An Output stores its value in the Output object, so threads
+            // that share a model must not evaluate Outputs concurrently.
+            std::unique_lock<std::mutex> lock(m_outputMutex, std::defer_lock);
+            if (m_shareModel) lock.lock();
             SimTK::Vector auxResiduals((int)residualOutputs.size(), 0.0);
             for (int i = 0; i < (int)residualOutputs.size(); ++i) {
                 auxResiduals[i] = residualOutputs[i]->getValue(state);
@@ -746,11 +1250,51 @@ private:
     }
 
     std::unique_ptr<ThreadsafeJar<const MocoProblemRep>> m_jar;
+    /// The callbacks for the shape of this problem (see CallbackShape).
+    void (MocoCasOCProblem::*m_applyInput)(SimTK::Stage, const double&,
+            const casadi::DM&, const casadi::DM&, const casadi::DM&,
+            const casadi::DM&, const casadi::DM&,
+            const std::unique_ptr<const MocoProblemRep>&, int) const =
+            nullptr;
+    void (MocoCasOCProblem::*m_calcMultibodySystemExplicit)(
+            const ContinuousInput&, bool, MultibodySystemExplicitOutput&)
+            const = nullptr;
+    void (MocoCasOCProblem::*m_calcMultibodySystemImplicit)(
+            const ContinuousInput&, bool, MultibodySystemImplicitOutput&)
+            const = nullptr;
     bool m_paramsRequireInitSystem = true;
+    int m_multipleShootingIntegratorSteps = 10;
+    /// If true, the MocoProblemReps in the jar share a single copy of the
+    /// model (see MocoProblemRep::createRepSharingModels()).
+    bool m_shareModel = false;
+    mutable std::mutex m_outputMutex;
+    /// The CPUs of each NUMA node, if the MocoProblemReps in the jar were
+    /// placed on NUMA nodes; otherwise, this has at most one element.
+    std::vector<std::vector<int>> m_numaNodeCPUs;
+    /// The NUMA node of each MocoProblemRep in the jar, if they were placed
+    /// on NUMA nodes. This does not change after construction.
+    std::unordered_map<const MocoProblemRep*, int> m_repNodes;
+    std::thread::id m_mainThreadId;
+    /// If true, applyInput() writes only the variables whose values differ
+    /// from those already in the SimTK::State, so that unchanged stages stay
+    /// realized. This is disabled if parameters are applied to model
+    /// properties without calling initSystem(), since the realized cache
+    /// would then not reflect the new property values.
+    bool m_applyOnlyChangedInputs = true;
     std::string m_formattedTimeString;
-    std::unordered_map<int, int> m_yIndexMap;
+    /// The index in Simbody's Q (and Y) vector of each coordinate state.
+    std::vector<int> m_coordinateYIndices;
+    /// Is m_coordinateYIndices 0, 1, 2, ...?
+    bool m_coordinateYIndicesAreContiguous = true;
     std::vector<int> m_modelControlIndices;
     std::unique_ptr<FileDeletionThrower> m_fileDeletionThrower;
+    std::unique_ptr<MocoCasOCTraceWriter> m_traceWriter;
+    std::vector<std::string> m_symbolicMusclePaths;
+    /// The symbolic muscles within each MocoProblemRep in the jar. This is
+    /// only modified in the constructor.
+    std::unordered_map<const MocoProblemRep*,
+            std::vector<const DeGrooteFregly2016Muscle*>>
+            m_symbolicMuscles;
     // Local memory to hold constraint forces.
     static thread_local SimTK::Vector_<SimTK::SpatialVec>
             m_constraintBodyForces;
@@ -0,0 +1,301 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: MocoCasOCTrace.cpp                                           *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "MocoCasOCTrace.h"
+
+#include "../MocoUtilities.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <thread>
+
+using namespace OpenSim;
+using casadi::DM;
+
+namespace {
+const char traceMagic[8] = {'M', 'O', 'C', 'O', 'T', 'R', 'C', '1'};
+
+template <typename T>
+void append(std::vector<char>& buffer, const T& value) {
+    const auto* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+void append(std::vector<char>& buffer, const DM& values) {
+    const auto* bytes = reinterpret_cast<const char*>(values.ptr());
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(double) * values.nnz());
+}
+
+template <typename T>
+void readValue(std::istream& stream, T& value) {
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+void readValues(std::istream& stream, int size, DM& values) {
+    values = DM::zeros(size, 1);
+    stream.read(reinterpret_cast<char*>(values.ptr()), sizeof(double) * size);
+}
+
+/// Evaluate the callback of the record with outputs of the sizes that the
+/// CasOC::Function%s use.
+void evaluate(
+        const CasOC::Problem& problem, const MocoCasOCTrace::Record& record) {
+    using Callback = MocoCasOCTrace::Callback;
+    const CasOC::Problem::ContinuousInput input{record.time, record.states,
+            record.controls, record.multipliers, record.derivatives,
+            record.parameters};
+    switch (record.callback) {
+    case Callback::MultibodySystemExplicit:
+    case Callback::MultibodySystemImplicit: {
+        DM multibody = DM::zeros(problem.getNumMultibodyDynamicsEquations(), 1);
+        DM auxiliaryDerivatives = DM::zeros(problem.getNumAuxiliaryStates(), 1);
+        DM auxiliaryResiduals =
+                DM::zeros(problem.getNumAuxiliaryResidualEquations(), 1);
+        DM kinematicConstraintErrors(casadi::Sparsity(0, 0));
+        if (record.index) {
+            kinematicConstraintErrors = DM::zeros(
+                    problem.getNumKinematicConstraintEquations(), 1);
+        }
+        if (record.callback == Callback::MultibodySystemExplicit) {
+            CasOC::Problem::MultibodySystemExplicitOutput output{multibody,
+                    auxiliaryDerivatives, auxiliaryResiduals,
+                    kinematicConstraintErrors};
+            problem.calcMultibodySystemExplicit(
+                    input, record.index != 0, output);
+        } else {
+            CasOC::Problem::MultibodySystemImplicitOutput output{multibody,
+                    auxiliaryDerivatives, auxiliaryResiduals,
+                    kinematicConstraintErrors};
+            problem.calcMultibodySystemImplicit(
+                    input, record.index != 0, output);
+        }
+        break;
+    }
+    case Callback::PathGeometry: {
+        const int numActuators = problem.getNumSymbolicActuators();
+        DM lengths = DM::zeros(numActuators, 1);
+        DM speeds = DM::zeros(numActuators, 1);
+        DM generalizedForces = DM::zeros(
+                problem.getNumMultibodyDynamicsEquations() * numActuators, 1);
+        CasOC::Problem::PathGeometryOutput output{
+                lengths, speeds, generalizedForces};
+        problem.calcPathGeometry(input, output);
+        break;
+    }
+    case Callback::CostIntegrand: {
+        double integrand = 0;
+        problem.calcCostIntegrand(record.index, input, integrand);
+        break;
+    }
+    case Callback::CostIntegrandResiduals: {
+        DM residuals = DM::zeros(
+                problem.getCostInfos()[record.index].num_residuals, 1);
+        problem.calcCostIntegrandResiduals(record.index, input, residuals);
+        break;
+    }
+    case Callback::EndpointConstraintIntegrand: {
+        double integrand = 0;
+        problem.calcEndpointConstraintIntegrand(
+                record.index, input, integrand);
+        break;
+    }
+    case Callback::PathConstraint: {
+        DM errors = DM::zeros(
+                problem.getPathConstraintInfos()[record.index].size(), 1);
+        problem.calcPathConstraint(record.index, input, errors);
+        break;
+    }
+    }
+}
+} // namespace
+
+std::string MocoCasOCTrace::getCallbackName(Callback callback) {
+    switch (callback) {
+    case Callback::MultibodySystemExplicit: return "multibody_system_explicit";
+    case Callback::MultibodySystemImplicit: return "multibody_system_implicit";
+    case Callback::PathGeometry: return "path_geometry";
+    case Callback::CostIntegrand: return "cost_integrand";
+    case Callback::CostIntegrandResiduals: return "cost_integrand_residuals";
+    case Callback::EndpointConstraintIntegrand:
+        return "endpoint_constraint_integrand";
+    case Callback::PathConstraint: return "path_constraint";
+    default: OPENSIM_THROW(Exception, "Internal error.");
+    }
+}
+
+MocoCasOCTrace MocoCasOCTrace::read(const std::string& fileName) {
+    std::ifstream stream(fileName, std::ios::binary);
+    OPENSIM_THROW_IF(!stream, Exception, "Could not open trace file '{}'.",
+            fileName);
+    char magic[sizeof(traceMagic)];
+    stream.read(magic, sizeof(magic));
+    OPENSIM_THROW_IF(!stream || std::memcmp(magic, traceMagic, sizeof(magic)),
+            Exception, "File '{}' is not a MocoCasOCTrace file.", fileName);
+
+    MocoCasOCTrace trace;
+    std::int32_t sizes[5];
+    for (auto& size : sizes) readValue(stream, size);
+    OPENSIM_THROW_IF(!stream || *std::min_element(sizes, sizes + 5) < 0,
+            Exception, "The header of trace file '{}' is invalid.", fileName);
+    trace.m_numStates = sizes[0];
+    trace.m_numControls = sizes[1];
+    trace.m_numMultipliers = sizes[2];
+    trace.m_numDerivatives = sizes[3];
+    trace.m_numParameters = sizes[4];
+
+    while (stream.peek() != std::char_traits<char>::eof()) {
+        std::int32_t callback;
+        std::int32_t index;
+        double time;
+        readValue(stream, callback);
+        readValue(stream, index);
+        readValue(stream, time);
+        DM states, controls, multipliers, derivatives, parameters;
+        readValues(stream, trace.m_numStates, states);
+        readValues(stream, trace.m_numControls, controls);
+        readValues(stream, trace.m_numMultipliers, multipliers);
+        readValues(stream, trace.m_numDerivatives, derivatives);
+        readValues(stream, trace.m_numParameters, parameters);
+        OPENSIM_THROW_IF(!stream, Exception,
+                "Trace file '{}' is truncated after {} records.", fileName,
+                trace.m_records.size());
+        OPENSIM_THROW_IF(callback < 0 || callback >= NumCallbacks || index < 0,
+                Exception, "Record {} of trace file '{}' is invalid.",
+                trace.m_records.size(), fileName);
+        trace.m_records.push_back({static_cast<Callback>(callback), index,
+                time, std::move(states), std::move(controls),
+                std::move(multipliers), std::move(derivatives),
+                std::move(parameters)});
+    }
+    return trace;
+}
+
+MocoCasOCTrace::ReplayTimes MocoCasOCTrace::replay(
+        const CasOC::Problem& problem, int numThreads) const {
+    OPENSIM_THROW_IF(m_numStates != problem.getNumStates() ||
+                             m_numControls != problem.getNumControls() ||
+                             m_numMultipliers != problem.getNumMultipliers() ||
+                             m_numDerivatives != problem.getNumDerivatives() ||
+                             m_numParameters != problem.getNumParameters(),
+            Exception,
+            "The trace has {} states, {} controls, {} multipliers, {} "
+            "derivatives, and {} parameters, but the problem has {}, {}, {}, "
+            "{}, and {}.",
+            m_numStates, m_numControls, m_numMultipliers, m_numDerivatives,
+            m_numParameters, problem.getNumStates(), problem.getNumControls(),
+            problem.getNumMultipliers(), problem.getNumDerivatives(),
+            problem.getNumParameters());
+    OPENSIM_THROW_IF(numThreads < 1, Exception,
+            "Expected numThreads to be at least 1, but got {}.", numThreads);
+    for (const auto& record : m_records) {
+        int numIndices = std::numeric_limits<int>::max();
+        switch (record.callback) {
+        case Callback::PathGeometry:
+            OPENSIM_THROW_IF(!problem.getNumSymbolicActuators(), Exception,
+                    "The trace evaluates path geometry, but the problem has "
+                    "no symbolic actuators.");
+            break;
+        case Callback::CostIntegrand:
+            numIndices = problem.getNumCosts();
+            break;
+        case Callback::CostIntegrandResiduals:
+            numIndices = problem.getNumCosts();
+            OPENSIM_THROW_IF(record.index < numIndices &&
+                                     !problem.getCostInfos()[record.index]
+                                              .num_residuals,
+                    Exception,
+                    "The trace evaluates the residuals of cost {}, but the "
+                    "cost has no residuals in this problem.",
+                    record.index);
+            break;
+        case Callback::EndpointConstraintIntegrand:
+            numIndices = (int)problem.getEndpointConstraintInfos().size();
+            break;
+        case Callback::PathConstraint:
+            numIndices = (int)problem.getPathConstraintInfos().size();
+            break;
+        default: break;
+        }
+        OPENSIM_THROW_IF(record.index >= numIndices, Exception,
+                "The trace evaluates {} {}, but the problem has only {}.",
+                getCallbackName(record.callback), record.index, numIndices);
+    }
+
+    ReplayTimes times;
+    times.latencies.resize(m_records.size());
+    std::atomic<int> next(0);
+    std::mutex exceptionMutex;
+    std::exception_ptr exception;
+    auto work = [&]() {
+        try {
+            int irecord;
+            while ((irecord = next++) < (int)m_records.size()) {
+                const Stopwatch stopwatch;
+                evaluate(problem, m_records[irecord]);
+                times.latencies[irecord] = stopwatch.getElapsedTimeInNs();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(exceptionMutex);
+            if (!exception) exception = std::current_exception();
+            next = (int)m_records.size();
+        }
+    };
+    const Stopwatch stopwatch;
+    std::vector<std::thread> threads;
+    for (int ithread = 1; ithread < numThreads; ++ithread) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) thread.join();
+    times.duration = stopwatch.getElapsedTimeInNs();
+    if (exception) std::rethrow_exception(exception);
+    return times;
+}
+
+MocoCasOCTraceWriter::MocoCasOCTraceWriter(
+        const std::string& fileName, const CasOC::Problem& problem)
+        : m_stream(fileName, std::ios::binary) {
+    OPENSIM_THROW_IF(!m_stream, Exception,
+            "Could not open trace file '{}' for writing.", fileName);
+    std::vector<char> header(traceMagic, traceMagic + sizeof(traceMagic));
+    append(header, (std::int32_t)problem.getNumStates());
+    append(header, (std::int32_t)problem.getNumControls());
+    append(header, (std::int32_t)problem.getNumMultipliers());
+    append(header, (std::int32_t)problem.getNumDerivatives());
+    append(header, (std::int32_t)problem.getNumParameters());
+    m_stream.write(header.data(), header.size());
+}
+
+void MocoCasOCTraceWriter::record(MocoCasOCTrace::Callback callback,
+        int index, const CasOC::Problem::ContinuousInput& input) {
+    // Assemble the record before taking the lock, so that threads wait only
+    // for the write.
+    thread_local std::vector<char> buffer;
+    buffer.clear();
+    append(buffer, static_cast<std::int32_t>(callback));
+    append(buffer, static_cast<std::int32_t>(index));
+    append(buffer, input.time);
+    append(buffer, input.states);
+    append(buffer, input.controls);
+    append(buffer, input.multipliers);
+    append(buffer, input.derivatives);
+    append(buffer, input.parameters);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stream.write(buffer.data(), buffer.size());
+}
@@ -0,0 +1,116 @@
+#ifndef MOCO_MOCOCASOCTRACE_H
+#define MOCO_MOCOCASOCTRACE_H
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: MocoCasOCTrace.h                                             *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "CasOCProblem.h"
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+
+namespace OpenSim {
+
+/// The inputs to the continuous callbacks of a MocoCasOCProblem (the
+/// multibody system, path geometry, integrands, and path constraints),
+/// recorded during a solve (see MocoCasADiSolver's `callback_trace_file`).
+/// Replaying a trace evaluates the same callbacks without the optimizer, so
+/// that changes to the model's components or to threading can be
+/// benchmarked deterministically. The endpoint function (endpoint goals and
+/// constraints), the velocity correction, and the interval integration of
+/// multiple shooting are not recorded, as their inputs differ; a trace of a
+/// multiple shooting problem contains only integrands and path constraints.
+///
+/// The file is binary, in the byte order of the machine that wrote it. It
+/// starts with the 8 characters "MOCOTRC1" and the number of states,
+/// controls, multipliers, derivatives, and parameters (32-bit integers).
+/// Each record follows, with the callback and the index (32-bit integers),
+/// then the time, states, controls, multipliers, derivatives, and
+/// parameters (doubles).
+class MocoCasOCTrace {
+public:
+    enum class Callback : std::int32_t {
+        MultibodySystemExplicit = 0,
+        MultibodySystemImplicit = 1,
+        PathGeometry = 2,
+        CostIntegrand = 3,
+        CostIntegrandResiduals = 4,
+        EndpointConstraintIntegrand = 5,
+        PathConstraint = 6
+    };
+    static constexpr int NumCallbacks = 7;
+    static std::string getCallbackName(Callback callback);
+
+    struct Record {
+        Callback callback;
+        /// The index of the cost, endpoint constraint, or path constraint.
+        /// For the multibody system callbacks, 1 if the kinematic constraint
+        /// errors were computed and 0 otherwise.
+        int index;
+        double time;
+        casadi::DM states;
+        casadi::DM controls;
+        casadi::DM multipliers;
+        casadi::DM derivatives;
+        casadi::DM parameters;
+    };
+
+    /// Read a trace written by MocoCasOCTraceWriter.
+    static MocoCasOCTrace read(const std::string& fileName);
+
+    const std::vector<Record>& getRecords() const { return m_records; }
+
+    /// The wall-clock time to evaluate the records, and the time to evaluate
+    /// each record, in nanoseconds.
+    struct ReplayTimes {
+        long long duration = 0;
+        std::vector<long long> latencies;
+    };
+    /// Evaluate the callbacks of each record with the given problem, which
+    /// must have the same variables and goals as the problem that recorded
+    /// the trace. The records are distributed across numThreads threads; for
+    /// the threads to evaluate in parallel, the problem needs at least this
+    /// many MocoProblemRep%s (see MocoCasOCProblem::getJarSize()).
+    ReplayTimes replay(const CasOC::Problem& problem, int numThreads) const;
+
+private:
+    int m_numStates = 0;
+    int m_numControls = 0;
+    int m_numMultipliers = 0;
+    int m_numDerivatives = 0;
+    int m_numParameters = 0;
+    std::vector<Record> m_records;
+};
+
+/// Write the inputs of the callbacks of a problem to a MocoCasOCTrace file as
+/// the callbacks are evaluated. Records may be written from multiple threads.
+class MocoCasOCTraceWriter {
+public:
+    MocoCasOCTraceWriter(
+            const std::string& fileName, const CasOC::Problem& problem);
+    void record(MocoCasOCTrace::Callback callback, int index,
+            const CasOC::Problem::ContinuousInput& input);
+
+private:
+    std::mutex m_mutex;
+    std::ofstream m_stream;
+};
+
+} // namespace OpenSim
+
+#endif // MOCO_MOCOCASOCTRACE_H
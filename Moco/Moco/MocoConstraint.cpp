@@ -137,6 +137,7 @@ void MocoPathConstraint::initializeOnModel(const Model& model,
         const int& pathConstraintIndex) const {
 
     m_model.reset(&model);
+    m_stageDependency = SimTK::Stage::Acceleration;
     initializeOnModelImpl(model, problemInfo);
 
     OPENSIM_THROW_IF_FRMOBJ(get_MocoConstraintInfo().getNumEquations() < 0,
@@ -170,6 +170,15 @@ public:
         return m_path_constraint_index;
     }
 
+    /// Obtain the stage that this path constraint depends on. Solvers can use
+    /// this to avoid preparing the state beyond what calcPathConstraintErrors()
+    /// needs. The stages have the same meaning as for MocoGoal (see the
+    /// MocoGoal class description); for example, a constraint that depends
+    /// only on controls has a stage dependency of SimTK::Stage::Velocity (the
+    /// stage at which Model::getControls() is available), and a constraint on
+    /// positions has a stage dependency of SimTK::Stage::Position.
+    SimTK::Stage getStageDependency() const { return m_stageDependency; }
+
     /// Calculate errors in the path constraint equations. The *errors* argument
     /// represents the concatenated error vector for all path constraints in the
     /// MocoProblem. This method creates a view into *errors* to access the
@@ -184,7 +193,20 @@ public:
         SimTK::Vector theseErrors(getConstraintInfo().getNumEquations(),
                 errors.updContiguousScalarData() + getPathConstraintIndex(),
                 true);
+        const SimTK::Stage stageBefore = state.getSystemStage();
+
         calcPathConstraintErrorsImpl(state, theseErrors);
+
+        if (state.getSystemStage() > stageBefore) {
+            SimTK_ERRCHK2_ALWAYS(state.getSystemStage() <= m_stageDependency,
+                    (getConcreteClassName() + "::calcPathConstraintErrors()")
+                            .c_str(),
+                    "This path constraint has a stage dependency of %s, but "
+                    "calcPathConstraintErrorsImpl() exceeded this stage by "
+                    "realizing to %s.",
+                    m_stageDependency.getName().c_str(),
+                    state.getSystemStage().getName().c_str());
+        }
     }
 
     /// For use by solvers. This also performs error checks on the Problem.
@@ -215,7 +237,20 @@ protected:
                 ->updConstraintInfo()
                 .setNumEquations(numEqs);
     }
-    /// @precondition The state is realized to SimTK::Stage::Position.
+    /// Set the stage that this path constraint depends on; invoke this within
+    /// initializeOnModelImpl(). The stage dependency can be set to lower
+    /// stages to avoid unnecessary calculations. If you are not sure what
+    /// your stage dependency is, leave it as SimTK::Stage::Acceleration (the
+    /// default) to be safe.
+    ///
+    /// You must still realize to the appropriate stage within
+    /// calcPathConstraintErrorsImpl(), and you must not realize beyond the
+    /// stage dependency.
+    void setStageDependency(SimTK::Stage stageDependency) const {
+        m_stageDependency = stageDependency;
+    }
+    /// The state variables, time, and controls are set in the state; the
+    /// state is not necessarily realized to any stage.
     /// If you need access to the controls, you must realize to Velocity:
     /// @code
     /// getModel().realizeVelocity(state);
@@ -234,6 +269,7 @@ private:
 
     mutable SimTK::ReferencePtr<const Model> m_model;
     mutable int m_path_constraint_index = -1;
+    mutable SimTK::Stage m_stageDependency = SimTK::Stage::Acceleration;
 };
 
 } // namespace OpenSim
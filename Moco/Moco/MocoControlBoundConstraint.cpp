@@ -97,6 +97,7 @@ void MocoControlBoundConstraint::initializeOnModelImpl(
     }
 
     setNumEquations(numEqsPerControl * (int)m_controlIndices.size());
+    setStageDependency(SimTK::Stage::Velocity);
 
     // TODO: setConstraintInfo() is not really intended for use here.
     MocoConstraintInfo info;
@@ -34,6 +34,10 @@ class MocoProblemInfo;
 /// possible time range in the problem (using the problem's time bounds). We do
 /// not perform such a check for other types of functions.
 ///
+/// MocoCasADiSolver evaluates this constraint symbolically (without invoking
+/// calcPathConstraintErrors()) if each bound is a Constant or a
+/// LinearFunction.
+///
 /// @note If you omit the lower and upper bounds, then this class will not
 /// constrain any control signals, even if you have provided control paths.
 ///
@@ -119,9 +119,10 @@ public:
             "Tolerance used to determine if the constraints are satisfied "
             "(-1 for solver's default)");
     OpenSim_DECLARE_PROPERTY(optim_hessian_approximation, std::string,
-            "When using IPOPT, 'limited-memory' (default) for quasi-Newton, or "
-            "'exact' for full "
-            "Newton.");
+            "When using IPOPT, 'limited-memory' (default) for quasi-Newton, "
+            "'exact' for full Newton, or 'gauss-newton' (MocoCasADiSolver "
+            "only) to approximate the Hessian of least-squares goals with "
+            "the Jacobian of their residuals.");
     OpenSim_DECLARE_PROPERTY(optim_ipopt_print_level, int,
             "IPOPT's verbosity (see IPOPT documentation).");
     OpenSim_DECLARE_OPTIONAL_PROPERTY(enforce_constraint_derivatives, bool,
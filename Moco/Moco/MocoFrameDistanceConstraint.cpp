@@ -107,6 +107,7 @@ void MocoFrameDistanceConstraint::initializeOnModelImpl(
     }
 
     setNumEquations(nFramePairs);
+    setStageDependency(SimTK::Stage::Position);
     info.setBounds(bounds);
     const_cast<MocoFrameDistanceConstraint*>(this)->setConstraintInfo(info);
 }
@@ -182,6 +182,7 @@ void MocoContactTrackingGoal::initializeOnModelImpl(const Model& model) const {
     }
 
     setRequirements(1, 1, SimTK::Stage::Velocity);
+    setIntegrandResiduals(3 * (int)m_groups.size(), 1.0 / m_denominator);
 }
 
 int MocoContactTrackingGoal::findRecordOffset(
@@ -237,6 +238,46 @@ int MocoContactTrackingGoal::findRecordOffset(
             halfSpaceBaseName, appliedToBody, group.get_external_force_name());
 }
 
+SimTK::Vec3 MocoContactTrackingGoal::calcContactForceError(
+        const SimTK::State& state, const SimTK::Vector& timeVec,
+        const GroupInfo& group) const {
+    // Model force.
+    SimTK::Vec3 force_model(0);
+    for (const auto& entry : group.contacts) {
+        Array<double> recordValues = entry.first->getRecordValues(state);
+        const auto& recordOffset = entry.second;
+        for (int im = 0; im < force_model.size(); ++im) {
+            force_model[im] += recordValues[recordOffset + im];
+        }
+    }
+
+    // Reference force.
+    SimTK::Vec3 force_ref;
+    for (int ir = 0; ir < force_ref.size(); ++ir) {
+        force_ref[ir] = group.refSplines[ir].calcValue(timeVec);
+    }
+
+    // Re-express the reference force.
+    if (group.refExpressedInFrame) {
+        group.refExpressedInFrame->expressVectorInGround(state, force_ref);
+    }
+
+    SimTK::Vec3 error3D = force_model - force_ref;
+
+    // Project the error.
+    SimTK::Vec3 error;
+    if (m_projectionType == ProjectionType::None) {
+        error = error3D;
+    } else if (m_projectionType == ProjectionType::Vector) {
+        error = SimTK::dot(error3D, m_projectionVector) *
+                m_projectionVector;
+    } else {
+        error = error3D - SimTK::dot(error3D, m_projectionVector) *
+                                  m_projectionVector;
+    }
+    return error;
+}
+
 void MocoContactTrackingGoal::calcIntegrandImpl(
         const IntegrandInput& input, double& integrand) const {
     const auto& state = input.state;
@@ -245,44 +286,21 @@ void MocoContactTrackingGoal::calcIntegrandImpl(
     SimTK::Vector timeVec(1, time);
 
     integrand = 0;
-    SimTK::Vec3 force_ref;
     for (const auto& group : m_groups) {
+        integrand += calcContactForceError(state, timeVec, group).normSqr();
+    }
+}
 
-        // Model force.
-        SimTK::Vec3 force_model(0);
-        for (const auto& entry : group.contacts) {
-            Array<double> recordValues = entry.first->getRecordValues(state);
-            const auto& recordOffset = entry.second;
-            for (int im = 0; im < force_model.size(); ++im) {
-                force_model[im] += recordValues[recordOffset + im];
-            }
-        }
-
-        // Reference force.
-        for (int ir = 0; ir < force_ref.size(); ++ir) {
-            force_ref[ir] = group.refSplines[ir].calcValue(timeVec);
-        }
-
-        // Re-express the reference force.
-        if (group.refExpressedInFrame) {
-            group.refExpressedInFrame->expressVectorInGround(state, force_ref);
-        }
-
-        SimTK::Vec3 error3D = force_model - force_ref;
-
-        // Project the error.
-        SimTK::Vec3 error;
-        if (m_projectionType == ProjectionType::None) {
-            error = error3D;
-        } else if (m_projectionType == ProjectionType::Vector) {
-            error = SimTK::dot(error3D, m_projectionVector) *
-                    m_projectionVector;
-        } else {
-            error = error3D - SimTK::dot(error3D, m_projectionVector) *
-                                      m_projectionVector;
-        }
+void MocoContactTrackingGoal::calcIntegrandResidualsImpl(
+        const IntegrandInput& input, SimTK::Vector& residuals) const {
+    const auto& state = input.state;
+    getModel().realizeVelocity(state);
+    SimTK::Vector timeVec(1, state.getTime());
 
-        integrand += error.normSqr();
+    for (int ig = 0; ig < (int)m_groups.size(); ++ig) {
+        const SimTK::Vec3 error =
+                calcContactForceError(state, timeVec, m_groups[ig]);
+        for (int i = 0; i < 3; ++i) residuals[3 * ig + i] = error[i];
     }
 }
 
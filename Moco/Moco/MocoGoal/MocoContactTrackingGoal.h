@@ -217,6 +217,8 @@ protected:
     void initializeOnModelImpl(const Model&) const override;
     void calcIntegrandImpl(
             const IntegrandInput& input, double& integrand) const override;
+    void calcIntegrandResidualsImpl(const IntegrandInput& input,
+            SimTK::Vector& residuals) const override;
     void calcGoalImpl(
             const GoalInput& input, SimTK::Vector& cost) const override {
         cost[0] = input.integral / m_denominator;
@@ -268,6 +270,11 @@ private:
         const PhysicalFrame* refExpressedInFrame = nullptr;
     };
     mutable std::vector<GroupInfo> m_groups;
+
+    /// The (projected) difference between the model and reference forces for
+    /// a contact group.
+    SimTK::Vec3 calcContactForceError(const SimTK::State& state,
+            const SimTK::Vector& timeVec, const GroupInfo& group) const;
 };
 
 } // namespace OpenSim
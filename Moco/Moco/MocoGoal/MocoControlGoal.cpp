@@ -116,6 +116,12 @@ void MocoControlGoal::initializeOnModelImpl(const Model& model) const {
     setRequirements(1, 1,
             get_divide_by_displacement() ? SimTK::Stage::Position
                                          : SimTK::Stage::Model);
+    // With an exponent of 2, the integrand is a sum of squares. Dividing by
+    // displacement makes the goal depend on more than the integral.
+    if (exponent == 2 && !get_divide_by_displacement()) {
+        setWeightedIntegrandResiduals(
+                (int)m_controlIndices.size(), m_weights);
+    }
 }
 
 void MocoControlGoal::calcIntegrandImpl(
@@ -130,6 +136,14 @@ void MocoControlGoal::calcIntegrandImpl(
     }
 }
 
+void MocoControlGoal::calcIntegrandResidualsImpl(
+        const IntegrandInput& input, SimTK::Vector& residuals) const {
+    for (int i = 0; i < (int)m_controlIndices.size(); ++i) {
+        residuals[i] = std::sqrt(m_weights[i]) *
+                       input.controls[m_controlIndices[i]];
+    }
+}
+
 void MocoControlGoal::calcGoalImpl(
         const GoalInput& input, SimTK::Vector& cost) const {
     cost[0] = input.integral;
@@ -97,6 +97,8 @@ protected:
     void initializeOnModelImpl(const Model&) const override;
     void calcIntegrandImpl(
             const IntegrandInput& input, SimTK::Real& integrand) const override;
+    void calcIntegrandResidualsImpl(const IntegrandInput& input,
+            SimTK::Vector& residuals) const override;
     void calcGoalImpl(
             const GoalInput& input, SimTK::Vector& cost) const override;
     void printDescriptionImpl() const override;
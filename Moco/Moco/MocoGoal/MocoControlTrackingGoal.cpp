@@ -141,6 +141,8 @@ void MocoControlTrackingGoal::initializeOnModelImpl(const Model& model) const {
     }
 
     setRequirements(1, 1, SimTK::Stage::Model);
+    setWeightedIntegrandResiduals(
+            (int)m_control_indices.size(), m_control_weights);
 }
 
 void MocoControlTrackingGoal::calcIntegrandImpl(
@@ -159,6 +161,18 @@ void MocoControlTrackingGoal::calcIntegrandImpl(
     }
 }
 
+void MocoControlTrackingGoal::calcIntegrandResidualsImpl(
+        const IntegrandInput& input, SimTK::Vector& residuals) const {
+    SimTK::Vector timeVec(1, input.time);
+    for (int i = 0; i < (int)m_control_indices.size(); ++i) {
+        const auto& modelValue = input.controls[m_control_indices[i]];
+        const auto& refValue =
+                m_ref_splines[m_ref_indices[i]].calcValue(timeVec);
+        residuals[i] =
+                std::sqrt(m_control_weights[i]) * (modelValue - refValue);
+    }
+}
+
 void MocoControlTrackingGoal::printDescriptionImpl() const {
     for (int i = 0; i < (int)m_control_names.size(); i++) {
         log_cout("        control: {}, reference label: {}, weight: {}",
@@ -208,6 +208,8 @@ protected:
     void initializeOnModelImpl(const Model& model) const override;
     void calcIntegrandImpl(
             const IntegrandInput& input, SimTK::Real& integrand) const override;
+    void calcIntegrandResidualsImpl(const IntegrandInput& input,
+            SimTK::Vector& residuals) const override;
     void calcGoalImpl(
             const GoalInput& input, SimTK::Vector& cost) const override {
         cost[0] = input.integral;
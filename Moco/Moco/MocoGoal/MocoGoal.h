@@ -196,6 +196,29 @@ public:
         return integrand;
     }
 
+    /// Get the number of residuals provided by calcIntegrandResiduals(), or 0
+    /// if this goal does not provide residuals.
+    /// @precondition This goal must be initialized.
+    int getNumIntegrandResiduals() const { return m_numIntegrandResiduals; }
+    /// Some goals are least-squares goals: the integrand is the sum of squares
+    /// of a vector of residuals, and the goal (in cost mode) is
+    /// getResidualCostScale() times the integral. Solvers can use the
+    /// residuals to approximate the Hessian of the goal from first derivatives
+    /// (Gauss-Newton). The length of `residuals` is getNumIntegrandResiduals().
+    void calcIntegrandResiduals(
+            const IntegrandInput& input, SimTK::Vector& residuals) const {
+        residuals.resize(getNumIntegrandResiduals());
+        residuals = 0;
+        if (!get_enabled()) { return; }
+        calcIntegrandResidualsImpl(input, residuals);
+    }
+    /// The factor (including the weight) that relates the integral of the
+    /// squared residuals to the value of this goal in cost mode.
+    /// @precondition This goal must be initialized.
+    double getResidualCostScale() const {
+        return m_weightToUse * m_residualIntegralScale;
+    }
+
     /// @see IntegrandInput.
     struct GoalInput {
         const SimTK::Real& initial_time;
@@ -264,6 +287,7 @@ public:
                 Exception,
                 "Endpoint constraint mode not supported by this goal.");
         m_modeToUse = mode;
+        m_numIntegrandResiduals = 0;
         if (m_modeToUse == Mode::EndpointConstraint) {
             m_weightToUse = 1;
         } else {
@@ -320,6 +344,30 @@ protected:
         m_stageDependency = stageDependency;
     }
 
+    /// Least-squares goals invoke this within initializeOnModelImpl() to
+    /// declare that the integrand is the sum of squares of `numResiduals`
+    /// residuals (see calcIntegrandResidualsImpl()). calcGoalImpl() must
+    /// return `integralScale` times the integral.
+    void setIntegrandResiduals(int numResiduals,
+            double integralScale = 1) const {
+        OPENSIM_THROW_IF(numResiduals < 0, Exception,
+                "Number of residuals must be non-negative.");
+        m_numIntegrandResiduals = numResiduals;
+        m_residualIntegralScale = integralScale;
+    }
+    /// Goals whose residuals are the errors multiplied by the square roots of
+    /// `weights` invoke this instead of setIntegrandResiduals(). The residuals
+    /// are not declared if any weight is negative, as such a goal is not a sum
+    /// of squares.
+    template <typename Weights>
+    void setWeightedIntegrandResiduals(int numResiduals, const Weights& weights,
+            double integralScale = 1) const {
+        for (const auto& weight : weights) {
+            if (weight < 0) return;
+        }
+        setIntegrandResiduals(numResiduals, integralScale);
+    }
+
     virtual Mode getDefaultModeImpl() const { return Mode::Cost; }
     virtual bool getSupportsEndpointConstraintImpl() const { return false; }
     /// You may need to realize the state to the stage required for your
@@ -329,6 +377,10 @@ protected:
     /// The Lagrange multipliers for kinematic constraints are not available.
     virtual void calcIntegrandImpl(
             const IntegrandInput& input, SimTK::Real& integrand) const;
+    /// If the goal invokes setIntegrandResiduals(), this must compute residuals
+    /// whose sum of squares is the integrand.
+    virtual void calcIntegrandResidualsImpl(
+            const IntegrandInput& input, SimTK::Vector& residuals) const;
     /// You may need to realize the state to the stage required for your
     /// calculations.
     /// Do NOT realize to a stage higher than the goal's stage dependency;
@@ -377,11 +429,20 @@ private:
     mutable Mode m_modeToUse;
     mutable SimTK::Stage m_stageDependency = SimTK::Stage::Acceleration;
     mutable int m_numIntegrals = -1;
+    mutable int m_numIntegrandResiduals = 0;
+    mutable double m_residualIntegralScale = 1;
 };
 
 inline void MocoGoal::calcIntegrandImpl(
         const IntegrandInput&, SimTK::Real&) const {}
 
+inline void MocoGoal::calcIntegrandResidualsImpl(
+        const IntegrandInput&, SimTK::Vector&) const {
+    OPENSIM_THROW_FRMOBJ(Exception,
+            "This goal declared integrand residuals but does not implement "
+            "calcIntegrandResidualsImpl().");
+}
+
 /// Endpoint cost for final time.
 /// @ingroup mocogoal
 class OSIMMOCO_API MocoFinalTimeGoal : public MocoGoal {
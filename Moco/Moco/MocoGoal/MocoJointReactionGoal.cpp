@@ -41,6 +41,13 @@ void MocoJointReactionGoal::initializeOnModelImpl(const Model& model) const {
             "Expected a joint path, but property joint_path is empty.");
     m_joint = &model.getComponent<Joint>(get_joint_path());
 
+    // Share the reaction loads computed for all joints with other goals.
+    m_jointReactions.reset();
+    for (const auto& comp : model.getComponentList<JointReactions>()) {
+        m_jointReactions.reset(&comp);
+        break;
+    }
+
     m_denominator = model.getTotalMass(model.getWorkingState());
     const double gravityAccelMagnitude = model.get_gravity().norm();
     if (gravityAccelMagnitude > SimTK::SignificantReal) {
@@ -122,7 +129,15 @@ void MocoJointReactionGoal::calcIntegrandImpl(
 
     // Compute the reaction loads on the parent or child frame.
     SimTK::SpatialVec reactionInGround;
-    if (m_isParentFrame) {
+    if (m_jointReactions && m_isParentFrame) {
+        reactionInGround =
+                m_jointReactions->calcReactionOnParentExpressedInGround(
+                        input.state, *m_joint);
+    } else if (m_jointReactions) {
+        reactionInGround =
+                m_jointReactions->calcReactionOnChildExpressedInGround(
+                        input.state, *m_joint);
+    } else if (m_isParentFrame) {
         reactionInGround =
                 m_joint->calcReactionOnParentExpressedInGround(input.state);
     } else {
@@ -18,6 +18,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 
+#include "../Components/JointReactions.h"
 #include "../MocoWeightSet.h"
 #include "MocoGoal.h"
 
@@ -47,7 +48,10 @@ namespace OpenSim {
 /// cost->setReactionMeasures({"force-y"});
 /// @endcode
 ///
-/// This cost requires realizing to the Acceleration stage.
+/// This cost requires realizing to the Acceleration stage. The reaction loads
+/// are read from the model's JointReactions component (if any), so that
+/// multiple joint reaction goals share a single computation of the loads for
+/// each state.
 /// @ingroup mocogoal
 class OSIMMOCO_API MocoJointReactionGoal : public MocoGoal {
 OpenSim_DECLARE_CONCRETE_OBJECT(MocoJointReactionGoal, MocoGoal);
@@ -132,6 +136,8 @@ private:
 
     mutable double m_denominator;
     mutable SimTK::ReferencePtr<const Joint> m_joint;
+    // Null if the model does not contain a JointReactions component.
+    mutable SimTK::ReferencePtr<const JointReactions> m_jointReactions;
     mutable SimTK::ReferencePtr<const Frame> m_frame;
     mutable std::vector<std::pair<int, int>> m_measureIndices;
     mutable std::vector<double> m_measureWeights;
@@ -80,6 +80,8 @@ void MocoMarkerTrackingGoal::initializeOnModelImpl(const Model& model) const {
             GCVSplineSet(get_markers_reference().getMarkerTable().flatten());
 
     setRequirements(1, 1, SimTK::Stage::Position);
+    setWeightedIntegrandResiduals(
+            3 * (int)m_model_markers.size(), m_marker_weights);
 }
 
 void MocoMarkerTrackingGoal::calcIntegrandImpl(
@@ -106,6 +108,24 @@ void MocoMarkerTrackingGoal::calcIntegrandImpl(
     }
 }
 
+void MocoMarkerTrackingGoal::calcIntegrandResidualsImpl(
+        const IntegrandInput& input, SimTK::Vector& residuals) const {
+    getModel().realizePosition(input.state);
+    SimTK::Vector timeVec(1, input.state.getTime());
+
+    for (int i = 0; i < (int)m_model_markers.size(); ++i) {
+        const auto& modelValue =
+                m_model_markers[i]->getLocationInGround(input.state);
+        const int refidx = m_refindices[i];
+        const double sqrtWeight = std::sqrt(m_marker_weights[refidx]);
+        for (int ic = 0; ic < 3; ++ic) {
+            const double refValue =
+                    m_refsplines[3 * refidx + ic].calcValue(timeVec);
+            residuals[3 * i + ic] = sqrtWeight * (modelValue[ic] - refValue);
+        }
+    }
+}
+
 void MocoMarkerTrackingGoal::printDescriptionImpl() const {
     log_cout(
             "        allow unused references: ", get_allow_unused_references());
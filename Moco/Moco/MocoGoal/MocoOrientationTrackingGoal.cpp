@@ -164,6 +164,37 @@ void MocoOrientationTrackingGoal::initializeOnModelImpl(const Model& model)
     m_ref_splines = GCVSplineSet(flatTable);
 
     setRequirements(1, 1, SimTK::Stage::Position);
+    setWeightedIntegrandResiduals(
+            (int)m_model_frames.size(), m_rotation_weights);
+}
+
+double MocoOrientationTrackingGoal::calcRotationErrorAngle(
+        const SimTK::State& state, const SimTK::Vector& timeVec,
+        int iframe) const {
+    // Rotation frame symbols: 
+    //  G - ground
+    //  D - data (reference)
+    //  M - model
+    const auto& R_GM = m_model_frames[iframe]->getRotationInGround(state);
+
+    // Construct a new quaternion object from the splined quaternion data.
+    // This constructor normalizes the provided values to ensure that a 
+    // valid unit quaternion is created. Other approaches, such as the 
+    // Slerp algorithm (https://en.wikipedia.org/wiki/Slerp) may also be
+    // valid. However, ensuring that the normalization step is included
+    // seems to be sufficient for the purposes of this cost. 
+    // https://keithmaggio.wordpress.com/2011/02/15/math-magician-lerp-slerp-and-nlerp/
+    const SimTK::Quaternion e(
+        m_ref_splines[4*iframe].calcValue(timeVec),
+        m_ref_splines[4*iframe + 1].calcValue(timeVec),
+        m_ref_splines[4*iframe + 2].calcValue(timeVec),
+        m_ref_splines[4*iframe + 3].calcValue(timeVec));
+    // Construct a Rotation object from which we'll calcuation an angle-axis 
+    // representation of the current orientation error.
+    const Rotation R_GD(e);
+    const Rotation R_MD = ~R_GM*R_GD;
+    const SimTK::Vec4 aa_MD = R_MD.convertRotationToAngleAxis();
+    return aa_MD[0];
 }
 
 void MocoOrientationTrackingGoal::calcIntegrandImpl(
@@ -172,36 +203,23 @@ void MocoOrientationTrackingGoal::calcIntegrandImpl(
     getModel().realizePosition(input.state);
     SimTK::Vector timeVec(1, time);
 
-    // Rotation frame symbols: 
-    //  G - ground
-    //  D - data (reference)
-    //  M - model
     integrand = 0;
     for (int iframe = 0; iframe < (int)m_model_frames.size(); ++iframe) {
-        const auto& R_GM =
-            m_model_frames[iframe]->getRotationInGround(input.state);
-
-        // Construct a new quaternion object from the splined quaternion data.
-        // This constructor normalizes the provided values to ensure that a 
-        // valid unit quaternion is created. Other approaches, such as the 
-        // Slerp algorithm (https://en.wikipedia.org/wiki/Slerp) may also be
-        // valid. However, ensuring that the normalization step is included
-        // seems to be sufficient for the purposes of this cost. 
-        // https://keithmaggio.wordpress.com/2011/02/15/math-magician-lerp-slerp-and-nlerp/
-        const SimTK::Quaternion e(
-            m_ref_splines[4*iframe].calcValue(timeVec),
-            m_ref_splines[4*iframe + 1].calcValue(timeVec),
-            m_ref_splines[4*iframe + 2].calcValue(timeVec),
-            m_ref_splines[4*iframe + 3].calcValue(timeVec));
-        // Construct a Rotation object from which we'll calcuation an angle-axis 
-        // representation of the current orientation error.
-        const Rotation R_GD(e);
-        const Rotation R_MD = ~R_GM*R_GD;
-        const SimTK::Vec4 aa_MD = R_MD.convertRotationToAngleAxis();
-
         // Add this frame's rotation error to the integrand.
         const double& weight = m_rotation_weights[iframe];
-        integrand += weight * SimTK::square(aa_MD[0]);
+        integrand += weight * SimTK::square(
+                calcRotationErrorAngle(input.state, timeVec, iframe));
+    }
+}
+
+void MocoOrientationTrackingGoal::calcIntegrandResidualsImpl(
+        const IntegrandInput& input, SimTK::Vector& residuals) const {
+    getModel().realizePosition(input.state);
+    SimTK::Vector timeVec(1, input.state.getTime());
+
+    for (int iframe = 0; iframe < (int)m_model_frames.size(); ++iframe) {
+        residuals[iframe] = std::sqrt(m_rotation_weights[iframe]) *
+                calcRotationErrorAngle(input.state, timeVec, iframe);
     }
 }
 
@@ -139,6 +139,8 @@ protected:
     void initializeOnModelImpl(const Model& model) const override;
     void calcIntegrandImpl(
             const IntegrandInput& input, SimTK::Real& integrand) const override;
+    void calcIntegrandResidualsImpl(const IntegrandInput& input,
+            SimTK::Vector& residuals) const override;
     void calcGoalImpl(
             const GoalInput& input, SimTK::Vector& cost) const override {
         cost[0] = input.integral;
@@ -164,6 +166,10 @@ private:
             "individual "
             "frames' rotations in the cost.");
 
+    /// The angle of the rotation from the model frame to the reference.
+    double calcRotationErrorAngle(const SimTK::State& state,
+            const SimTK::Vector& timeVec, int iframe) const;
+
     void constructProperties() {
         constructProperty_states_reference(TableProcessor());
         constructProperty_rotation_reference_file("");
@@ -27,7 +27,14 @@ using namespace OpenSim;
 void MocoStateTrackingGoal::initializeOnModelImpl(const Model& model) const {
 
     // TODO: set relativeToDirectory properly.
-    TimeSeriesTable tableToUse = get_reference().process("", &model);
+    // Unless unused references are an error, we only need the columns for
+    // states in the model.
+    std::vector<std::string> columnLabels;
+    if (get_allow_unused_references()) {
+        columnLabels = createStateVariableNamesInSystemOrder(model);
+    }
+    TimeSeriesTable tableToUse =
+            get_reference().process("", &model, columnLabels);
 
     auto allSplines = GCVSplineSet(tableToUse);
 
@@ -98,6 +105,7 @@ void MocoStateTrackingGoal::initializeOnModelImpl(const Model& model) const {
     }
 
     setRequirements(1, 1, SimTK::Stage::Time);
+    setWeightedIntegrandResiduals(m_refsplines.getSize(), m_state_weights);
 }
 
 void MocoStateTrackingGoal::calcIntegrandImpl(
@@ -116,6 +124,17 @@ void MocoStateTrackingGoal::calcIntegrandImpl(
     }
 }
 
+void MocoStateTrackingGoal::calcIntegrandResidualsImpl(
+        const IntegrandInput& input, SimTK::Vector& residuals) const {
+    SimTK::Vector timeVec(1, input.time);
+    for (int iref = 0; iref < m_refsplines.getSize(); ++iref) {
+        const auto& modelValue = input.state.getY()[m_sysYIndices[iref]];
+        const auto& refValue = m_refsplines[iref].calcValue(timeVec);
+        residuals[iref] = std::sqrt(m_state_weights[iref]) *
+                          (modelValue - refValue);
+    }
+}
+
 void MocoStateTrackingGoal::printDescriptionImpl() const {
     for (int i = 0; i < (int) m_state_names.size(); i++) {
         log_cout("        state: {}, weight: {}", m_state_names[i],
@@ -132,6 +132,8 @@ void MocoTranslationTrackingGoal::initializeOnModelImpl(const Model& model)
         {"/position_x", "/position_y", "/position_z"}));
 
     setRequirements(1, 1, SimTK::Stage::Position);
+    setWeightedIntegrandResiduals(
+            3 * (int)m_model_frames.size(), m_translation_weights);
 }
 
 void MocoTranslationTrackingGoal::calcIntegrandImpl(
@@ -160,6 +162,24 @@ void MocoTranslationTrackingGoal::calcIntegrandImpl(
     }
 }
 
+void MocoTranslationTrackingGoal::calcIntegrandResidualsImpl(
+        const IntegrandInput& input, SimTK::Vector& residuals) const {
+    getModel().realizePosition(input.state);
+    SimTK::Vector timeVec(1, input.state.getTime());
+
+    for (int iframe = 0; iframe < (int)m_model_frames.size(); ++iframe) {
+        const auto& position_model =
+            m_model_frames[iframe]->getPositionInGround(input.state);
+        const double sqrtWeight = std::sqrt(m_translation_weights[iframe]);
+        for (int ip = 0; ip < 3; ++ip) {
+            const double position_ref =
+                    m_ref_splines[3*iframe + ip].calcValue(timeVec);
+            residuals[3*iframe + ip] =
+                    sqrtWeight * (position_model[ip] - position_ref);
+        }
+    }
+}
+
 void MocoTranslationTrackingGoal::printDescriptionImpl() const {
     log_cout("        translation reference file: {}",
              get_translation_reference_file());
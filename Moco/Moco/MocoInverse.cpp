@@ -50,8 +50,21 @@ std::pair<MocoStudy, TimeSeriesTable> MocoInverse::initializeInternal() const {
     Model model = get_model().process(getDocumentDirectory());
     model.initSystem();
 
-    TimeSeriesTable kinematics =
-            get_kinematics().process(getDocumentDirectory(), &model);
+    // If extra columns are allowed, we only need the columns for coordinates
+    // (labeled with state paths or with pre-4.0 state names). We keep all
+    // rows, since the kinematics are splined.
+    std::vector<std::string> columnLabels;
+    if (get_kinematics_allow_extra_columns()) {
+        for (const auto& coord : model.getComponentList<Coordinate>()) {
+            const auto path = coord.getAbsolutePathString();
+            columnLabels.push_back(path + "/value");
+            columnLabels.push_back(path + "/speed");
+            columnLabels.push_back(coord.getName());
+            columnLabels.push_back(coord.getName() + "_u");
+        }
+    }
+    TimeSeriesTable kinematics = get_kinematics().process(
+            getDocumentDirectory(), &model, columnLabels);
 
     // Prescribe the kinematics.
     // -------------------------
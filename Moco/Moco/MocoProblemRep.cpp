@@ -21,12 +21,20 @@
 #include "Components/AccelerationMotion.h"
 #include "Components/DiscreteController.h"
 #include "Components/DiscreteForces.h"
+#include "Components/JointReactions.h"
+#include "MocoGoal/MocoJointReactionGoal.h"
+#include "Components/ModelFactory.h"
 #include "Components/PositionMotion.h"
 #include "MocoProblem.h"
 #include "MocoProblemInfo.h"
 #include <regex>
+#include <set>
 #include <unordered_set>
 
+#include <OpenSim/Actuators/CoordinateActuator.h>
+#include <OpenSim/Common/Constant.h>
+#include <OpenSim/Simulation/SimbodyEngine/CoordinateCouplerConstraint.h>
+
 using namespace OpenSim;
 
 MocoProblemRep::MocoProblemRep(const MocoProblem& problem)
@@ -70,6 +78,29 @@ void MocoProblemRep::initialize() {
 
     m_model_base.finalizeFromProperties();
 
+    // MocoJointReactionGoals share the joint reaction loads cached by this
+    // component. Other models are left unchanged.
+    bool hasJointReactionGoal = false;
+    for (int i = 0; i < ph0.getProperty_goals().size(); ++i) {
+        const auto& goal = ph0.get_goals(i);
+        if (goal.getEnabled() &&
+                dynamic_cast<const MocoJointReactionGoal*>(&goal)) {
+            hasJointReactionGoal = true;
+            break;
+        }
+    }
+    if (hasJointReactionGoal &&
+            !m_model_base.countNumComponents<JointReactions>()) {
+        // Avoid the names of the model's existing components.
+        std::string name = "moco_joint_reactions";
+        for (int i = 1; m_model_base.hasComponent(name); ++i) {
+            name = "moco_joint_reactions_" + std::to_string(i);
+        }
+        m_model_base.addModelComponent(
+                make_unique<JointReactions>(name).release());
+        m_model_base.finalizeFromProperties();
+    }
+
     int countMotion = 0;
     for (const auto& comp : m_model_base.getComponentList<PositionMotion>()) {
         // Next line exists only to avoid an "unused variable" compiler warning.
@@ -529,6 +560,152 @@ void MocoProblemRep::initialize() {
     }
 }
 
+std::unique_ptr<MocoProblemRep> MocoProblemRep::createRepSharingModels(
+        std::shared_ptr<const MocoProblemRep> rep) {
+    if (rep->m_shared_rep) rep = rep->m_shared_rep;
+    OPENSIM_THROW_IF(rep->getNumParameters(), Exception,
+            "Cannot share models among MocoProblemReps if the problem has "
+            "MocoParameters, but the problem has {} parameters.",
+            rep->getNumParameters());
+    std::unique_ptr<MocoProblemRep> out(new MocoProblemRep());
+    out->m_problem = rep->m_problem;
+    out->m_state_base = rep->m_state_base;
+    out->m_state_disabled_constraints = rep->m_state_disabled_constraints;
+    out->m_shared_rep = std::move(rep);
+    return out;
+}
+
+namespace {
+/// Is the coordinate held at a single value by an ideal constraint?
+bool isCoordinateFixed(const Coordinate& coord) {
+    if (coord.get_locked()) return true;
+    return coord.get_prescribed() &&
+           !coord.getProperty_prescribed_function().empty() &&
+           dynamic_cast<const Constant*>(&coord.get_prescribed_function());
+}
+} // namespace
+
+MocoProblemRep::ProblemReduction MocoProblemRep::createReducedProblem(
+        MocoProblem& reducedProblem) const {
+    reducedProblem = *m_problem;
+    ProblemReduction reduction;
+    if (isPrescribedKinematics()) return reduction;
+
+    Model model = m_problem->getPhase(0).getModelProcessor().process();
+    SimTK::State state = model.initSystem();
+    model.realizePosition(state);
+
+    // Coordinates that other components refer to must remain in the model.
+    std::set<std::string> referencedCoordinates;
+    for (const auto& coupler :
+            model.getComponentList<CoordinateCouplerConstraint>()) {
+        referencedCoordinates.insert(coupler.get_dependent_coordinate_name());
+        const auto& independent =
+                coupler.getProperty_independent_coordinate_names();
+        for (int i = 0; i < independent.size(); ++i) {
+            referencedCoordinates.insert(independent[i]);
+        }
+    }
+    for (const auto& actu : model.getComponentList<CoordinateActuator>()) {
+        referencedCoordinates.insert(actu.get_coordinate());
+    }
+
+    // Find the joints to weld and their poses, using the fixed coordinate
+    // values from the assembled default state.
+    std::vector<std::pair<std::string, SimTK::Transform>> welds;
+    std::set<int> weldedBodies;
+    const auto& jointSet = model.getJointSet();
+    for (int ij = 0; ij < jointSet.getSize(); ++ij) {
+        const auto& joint = jointSet.get(ij);
+        if (!joint.numCoordinates()) continue;
+        if (!dynamic_cast<const PhysicalOffsetFrame*>(
+                    &joint.getParentFrame()) ||
+                !dynamic_cast<const PhysicalOffsetFrame*>(
+                        &joint.getChildFrame())) {
+            continue;
+        }
+        bool fixed = true;
+        for (int ic = 0; ic < joint.numCoordinates(); ++ic) {
+            const auto& coord = joint.get_coordinates(ic);
+            if (!isCoordinateFixed(coord) ||
+                    referencedCoordinates.count(coord.getName())) {
+                fixed = false;
+                break;
+            }
+        }
+        if (!fixed) continue;
+
+        reduction.weldedJoints.push_back(joint.getName());
+        welds.emplace_back(joint.getName(),
+                joint.getParentFrame().findTransformBetween(
+                        state, joint.getChildFrame()));
+        for (int ic = 0; ic < joint.numCoordinates(); ++ic) {
+            const auto& coord = joint.get_coordinates(ic);
+            reduction.removedCoordinates.emplace_back(
+                    coord.getAbsolutePathString(), coord.getValue(state));
+            weldedBodies.insert(coord.getBodyIndex());
+        }
+    }
+    if (welds.empty()) return reduction;
+
+    // The constraints that fix the coordinates are PrescribedMotion
+    // constraints on the mobilizers of the welded joints.
+    const auto& matter = getModelBase().getMatterSubsystem();
+    std::vector<std::string> keptMultipliers;
+    for (const auto& kc : owner().m_kinematic_constraints) {
+        const auto& constraint =
+                matter.getConstraint(kc.getSimbodyConstraintIndex());
+        const bool removed =
+                SimTK::Constraint::PrescribedMotion::isInstanceOf(
+                        constraint) &&
+                constraint.getNumConstrainedMobilizers() == 1 &&
+                weldedBodies.count(
+                        constraint
+                                .getMobilizedBodyFromConstrainedMobilizer(
+                                        SimTK::ConstrainedMobilizerIndex(0))
+                                .getMobilizedBodyIndex());
+        for (const auto& info :
+                getMultiplierInfos(kc.getConstraintInfo().getName())) {
+            (removed ? reduction.removedMultipliers : keptMultipliers)
+                    .push_back(info.getName());
+        }
+    }
+
+    for (const auto& weld : welds) {
+        ModelFactory::replaceJointWithWeldJoint(model, weld.first, weld.second);
+    }
+    auto& phase = reducedProblem.updPhase(0);
+    phase.setModelCopy(model);
+
+    std::set<std::string> removedStates;
+    for (const auto& coord : reduction.removedCoordinates) {
+        removedStates.insert(coord.first + "/value");
+        removedStates.insert(coord.first + "/speed");
+    }
+    std::vector<MocoVariableInfo> stateInfos;
+    for (int i = 0; i < phase.getProperty_state_infos().size(); ++i) {
+        if (!removedStates.count(phase.get_state_infos(i).getName())) {
+            stateInfos.push_back(phase.get_state_infos(i));
+        }
+    }
+    phase.updProperty_state_infos().clear();
+    for (const auto& info : stateInfos) phase.append_state_infos(info);
+
+    // Creating the rep checks that the reduced problem is valid.
+    const MocoProblemRep reducedRep = reducedProblem.createRep();
+    const auto reducedMultipliers = reducedRep.createMultiplierInfoNames();
+    OPENSIM_THROW_IF(reducedMultipliers.size() != keptMultipliers.size(),
+            Exception,
+            "Expected the reduced problem to have {} Lagrange multipliers, but "
+            "it has {}.",
+            keptMultipliers.size(), reducedMultipliers.size());
+    for (int i = 0; i < (int)keptMultipliers.size(); ++i) {
+        reduction.reducedMultiplierNames[keptMultipliers[i]] =
+                reducedMultipliers[i];
+    }
+    return reduction;
+}
+
 const std::string& MocoProblemRep::getName() const {
     return m_problem->getName();
 }
@@ -541,9 +718,9 @@ MocoFinalBounds MocoProblemRep::getTimeFinalBounds() const {
 std::vector<std::string> MocoProblemRep::createStateVariableNamesInSystemOrder(
         std::unordered_map<int, int>& yIndexMap) const {
     auto stateNames = OpenSim::createStateVariableNamesInSystemOrder(
-            m_model_base, yIndexMap);
+            owner().m_model_base, yIndexMap);
     auto out = stateNames;
-    if (m_prescribedKinematics) {
+    if (owner().m_prescribedKinematics) {
         for (int i = 0; i < (int)stateNames.size(); ++i) {
             if (endsWith(stateNames[i], "/value") ||
                     endsWith(stateNames[i], "/speed")) {
@@ -554,18 +731,18 @@ std::vector<std::string> MocoProblemRep::createStateVariableNamesInSystemOrder(
     return out;
 }
 std::vector<std::string> MocoProblemRep::createStateInfoNames() const {
-    std::vector<std::string> names(m_state_infos.size());
+    std::vector<std::string> names(owner().m_state_infos.size());
     int i = 0;
-    for (const auto& info : m_state_infos) {
+    for (const auto& info : owner().m_state_infos) {
         names[i] = info.first;
         ++i;
     }
     return names;
 }
 std::vector<std::string> MocoProblemRep::createControlInfoNames() const {
-    std::vector<std::string> names(m_control_infos.size());
+    std::vector<std::string> names(owner().m_control_infos.size());
     int i = 0;
-    for (const auto& info : m_control_infos) {
+    for (const auto& info : owner().m_control_infos) {
         names[i] = info.first;
         ++i;
     }
@@ -573,60 +750,61 @@ std::vector<std::string> MocoProblemRep::createControlInfoNames() const {
 }
 std::vector<std::string> MocoProblemRep::createMultiplierInfoNames() const {
     std::vector<std::string> names;
-    for (const auto& kc : m_kinematic_constraints) {
-        const auto& infos =
-                m_multiplier_infos_map.at(kc.getConstraintInfo().getName());
+    for (const auto& kc : owner().m_kinematic_constraints) {
+        const auto& infos = owner().m_multiplier_infos_map.at(
+                kc.getConstraintInfo().getName());
         for (const auto& info : infos) { names.push_back(info.getName()); }
     }
     return names;
 }
 std::vector<std::string>
 MocoProblemRep::createKinematicConstraintNames() const {
-    std::vector<std::string> names(m_kinematic_constraints.size());
+    const auto& kinematicConstraints = owner().m_kinematic_constraints;
+    std::vector<std::string> names(kinematicConstraints.size());
     // Kinematic constraint names are stored in the internal constraint
     // info.
-    for (int i = 0; i < (int)m_kinematic_constraints.size(); ++i) {
-        names[i] = m_kinematic_constraints[i].getConstraintInfo().getName();
+    for (int i = 0; i < (int)kinematicConstraints.size(); ++i) {
+        names[i] = kinematicConstraints[i].getConstraintInfo().getName();
     }
     return names;
 }
 std::vector<std::string> MocoProblemRep::getKinematicConstraintEquationNames(
         bool includeDerivatives) const {
     if (includeDerivatives)
-        return m_kinematic_constraint_eq_names_with_derivatives;
-    return m_kinematic_constraint_eq_names_without_derivatives;
+        return owner().m_kinematic_constraint_eq_names_with_derivatives;
+    return owner().m_kinematic_constraint_eq_names_without_derivatives;
 }
 std::vector<std::string> MocoProblemRep::createParameterNames() const {
-    std::vector<std::string> names(m_parameters.size());
+    std::vector<std::string> names(owner().m_parameters.size());
     int i = 0;
-    for (const auto& param : m_parameters) {
+    for (const auto& param : owner().m_parameters) {
         names[i] = param->getName();
         ++i;
     }
     return names;
 }
 std::vector<std::string> MocoProblemRep::createCostNames() const {
-    std::vector<std::string> names(m_costs.size());
+    std::vector<std::string> names(owner().m_costs.size());
     int i = 0;
-    for (const auto& cost : m_costs) {
+    for (const auto& cost : owner().m_costs) {
         names[i] = cost->getName();
         ++i;
     }
     return names;
 }
 std::vector<std::string> MocoProblemRep::createEndpointConstraintNames() const {
-    std::vector<std::string> names(m_endpoint_constraints.size());
+    std::vector<std::string> names(owner().m_endpoint_constraints.size());
     int i = 0;
-    for (const auto& endpoint_constraint : m_endpoint_constraints) {
+    for (const auto& endpoint_constraint : owner().m_endpoint_constraints) {
         names[i] = endpoint_constraint->getName();
         ++i;
     }
     return names;
 }
 std::vector<std::string> MocoProblemRep::createPathConstraintNames() const {
-    std::vector<std::string> names(m_path_constraints.size());
+    std::vector<std::string> names(owner().m_path_constraints.size());
     int i = 0;
-    for (const auto& pc : m_path_constraints) {
+    for (const auto& pc : owner().m_path_constraints) {
         names[i] = pc->getName();
         ++i;
     }
@@ -634,64 +812,64 @@ std::vector<std::string> MocoProblemRep::createPathConstraintNames() const {
 }
 const MocoVariableInfo& MocoProblemRep::getStateInfo(
         const std::string& name) const {
-    OPENSIM_THROW_IF(m_state_infos.count(name) == 0, Exception,
+    OPENSIM_THROW_IF(owner().m_state_infos.count(name) == 0, Exception,
             "No info available for state '{}'.", name);
-    return m_state_infos.at(name);
+    return owner().m_state_infos.at(name);
 }
 const MocoVariableInfo& MocoProblemRep::getControlInfo(
         const std::string& name) const {
-    OPENSIM_THROW_IF(m_control_infos.count(name) == 0, Exception,
+    OPENSIM_THROW_IF(owner().m_control_infos.count(name) == 0, Exception,
             "No info available for control '{}'.", name);
-    return m_control_infos.at(name);
+    return owner().m_control_infos.at(name);
 }
 const MocoParameter& MocoProblemRep::getParameter(
         const std::string& name) const {
 
-    for (const auto& param : m_parameters) {
+    for (const auto& param : owner().m_parameters) {
         if (param->getName() == name) { return *param.get(); }
     }
     OPENSIM_THROW(Exception, "No parameter with name '{}' found.", name);
 }
 const MocoGoal& MocoProblemRep::getCost(const std::string& name) const {
 
-    for (const auto& c : m_costs) {
+    for (const auto& c : owner().m_costs) {
         if (c->getName() == name) { return *c.get(); }
     }
     OPENSIM_THROW(Exception, "No cost with name '{}' found.", name);
 }
 const MocoGoal& MocoProblemRep::getCostByIndex(int index) const {
-    return *m_costs[index];
+    return *owner().m_costs[index];
 }
 const MocoGoal& MocoProblemRep::getEndpointConstraint(
         const std::string& name) const {
 
-    for (const auto& c : m_endpoint_constraints) {
+    for (const auto& c : owner().m_endpoint_constraints) {
         if (c->getName() == name) { return *c.get(); }
     }
     OPENSIM_THROW(
             Exception, "No endpoint constraint with name '{}' found.", name);
 }
 const MocoGoal& MocoProblemRep::getEndpointConstraintByIndex(int index) const {
-    return *m_endpoint_constraints[index];
+    return *owner().m_endpoint_constraints[index];
 }
 const MocoPathConstraint& MocoProblemRep::getPathConstraint(
         const std::string& name) const {
 
-    for (const auto& pc : m_path_constraints) {
+    for (const auto& pc : owner().m_path_constraints) {
         if (pc->getName() == name) { return *pc.get(); }
     }
     OPENSIM_THROW(Exception, "No path constraint with name '{}' found.", name);
 }
 const MocoPathConstraint& MocoProblemRep::getPathConstraintByIndex(
         int index) const {
-    return *m_path_constraints[index];
+    return *owner().m_path_constraints[index];
 }
 const MocoKinematicConstraint& MocoProblemRep::getKinematicConstraint(
         const std::string& name) const {
 
     // Kinematic constraint names are stored in the internal constraint
     // info.
-    for (const auto& kc : m_kinematic_constraints) {
+    for (const auto& kc : owner().m_kinematic_constraints) {
         if (kc.getConstraintInfo().getName() == name) { return kc; }
     }
     OPENSIM_THROW(
@@ -700,9 +878,10 @@ const MocoKinematicConstraint& MocoProblemRep::getKinematicConstraint(
 const std::vector<MocoVariableInfo>& MocoProblemRep::getMultiplierInfos(
         const std::string& kinematicConstraintInfoName) const {
 
-    auto search = m_multiplier_infos_map.find(kinematicConstraintInfoName);
-    if (search != m_multiplier_infos_map.end()) {
-        return m_multiplier_infos_map.at(kinematicConstraintInfoName);
+    const auto& multiplierInfosMap = owner().m_multiplier_infos_map;
+    auto search = multiplierInfosMap.find(kinematicConstraintInfoName);
+    if (search != multiplierInfosMap.end()) {
+        return multiplierInfosMap.at(kinematicConstraintInfoName);
     } else {
         OPENSIM_THROW(Exception,
                 "No variable infos for kinematic constraint info with name "
@@ -714,6 +893,9 @@ const std::vector<MocoVariableInfo>& MocoProblemRep::getMultiplierInfos(
 void MocoProblemRep::applyParametersToModelProperties(
         const SimTK::Vector& parameterValues,
         bool initSystemAndDisableConstraints) const {
+    OPENSIM_THROW_IF(m_shared_rep, Exception,
+            "Cannot apply parameters to models that are shared with other "
+            "MocoProblemReps.");
     OPENSIM_THROW_IF(parameterValues.size() != (int)m_parameters.size(),
             Exception,
             "There are {} parameters in this MocoProblem, but {} values were "
@@ -771,6 +953,10 @@ void MocoProblemRep::applyParametersToModelProperties(
 }
 
 void MocoProblemRep::printDescription() const {
+    if (m_shared_rep) {
+        m_shared_rep->printDescription();
+        return;
+    }
 
     auto printHeaderLine = [&](const std::string& label, size_t size) {
         std::stringstream ss;
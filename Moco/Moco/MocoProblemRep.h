@@ -66,13 +66,13 @@ public:
     /// forces and constraint errors (see getModelDisabledConstraints() for more
     /// details). Any parameter updates via a MocoParameter added to the problem
     /// will be applied to this model.
-    const Model& getModelBase() const { return m_model_base; }
+    const Model& getModelBase() const { return owner().m_model_base; }
     /// This is a state object that solvers can use along with ModelBase.
     SimTK::State& updStateBase() const { return m_state_base; }
     /// This is a component inside ModelBase that you can use to
     /// set the value of control signals.
     const DiscreteController& getDiscreteControllerBase() const {
-        return m_discrete_controller_base.getRef();
+        return owner().m_discrete_controller_base.getRef();
     }
     /// Get a reference to a copy of the model being used by this
     /// MocoProblemRep, but with all constraints disabled and an additional
@@ -88,7 +88,7 @@ public:
     /// Any parameter updates via a MocoParameter added to the problem
     /// will be applied to this model.
     const Model& getModelDisabledConstraints() const {
-        return m_model_disabled_constraints;
+        return owner().m_model_disabled_constraints;
     }
     /// This is a state object that solvers can use with
     /// ModelDisabledConstraints. Some solvers may need to use 2 state objects
@@ -100,37 +100,39 @@ public:
     /// This is a component inside ModelDisabledConstraints that you can use to
     /// set the value of control signals.
     const DiscreteController& getDiscreteControllerDisabledConstraints() const {
-        return m_discrete_controller_disabled_constraints.getRef();
+        return owner().m_discrete_controller_disabled_constraints.getRef();
     }
     /// This is a component inside ModelDisabledConstraints that you can use
     /// to set the value of discrete forces, intended to hold the constraint
     /// forces obtained from ModelBase.
     const DiscreteForces& getConstraintForces() const {
-        return m_constraint_forces.getRef();
+        return owner().m_constraint_forces.getRef();
     }
     /// This is a component inside ModelDisabledConstraints that you can use
     /// to set the value of generalized accelerations UDot, for use in
     /// implicit dynamics formulations. The motion is not necessarily enabled.
     const AccelerationMotion& getAccelerationMotion() const {
-        return m_acceleration_motion.getRef();
+        return owner().m_acceleration_motion.getRef();
     }
-    int getNumStates() const { return (int)m_state_infos.size(); }
-    int getNumControls() const { return (int)m_control_infos.size(); }
-    int getNumParameters() const { return (int)m_parameters.size(); }
+    int getNumStates() const { return (int)owner().m_state_infos.size(); }
+    int getNumControls() const { return (int)owner().m_control_infos.size(); }
+    int getNumParameters() const { return (int)owner().m_parameters.size(); }
     /// Get the number of goals in cost mode.
-    int getNumCosts() const { return (int)m_costs.size(); }
+    int getNumCosts() const { return (int)owner().m_costs.size(); }
     /// Get the number of goals in endpoint constraint mode.
     int getNumEndpointConstraints() const {
-        return (int)m_endpoint_constraints.size();
+        return (int)owner().m_endpoint_constraints.size();
     }
     int getNumKinematicConstraints() const {
-        return (int)m_kinematic_constraints.size();
+        return (int)owner().m_kinematic_constraints.size();
     }
     /// Does the model contain a PositionMotion to prescribe all generalized
     /// coordinates, speeds, and accelerations?
-    bool isPrescribedKinematics() const { return m_prescribedKinematics; }
+    bool isPrescribedKinematics() const {
+        return owner().m_prescribedKinematics;
+    }
     int getNumImplicitAuxiliaryResiduals() const {
-        return (int)m_implicit_residual_refs.size();
+        return (int)owner().m_implicit_residual_refs.size();
     }
     /// This excludes generalized coordinate and speed states if
     /// isPrescribedKinematics() is true.
@@ -203,10 +205,11 @@ public:
     /// Get the number of scalar path constraints in the MocoProblem. This does
     /// not include kinematic constraints equations.
     int getNumPathConstraintEquations() const {
-        OPENSIM_THROW_IF(m_num_path_constraint_equations == -1, Exception,
+        OPENSIM_THROW_IF(owner().m_num_path_constraint_equations == -1,
+                Exception,
                 "The number of scalar path constraint equations is not "
                 "available until after initialization.");
-        return m_num_path_constraint_equations;
+        return owner().m_num_path_constraint_equations;
     }
     /// Given a kinematic constraint name, get a vector of MocoVariableInfos
     /// corresponding to the Lagrange multipliers for that kinematic constraint.
@@ -223,10 +226,11 @@ public:
     /// Get the number of scalar kinematic constraints in the MocoProblem. This
     /// does not include path constraints equations.
     int getNumKinematicConstraintEquations() const {
-        OPENSIM_THROW_IF(m_num_kinematic_constraint_equations == -1, Exception,
+        OPENSIM_THROW_IF(owner().m_num_kinematic_constraint_equations == -1,
+                Exception,
                 "The number of scalar kinematic constraint equations is not "
                 "available until after initialization.");
-        return m_num_kinematic_constraint_equations;
+        return owner().m_num_kinematic_constraint_equations;
     }
 
     /// Print a description of this problem, including costs and variable
@@ -249,7 +253,7 @@ public:
                 "number of scalar path constraint equations in this "
                 "MocoProblem.");
 
-        for (const auto& pc : m_path_constraints) {
+        for (const auto& pc : owner().m_path_constraints) {
             pc->calcPathConstraintErrors(state, errors);
         }
     }
@@ -263,14 +267,15 @@ public:
         SimTK::Vector errors(getNumKinematicConstraintEquations(), 0.0);
         int index = 0;
         int thisConstraintNumEquations;
-        for (int i = 0; i < (int)m_kinematic_constraints.size(); ++i) {
-            thisConstraintNumEquations = m_kinematic_constraints[i]
+        const auto& kinematicConstraints = owner().m_kinematic_constraints;
+        for (int i = 0; i < (int)kinematicConstraints.size(); ++i) {
+            thisConstraintNumEquations = kinematicConstraints[i]
                                                  .getConstraintInfo()
                                                  .getNumEquations();
 
             SimTK::Vector theseErrors(thisConstraintNumEquations,
                     errors.getContiguousScalarData() + index, true);
-            m_kinematic_constraints[i].calcKinematicConstraintErrors(
+            kinematicConstraints[i].calcKinematicConstraintErrors(
                     getModelBase(), state, theseErrors);
 
             index += thisConstraintNumEquations;
@@ -296,7 +301,7 @@ public:
     /// getModelDisabledConstraints(). 
     const std::vector<SimTK::ReferencePtr<const Output<double>>>&
     getImplicitResidualReferencePtrs() const {
-        return m_implicit_residual_refs;
+        return owner().m_implicit_residual_refs;
     }
 
     /// Get reference pointers to components that enforce dynamics in implicit 
@@ -305,8 +310,56 @@ public:
     const 
     std::vector<std::pair<std::string, SimTK::ReferencePtr<const Component>>>&
     getImplicitComponentReferencePtrs() const {
-        return m_implicit_component_refs;
+        return owner().m_implicit_component_refs;
     }
+
+    /// Create a MocoProblemRep that uses the models, goals, and constraints
+    /// of `rep` but has its own SimTK::State objects. Solvers can give one
+    /// such MocoProblemRep to each thread so that the threads share a single
+    /// copy of the model. The returned MocoProblemRep keeps `rep` alive.
+    /// The problem must not contain MocoParameter%s, as applying parameters
+    /// would modify the shared models; applyParametersToModelProperties()
+    /// throws an exception on the returned MocoProblemRep.
+    /// The components of the model and the goals and constraints of the
+    /// problem must not store intermediate results outside of the
+    /// SimTK::State, since they are evaluated concurrently.
+    static std::unique_ptr<MocoProblemRep> createRepSharingModels(
+            std::shared_ptr<const MocoProblemRep> rep);
+
+    /// The changes that createReducedProblem() made to the problem, for
+    /// mapping a solution of the reduced problem back to this problem.
+    struct ProblemReduction {
+        /// The joints that were replaced with WeldJoint%s.
+        std::vector<std::string> weldedJoints;
+        /// The paths of the coordinates of the welded joints, and their
+        /// fixed values. The reduced problem does not contain the states
+        /// (or accelerations) of these coordinates.
+        std::vector<std::pair<std::string, double>> removedCoordinates;
+        /// The Lagrange multipliers of this problem for the constraints that
+        /// locked or prescribed the removed coordinates.
+        std::vector<std::string> removedMultipliers;
+        /// The remaining Lagrange multipliers of this problem, and the names
+        /// of the corresponding multipliers in the reduced problem (Simbody
+        /// constraint indices, and therefore multiplier names, change when
+        /// joints are welded).
+        std::map<std::string, std::string> reducedMultiplierNames;
+    };
+    /// Create a copy of the MocoProblem in which each joint whose coordinates
+    /// are all provably fixed is replaced with a WeldJoint at the fixed pose.
+    /// A coordinate is fixed if it is locked or prescribed with a Constant
+    /// function, is not part of a CoordinateCouplerConstraint, and is not
+    /// actuated by a CoordinateActuator. Welding such a joint does not change
+    /// the motion of the model, but removes the coordinate's states, the
+    /// constraint that fixes it, and the constraint's Lagrange multipliers
+    /// from the optimal control problem.
+    /// The model of `reducedProblem` is the processed model of this problem
+    /// with the joints welded, and the state infos for the removed
+    /// coordinates are removed. This throws an exception if the reduced
+    /// problem is invalid (e.g., a goal refers to a removed coordinate). If
+    /// no joint can be welded (or isPrescribedKinematics() is true), the
+    /// returned ProblemReduction is empty and `reducedProblem` is a copy of
+    /// the MocoProblem.
+    ProblemReduction createReducedProblem(MocoProblem& reducedProblem) const;
     /// @}
 
 private:
@@ -315,7 +368,15 @@ private:
 
     void initialize();
 
-    const MocoProblem* m_problem;
+    /// The MocoProblemRep that holds the models, goals, and constraints this
+    /// MocoProblemRep uses. This is `*this` unless this MocoProblemRep was
+    /// created with createRepSharingModels().
+    const MocoProblemRep& owner() const {
+        return m_shared_rep ? *m_shared_rep : *this;
+    }
+
+    const MocoProblem* m_problem = nullptr;
+    std::shared_ptr<const MocoProblemRep> m_shared_rep;
 
     Model m_model_base;
     mutable SimTK::State m_state_base;
@@ -19,7 +19,15 @@
 
 #include "MocoProblem.h"
 
+#include "Components/DeGrooteFregly2016Muscle.h"
+#include "Components/DiscreteController.h"
+
 #include <OpenSim/Simulation/Manager/Manager.h>
+#include <OpenSim/Simulation/Model/Muscle.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
 
 using namespace OpenSim;
 
@@ -75,6 +83,171 @@ MocoTrajectory MocoSolver::createGuessTimeStepping() const {
             probrep, statesTable, controlsTable);
 }
 
+MocoTrajectory MocoSolver::createGuessEquilibrium(MocoTrajectory guess,
+        const std::vector<const MocoProblemRep*>& reps) const {
+    const auto& probrep = getProblemRep();
+    const int numTimes = guess.getNumTimes();
+    OPENSIM_THROW_IF_FRMOBJ(numTimes < 2, Exception,
+            "Expected the guess to have at least 2 times, but it has {}.",
+            numTimes);
+    OPENSIM_THROW_IF_FRMOBJ(reps.empty(), Exception,
+            "Expected at least one MocoProblemRep.");
+    const SimTK::Vector& time = guess.getTime();
+    const double initialTime = time[0];
+    const double finalTime = time[numTimes - 1];
+
+    // Coordinate values and speeds.
+    // -----------------------------
+    // Interpolate the coordinate values linearly between the initial and
+    // final values, and fill in the speeds (and, in implicit mode,
+    // accelerations) from a spline of the values, so that the kinematics are
+    // consistent with the defect constraints.
+    bool hasCoordinates = false;
+    for (const auto& name : guess.getStateNames()) {
+        if (name.find("/value") == std::string::npos) continue;
+        hasCoordinates = true;
+        SimTK::Vector values = guess.getState(name);
+        const double initialValue = values[0];
+        const double finalValue = values[numTimes - 1];
+        for (int itime = 0; itime < numTimes; ++itime) {
+            const double fraction =
+                    finalTime > initialTime
+                            ? (time[itime] - initialTime) /
+                                      (finalTime - initialTime)
+                            : 0;
+            values[itime] =
+                    initialValue + fraction * (finalValue - initialValue);
+        }
+        guess.setState(name, values);
+    }
+    if (hasCoordinates) {
+        guess.generateSpeedsFromValues();
+        if (guess.getNumDerivatives()) {
+            // generateAccelerationsFromSpeeds() replaces all derivatives, so
+            // we copy only the accelerations back into the guess to preserve
+            // any auxiliary derivatives.
+            MocoTrajectory accelerations = guess;
+            accelerations.generateAccelerationsFromSpeeds();
+            const auto& derivNames = guess.getDerivativeNames();
+            for (const auto& name : accelerations.getDerivativeNames()) {
+                if (std::find(derivNames.begin(), derivNames.end(), name) !=
+                        derivNames.end()) {
+                    guess.setDerivative(name, accelerations.getDerivative(name));
+                }
+            }
+        }
+    }
+
+    // Per-time-point static solve.
+    // ----------------------------
+    // At each time point, set muscle activations to their steady-state value
+    // (the excitation), equilibrate the muscles to obtain fiber lengths or
+    // tendon forces, and compute the Lagrange multipliers from the resulting
+    // forward dynamics. Time points are independent, so they are distributed
+    // across threads, each with its own MocoProblemRep.
+    const auto& modelBase = probrep.getModelBase();
+    const auto yIndexMap = createSystemYIndexMap(modelBase);
+    const auto controlIndexMap = createSystemControlIndexMap(modelBase);
+    const auto& stateNames = guess.getStateNames();
+    const auto& controlNames = guess.getControlNames();
+    std::vector<int> stateYIndices;
+    for (const auto& name : stateNames) {
+        stateYIndices.push_back(yIndexMap.at(name));
+    }
+    std::vector<int> controlIndices;
+    for (const auto& name : controlNames) {
+        controlIndices.push_back(controlIndexMap.at(name));
+    }
+    // Pairs of (state index, control index) in the guess for activation states
+    // whose excitation is a control.
+    std::vector<std::pair<int, int>> activationControlPairs;
+    for (int is = 0; is < (int)stateNames.size(); ++is) {
+        const auto leafpos = stateNames[is].find("/activation");
+        if (leafpos == std::string::npos) continue;
+        const auto controlName = stateNames[is].substr(0, leafpos);
+        const auto it = std::find(
+                controlNames.begin(), controlNames.end(), controlName);
+        if (it == controlNames.end()) continue;
+        activationControlPairs.emplace_back(
+                is, (int)std::distance(controlNames.begin(), it));
+    }
+
+    SimTK::Matrix states = guess.getStatesTrajectory();
+    const SimTK::Matrix& controls = guess.getControlsTrajectory();
+    SimTK::Matrix multipliers = guess.getMultipliersTrajectory();
+    const int numMultipliers = guess.getNumMultipliers();
+
+    auto calcTimePoint = [&](const MocoProblemRep& rep, int itime) {
+        const auto& model = rep.getModelBase();
+        SimTK::State& state = rep.updStateBase();
+        state.setTime(time[itime]);
+        for (int is = 0; is < (int)stateYIndices.size(); ++is) {
+            state.updY()[stateYIndices[is]] = states(itime, is);
+        }
+        SimTK::Vector& simtkControls =
+                rep.getDiscreteControllerBase().updDiscreteControls(state);
+        for (int ic = 0; ic < (int)controlIndices.size(); ++ic) {
+            simtkControls[controlIndices[ic]] = controls(itime, ic);
+        }
+        for (const auto& pair : activationControlPairs) {
+            const auto& bounds =
+                    rep.getStateInfo(stateNames[pair.first]).getBounds();
+            const double activation = SimTK::clamp(bounds.getLower(),
+                    controls(itime, pair.second), bounds.getUpper());
+            state.updY()[stateYIndices[pair.first]] = activation;
+        }
+        // The rep's model is const, so we cannot use
+        // Model::equilibrateMuscles(); we equilibrate each muscle as it does.
+        model.realizeVelocity(state);
+        for (const auto& muscle : model.getComponentList<Muscle>()) {
+            if (!muscle.isActuationOverridden(state)) {
+                muscle.equilibrate(state);
+            }
+        }
+        if (numMultipliers) {
+            model.realizeAcceleration(state);
+            const auto& simtkMultipliers = state.getMultipliers();
+            if (simtkMultipliers.size() == numMultipliers) {
+                for (int im = 0; im < numMultipliers; ++im) {
+                    multipliers(itime, im) = simtkMultipliers[im];
+                }
+            }
+        }
+        for (int is = 0; is < (int)stateYIndices.size(); ++is) {
+            states(itime, is) = state.getY()[stateYIndices[is]];
+        }
+    };
+
+    const int numThreads = std::min((int)reps.size(), numTimes);
+    std::vector<std::exception_ptr> exceptions(numThreads);
+    std::vector<std::thread> threads;
+    for (int ithread = 0; ithread < numThreads; ++ithread) {
+        threads.emplace_back([&, ithread]() {
+            try {
+                for (int itime = ithread; itime < numTimes;
+                        itime += numThreads) {
+                    calcTimePoint(*reps[ithread], itime);
+                }
+            } catch (...) {
+                exceptions[ithread] = std::current_exception();
+            }
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    for (const auto& exception : exceptions) {
+        if (exception) std::rethrow_exception(exception);
+    }
+
+    for (int is = 0; is < (int)stateNames.size(); ++is) {
+        guess.setState(stateNames[is], states.col(is));
+    }
+    const auto& multiplierNames = guess.getMultiplierNames();
+    for (int im = 0; im < numMultipliers; ++im) {
+        guess.setMultiplier(multiplierNames[im], multipliers.col(im));
+    }
+    return guess;
+}
+
 void MocoSolver::resetProblem(const MocoProblem& problem) {
     m_problem.reset(&problem);
     m_problemRep = problem.createRep();
@@ -97,9 +270,113 @@ void MocoSolver::setSolutionStats(MocoSolution& sol, bool success,
     sol.setObjectiveBreakdown(std::move(objectiveBreakdown));
 }
 
+void MocoSolver::setSolutionSensitivities(MocoSolution& sol,
+        std::vector<std::pair<std::string, MocoTrajectory>> goalWeights,
+        std::vector<std::pair<std::string, MocoTrajectory>> parameters) {
+    sol.setSensitivities(std::move(goalWeights), std::move(parameters));
+}
+
+namespace {
+/// Call `function` once for each distinct DeGrooteFregly2016Muscle in the
+/// models; models may be listed more than once.
+template <typename F>
+void forEachDeGrooteFregly2016Muscle(
+        const std::vector<const Model*>& models, F function) {
+    std::set<const Model*> visited;
+    for (const auto* model : models) {
+        if (!visited.insert(model).second) continue;
+        for (const auto& muscle :
+                model->getComponentList<DeGrooteFregly2016Muscle>()) {
+            function(muscle);
+        }
+    }
+}
+} // namespace
+
+void MocoSolver::resetDiagnostics(const std::vector<const Model*>& models) {
+    forEachDeGrooteFregly2016Muscle(
+            models, [](const DeGrooteFregly2016Muscle& muscle) {
+                muscle.resetDiagnosticCounters();
+            });
+}
+
+void MocoSolver::logDiagnostics(const std::vector<const Model*>& models) {
+    struct Summary {
+        long long count = 0;
+        double firstTime = SimTK::Infinity;
+    };
+    // Keyed by the message and the path of the component.
+    std::map<std::pair<std::string, std::string>, Summary> summaries;
+    auto add = [&](const std::string& message, const Component& component,
+                       const DiagnosticCounter& counter) {
+        if (!counter.getCount()) return;
+        auto& summary = summaries[std::make_pair(
+                message, component.getAbsolutePathString())];
+        summary.count += counter.getCount();
+        summary.firstTime = std::min(summary.firstTime, counter.getFirstTime());
+    };
+    forEachDeGrooteFregly2016Muscle(
+            models, [&](const DeGrooteFregly2016Muscle& muscle) {
+                add("is buckling (length < tendon_slack_length)", muscle,
+                        muscle.getBucklingCounter());
+                add("is exceeding maximum contraction velocity", muscle,
+                        muscle.getExceedingMaxContractionVelocityCounter());
+            });
+    for (const auto& entry : summaries) {
+        log_info("DeGrooteFregly2016Muscle '{}' {} in {} evaluation(s), "
+                 "first at time {} s.",
+                entry.first.second, entry.first.first, entry.second.count,
+                entry.second.firstTime);
+    }
+}
+
 std::unique_ptr<ThreadsafeJar<const MocoProblemRep>>
-        MocoSolver::createProblemRepJar(int size) const {
+        MocoSolver::createProblemRepJar(
+                int size, bool shareModels,
+                const std::vector<std::vector<int>>& nodeCPUs) const {
     auto jar = OpenSim::make_unique<ThreadsafeJar<const MocoProblemRep>>();
+    if (nodeCPUs.size() > 1) {
+        const int numNodes = (int)nodeCPUs.size();
+        // Memory is allocated on the NUMA node of the thread that first
+        // touches it, so each node's MocoProblemReps are created by a thread
+        // pinned to that node. The threads take turns creating
+        // MocoProblemReps, as creating a MocoProblemRep may not be threadsafe.
+        std::mutex creationMutex;
+        std::vector<std::exception_ptr> exceptions(numNodes);
+        std::vector<std::thread> threads;
+        for (int inode = 0; inode < numNodes; ++inode) {
+            threads.emplace_back([&, inode]() {
+                try {
+                    pinThreadToCPUs(nodeCPUs[inode]);
+                    std::lock_guard<std::mutex> lock(creationMutex);
+                    std::shared_ptr<const MocoProblemRep> rep;
+                    for (int i = inode; i < size; i += numNodes) {
+                        if (!shareModels) {
+                            jar->leave(m_problem->createRepHeap(), inode);
+                            continue;
+                        }
+                        if (!rep) rep.reset(m_problem->createRepHeap());
+                        jar->leave(MocoProblemRep::createRepSharingModels(rep),
+                                inode);
+                    }
+                } catch (...) {
+                    exceptions[inode] = std::current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads) { thread.join(); }
+        for (const auto& exception : exceptions) {
+            if (exception) std::rethrow_exception(exception);
+        }
+        return jar;
+    }
+    if (shareModels) {
+        std::shared_ptr<const MocoProblemRep> rep(m_problem->createRepHeap());
+        for (int i = 0; i < size; ++i) {
+            jar->leave(MocoProblemRep::createRepSharingModels(rep));
+        }
+        return jar;
+    }
     for (int i = 0; i < size; ++i) {
         jar->leave(std::unique_ptr<MocoProblemRep>(m_problem->createRepHeap()));
     }
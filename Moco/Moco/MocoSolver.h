@@ -100,15 +100,57 @@ protected:
             double duration,
             std::vector<std::pair<std::string, double>> objectiveBreakdown =
                     {});
+    static void setSolutionSensitivities(MocoSolution&,
+            std::vector<std::pair<std::string, MocoTrajectory>> goalWeights,
+            std::vector<std::pair<std::string, MocoTrajectory>> parameters);
+
+    /// Reset the diagnostic counters (see DiagnosticCounter) of the components
+    /// in the given models. Solvers call this before solving so that
+    /// logDiagnostics() reports only the events from the solve.
+    static void resetDiagnostics(const std::vector<const Model*>& models);
+    /// Log a summary of the diagnostic counters of the components in the given
+    /// models. The counts of components with the same path (in different
+    /// copies of the model) are combined. Nothing is logged if no events
+    /// occurred. Components currently providing counters:
+    ///  - DeGrooteFregly2016Muscle.
+    static void logDiagnostics(const std::vector<const Model*>& models);
+
+    const MocoProblem& getProblem() const { return m_problem.getRef(); }
 
     const MocoProblemRep& getProblemRep() const {
         return m_problemRep;
     }
 
     /// Create a library of MocoProblemRep%s for use in parallelized code.
+    /// If `shareModels` is true, the MocoProblemRep%s share a single copy of
+    /// the models and each has only its own SimTK::State objects (see
+    /// MocoProblemRep::createRepSharingModels()).
+    /// If `nodeCPUs` (see getNUMANodeCPUs()) has more than one NUMA node, the
+    /// MocoProblemRep%s are distributed evenly across the nodes: each is
+    /// created by a thread pinned to its node, so that its memory is allocated
+    /// on that node, and is left in the jar with the index of its node as the
+    /// key. If models are shared, there is one copy of the models per node.
     // TODO SWIG ignore.
     std::unique_ptr<ThreadsafeJar<const MocoProblemRep>>
-    createProblemRepJar(int size) const;
+    createProblemRepJar(int size, bool shareModels = false,
+            const std::vector<std::vector<int>>& nodeCPUs = {}) const;
+
+    /// Starting from a guess whose variables lie within their bounds (e.g., a
+    /// "bounds" guess), create a guess that is closer to physically consistent:
+    ///  - coordinate values are interpolated linearly between their initial
+    ///    and final values, and speeds (and accelerations, if present) are
+    ///    computed from a spline of the values,
+    ///  - muscle activations are set to their steady-state value (the
+    ///    excitation, clamped to the activation bounds),
+    ///  - fiber lengths or tendon forces are set from muscle equilibrium,
+    ///  - Lagrange multipliers are computed from forward dynamics.
+    ///
+    /// The time points are processed in parallel, with one thread for each of
+    /// the given MocoProblemRep%s; solvers pass the reps that they already
+    /// created for their own threads.
+    /// Parameters in the guess are not applied to the model.
+    MocoTrajectory createGuessEquilibrium(MocoTrajectory guess,
+            const std::vector<const MocoProblemRep*>& reps) const;
 
 private:
 
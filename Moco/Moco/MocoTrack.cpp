@@ -146,9 +146,15 @@ MocoSolution MocoTrack::solve(bool visualize) {
 TimeSeriesTable MocoTrack::configureStateTracking(
         MocoProblem& problem, Model& model) {
 
-    // Read in the states reference data and spline.
-    TimeSeriesTable states =
-            get_states_reference().process(getDocumentDirectory(), &model);
+    // Read in the states reference data and spline. Unless unused references
+    // are an error, we only need the columns for states in the model. We keep
+    // all rows, since the splines depend on the entire table.
+    std::vector<std::string> columnLabels;
+    if (get_allow_unused_references()) {
+        columnLabels = createStateVariableNamesInSystemOrder(model);
+    }
+    TimeSeriesTable states = get_states_reference().process(
+            getDocumentDirectory(), &model, columnLabels);
     auto stateSplines = GCVSplineSet(states, states.getColumnLabels());
 
     // Loop through all coordinates and compare labels in the reference data
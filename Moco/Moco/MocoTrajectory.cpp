@@ -1343,6 +1343,26 @@ void MocoTrajectory::ensureUnsealed() const {
     OPENSIM_THROW_IF(m_sealed, MocoTrajectoryIsSealed);
 }
 
+void MocoTrajectory::addScaled(const MocoTrajectory& other, double scale) {
+    ensureUnsealed();
+    OPENSIM_THROW_IF(other.m_time.size() != m_time.size() ||
+                             other.m_state_names != m_state_names ||
+                             other.m_control_names != m_control_names ||
+                             other.m_multiplier_names != m_multiplier_names ||
+                             other.m_derivative_names != m_derivative_names ||
+                             other.m_slack_names != m_slack_names ||
+                             other.m_parameter_names != m_parameter_names,
+            Exception,
+            "Expected trajectories to have the same times and variables.");
+    m_time += scale * other.m_time;
+    m_states += scale * other.m_states;
+    m_controls += scale * other.m_controls;
+    m_multipliers += scale * other.m_multipliers;
+    m_derivatives += scale * other.m_derivatives;
+    m_slacks += scale * other.m_slacks;
+    m_parameters += scale * other.m_parameters;
+}
+
 std::vector<std::string> MocoSolution::getObjectiveTermNames() const {
     ensureUnsealed();
     std::vector<std::string> names;
@@ -1384,6 +1404,44 @@ void MocoSolution::printObjectiveBreakdown() const {
     }
 }
 
+const MocoTrajectory& MocoSolution::getSensitivityToGoalWeight(
+        const std::string& goalName) const {
+    ensureUnsealed();
+    for (const auto& entry : m_goalWeightSensitivities) {
+        if (entry.first == goalName) { return entry.second; }
+    }
+    OPENSIM_THROW(Exception,
+            "No sensitivity to the weight of goal '{}' is available.",
+            goalName);
+}
+
+const MocoTrajectory& MocoSolution::getSensitivityToParameter(
+        const std::string& parameterName) const {
+    ensureUnsealed();
+    for (const auto& entry : m_parameterSensitivities) {
+        if (entry.first == parameterName) { return entry.second; }
+    }
+    OPENSIM_THROW(Exception,
+            "No sensitivity to the value of parameter '{}' is available.",
+            parameterName);
+}
+
+MocoTrajectory MocoSolution::predictSolution(
+        const std::map<std::string, double>& goalWeightChanges,
+        const std::map<std::string, double>& parameterChanges) const {
+    ensureUnsealed();
+    MocoSolution prediction(*this);
+    for (const auto& change : goalWeightChanges) {
+        prediction.addScaled(
+                getSensitivityToGoalWeight(change.first), change.second);
+    }
+    for (const auto& change : parameterChanges) {
+        prediction.addScaled(
+                getSensitivityToParameter(change.first), change.second);
+    }
+    return MocoTrajectory(prediction);
+}
+
 void MocoSolution::convertToTableImpl(TimeSeriesTable& table) const {
     std::string success = m_success ? "true" : "false";
     table.updTableMetaData().setValueForKey("success", success);
@@ -680,6 +680,10 @@ protected:
     bool isSealed() const { return m_sealed; }
     /// @throws MocoTrajectoryIsSealed if the trajectory is sealed.
     void ensureUnsealed() const;
+    /// Add `scale` times the time, variables, and parameters of `other` to
+    /// those of this trajectory. The two trajectories must have the same
+    /// number of times and the same variables (in the same order).
+    void addScaled(const MocoTrajectory& other, double scale);
 
 private:
     TimeSeriesTable convertToTable() const;
@@ -801,6 +805,47 @@ public:
     void printObjectiveBreakdown() const;
     /// @}
 
+    /// @name Sensitivities
+    /// Some solvers (see MocoCasADiSolver's `compute_sensitivities`) can
+    /// compute the derivatives of the solution (time, states, controls,
+    /// multipliers, derivatives, and parameters) with respect to the weights of
+    /// the cost goals and with respect to the values of the MocoParameter%s.
+    /// Each sensitivity is returned as a trajectory whose entries are
+    /// derivatives rather than values. These derivatives give a first-order
+    /// prediction of the solution to a slightly different problem, which can
+    /// be used as a fast approximation or as an initial guess.
+    /// Sensitivities are available only for parameters with equal lower and
+    /// upper bounds (fixed parameters), for which the derivative is with
+    /// respect to the parameter's value. The optimizer chooses the value of a
+    /// free parameter, so its value is not an input to the problem.
+    /// @{
+
+    /// Did the solver compute sensitivities for this solution?
+    bool hasSensitivities() const {
+        ensureUnsealed();
+        return !m_goalWeightSensitivities.empty() ||
+               !m_parameterSensitivities.empty();
+    }
+    /// Get the derivative of the solution with respect to the weight of the
+    /// cost goal with the given name. Sensitivities are not available for goals
+    /// whose weight is 0.
+    const MocoTrajectory& getSensitivityToGoalWeight(
+            const std::string& goalName) const;
+    /// Get the derivative of the solution with respect to the value of the
+    /// parameter with the given name. Sensitivities are not available for
+    /// parameters whose lower and upper bounds differ.
+    const MocoTrajectory& getSensitivityToParameter(
+            const std::string& parameterName) const;
+    /// Predict the solution to the problem after changing the weights of the
+    /// cost goals and the values of the parameters by the given amounts (keys
+    /// are goal or parameter names, and values are the changes), using the
+    /// sensitivities. The prediction is accurate only for small changes, and
+    /// it does not account for a bound becoming active or inactive.
+    MocoTrajectory predictSolution(
+            const std::map<std::string, double>& goalWeightChanges,
+            const std::map<std::string, double>& parameterChanges = {}) const;
+    /// @}
+
     /// @name Access control
     /// @{
 
@@ -842,6 +887,12 @@ private:
         m_numIterations = numIterations;
     };
     void setSolverDuration(double duration) { m_solverDuration = duration; }
+    void setSensitivities(
+            std::vector<std::pair<std::string, MocoTrajectory>> goalWeights,
+            std::vector<std::pair<std::string, MocoTrajectory>> parameters) {
+        m_goalWeightSensitivities = std::move(goalWeights);
+        m_parameterSensitivities = std::move(parameters);
+    }
     void convertToTableImpl(TimeSeriesTable&) const override;
     bool m_success = true;
     double m_objective = -1;
@@ -849,6 +900,10 @@ private:
     std::string m_status;
     int m_numIterations = -1;
     double m_solverDuration = -1;
+    std::vector<std::pair<std::string, MocoTrajectory>>
+            m_goalWeightSensitivities;
+    std::vector<std::pair<std::string, MocoTrajectory>>
+            m_parameterSensitivities;
     // Allow solvers to set success, status, and construct a solution.
     friend class MocoSolver;
 };
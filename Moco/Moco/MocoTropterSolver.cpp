@@ -115,6 +115,10 @@ MocoTropterSolver::createTropterSolver(
                 getProperty_exact_hessian_block_sparsity_mode(),
                 {"dense", "sparse"});
     }
+    OPENSIM_THROW_IF_FRMOBJ(
+            get_optim_hessian_approximation() == "gauss-newton", Exception,
+            "The 'gauss-newton' Hessian approximation is only supported by "
+            "MocoCasADiSolver.");
     // Hessian information is not used in SNOPT.
     OPENSIM_THROW_IF(get_optim_hessian_approximation() == "exact" &&
                              get_optim_solver() == "snopt",
@@ -211,11 +215,12 @@ MocoTropterSolver::createTropterSolver(
 
 MocoTrajectory MocoTropterSolver::createGuess(const std::string& type) const {
 #ifdef MOCO_WITH_TROPTER
-    OPENSIM_THROW_IF_FRMOBJ(
-            type != "bounds" && type != "random" && type != "time-stepping",
+    OPENSIM_THROW_IF_FRMOBJ(type != "bounds" && type != "random" &&
+                                    type != "time-stepping" &&
+                                    type != "equilibrium",
             Exception,
             "Unexpected guess type '{}'; supported types are "
-            "'bounds', 'random', and 'time-stepping'.",
+            "'bounds', 'random', 'time-stepping', and 'equilibrium'.",
             type);
 
     if (type == "time-stepping") { return createGuessTimeStepping(); }
@@ -224,11 +229,17 @@ MocoTrajectory MocoTropterSolver::createGuess(const std::string& type) const {
     auto dircol = createTropterSolver(ocp);
 
     tropter::Iterate tropIter;
-    if (type == "bounds") {
+    if (type == "bounds" || type == "equilibrium") {
         tropIter = dircol->make_initial_guess_from_bounds();
     } else if (type == "random") {
         tropIter = dircol->make_random_iterate_within_bounds();
     }
+    if (type == "equilibrium") {
+        // tropter evaluates the problem serially with the solver's
+        // MocoProblemRep.
+        return createGuessEquilibrium(ocp->convertToMocoTrajectory(tropIter),
+                {&getProblemRep()});
+    }
     return ocp->convertToMocoTrajectory(tropIter);
 #else
     OPENSIM_THROW(MocoTropterSolverNotAvailable);
@@ -330,17 +341,15 @@ MocoSolution MocoTropterSolver::solveImpl() const {
     MocoTrajectory guess = getGuess();
     tropter::Iterate tropIterate = ocp->convertToTropterIterate(guess);
 
-    // Temporarily disable printing of negative muscle force warnings so the
-    // output stream isn't flooded while computing finite differences.
-    Logger::Level origLoggerLevel = Logger::getLevel();
-    Logger::setLevel(Logger::Level::Warn);
-    tropter::Solution tropSolution;
-    try {
-        tropSolution = dircol->solve(tropIterate);
-    } catch (...) {
-        OpenSim::Logger::setLevel(origLoggerLevel);
-    }
-    OpenSim::Logger::setLevel(origLoggerLevel);
+    // Components count events (e.g., muscles buckling) instead of logging
+    // them while computing finite differences, and we report the counts once,
+    // below.
+    const std::vector<const Model*> models{
+            &getProblemRep().getModelBase(),
+            &getProblemRep().getModelDisabledConstraints()};
+    resetDiagnostics(models);
+    tropter::Solution tropSolution = dircol->solve(tropIterate);
+    if (get_verbosity()) logDiagnostics(models);
 
     if (get_verbosity()) { dircol->print_constraint_values(tropSolution); }
 
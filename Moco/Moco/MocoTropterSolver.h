@@ -101,6 +101,12 @@ public:
     ///   bound). This is the default type.
     /// - **random**: values are randomly generated within the bounds.
     /// - **time-stepping**: see MocoSolver::createGuessTimeStepping().
+    /// - **equilibrium**: starts from the **bounds** guess, then fills in
+    ///   speeds from splined coordinate values, steady-state activations,
+    ///   equilibrium fiber lengths (or tendon forces), and consistent Lagrange
+    ///   multipliers; see MocoSolver::createGuessEquilibrium(). This guess
+    ///   often reduces the number of iterations for muscle-driven problems
+    ///   solved without a guess.
     /// @note Calling this method does *not* set an initial guess to be used
     /// in the solver; you must call setGuess() or setGuessFile() for that.
     /// @precondition You must have called resetProblem().
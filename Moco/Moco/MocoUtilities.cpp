@@ -22,9 +22,15 @@
 #include "MocoTrajectory.h"
 #include <cstdarg>
 #include <cstdio>
+#include <fstream>
 #include <iomanip>
 #include <regex>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <simbody/internal/Visualizer_InputListener.h>
 
 #include <OpenSim/Actuators/CoordinateActuator.h>
@@ -778,6 +784,65 @@ int OpenSim::getMocoParallelEnvironmentVariable() {
     return -1;
 }
 
+std::vector<std::vector<int>> OpenSim::getNUMANodeCPUs() {
+    std::vector<std::vector<int>> nodeCPUs;
+#if defined(__linux__)
+    // Each node has a file like /sys/devices/system/node/node0/cpulist that
+    // contains a list of CPU ranges, e.g., "0-15,32-47".
+    for (int inode = 0;; ++inode) {
+        std::ifstream file(fmt::format(
+                "/sys/devices/system/node/node{}/cpulist", inode));
+        if (!file) break;
+        std::string line;
+        std::getline(file, line);
+        std::vector<int> cpus;
+        std::stringstream ss(line);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty()) continue;
+            const auto dash = range.find('-');
+            const int first = std::atoi(range.substr(0, dash).c_str());
+            int last = first;
+            if (dash != std::string::npos) {
+                last = std::atoi(range.substr(dash + 1).c_str());
+            }
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        }
+        nodeCPUs.push_back(std::move(cpus));
+    }
+#endif
+    if (nodeCPUs.empty()) nodeCPUs.resize(1);
+    return nodeCPUs;
+}
+
+bool OpenSim::pinThreadToCPUs(const std::vector<int>& cpus) {
+    if (cpus.empty()) return false;
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (const auto& cpu : cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &cpuSet);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+    return false;
+#endif
+}
+
+int OpenSim::getCurrentNUMANode(
+        const std::vector<std::vector<int>>& nodeCPUs) {
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    for (int inode = 0; inode < (int)nodeCPUs.size(); ++inode) {
+        const auto& cpus = nodeCPUs[inode];
+        if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end()) {
+            return inode;
+        }
+    }
+#endif
+    return 0;
+}
+
 TimeSeriesTable OpenSim::createExternalLoadsTableForGait(Model model,
         const StatesTrajectory& trajectory,
         const std::vector<std::string>& forcePathsRightFoot,
@@ -31,10 +31,11 @@
 #include <Common/Reporter.h>
 #include <Simulation/Model/Model.h>
 #include <Simulation/StatesTrajectory.h>
+#include <atomic>
 #include <condition_variable>
 #include <regex>
 #include <set>
-#include <stack>
+#include <unordered_map>
 
 #include <OpenSim/Common/GCVSplineSet.h>
 #include <OpenSim/Common/PiecewiseLinearFunction.h>
@@ -659,6 +660,46 @@ private:
     long long m_startTime;
 };
 
+/// Count occurrences of an event (e.g., a muscle buckling) in code that runs
+/// in solver callbacks, without formatting messages or locking. Along with the
+/// count, the counter keeps the time of the first occurrence that was
+/// recorded. Components hold counters as mutable members and solvers report
+/// them once after solving. Copying a counter (e.g., when copying a model)
+/// gives a counter with no occurrences.
+/// @ingroup mocogenutil
+class DiagnosticCounter {
+public:
+    DiagnosticCounter() = default;
+    DiagnosticCounter(const DiagnosticCounter&) {}
+    DiagnosticCounter& operator=(const DiagnosticCounter&) {
+        reset();
+        return *this;
+    }
+    /// Record an occurrence at the given time. This is safe to call from
+    /// multiple threads.
+    void record(double time) {
+        if (m_count.fetch_add(1, std::memory_order_relaxed) == 0) {
+            m_firstTime.store(time, std::memory_order_relaxed);
+        }
+    }
+    /// The number of occurrences recorded since construction or reset().
+    long long getCount() const {
+        return m_count.load(std::memory_order_relaxed);
+    }
+    /// The time of the first occurrence recorded, or NaN if there are none.
+    double getFirstTime() const {
+        return m_firstTime.load(std::memory_order_relaxed);
+    }
+    void reset() {
+        m_count.store(0, std::memory_order_relaxed);
+        m_firstTime.store(SimTK::NaN, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<long long> m_count{0};
+    std::atomic<double> m_firstTime{SimTK::NaN};
+};
+
 /// This obtains the value of the OPENSIM_MOCO_PARALLEL environment variable.
 /// The value has the following meanings:
 /// - 0: run in series (not parallel).
@@ -673,10 +714,32 @@ private:
 /// @ingroup mocogenutil
 OSIMMOCO_API int getMocoParallelEnvironmentVariable();
 
+/// Get the CPUs of each NUMA node of this machine. On Linux, this
+/// information is read from /sys/devices/system/node. On other platforms, or
+/// if the information is unavailable, this returns a single node with an empty
+/// list of CPUs.
+/// @ingroup mocogenutil
+OSIMMOCO_API std::vector<std::vector<int>> getNUMANodeCPUs();
+
+/// Restrict the calling thread to run only on the given CPUs. This returns
+/// false (and does nothing) if `cpus` is empty or if this is not supported on
+/// this platform (only Linux is supported).
+/// @ingroup mocogenutil
+OSIMMOCO_API bool pinThreadToCPUs(const std::vector<int>& cpus);
+
+/// Get the index of the NUMA node (in `nodeCPUs`, from getNUMANodeCPUs()) of
+/// the CPU on which the calling thread is currently running. This returns 0
+/// if the CPU is unknown.
+/// @ingroup mocogenutil
+OSIMMOCO_API int getCurrentNUMANode(
+        const std::vector<std::vector<int>>& nodeCPUs);
+
 /// This class lets you store objects of a single type for reuse by multiple
 /// threads, ensuring threadsafe access to each of those objects.
+/// Each object can be associated with an integer key (e.g., the NUMA node on
+/// which the object's memory resides), and threads can request an object with
+/// a given key.
 /// @ingroup mocogenutil
-// TODO: Find a way to always give the same thread the same object.
 template <typename T> class ThreadsafeJar {
 public:
     /// Request an object for your exclusive use on your thread. This function
@@ -689,16 +752,48 @@ public:
         // Block this thread until the condition variable is woken up
         // (by a notify_...()) and the lambda function returns true.
         m_inventoryMonitor.wait(lock, [this] { return m_entries.size() > 0; });
-        std::unique_ptr<T> top = std::move(m_entries.top());
-        m_entries.pop();
+        std::unique_ptr<T> top = std::move(m_entries.back());
+        m_entries.pop_back();
+        m_keys.erase(top.get());
         return top;
     }
+    /// Same as take(), but prefer an object whose key is `preferredKey`. If
+    /// no such object is available, this returns any available object.
+    std::unique_ptr<T> take(int preferredKey) {
+        int key;
+        return take(preferredKey, key);
+    }
+    /// Same as take(int), and also provide the key of the returned object.
+    std::unique_ptr<T> take(int preferredKey, int& key) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_inventoryMonitor.wait(lock, [this] { return m_entries.size() > 0; });
+        auto it = m_entries.end() - 1;
+        for (auto candidate = m_entries.rbegin();
+                candidate != m_entries.rend(); ++candidate) {
+            if (m_keys.at(candidate->get()) == preferredKey) {
+                it = candidate.base() - 1;
+                break;
+            }
+        }
+        std::unique_ptr<T> entry = std::move(*it);
+        m_entries.erase(it);
+        const auto keyIt = m_keys.find(entry.get());
+        key = keyIt->second;
+        m_keys.erase(keyIt);
+        return entry;
+    }
     /// Add or return an object so that another thread can use it. You will need
     /// to std::move() the entry, ensuring that you will no longer have access
     /// to the entry in your code (the pointer will now be null).
-    void leave(std::unique_ptr<T> entry) {
+    /// The object is associated with the key 0.
+    void leave(std::unique_ptr<T> entry) { leave(std::move(entry), 0); }
+    /// Same as leave(), but associate the object with `key`. The jar only
+    /// knows the keys of the objects it holds, so an object must be given its
+    /// key each time it is returned.
+    void leave(std::unique_ptr<T> entry, int key) {
         std::unique_lock<std::mutex> lock(m_mutex);
-        m_entries.push(std::move(entry));
+        m_keys[entry.get()] = key;
+        m_entries.push_back(std::move(entry));
         lock.unlock();
         m_inventoryMonitor.notify_one();
     }
@@ -709,7 +804,8 @@ public:
     }
 
 private:
-    std::stack<std::unique_ptr<T>> m_entries;
+    std::vector<std::unique_ptr<T>> m_entries;
+    std::unordered_map<const T*, int> m_keys;
     mutable std::mutex m_mutex;
     std::condition_variable m_inventoryMonitor;
 };
@@ -22,6 +22,7 @@
 #include "Components/AccelerationMotion.h"
 #include "Components/DeGrooteFregly2016Muscle.h"
 #include "Components/DiscreteForces.h"
+#include "Components/JointReactions.h"
 #include "Components/MultivariatePolynomialFunction.h"
 #include "Components/PositionMotion.h"
 #include "Components/Bhargava2004Metabolics.h"
@@ -131,6 +132,7 @@ OSIMMOCO_API void RegisterTypes_osimMoco() {
         Object::registerType(DeGrooteFregly2016Muscle());
         Object::registerType(MultivariatePolynomialFunction());
         Object::registerType(Bhargava2004Metabolics());
+        Object::registerType(JointReactions());
 
         Object::registerType(DiscreteForces());
         Object::registerType(AccelerationMotion());
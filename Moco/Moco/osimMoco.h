@@ -22,6 +22,7 @@
 #include "Common/TableProcessor.h"
 #include "Components/DeGrooteFregly2016Muscle.h"
 #include "Components/DiscreteForces.h"
+#include "Components/JointReactions.h"
 #include "Components/ModelFactory.h"
 #include "Components/MultivariatePolynomialFunction.h"
 #include "Components/PositionMotion.h"
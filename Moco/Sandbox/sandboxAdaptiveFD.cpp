@@ -0,0 +1,118 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: sandboxAdaptiveFD.cpp                                        *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// This benchmark compares the number of iterations, the solve time, and the
+// objective for MocoCasADiSolver's finite difference schemes, including the
+// 'adaptive' scheme, on a problem with muscles (whose equations involve
+// inputs with very different magnitudes) and on a torque-driven problem.
+
+#include <Moco/osimMoco.h>
+
+using namespace OpenSim;
+
+void compare(const std::string& name, MocoStudy& study) {
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    for (const std::string scheme : {"central", "forward", "adaptive"}) {
+        solver.set_optim_finite_difference_scheme(scheme);
+        const Stopwatch stopwatch;
+        MocoSolution solution = study.solve().unseal();
+        std::cout << name << " (" << scheme
+                  << "): " << solution.getNumIterations() << " iterations, "
+                  << stopwatch.getElapsedTimeFormatted() << ", "
+                  << (solution.success() ? "success" : "failure")
+                  << ", objective " << solution.getObjective() << std::endl;
+    }
+}
+
+MocoStudy createDoublePendulumSwingUp() {
+    MocoStudy study;
+    study.set_write_solution("false");
+    auto& problem = study.updProblem();
+    problem.setModel(OpenSim::make_unique<Model>(
+            ModelFactory::createDoublePendulum()));
+    problem.setTimeBounds(0, {0, 5});
+    problem.setStateInfo(
+            "/jointset/j0/q0/value", {-10, 10}, 0, SimTK::Pi);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setStateInfo("/jointset/j1/q1/value", {-10, 10}, 0, 0);
+    problem.setStateInfo("/jointset/j1/q1/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.setControlInfo("/tau1", {-100, 100});
+    problem.addGoal<MocoControlGoal>("effort", 1e-3);
+    problem.addGoal<MocoFinalTimeGoal>("time");
+
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(50);
+    solver.set_verbosity(0);
+    return study;
+}
+
+MocoStudy createHangingMuscle() {
+    Model model;
+    model.setName("hanging_muscle");
+    model.set_gravity(SimTK::Vec3(9.81, 0, 0));
+    auto* body = new Body("body", 0.5, SimTK::Vec3(0), SimTK::Inertia(0));
+    model.addComponent(body);
+    auto* joint = new SliderJoint("joint", model.getGround(), *body);
+    auto& coord = joint->updCoordinate(SliderJoint::Coord::TranslationX);
+    coord.setName("height");
+    model.addComponent(joint);
+
+    auto* actu = new DeGrooteFregly2016Muscle();
+    actu->setName("actuator");
+    actu->set_max_isometric_force(30.0);
+    actu->set_optimal_fiber_length(0.10);
+    actu->set_tendon_slack_length(0.05);
+    actu->set_tendon_strain_at_one_norm_force(0.10);
+    actu->set_fiber_damping(0.01);
+    actu->set_ignore_tendon_compliance(false);
+    actu->addNewPathPoint("origin", model.updGround(), SimTK::Vec3(0));
+    actu->addNewPathPoint("insertion", *body, SimTK::Vec3(0));
+    model.addForce(actu);
+    model.finalizeConnections();
+
+    MocoStudy study;
+    study.set_write_solution("false");
+    auto& problem = study.updProblem();
+    problem.setModelCopy(model);
+    problem.setTimeBounds(0, {0.05, 1.0});
+    problem.setStateInfo("/joint/height/value", {0.14, 0.16}, 0.15, 0.14);
+    problem.setStateInfo("/joint/height/speed", {-1, 1}, 0, 0);
+    problem.setStateInfo("/forceset/actuator/activation", {0, 1}, 0);
+    problem.setStateInfo("/forceset/actuator/normalized_tendon_force",
+            {0, 2}, {0, 2});
+    problem.setControlInfo("/forceset/actuator", {0.01, 1});
+    problem.addGoal<MocoFinalTimeGoal>();
+
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(50);
+    solver.set_verbosity(0);
+    return study;
+}
+
+int main() {
+    {
+        MocoStudy study = createDoublePendulumSwingUp();
+        compare("Double pendulum swing-up", study);
+    }
+    {
+        MocoStudy study = createHangingMuscle();
+        compare("Hanging muscle", study);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: sandboxCasADiConversions.cpp                                 *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Microbenchmark for converting trajectories between casadi::DM and SimTK
+// containers. The bulk conversions in MocoCasOCProblem.h are compared against
+// element-by-element conversions (how these conversions used to be
+// implemented) for trajectories with 100k elements.
+
+#include <Moco/MocoCasADiSolver/MocoCasOCProblem.h>
+#include <Moco/osimMoco.h>
+
+using namespace OpenSim;
+
+casadi::DM elementwiseToCasADiDMTranspose(const SimTK::Matrix& simtkMatrix) {
+    casadi::DM out(simtkMatrix.ncol(), simtkMatrix.nrow());
+    for (int irow = 0; irow < simtkMatrix.nrow(); ++irow) {
+        for (int icol = 0; icol < simtkMatrix.ncol(); ++icol) {
+            out(icol, irow) = simtkMatrix(irow, icol);
+        }
+    }
+    return out;
+}
+
+SimTK::Matrix elementwiseToSimTKMatrix(const casadi::DM& casMatrix) {
+    SimTK::Matrix simtkMatrix((int)casMatrix.columns(), (int)casMatrix.rows());
+    for (int irow = 0; irow < casMatrix.rows(); ++irow) {
+        for (int icol = 0; icol < casMatrix.columns(); ++icol) {
+            simtkMatrix(icol, irow) = double(casMatrix(irow, icol));
+        }
+    }
+    return simtkMatrix;
+}
+
+SimTK::Vector elementwiseToSimTKVector(const casadi::DM& casVector) {
+    SimTK::Vector simtkVector((int)casVector.numel());
+    for (int i = 0; i < casVector.numel(); ++i) {
+        simtkVector[i] = double(casVector(i));
+    }
+    return simtkVector;
+}
+
+template <typename F>
+double timeAverage(int numReps, F function) {
+    Stopwatch stopwatch;
+    for (int i = 0; i < numReps; ++i) function();
+    return stopwatch.getElapsedTime() / numReps;
+}
+
+void benchmark(int numTimes, int numVars, int numReps) {
+    std::cout << numTimes << " times x " << numVars << " variables:"
+              << std::endl;
+    SimTK::Matrix simtkMatrix(numTimes, numVars);
+    SimTK::Random::Uniform random(-1, 1);
+    random.setSeed(0);
+    for (int i = 0; i < numTimes; ++i) {
+        for (int j = 0; j < numVars; ++j) simtkMatrix(i, j) = random.getValue();
+    }
+    const casadi::DM casMatrix = convertToCasADiDMTranspose(simtkMatrix);
+    const casadi::DM casVector = casadi::DM::vec(casMatrix);
+
+    // Make sure the bulk conversions are correct.
+    OPENSIM_THROW_IF(
+            !casadi::DM::is_equal(casMatrix,
+                    elementwiseToCasADiDMTranspose(simtkMatrix)),
+            Exception, "convertToCasADiDMTranspose() is incorrect.");
+    OPENSIM_THROW_IF(
+            (convertToSimTKMatrix(casMatrix) - simtkMatrix).norm() != 0,
+            Exception, "convertToSimTKMatrix() is incorrect.");
+    OPENSIM_THROW_IF((convertToSimTKVector(casVector) -
+                             elementwiseToSimTKVector(casVector))
+                                     .norm() != 0,
+            Exception, "convertToSimTKVector() is incorrect.");
+
+    auto report = [](const std::string& name, double elementwise,
+                          double bulk) {
+        std::cout << "  " << name << ": element-wise " << 1e3 * elementwise
+                  << " ms, bulk " << 1e3 * bulk << " ms ("
+                  << elementwise / bulk << "x)" << std::endl;
+    };
+    report("SimTK::Matrix -> DM",
+            timeAverage(numReps,
+                    [&] { elementwiseToCasADiDMTranspose(simtkMatrix); }),
+            timeAverage(numReps,
+                    [&] { convertToCasADiDMTranspose(simtkMatrix); }));
+    report("DM -> SimTK::Matrix",
+            timeAverage(
+                    numReps, [&] { elementwiseToSimTKMatrix(casMatrix); }),
+            timeAverage(numReps, [&] { convertToSimTKMatrix(casMatrix); }));
+    report("DM -> SimTK::Vector",
+            timeAverage(
+                    numReps, [&] { elementwiseToSimTKVector(casVector); }),
+            timeAverage(numReps, [&] { convertToSimTKVector(casVector); }));
+}
+
+int main() {
+    const int numReps = 20;
+    // Each trajectory has 100k elements.
+    benchmark(1000, 100, numReps);
+    benchmark(10000, 10, numReps);
+    benchmark(100, 1000, numReps);
+    return EXIT_SUCCESS;
+}
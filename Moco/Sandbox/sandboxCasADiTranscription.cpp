@@ -0,0 +1,67 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: sandboxCasADiTranscription                                   *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// This benchmark reports the time spent building the CasADi NLP (and the size
+// of the resulting MX graph) for a double pendulum swing-up as the number of
+// mesh intervals grows. The optimizer is not allowed to take any iterations,
+// so the reported elapsed time is dominated by transcription and solver
+// construction.
+
+#include <Moco/osimMoco.h>
+
+using namespace OpenSim;
+
+int main() {
+    Logger::setLevel(Logger::Level::Info);
+    for (const std::string scheme : {"trapezoidal", "hermite-simpson"}) {
+        for (const bool implicit : {false, true}) {
+            for (const int numMeshIntervals : {50, 200, 800}) {
+                MocoStudy study;
+                auto& problem = study.updProblem();
+                problem.setModel(OpenSim::make_unique<Model>(
+                        ModelFactory::createDoublePendulum()));
+                problem.setTimeBounds(0, {0, 5});
+                problem.setStateInfo("/jointset/j0/q0/value", {-10, 10}, 0,
+                        SimTK::Pi);
+                problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+                problem.setStateInfo("/jointset/j1/q1/value", {-10, 10}, 0, 0);
+                problem.setStateInfo("/jointset/j1/q1/speed", {-50, 50}, 0, 0);
+                problem.setControlInfo("/tau0", {-100, 100});
+                problem.setControlInfo("/tau1", {-100, 100});
+                problem.addGoal<MocoControlGoal>("effort");
+                problem.addGoal<MocoFinalTimeGoal>("time");
+
+                auto& solver = study.initCasADiSolver();
+                solver.set_num_mesh_intervals(numMeshIntervals);
+                solver.set_transcription_scheme(scheme);
+                solver.set_multibody_dynamics_mode(
+                        implicit ? "implicit" : "explicit");
+                solver.set_optim_max_iterations(0);
+
+                log_info("Scheme: {}; dynamics mode: {}; mesh intervals: {}.",
+                        scheme, implicit ? "implicit" : "explicit",
+                        numMeshIntervals);
+                const Stopwatch stopwatch;
+                study.solve().unseal();
+                log_info("Total time: {}.",
+                        stopwatch.getElapsedTimeFormatted());
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
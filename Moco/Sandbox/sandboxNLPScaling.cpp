@@ -0,0 +1,101 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: sandboxNLPScaling.cpp                                        *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// This benchmark compares the number of iterations and the solve time with and
+// without MocoCasADiSolver's optim_automatic_scaling for a few problems whose
+// variables have very different magnitudes.
+
+#include <Moco/osimMoco.h>
+
+using namespace OpenSim;
+
+void compare(const std::string& name, MocoStudy& study) {
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    for (const bool scaling : {false, true}) {
+        solver.set_optim_automatic_scaling(scaling);
+        const Stopwatch stopwatch;
+        MocoSolution solution = study.solve().unseal();
+        std::cout << name << (scaling ? " (scaled): " : " (unscaled): ")
+                  << solution.getNumIterations() << " iterations, "
+                  << stopwatch.getElapsedTimeFormatted() << ", "
+                  << (solution.success() ? "success" : "failure")
+                  << ", objective " << solution.getObjective() << std::endl;
+    }
+}
+
+MocoStudy createDoublePendulumSwingUp(const std::string& dynamicsMode) {
+    MocoStudy study;
+    study.set_write_solution("false");
+    auto& problem = study.updProblem();
+    problem.setModel(OpenSim::make_unique<Model>(
+            ModelFactory::createDoublePendulum()));
+    problem.setTimeBounds(0, {0, 5});
+    problem.setStateInfo(
+            "/jointset/j0/q0/value", {-10, 10}, 0, SimTK::Pi);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setStateInfo("/jointset/j1/q1/value", {-10, 10}, 0, 0);
+    problem.setStateInfo("/jointset/j1/q1/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.setControlInfo("/tau1", {-100, 100});
+    problem.addGoal<MocoControlGoal>("effort", 1e-3);
+    problem.addGoal<MocoFinalTimeGoal>("time");
+
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(50);
+    solver.set_multibody_dynamics_mode(dynamicsMode);
+    solver.set_verbosity(0);
+    return study;
+}
+
+MocoStudy createPlanarPointMassReach() {
+    MocoStudy study;
+    study.set_write_solution("false");
+    auto& problem = study.updProblem();
+    problem.setModel(OpenSim::make_unique<Model>(
+            ModelFactory::createPlanarPointMass()));
+    problem.setTimeBounds(0, 2);
+    // Positions in meters, speeds in meters per second, and large forces.
+    problem.setStateInfo("/jointset/tx/tx/value", {-5, 5}, 0, 1);
+    problem.setStateInfo("/jointset/ty/ty/value", {-5, 5}, 0, 0.01);
+    problem.setStateInfo("/jointset/tx/tx/speed", {-50, 50}, 0, 0);
+    problem.setStateInfo("/jointset/ty/ty/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/forceset/force_x", {-1000, 1000});
+    problem.setControlInfo("/forceset/force_y", {-1000, 1000});
+    problem.addGoal<MocoControlGoal>("effort");
+
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(50);
+    solver.set_verbosity(0);
+    return study;
+}
+
+int main() {
+    {
+        MocoStudy study = createDoublePendulumSwingUp("explicit");
+        compare("Double pendulum swing-up (explicit)", study);
+    }
+    {
+        MocoStudy study = createDoublePendulumSwingUp("implicit");
+        compare("Double pendulum swing-up (implicit)", study);
+    }
+    {
+        MocoStudy study = createPlanarPointMassReach();
+        compare("Planar point mass reach", study);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: sandboxNUMA.cpp                                              *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// This benchmark compares the solve time with and without MocoCasADiSolver's
+// numa_aware_parallelism (pinned and unpinned threads) using all cores. Run
+// this on a machine with multiple NUMA nodes; on a machine with one node, the
+// pinned and unpinned runs are the same.
+
+#include <Moco/osimMoco.h>
+
+#include <thread>
+
+using namespace OpenSim;
+
+MocoStudy createDoublePendulumSwingUp(int numMeshIntervals) {
+    MocoStudy study;
+    study.set_write_solution("false");
+    auto& problem = study.updProblem();
+    problem.setModel(OpenSim::make_unique<Model>(
+            ModelFactory::createDoublePendulum()));
+    problem.setTimeBounds(0, 2);
+    problem.setStateInfo("/jointset/j0/q0/value", {-10, 10}, 0, SimTK::Pi);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setStateInfo("/jointset/j1/q1/value", {-10, 10}, 0, 0);
+    problem.setStateInfo("/jointset/j1/q1/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.setControlInfo("/tau1", {-100, 100});
+    problem.addGoal<MocoControlGoal>();
+
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(numMeshIntervals);
+    solver.set_multibody_dynamics_mode("implicit");
+    solver.set_parallel((int)std::thread::hardware_concurrency());
+    solver.set_verbosity(0);
+    return study;
+}
+
+int main() {
+    const auto nodeCPUs = getNUMANodeCPUs();
+    std::cout << "Number of NUMA nodes: " << nodeCPUs.size() << std::endl;
+    std::cout << "Number of threads: " << std::thread::hardware_concurrency()
+              << std::endl;
+
+    const int numRepetitions = 3;
+    for (const int numMeshIntervals : {100, 400}) {
+        MocoStudy study = createDoublePendulumSwingUp(numMeshIntervals);
+        auto& solver = study.updSolver<MocoCasADiSolver>();
+        for (const bool shareModel : {false, true}) {
+            solver.set_share_model_across_threads(shareModel);
+            for (const bool numaAware : {false, true}) {
+                solver.set_numa_aware_parallelism(numaAware);
+                double total = 0;
+                int numIterations = 0;
+                for (int i = 0; i < numRepetitions; ++i) {
+                    const Stopwatch stopwatch;
+                    MocoSolution solution = study.solve().unseal();
+                    total += stopwatch.getElapsedTime();
+                    numIterations = solution.getNumIterations();
+                }
+                std::cout << numMeshIntervals << " mesh intervals"
+                          << (shareModel ? ", shared model" : "")
+                          << (numaAware ? " (pinned): " : " (unpinned): ")
+                          << total / numRepetitions << " s average, "
+                          << numIterations << " iterations" << std::endl;
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -1588,6 +1588,43 @@ TEMPLATE_TEST_CASE(
     }
 }
 
+TEST_CASE("MocoControlBoundConstraint with symbolic bounds") {
+    // MocoCasADiSolver evaluates MocoControlBoundConstraints with Constant and
+    // LinearFunction bounds symbolically, and other bounds with callbacks.
+    // Both must produce the same solution.
+    auto solve = [](const Function& lowerBound) {
+        MocoStudy study;
+        auto& problem = study.updProblem();
+        problem.setModelCopy(ModelFactory::createPendulum());
+        problem.setTimeBounds(0, 1);
+        problem.setStateInfo("/jointset/j0/q0/value", {-10, 10}, 0);
+        problem.setStateInfo("/jointset/j0/q0/speed", {-10, 10}, 0);
+        problem.setControlInfo("/tau0", {-5, 5});
+        problem.addGoal<MocoControlGoal>();
+        auto* constr = problem.addPathConstraint<MocoControlBoundConstraint>();
+        constr->addControlPath("/tau0");
+        constr->setLowerBound(lowerBound);
+        constr->setUpperBound(Constant(0.4));
+
+        auto rep = problem.createRep();
+        CHECK(rep.getPathConstraintByIndex(0).getStageDependency() ==
+                SimTK::Stage::Velocity);
+
+        auto& solver = study.initCasADiSolver();
+        solver.set_num_mesh_intervals(20);
+        return study.solve();
+    };
+    MocoSolution symbolic = solve(LinearFunction(0.5, 0.1));
+    PiecewiseLinearFunction line;
+    line.addPoint(0, 0.1);
+    line.addPoint(1, 0.6);
+    MocoSolution callback = solve(line);
+
+    CHECK(symbolic.getObjective() ==
+            Approx(callback.getObjective()).epsilon(1e-6));
+    CHECK(symbolic.compareContinuousVariablesRMS(callback) < 1e-6);
+}
+
 TEMPLATE_TEST_CASE("MocoFrameDistanceConstraint", "", MocoTropterSolver, 
         MocoCasADiSolver) {
     using SimTK::Pi;
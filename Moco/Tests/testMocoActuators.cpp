@@ -1045,6 +1045,35 @@ TEST_CASE("DeGrooteFregly2016Muscle basics") {
         CHECK(muscle.getActivation(state) == Approx(0.451));
         CHECK(state.getY()[2] == Approx(0.451));
     }
+
+    SECTION("Diagnostic counters") {
+        SimTK::State state = model.initSystem();
+        coord.setValue(state, muscle.get_optimal_fiber_length() +
+                                      muscle.get_tendon_slack_length());
+        const auto& counter =
+                muscle.getExceedingMaxContractionVelocityCounter();
+        CHECK(counter.getCount() == 0);
+        CHECK(SimTK::isNaN(counter.getFirstTime()));
+        // Much faster than the maximum contraction velocity.
+        const double speed = -100 * muscle.get_optimal_fiber_length() *
+                             muscle.get_max_contraction_velocity();
+        for (const double time : {0.5, 0.7}) {
+            state.setTime(time);
+            coord.setSpeedValue(state, speed);
+            model.realizeVelocity(state);
+            muscle.getFiberVelocityInfo(state);
+        }
+        CHECK(counter.getCount() == 2);
+        CHECK(counter.getFirstTime() == 0.5);
+        CHECK(muscle.getBucklingCounter().getCount() == 0);
+
+        // Copies of the muscle start with no events.
+        DeGrooteFregly2016Muscle copy = muscle;
+        CHECK(copy.getExceedingMaxContractionVelocityCounter().getCount() ==
+                0);
+        muscle.resetDiagnosticCounters();
+        CHECK(counter.getCount() == 0);
+    }
 }
 
 Model createHangingMuscleModel(
@@ -1263,6 +1292,172 @@ TEMPLATE_TEST_CASE("Hanging muscle minimum time", "", MocoCasADiSolver) {
     }
 }
 
+TEMPLATE_TEST_CASE("Hanging muscle equilibrium guess", "", MocoCasADiSolver) {
+    SimTK::Real initHeight = 0.15;
+    SimTK::Real finalHeight = 0.14;
+    Model model = createHangingMuscleModel(false, false, true);
+
+    MocoStudy study;
+    MocoProblem& problem = study.updProblem();
+    problem.setModelCopy(model);
+    problem.setTimeBounds(0, 0.5);
+    problem.setStateInfo(
+            "/joint/height/value", {0.14, 0.16}, initHeight, finalHeight);
+    problem.setStateInfo("/joint/height/speed", {-1, 1}, 0, 0);
+    problem.setControlInfo("/forceset/actuator", {0.01, 0.5});
+    problem.setStateInfo("/forceset/actuator/activation", {0, 1});
+    problem.addGoal<MocoControlGoal>();
+
+    auto& solver = study.initSolver<TestType>();
+    solver.set_num_mesh_intervals(10);
+    // Distribute the time points across the solver's threads.
+    solver.set_parallel(2);
+    MocoTrajectory guess = solver.createGuess("equilibrium");
+    CHECK_NOTHROW(solver.setGuess(guess));
+
+    const auto& time = guess.getTime();
+    const int N = guess.getNumTimes();
+    const auto height = guess.getState("/joint/height/value");
+    const auto speed = guess.getState("/joint/height/speed");
+    const auto excitation = guess.getControl("/forceset/actuator");
+    const auto activation = guess.getState("/forceset/actuator/activation");
+    const double slope = (finalHeight - initHeight) / (time[N - 1] - time[0]);
+    model.initSystem();
+    const auto& muscle =
+            model.getComponent<DeGrooteFregly2016Muscle>("/forceset/actuator");
+    for (int itime = 0; itime < N; ++itime) {
+        // Coordinates are interpolated linearly and speeds are consistent.
+        CHECK(height[itime] == Approx(initHeight + slope * time[itime]));
+        CHECK(speed[itime] == Approx(slope).margin(1e-4));
+        // Activations are at steady state.
+        CHECK(activation[itime] == Approx(excitation[itime]));
+
+        // The tendon force is at equilibrium.
+        SimTK::State state = model.getWorkingState();
+        state.setTime(time[itime]);
+        for (const auto& name : guess.getStateNames()) {
+            model.setStateVariableValue(
+                    state, name, guess.getState(name)[itime]);
+        }
+        model.realizeDynamics(state);
+        CHECK(muscle.getEquilibriumResidual(state) ==
+                Approx(0).margin(1e-6 * muscle.get_max_isometric_force()));
+        const double normTendonForce =
+                muscle.getNormalizedTendonForce(state);
+        muscle.computeInitialFiberEquilibrium(state);
+        CHECK(normTendonForce ==
+                Approx(muscle.getNormalizedTendonForce(state)));
+    }
+
+    // Solving from the guess gives the same solution as from the bounds.
+    solver.clearGuess();
+    const MocoSolution boundsSolution = study.solve();
+    REQUIRE(boundsSolution.success());
+    solver.setGuess(guess);
+    const MocoSolution solution = study.solve();
+    REQUIRE(solution.success());
+    CHECK(solution.getObjective() ==
+            Approx(boundsSolution.getObjective()).epsilon(1e-3));
+}
+
+TEST_CASE("Symbolic DeGrooteFregly2016Muscle dynamics") {
+    Model model = createHangingMuscleModel(false, true, true);
+    model.initSystem();
+    const auto& muscle =
+            model.getComponent<DeGrooteFregly2016Muscle>("/forceset/actuator");
+
+    SECTION("Generic scalar equations match the muscle") {
+        SimTK::State state = model.getWorkingState();
+        model.setStateVariableValue(state, "/joint/height/value", 0.148);
+        model.setStateVariableValue(state, "/joint/height/speed", -0.3);
+        model.setStateVariableValue(
+                state, "/forceset/actuator/activation", 0.4);
+        model.realizeVelocity(state);
+        SimTK::Vector& controls = model.updControls(state);
+        muscle.setControls(SimTK::Vector(1, 0.7), controls);
+        model.setControls(state, controls);
+        model.realizeAcceleration(state);
+
+        const double activation = muscle.getActivation(state);
+        CHECK(muscle.calcRigidTendonTension(activation,
+                      muscle.getLength(state),
+                      muscle.getLengtheningSpeed(state)) ==
+                Approx(muscle.getTendonForce(state)));
+        CHECK(muscle.calcActivationDerivative(0.7, activation) ==
+                Approx(muscle.getStateVariableDerivativeValue(
+                        state, "activation")));
+    }
+
+    SECTION("Solution matches the numerical muscle dynamics") {
+        auto solve = [&](bool symbolic) {
+            MocoStudy study;
+            MocoProblem& problem = study.updProblem();
+            problem.setModelCopy(model);
+            problem.setTimeBounds(0, 0.5);
+            problem.setStateInfo(
+                    "/joint/height/value", {0.14, 0.16}, 0.15, 0.14);
+            problem.setStateInfo("/joint/height/speed", {-1, 1}, 0, 0);
+            problem.setControlInfo("/forceset/actuator", {0.01, 1});
+            problem.setStateInfo("/forceset/actuator/activation", {0, 1});
+            problem.addGoal<MocoControlGoal>();
+
+            auto& solver = study.initSolver<MocoCasADiSolver>();
+            solver.set_num_mesh_intervals(20);
+            solver.set_multibody_dynamics_mode("implicit");
+            solver.set_symbolic_muscle_dynamics(symbolic);
+            return study.solve();
+        };
+        const MocoSolution numerical = solve(false);
+        const MocoSolution symbolic = solve(true);
+        REQUIRE(symbolic.success());
+        CHECK(symbolic.getObjective() ==
+                Approx(numerical.getObjective()).epsilon(1e-3));
+        OpenSim_CHECK_MATRIX_ABSTOL(symbolic.getStatesTrajectory(),
+                numerical.getStatesTrajectory(), 1e-3);
+        OpenSim_CHECK_MATRIX_ABSTOL(symbolic.getControlsTrajectory(),
+                numerical.getControlsTrajectory(), 1e-3);
+    }
+
+    SECTION("Requires implicit dynamics") {
+        MocoStudy study;
+        study.updProblem().setModelCopy(model);
+        auto& solver = study.initSolver<MocoCasADiSolver>();
+        solver.set_symbolic_muscle_dynamics(true);
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("requires implicit dynamics mode"));
+    }
+
+    SECTION("Compliant tendons are not supported") {
+        MocoStudy study;
+        study.updProblem().setModelCopy(
+                createHangingMuscleModel(false, false, false));
+        auto& solver = study.initSolver<MocoCasADiSolver>();
+        solver.set_multibody_dynamics_mode("implicit");
+        solver.set_symbolic_muscle_dynamics(true);
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("supports only rigid tendons"));
+    }
+
+    SECTION("Prescribed kinematics are not supported") {
+        MocoStudy study;
+        auto& problem = study.updProblem();
+        Model prescribedModel = model;
+        prescribedModel.initSystem();
+        const SimTK::Vector time = createVectorLinspace(10, 0, 1);
+        TimeSeriesTable coordinates(
+                std::vector<double>(time.begin(), time.end()),
+                SimTK::Matrix(10, 1, 0.15), {"/joint/height/value"});
+        prescribedModel.addComponent(PositionMotion::createFromTable(
+                prescribedModel, coordinates).release());
+        problem.setModelCopy(prescribedModel);
+        auto& solver = study.initSolver<MocoCasADiSolver>();
+        solver.set_multibody_dynamics_mode("implicit");
+        solver.set_symbolic_muscle_dynamics(true);
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("not supported with prescribed kinematics"));
+    }
+}
+
 TEST_CASE("ActivationCoordinateActuator") {
     // TODO create a problem with ACA and ensure the activation bounds are
     // set as expected.
@@ -0,0 +1,377 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: testMocoCasADiSolver.cpp                                     *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#define CATCH_CONFIG_MAIN
+#include "Testing.h"
+#include <Moco/Components/ModelFactory.h>
+#include <Moco/MocoCasADiSolver/MocoCasOCProblem.h>
+#include <Moco/MocoCasADiSolver/MocoCasOCTrace.h>
+#include <Moco/osimMoco.h>
+#include <set>
+#include <thread>
+
+using namespace OpenSim;
+
+namespace {
+/// Gives the tests access to the MocoCasOCProblem that the solver uses.
+class MocoCasADiSolverTester : public MocoCasADiSolver {
+public:
+    using MocoCasADiSolver::createCasOCProblem;
+};
+
+casadi::DM calcStateDerivatives(const CasOC::Problem& problem,
+        const casadi::DM& states, const casadi::DM& controls,
+        const casadi::DM& parameters) {
+    const double time = 0.3;
+    const casadi::DM empty(0, 1);
+    const CasOC::Problem::ContinuousInput input{
+            time, states, controls, empty, empty, parameters};
+    casadi::DM multibodyDerivatives(problem.getNumSpeeds(), 1);
+    casadi::DM auxiliaryDerivatives(problem.getNumAuxiliaryStates(), 1);
+    casadi::DM auxiliaryResiduals(0, 1);
+    casadi::DM kinematicConstraintErrors(0, 1);
+    CasOC::Problem::MultibodySystemExplicitOutput output{multibodyDerivatives,
+            auxiliaryDerivatives, auxiliaryResiduals,
+            kinematicConstraintErrors};
+    problem.calcMultibodySystemExplicit(input, false, output);
+    return multibodyDerivatives;
+}
+
+casadi::DM calcMultibodyResiduals(const CasOC::Problem& problem,
+        const casadi::DM& states, const casadi::DM& controls,
+        const casadi::DM& multipliers, const casadi::DM& derivatives) {
+    const double time = 0.3;
+    const casadi::DM parameters(0, 1);
+    const CasOC::Problem::ContinuousInput input{
+            time, states, controls, multipliers, derivatives, parameters};
+    casadi::DM multibodyResiduals(
+            problem.getNumMultibodyDynamicsEquations(), 1);
+    casadi::DM auxiliaryDerivatives(problem.getNumAuxiliaryStates(), 1);
+    casadi::DM auxiliaryResiduals(0, 1);
+    casadi::DM kinematicConstraintErrors(
+            problem.getNumKinematicConstraintEquations(), 1);
+    CasOC::Problem::MultibodySystemImplicitOutput output{multibodyResiduals,
+            auxiliaryDerivatives, auxiliaryResiduals,
+            kinematicConstraintErrors};
+    problem.calcMultibodySystemImplicit(input, true, output);
+    return multibodyResiduals;
+}
+} // anonymous namespace
+
+TEST_CASE("Apply only changed inputs") {
+    MocoProblem problem;
+    problem.setModel(OpenSim::make_unique<Model>(
+            ModelFactory::createDoublePendulum()));
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo("/jointset/j0/q0/value", {-10, 10});
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50});
+    problem.setStateInfo("/jointset/j1/q1/value", {-10, 10});
+    problem.setStateInfo("/jointset/j1/q1/speed", {-50, 50});
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.setControlInfo("/tau1", {-100, 100});
+    problem.addParameter("mass", "/bodyset/b0", "mass", MocoBounds(0.5, 2));
+
+    MocoCasADiSolverTester solver;
+    solver.resetProblem(problem);
+
+    const casadi::DM statesA(std::vector<double>{0.2, -0.3, 0.5, 1.1});
+    const casadi::DM controlsA(std::vector<double>{1.5, -2.0});
+    const casadi::DM parametersA(std::vector<double>{1.0});
+    casadi::DM statesB = statesA;
+    casadi::DM controlsB = controlsA;
+    casadi::DM parametersB = parametersA;
+    SECTION("State") { statesB(2) = 0.6; }
+    SECTION("Control") { controlsB(1) = -1.0; }
+    SECTION("Parameter") { parametersB(0) = 1.5; }
+
+    // Evaluating at A leaves A's values in the rep's state, so that the
+    // evaluation at B writes only the variable that differs.
+    auto incremental = solver.createCasOCProblem(1);
+    const casadi::DM derivativesA =
+            calcStateDerivatives(*incremental, statesA, controlsA, parametersA);
+    const casadi::DM derivativesB =
+            calcStateDerivatives(*incremental, statesB, controlsB, parametersB);
+    CHECK(casadi::DM::norm_inf(derivativesB - derivativesA).scalar() > 1e-6);
+
+    // A new problem writes all of B's values.
+    auto full = solver.createCasOCProblem(1);
+    const casadi::DM expected =
+            calcStateDerivatives(*full, statesB, controlsB, parametersB);
+    for (casadi_int i = 0; i < expected.numel(); ++i) {
+        CHECK(derivativesB(i).scalar() == Approx(expected(i).scalar()));
+    }
+
+    // Returning to A gives A's values again.
+    const casadi::DM derivativesA2 =
+            calcStateDerivatives(*incremental, statesA, controlsA, parametersA);
+    for (casadi_int i = 0; i < derivativesA.numel(); ++i) {
+        CHECK(derivativesA2(i).scalar() == Approx(derivativesA(i).scalar()));
+    }
+}
+
+TEST_CASE("NUMA node assignment") {
+    MocoProblem problem;
+    problem.setModel(OpenSim::make_unique<Model>(
+            ModelFactory::createDoublePendulum()));
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo("/jointset/j0/q0/value", {-10, 10});
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50});
+    problem.setStateInfo("/jointset/j1/q1/value", {-10, 10});
+    problem.setStateInfo("/jointset/j1/q1/speed", {-50, 50});
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.setControlInfo("/tau1", {-100, 100});
+
+    MocoCasADiSolverTester solver;
+    const bool shareModel = GENERATE(false, true);
+    solver.set_share_model_across_threads(shareModel);
+    solver.resetProblem(problem);
+
+    // Pretend that the machine has 2 NUMA nodes.
+    const int numCPUs =
+            std::max(2, (int)std::thread::hardware_concurrency());
+    std::vector<std::vector<int>> nodeCPUs(2);
+    for (int cpu = 0; cpu < numCPUs; ++cpu) nodeCPUs[cpu % 2].push_back(cpu);
+    const int numReps = 5;
+    auto casProblem = solver.createCasOCProblem(numReps, nodeCPUs);
+
+    // Evaluate the callbacks from several threads; each MocoProblemRep must
+    // return to the jar with the node it was placed on.
+    const casadi::DM states(std::vector<double>{0.2, -0.3, 0.5, 1.1});
+    const casadi::DM controls(std::vector<double>{1.5, -2.0});
+    const casadi::DM parameters(0, 1);
+    std::vector<std::thread> threads;
+    for (int ithread = 0; ithread < 4; ++ithread) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 10; ++i) {
+                calcStateDerivatives(*casProblem, states, controls, parameters);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    // The reps are distributed evenly across the nodes.
+    const auto reps = casProblem->getProblemReps();
+    REQUIRE((int)reps.size() == numReps);
+    std::vector<int> numRepsPerNode(2, 0);
+    std::vector<std::set<const Model*>> modelsPerNode(2);
+    for (const auto* rep : reps) {
+        const int node = casProblem->getProblemRepNode(*rep);
+        REQUIRE(node >= 0);
+        REQUIRE(node < 2);
+        ++numRepsPerNode[node];
+        modelsPerNode[node].insert(&rep->getModelBase());
+    }
+    CHECK(numRepsPerNode[0] == 3);
+    CHECK(numRepsPerNode[1] == 2);
+    // With a shared model, each node has its own copy of the model.
+    CHECK((int)modelsPerNode[0].size() == (shareModel ? 1 : 3));
+    CHECK((int)modelsPerNode[1].size() == (shareModel ? 1 : 2));
+    CHECK(*modelsPerNode[0].begin() != *modelsPerNode[1].begin());
+}
+
+TEST_CASE("Implicit multibody residuals with kinematic constraints") {
+    // Without auxiliary states, the residuals are computed from the forces at
+    // Stage::Dynamics and the udot from the optimizer. They must match the
+    // residuals obtained by prescribing udot with the AccelerationMotion and
+    // realizing to Stage::Acceleration.
+    auto model = ModelFactory::createDoublePendulum();
+    auto* constraint = new CoordinateCouplerConstraint();
+    Array<std::string> names;
+    names.append("q0");
+    constraint->setIndependentCoordinateNames(names);
+    constraint->setDependentCoordinateName("q1");
+    LinearFunction func(1.0, 0.0);
+    constraint->setFunction(func);
+    model.addConstraint(constraint);
+
+    MocoProblem problem;
+    problem.setModelCopy(model);
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo("/jointset/j0/q0/value", {-10, 10});
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50});
+    problem.setStateInfo("/jointset/j1/q1/value", {-10, 10});
+    problem.setStateInfo("/jointset/j1/q1/speed", {-50, 50});
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.setControlInfo("/tau1", {-100, 100});
+
+    MocoCasADiSolverTester solver;
+    solver.set_multibody_dynamics_mode("implicit");
+    solver.set_enforce_constraint_derivatives(true);
+    solver.resetProblem(problem);
+    auto casProblem = solver.createCasOCProblem(1);
+    REQUIRE(casProblem->getNumMultipliers() == 1);
+    REQUIRE(casProblem->getNumAccelerations() == 2);
+
+    const casadi::DM states(std::vector<double>{0.2, -0.3, 0.5, 1.1});
+    const casadi::DM controls(std::vector<double>{1.5, -2.0});
+    const casadi::DM multipliers(std::vector<double>{0.7});
+    const casadi::DM derivatives(std::vector<double>{-1.2, 2.4});
+
+    // The constraint forces from the multipliers enter the residuals.
+    const casadi::DM noMultipliers(std::vector<double>{0});
+    const casadi::DM residualsNoMultipliers = calcMultibodyResiduals(
+            *casProblem, states, controls, noMultipliers, derivatives);
+    const casadi::DM residuals = calcMultibodyResiduals(
+            *casProblem, states, controls, multipliers, derivatives);
+    CHECK(casadi::DM::norm_inf(residuals - residualsNoMultipliers).scalar() >
+            1e-6);
+
+    // The rep's state holds the inputs (including the constraint forces)
+    // from the last evaluation.
+    const auto* rep = casProblem->getProblemReps()[0];
+    const auto& modelDisabledConstraints = rep->getModelDisabledConstraints();
+    auto& state = rep->updStateDisabledConstraints();
+    const auto& accel = rep->getAccelerationMotion();
+    accel.setEnabled(state, true);
+    accel.setUDot(state, SimTK::Vector(2, derivatives.ptr(), true));
+    modelDisabledConstraints.realizeAcceleration(state);
+    SimTK::Vector expected;
+    modelDisabledConstraints.getMatterSubsystem().findMotionForces(
+            state, expected);
+    accel.setEnabled(state, false);
+
+    REQUIRE(expected.size() == residuals.numel());
+    for (int i = 0; i < expected.size(); ++i) {
+        CHECK(residuals(i).scalar() == Approx(expected[i]).margin(1e-10));
+    }
+}
+
+TEST_CASE("Implicit multibody residuals with prescribed kinematics") {
+    // With prescribed kinematics, udot comes from the PositionMotion, so the
+    // residuals are still computed at Stage::Acceleration. They must match
+    // the inverse dynamics residuals for the prescribed udot.
+    auto model = ModelFactory::createDoublePendulum();
+    model.initSystem();
+    const SimTK::Vector time = createVectorLinspace(10, 0, 1);
+    SimTK::Matrix coordinatesMatrix(10, 2);
+    for (int i = 0; i < time.size(); ++i) {
+        coordinatesMatrix(i, 0) = 0.5 * std::sin(3 * time[i]);
+        coordinatesMatrix(i, 1) = -0.2 + time[i] * time[i];
+    }
+    TimeSeriesTable coordinates(std::vector<double>(time.begin(), time.end()),
+            coordinatesMatrix,
+            {"/jointset/j0/q0/value", "/jointset/j1/q1/value"});
+    model.addComponent(
+            PositionMotion::createFromTable(model, coordinates).release());
+
+    MocoProblem problem;
+    problem.setModelCopy(model);
+    problem.setTimeBounds(0, 1);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.setControlInfo("/tau1", {-100, 100});
+
+    MocoCasADiSolverTester solver;
+    solver.set_multibody_dynamics_mode("implicit");
+    solver.resetProblem(problem);
+    auto casProblem = solver.createCasOCProblem(1);
+    REQUIRE(casProblem->isPrescribedKinematics());
+    REQUIRE(casProblem->getNumAccelerations() == 0);
+
+    const casadi::DM empty(0, 1);
+    const casadi::DM controls(std::vector<double>{1.5, -2.0});
+    const casadi::DM residuals =
+            calcMultibodyResiduals(*casProblem, empty, controls, empty, empty);
+
+    // The rep's state is realized to Stage::Acceleration with the prescribed
+    // udot.
+    const auto* rep = casProblem->getProblemReps()[0];
+    const auto& modelDisabledConstraints = rep->getModelDisabledConstraints();
+    const auto& state = rep->updStateDisabledConstraints();
+    const auto& udot = state.getUDot();
+    CHECK(udot.normInf() > 1e-6);
+    const auto& system = modelDisabledConstraints.getMultibodySystem();
+    SimTK::Vector expected;
+    modelDisabledConstraints.getMatterSubsystem().calcResidualForce(state,
+            system.getMobilityForces(state, SimTK::Stage::Dynamics),
+            system.getRigidBodyForces(state, SimTK::Stage::Dynamics), udot,
+            SimTK::Vector(), expected);
+
+    REQUIRE(expected.size() == residuals.numel());
+    for (int i = 0; i < expected.size(); ++i) {
+        CHECK(residuals(i).scalar() == Approx(expected[i]).margin(1e-10));
+    }
+}
+
+TEST_CASE("Callback trace replay") {
+    MocoStudy study;
+    study.set_write_solution("false");
+    auto& problem = study.updProblem();
+    problem.setModel(OpenSim::make_unique<Model>(
+            ModelFactory::createSlidingPointMass()));
+    problem.setTimeBounds(0, {0, 10});
+    problem.setStateInfo("/slider/position/value", {0, 1}, 0, 1);
+    problem.setStateInfo("/slider/position/speed", {-100, 100}, 0, 0);
+    problem.addGoal<MocoFinalTimeGoal>("time");
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(10);
+    const std::string traceFile = "testMocoCasADiSolver_callback_trace.bin";
+    solver.set_callback_trace_file(traceFile);
+
+    SECTION("Replay evaluates the recorded callbacks") {
+        problem.addGoal<MocoControlGoal>("effort", 0.1);
+        solver.set_transcription_scheme("trapezoidal");
+        study.solve();
+        const MocoCasOCTrace trace = MocoCasOCTrace::read(traceFile);
+        const auto& records = trace.getRecords();
+        REQUIRE(!records.empty());
+        // The final time goal is evaluated only by the endpoint function,
+        // which is not recorded.
+        for (const auto& record : records) {
+            if (record.callback == MocoCasOCTrace::Callback::CostIntegrand) {
+                CHECK(record.index == 1);
+            }
+        }
+
+        // Replaying with a problem that records its own trace writes the
+        // same records.
+        MocoCasADiSolverTester replayer;
+        replayer.resetProblem(problem);
+        const std::string replayFile =
+                "testMocoCasADiSolver_callback_trace_replay.bin";
+        {
+            auto casProblem = replayer.createCasOCProblem(1);
+            casProblem->recordCallbackTrace(replayFile);
+            const auto times = trace.replay(*casProblem, 1);
+            CHECK(times.latencies.size() == records.size());
+        }
+        const MocoCasOCTrace replayed = MocoCasOCTrace::read(replayFile);
+        const auto& replayedRecords = replayed.getRecords();
+        REQUIRE(replayedRecords.size() == records.size());
+        for (int i = 0; i < (int)records.size(); ++i) {
+            const auto& expected = records[i];
+            const auto& actual = replayedRecords[i];
+            CHECK(actual.callback == expected.callback);
+            CHECK(actual.index == expected.index);
+            CHECK(actual.time == expected.time);
+            using casadi::DM;
+            CHECK(DM::norm_inf(actual.states - expected.states).scalar() == 0);
+            CHECK(DM::norm_inf(actual.controls - expected.controls).scalar() ==
+                    0);
+            CHECK(DM::norm_inf(actual.parameters - expected.parameters)
+                            .scalar() == 0);
+        }
+    }
+
+    SECTION("Interval integration is not recorded") {
+        // With multiple shooting, the dynamics are only integrated across
+        // intervals, and the only goal is an endpoint goal.
+        solver.set_transcription_scheme("multiple-shooting");
+        study.solve();
+        CHECK(MocoCasOCTrace::read(traceFile).getRecords().empty());
+    }
+}
@@ -22,6 +22,7 @@
 
 #include <OpenSim/Actuators/CoordinateActuator.h>
 #include <OpenSim/Actuators/PointActuator.h>
+#include <OpenSim/Simulation/Model/PhysicalOffsetFrame.h>
 #include <OpenSim/Simulation/SimbodyEngine/PinJoint.h>
 #include <OpenSim/Simulation/SimbodyEngine/SliderJoint.h>
 
@@ -410,6 +411,72 @@ TEMPLATE_TEST_CASE(
     CHECK(solution.getObjective() == Approx(0.0).margin(1e-6));
 }
 
+TEST_CASE("JointReactions matches Joint reaction loads") {
+    Model model = ModelFactory::createDoublePendulum();
+    auto* jointReactions = new JointReactions("joint_reactions");
+    model.addComponent(jointReactions);
+    SimTK::State state = model.initSystem();
+    model.setStateVariableValue(state, "/jointset/j0/q0/value", 0.3);
+    model.setStateVariableValue(state, "/jointset/j1/q1/value", -0.7);
+    model.setStateVariableValue(state, "/jointset/j0/q0/speed", 1.5);
+    model.setStateVariableValue(state, "/jointset/j1/q1/speed", -2.0);
+    model.realizeAcceleration(state);
+
+    for (const auto& joint : model.getComponentList<Joint>()) {
+        CAPTURE(joint.getName());
+        const SimTK::SpatialVec onChild =
+                joint.calcReactionOnChildExpressedInGround(state);
+        const SimTK::SpatialVec onParent =
+                joint.calcReactionOnParentExpressedInGround(state);
+        const SimTK::SpatialVec cachedOnChild =
+                jointReactions->calcReactionOnChildExpressedInGround(
+                        state, joint);
+        const SimTK::SpatialVec cachedOnParent =
+                jointReactions->calcReactionOnParentExpressedInGround(
+                        state, joint);
+        // The outputs have a channel for each joint.
+        const SimTK::SpatialVec outputOnChild =
+                jointReactions->getReactionOnChildExpressedInGround(
+                        state, joint.getName());
+        for (int i = 0; i < 2; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                CHECK(cachedOnChild[i][j] ==
+                        Approx(onChild[i][j]).margin(1e-10));
+                CHECK(cachedOnParent[i][j] ==
+                        Approx(onParent[i][j]).margin(1e-10));
+                CHECK(outputOnChild[i][j] ==
+                        Approx(onChild[i][j]).margin(1e-10));
+            }
+        }
+    }
+
+    // MocoProblemRep adds the component only for MocoJointReactionGoals, and
+    // only if the model does not contain one.
+    MocoProblem problem;
+    Model modelWithoutReactions = ModelFactory::createDoublePendulum();
+    // The name that MocoProblemRep would use is taken.
+    modelWithoutReactions.addComponent(
+            new PhysicalOffsetFrame("moco_joint_reactions",
+                    modelWithoutReactions.getGround(), SimTK::Transform()));
+    problem.setModelCopy(modelWithoutReactions);
+    CHECK(problem.createRep().getModelBase()
+                    .countNumComponents<JointReactions>() == 0);
+    auto* goal = problem.addGoal<MocoJointReactionGoal>("reaction");
+    goal->setJointPath("/jointset/j1");
+    {
+        const MocoProblemRep rep = problem.createRep();
+        const auto& modelBase = rep.getModelBase();
+        CHECK(modelBase.countNumComponents<JointReactions>() == 1);
+        CHECK(modelBase.hasComponent<JointReactions>(
+                "moco_joint_reactions_1"));
+        CHECK(modelBase.hasComponent<PhysicalOffsetFrame>(
+                "moco_joint_reactions"));
+    }
+    problem.setModelCopy(model);
+    CHECK(problem.createRep().getModelBase()
+                    .countNumComponents<JointReactions>() == 1);
+}
+
 TEST_CASE("Test MocoSumSquaredStateGoal") {
     using SimTK::Inertia;
     using SimTK::Vec3;
@@ -661,6 +728,49 @@ TEMPLATE_TEST_CASE("Endpoint constraint with integral", "", MocoCasADiSolver) {
     CHECK(solution.getControlsTrajectory().norm() < 1e-3);
 }
 
+TEST_CASE("Endpoint goals with parallel finite differences") {
+    // The endpoint values of all goals are computed together, and their finite
+    // differences are evaluated across threads if parallel > 1. The solution
+    // should not depend on the number of threads.
+    auto solve = [](int parallel, const std::string& scheme) {
+        MocoStudy study;
+        auto& problem = study.updProblem();
+        problem.setModelCopy(ModelFactory::createPendulum());
+        problem.setTimeBounds(0, 1);
+        problem.setStateInfo("/jointset/j0/q0/value", {-1.0, 1.0}, 0.1);
+        problem.setStateInfo("/jointset/j0/q0/speed", {-10, 10}, 0);
+
+        auto* periodic = problem.addGoal<MocoPeriodicityGoal>("periodic");
+        periodic->addStatePair(
+                {"/jointset/j0/q0/value", "/jointset/j0/q0/value"});
+        periodic->addStatePair(
+                {"/jointset/j0/q0/speed", "/jointset/j0/q0/speed"});
+        auto* periodicControl =
+                problem.addGoal<MocoPeriodicityGoal>("periodic_control");
+        periodicControl->setMode("cost");
+        periodicControl->addControlPair({"/tau0"});
+        problem.addGoal<MocoControlGoal>("control");
+        problem.addGoal<MocoControlGoalWithEndpointConstraint>("integral")
+                ->setMode("cost");
+
+        auto& solver = study.initCasADiSolver();
+        solver.set_num_mesh_intervals(10);
+        solver.set_optim_finite_difference_scheme(scheme);
+        solver.set_parallel(parallel);
+        return study.solve();
+    };
+    for (const std::string scheme : {"central", "forward", "backward"}) {
+        CAPTURE(scheme);
+        const auto serial = solve(0, scheme);
+        const auto parallel = solve(3, scheme);
+        REQUIRE(serial.success());
+        REQUIRE(parallel.success());
+        CHECK(parallel.getObjective() ==
+                Approx(serial.getObjective()).epsilon(1e-4));
+        CHECK(parallel.isNumericallyEqual(serial, 1e-3));
+    }
+}
+
 class MySumSquaredControls : public ModelComponent {
     OpenSim_DECLARE_CONCRETE_OBJECT(MySumSquaredControls, ModelComponent);
 public:
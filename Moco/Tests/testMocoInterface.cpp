@@ -19,6 +19,7 @@
 #define CATCH_CONFIG_MAIN
 #include "Testing.h"
 #include <Moco/osimMoco.h>
+#include <atomic>
 #include <fstream>
 
 #include <OpenSim/Actuators/BodyActuator.h>
@@ -924,6 +925,67 @@ TEMPLATE_TEST_CASE("State tracking", "", MocoTropterSolver, MocoCasADiSolver) {
     // TODO error if data does not cover time window.
 }
 
+TEST_CASE("Gauss-Newton Hessian approximation") {
+    auto makeStudy = []() {
+        MocoStudy study;
+        study.set_write_solution("false");
+        MocoProblem& mp = study.updProblem();
+        mp.setModel(createSlidingMassModel());
+        mp.setTimeBounds(0, 1);
+        mp.setStateInfo("/slider/position/value", {-1, 1}, 0);
+        mp.setStateInfo("/slider/position/speed", {-100, 100}, 0);
+        mp.setControlInfo("/actuator", {-50, 50});
+        TimeSeriesTable ref;
+        ref.setColumnLabels({"/slider/position/value"});
+        for (double time = -0.01; time < 1.02; time += 0.01) {
+            ref.appendRow(time, {0.5 * std::sin(SimTK::Pi * time)});
+        }
+        auto* tracking = mp.addGoal<MocoStateTrackingGoal>("tracking", 10.0);
+        tracking->setReference(ref);
+        mp.addGoal<MocoControlGoal>("effort", 0.01);
+        return study;
+    };
+
+    auto solve = [&](const std::string& hessian) {
+        auto study = makeStudy();
+        auto& solver = study.initCasADiSolver();
+        solver.set_num_mesh_intervals(20);
+        solver.set_optim_hessian_approximation(hessian);
+        return study.solve();
+    };
+    const MocoSolution exact = solve("exact");
+    const MocoSolution gaussNewton = solve("gauss-newton");
+    REQUIRE(gaussNewton.success());
+    // Constraint curvature is neglected, so the iterates differ, but the
+    // optimum is the same.
+    CHECK(gaussNewton.getObjective() ==
+            Approx(exact.getObjective()).epsilon(1e-4));
+    OpenSim_CHECK_MATRIX_ABSTOL(gaussNewton.getStatesTrajectory(),
+            exact.getStatesTrajectory(), 1e-3);
+
+    auto study = makeStudy();
+    study.initTropterSolver().set_optim_hessian_approximation(
+            "gauss-newton");
+    CHECK_THROWS_WITH(study.solve(),
+            Catch::Contains("only supported by MocoCasADiSolver"));
+
+    // A goal with a negative weight for one of its terms is not a sum of
+    // squares, so it does not provide residuals (whose weights would be the
+    // square roots of the weights).
+    auto& problem = study.updProblem();
+    auto& tracking =
+            dynamic_cast<MocoStateTrackingGoal&>(problem.updGoal("tracking"));
+    {
+        const MocoProblemRep rep = problem.createRep();
+        CHECK(rep.getCost("tracking").getNumIntegrandResiduals() == 1);
+    }
+    tracking.setWeightForState("/slider/position/value", -1);
+    {
+        const MocoProblemRep rep = problem.createRep();
+        CHECK(rep.getCost("tracking").getNumIntegrandResiduals() == 0);
+    }
+}
+
 TEMPLATE_TEST_CASE("Guess", "", MocoTropterSolver, MocoCasADiSolver) {
 
     MocoStudy study = createSlidingMassMocoStudy<TestType>();
@@ -1741,6 +1803,543 @@ TEMPLATE_TEST_CASE("Sliding mass", "", MocoTropterSolver, MocoCasADiSolver) {
     }
 }
 
+TEST_CASE("Sliding mass with multiple shooting") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_transcription_scheme("multiple-shooting");
+
+    SECTION("Requires explicit dynamics") {
+        solver.set_multibody_dynamics_mode("implicit");
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("requires the 'explicit'"));
+    }
+
+    SECTION("Solve") {
+        MocoSolution solution = study.solve();
+        const int numTimes = 20;
+        REQUIRE(solution.getTime().size() == numTimes);
+        // The controls are held constant across each interval, so the
+        // bang-bang switch cannot occur exactly at the midpoint.
+        CHECK(solution.getFinalTime() == Approx(2.0).epsilon(5e-2));
+        const auto& states = solution.getStatesTrajectory();
+        CHECK(states(numTimes - 1, 0) == Approx(1.0).margin(1e-6));
+        CHECK(states(numTimes - 1, 1) == Approx(0.0).margin(1e-6));
+    }
+}
+
+TEST_CASE("Sensitivities to goal weights and parameters") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& problem = study.updProblem();
+    auto* effort = problem.addGoal<MocoControlGoal>("effort", 0.1);
+    auto* mass =
+            problem.addParameter("mass", "/body", "mass", MocoBounds(10));
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+
+    SECTION("Not computed by default") {
+        MocoSolution solution = study.solve();
+        CHECK(!solution.hasSensitivities());
+        CHECK_THROWS_WITH(solution.getSensitivityToGoalWeight("effort"),
+                Catch::Contains("No sensitivity"));
+    }
+
+    SECTION("Predict re-solves") {
+        solver.set_compute_sensitivities(true);
+        MocoSolution solution = study.solve();
+        REQUIRE(solution.hasSensitivities());
+        CHECK_THROWS_WITH(solution.getSensitivityToParameter("nonexistent"),
+                Catch::Contains("No sensitivity"));
+
+        // A larger weight on effort or a larger mass slows the mass down.
+        const double dtf_dweight =
+                solution.getSensitivityToGoalWeight("effort").getFinalTime();
+        const double dtf_dmass =
+                solution.getSensitivityToParameter("mass").getFinalTime();
+        CHECK(dtf_dweight > 0);
+        CHECK(dtf_dmass > 0);
+
+        const double deltaWeight = 0.01;
+        const double deltaMass = 0.5;
+        MocoTrajectory prediction = solution.predictSolution(
+                {{"effort", deltaWeight}}, {{"mass", deltaMass}});
+        CHECK(prediction.getParameter("mass") == Approx(10 + deltaMass));
+
+        effort->setWeight(0.1 + deltaWeight);
+        mass->setBounds(MocoBounds(10 + deltaMass));
+        solver.set_compute_sensitivities(false);
+        solver.setGuess(prediction);
+        MocoSolution resolved = study.solve();
+        const double actualChange =
+                resolved.getFinalTime() - solution.getFinalTime();
+        const double predictedChange =
+                prediction.getFinalTime() - solution.getFinalTime();
+        CHECK(predictedChange == Approx(actualChange).epsilon(0.1));
+        CHECK(prediction.compareContinuousVariablesRMS(resolved) <
+                solution.compareContinuousVariablesRMS(resolved));
+    }
+
+    SECTION("Redundant active constraints") {
+        solver.set_compute_sensitivities(true);
+        MocoSolution expected = study.solve();
+        REQUIRE(expected.hasSensitivities());
+
+        // The initial and final speeds are already fixed to 0, so this
+        // constraint depends on the speeds' bounds.
+        auto* periodic = problem.addGoal<MocoPeriodicityGoal>("periodic");
+        periodic->addStatePair({"/slider/position/speed"});
+        periodic->setMode("endpoint_constraint");
+        MocoSolution solution = study.solve();
+        REQUIRE(solution.hasSensitivities());
+        const double dtf_dweight =
+                solution.getSensitivityToGoalWeight("effort").getFinalTime();
+        CHECK(std::isfinite(dtf_dweight));
+        CHECK(dtf_dweight ==
+                Approx(expected.getSensitivityToGoalWeight("effort")
+                                .getFinalTime())
+                        .epsilon(1e-3));
+        CHECK(solution.getSensitivityToParameter("mass").getFinalTime() ==
+                Approx(expected.getSensitivityToParameter("mass")
+                                .getFinalTime())
+                        .epsilon(1e-3));
+    }
+
+    SECTION("Free parameters have no sensitivities") {
+        mass->setBounds(MocoBounds(5, 20));
+        solver.set_compute_sensitivities(true);
+        MocoSolution solution = study.solve();
+        REQUIRE(solution.hasSensitivities());
+        CHECK_NOTHROW(solution.getSensitivityToGoalWeight("effort"));
+        CHECK_THROWS_WITH(solution.getSensitivityToParameter("mass"),
+                Catch::Contains("No sensitivity"));
+    }
+}
+
+TEST_CASE("Automatic scaling") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& problem = study.updProblem();
+    problem.addGoal<MocoControlGoal>("effort", 0.1);
+    problem.addParameter("mass", "/body", "mass", MocoBounds(10));
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_compute_sensitivities(true);
+    const MocoSolution unscaled = study.solve();
+
+    solver.set_optim_automatic_scaling(true);
+    const MocoSolution scaled = study.solve();
+    REQUIRE(scaled.success());
+    // The solution is returned in terms of the unscaled variables.
+    CHECK(scaled.getObjective() ==
+            Approx(unscaled.getObjective()).epsilon(1e-4));
+    CHECK(scaled.getFinalTime() ==
+            Approx(unscaled.getFinalTime()).epsilon(1e-3));
+    CHECK(scaled.getParameter("mass") == Approx(10));
+    CHECK(scaled.compareContinuousVariablesRMS(unscaled) < 1e-3);
+    CHECK(scaled.getSensitivityToGoalWeight("effort").getFinalTime() ==
+            Approx(unscaled.getSensitivityToGoalWeight("effort")
+                            .getFinalTime())
+                    .epsilon(1e-2));
+    CHECK(scaled.getSensitivityToParameter("mass").getFinalTime() ==
+            Approx(unscaled.getSensitivityToParameter("mass").getFinalTime())
+                    .epsilon(1e-2));
+}
+
+TEST_CASE("Share model across threads") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& problem = study.updProblem();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_parallel(4);
+
+    SECTION("MocoProblemRep") {
+        std::shared_ptr<const MocoProblemRep> rep(problem.createRepHeap());
+        auto shared0 = MocoProblemRep::createRepSharingModels(rep);
+        auto shared1 = MocoProblemRep::createRepSharingModels(rep);
+        CHECK(&shared0->getModelBase() == &rep->getModelBase());
+        CHECK(&shared1->getModelDisabledConstraints() ==
+                &rep->getModelDisabledConstraints());
+        CHECK(&shared1->getCostByIndex(0) == &rep->getCostByIndex(0));
+        CHECK(&shared0->updStateBase() != &shared1->updStateBase());
+        CHECK(&shared0->updStateDisabledConstraints() !=
+                &rep->updStateDisabledConstraints());
+        CHECK(shared0->createStateInfoNames() == rep->createStateInfoNames());
+        CHECK_THROWS_WITH(shared0->applyParametersToModelProperties(
+                        SimTK::Vector()),
+                Catch::Contains("shared with other MocoProblemReps"));
+    }
+    SECTION("Same solution") {
+        const MocoSolution expected = study.solve();
+        solver.set_share_model_across_threads(true);
+        const MocoSolution solution = study.solve();
+        REQUIRE(solution.success());
+        CHECK(solution.getObjective() == Approx(expected.getObjective()));
+        CHECK(solution.compareContinuousVariablesRMS(expected) < 1e-6);
+    }
+    SECTION("Requires no parameters") {
+        problem.addParameter("mass", "/body", "mass", MocoBounds(10));
+        solver.set_share_model_across_threads(true);
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("without MocoParameters"));
+    }
+    SECTION("MocoOutputGoal is not supported") {
+        auto* goal = problem.addGoal<MocoOutputGoal>("speed");
+        goal->setOutputPath("/slider/position|speed");
+        solver.set_share_model_across_threads(true);
+        CHECK_THROWS_WITH(study.solve(), Catch::Contains("MocoOutputGoal"));
+    }
+}
+
+TEST_CASE("NUMA-aware parallelism") {
+    SECTION("ThreadsafeJar keys") {
+        ThreadsafeJar<int> jar;
+        jar.leave(OpenSim::make_unique<int>(0), 0);
+        jar.leave(OpenSim::make_unique<int>(1), 1);
+        jar.leave(OpenSim::make_unique<int>(2), 0);
+        int key = -1;
+        auto one = jar.take(1, key);
+        CHECK(*one == 1);
+        CHECK(key == 1);
+        // The jar forgets the key of a taken entry, so the entry must be
+        // given its key again when it is returned.
+        jar.leave(std::move(one), key);
+        CHECK(*jar.take(1) == 1);
+        // If no entry has the requested key, any entry is returned.
+        auto other = jar.take(1, key);
+        CHECK(*other != 1);
+        CHECK(key == 0);
+        CHECK(jar.size() == 1);
+    }
+    SECTION("Same solution") {
+        CHECK(getNUMANodeCPUs().size() >= 1);
+        MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+        auto& solver = study.updSolver<MocoCasADiSolver>();
+        solver.set_parallel(4);
+        const MocoSolution expected = study.solve();
+        solver.set_numa_aware_parallelism(true);
+        const bool shareModel = GENERATE(false, true);
+        solver.set_share_model_across_threads(shareModel);
+        const MocoSolution solution = study.solve();
+        REQUIRE(solution.success());
+        CHECK(solution.compareContinuousVariablesRMS(expected) < 1e-6);
+    }
+}
+
+TEST_CASE("Adaptive finite differences") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& problem = study.updProblem();
+    problem.addParameter("mass", "/body", "mass", MocoBounds(10));
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    // The endpoint function uses the adaptive steps whether or not the
+    // problem is solved in parallel.
+    const int parallel = GENERATE(0, 2);
+    solver.set_parallel(parallel);
+    const MocoSolution expected = study.solve();
+    REQUIRE(expected.success());
+
+    solver.set_optim_finite_difference_scheme("adaptive");
+    const MocoSolution solution = study.solve();
+    REQUIRE(solution.success());
+    CHECK(solution.getObjective() ==
+            Approx(expected.getObjective()).epsilon(1e-4));
+    CHECK(solution.getParameter("mass") == Approx(10));
+    CHECK(solution.compareContinuousVariablesRMS(expected) < 1e-3);
+    // Convergence is close to that of central differences.
+    CHECK(solution.getNumIterations() <=
+            expected.getNumIterations() + expected.getNumIterations() / 4 + 2);
+
+    solver.set_optim_finite_difference_scheme("centered");
+    CHECK_THROWS(study.solve());
+}
+
+TEST_CASE("Jacobian reuse") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    const MocoSolution expected = study.solve();
+
+    solver.set_optim_jacobian_refresh_interval(0);
+    CHECK_THROWS(study.solve());
+
+    solver.set_optim_jacobian_refresh_interval(5);
+    SECTION("Solve") {
+        const std::string scheme = GENERATE(as<std::string>{}, "central",
+                "forward", "adaptive");
+        solver.set_optim_finite_difference_scheme(scheme);
+        const MocoSolution solution = study.solve();
+        REQUIRE(solution.success());
+        CHECK(solution.getObjective() ==
+                Approx(expected.getObjective()).epsilon(1e-3));
+        CHECK(solution.compareContinuousVariablesRMS(expected) < 1e-2);
+    }
+    SECTION("Exact Hessian") {
+        solver.set_optim_hessian_approximation("exact");
+        CHECK_THROWS_WITH(study.solve(), Catch::Contains("exact Hessian"));
+    }
+}
+
+/// A MocoControlGoal that counts the evaluations of its integrand.
+class MocoCountingControlGoal : public MocoControlGoal {
+    OpenSim_DECLARE_CONCRETE_OBJECT(MocoCountingControlGoal, MocoControlGoal);
+
+public:
+    static std::atomic<int> numEvaluations;
+
+protected:
+    void calcIntegrandImpl(const IntegrandInput& input,
+            SimTK::Real& integrand) const override {
+        ++numEvaluations;
+        MocoControlGoal::calcIntegrandImpl(input, integrand);
+    }
+};
+std::atomic<int> MocoCountingControlGoal::numEvaluations{0};
+
+TEST_CASE("Jacobian reuse with nonlinear dynamics") {
+    MocoStudy study;
+    study.set_write_solution("false");
+    auto& problem = study.updProblem();
+    problem.setModelCopy(ModelFactory::createDoublePendulum());
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo("/jointset/j0/q0/value", {-10, 10}, 0, SimTK::Pi);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setStateInfo("/jointset/j1/q1/value", {-10, 10}, 0, 0);
+    problem.setStateInfo("/jointset/j1/q1/speed", {-50, 50}, 0, 0);
+    problem.setControlInfo("/tau0", {-100, 100});
+    problem.setControlInfo("/tau1", {-100, 100});
+    problem.addGoal<MocoCountingControlGoal>();
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(20);
+    // Evaluate the mesh points in order, as a single caller.
+    solver.set_parallel(0);
+
+    MocoCountingControlGoal::numEvaluations = 0;
+    const MocoSolution expected = study.solve();
+    REQUIRE(expected.success());
+    const int expectedNumEvaluations = MocoCountingControlGoal::numEvaluations;
+
+    // Each mesh point keeps its own Jacobian, even though neighboring mesh
+    // points are close to each other.
+    solver.set_optim_jacobian_refresh_interval(5);
+    MocoCountingControlGoal::numEvaluations = 0;
+    const MocoSolution solution = study.solve();
+    REQUIRE(solution.success());
+    CHECK(solution.getObjective() ==
+            Approx(expected.getObjective()).epsilon(1e-3));
+    CHECK(solution.getNumIterations() <=
+            expected.getNumIterations() + expected.getNumIterations() / 2 + 5);
+    CHECK(MocoCountingControlGoal::numEvaluations < expectedNumEvaluations);
+}
+
+TEST_CASE("Callback trace") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    const std::string traceFile = "testMocoInterface_callback_trace.bin";
+    solver.set_callback_trace_file(traceFile);
+    const MocoSolution solution = study.solve();
+    REQUIRE(solution.success());
+    {
+        // The header alone is 28 bytes.
+        std::ifstream stream(traceFile, std::ios::binary | std::ios::ate);
+        CHECK(stream.tellg() > 28);
+    }
+
+    const int numThreads = GENERATE(1, 2);
+    CHECK_NOTHROW(solver.replayCallbackTrace(traceFile, numThreads));
+    CHECK_THROWS_WITH(solver.replayCallbackTrace("nonexistent.bin"),
+            Catch::Contains("Could not open"));
+
+    // The trace does not match a problem with a parameter.
+    auto& problem = study.updProblem();
+    problem.addParameter("mass", "/body", "mass", MocoBounds(10));
+    solver.resetProblem(problem);
+    CHECK_THROWS_WITH(solver.replayCallbackTrace(traceFile),
+            Catch::Contains("parameters"));
+}
+
+TEST_CASE("Time windows") {
+    MocoStudy study;
+    study.set_write_solution("false");
+    MocoProblem& problem = study.updProblem();
+    problem.setModel(createSlidingMassModel());
+    problem.setTimeBounds(0, 2);
+    problem.setStateInfo("/slider/position/value", {0, 1}, 0, 1);
+    problem.setStateInfo("/slider/position/speed", {-100, 100}, 0, 0);
+    // The effort grows with the mass, so every window chooses the smallest
+    // mass.
+    problem.addParameter("mass", "/body", "mass", MocoBounds(5, 15));
+    auto* effort = problem.addGoal<MocoControlGoal>("effort");
+    auto& solver = study.initCasADiSolver();
+    solver.set_num_mesh_intervals(40);
+    solver.set_transcription_scheme("trapezoidal");
+    MocoSolution expected = study.solve();
+    REQUIRE(expected.getParameter("mass") == Approx(5).margin(1e-6));
+
+    solver.set_num_time_windows(4);
+    SECTION("Requires fixed time bounds") {
+        problem.setTimeBounds(0, {1, 2});
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("fixed initial and final times"));
+    }
+    SECTION("Rejects goals that depend on the endpoints") {
+        SECTION("Endpoint cost") { problem.addGoal<MocoFinalTimeGoal>(); }
+        SECTION("Divided by displacement") {
+            effort->setDivideByDisplacement(true);
+        }
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("depends on the initial or final state"));
+    }
+    SECTION("Rejects endpoint constraints") {
+        auto* periodic = problem.addGoal<MocoPeriodicityGoal>("periodic");
+        periodic->addStatePair({"/slider/position/speed"});
+        periodic->setMode("endpoint_constraint");
+        CHECK_THROWS_WITH(study.solve(),
+                Catch::Contains("do not support endpoint constraints"));
+    }
+    SECTION("Solve") {
+        const int concurrency = GENERATE(1, 2);
+        solver.set_time_window_concurrency(concurrency);
+        solver.set_time_window_max_iterations(10);
+        solver.set_time_window_tolerance(1e-4);
+        // Each window records its own trace, even when windows are solved
+        // at the same time.
+        const std::string traceStem = "testMocoInterface_time_windows_trace_" +
+                                      std::to_string(concurrency);
+        const std::string traceFile = traceStem + ".bin";
+        std::remove(traceFile.c_str());
+        solver.set_callback_trace_file(traceFile);
+        MocoSolution solution = study.solve();
+        REQUIRE(solution.success());
+        CHECK(!std::ifstream(traceFile));
+        for (int iw = 0; iw < 4; ++iw) {
+            const std::string windowTraceFile =
+                    traceStem + "_window" + std::to_string(iw) + ".bin";
+            std::ifstream stream(
+                    windowTraceFile, std::ios::binary | std::ios::ate);
+            REQUIRE(stream);
+            // The header alone is 28 bytes.
+            CHECK(stream.tellg() > 28);
+        }
+        CHECK(solution.getInitialTime() == Approx(0));
+        CHECK(solution.getFinalTime() == Approx(2));
+        const auto& states = solution.getStatesTrajectory();
+        const int last = solution.getNumTimes() - 1;
+        CHECK(states(last, 0) == Approx(1).margin(1e-6));
+        CHECK(states(last, 1) == Approx(0).margin(1e-6));
+        CHECK(solution.compareContinuousVariablesRMS(expected) < 1e-2);
+        CHECK(solution.getParameter("mass") == Approx(5).margin(1e-6));
+        // The objective is that of the whole trajectory; summing the
+        // windows' objectives would count the overlaps twice.
+        CHECK(solution.getObjective() ==
+                Approx(expected.getObjective()).epsilon(1e-2));
+        CHECK(solution.getObjectiveTerm("effort") ==
+                Approx(solution.getObjective()));
+    }
+}
+
+TEST_CASE("Problem reduction") {
+    // A double pendulum whose second joint is locked.
+    Model model;
+    using SimTK::Vec3;
+    auto* b0 = new Body("b0", 1, Vec3(0), SimTK::Inertia(1));
+    model.addBody(b0);
+    auto* j0 = new PinJoint("j0", model.getGround(), Vec3(0), Vec3(0), *b0,
+            Vec3(-1, 0, 0), Vec3(0));
+    j0->updCoordinate().setName("q0");
+    model.addJoint(j0);
+    auto* b1 = new Body("b1", 1, Vec3(0), SimTK::Inertia(1));
+    model.addBody(b1);
+    auto* j1 = new PinJoint(
+            "j1", *b0, Vec3(0), Vec3(0), *b1, Vec3(-1, 0, 0), Vec3(0));
+    auto& q1 = j1->updCoordinate();
+    q1.setName("q1");
+    q1.setDefaultValue(0.5);
+    q1.setDefaultLocked(true);
+    model.addJoint(j1);
+    auto* tau0 = new CoordinateActuator("q0");
+    tau0->setName("tau0");
+    tau0->setOptimalForce(1);
+    model.addForce(tau0);
+    model.finalizeConnections();
+
+    MocoStudy study;
+    study.set_write_solution("false");
+    MocoProblem& problem = study.updProblem();
+    problem.setModelCopy(model);
+    problem.setTimeBounds(0, 1);
+    problem.setStateInfo("/jointset/j0/q0/value", {-10, 10}, 0, 0.5);
+    problem.setStateInfo("/jointset/j0/q0/speed", {-50, 50}, 0, 0);
+    problem.setStateInfo("/jointset/j1/q1/value", {-10, 10});
+    problem.setControlInfo("/forceset/tau0", {-100, 100});
+    problem.addGoal<MocoControlGoal>();
+
+    SECTION("Reduced problem") {
+        const MocoProblemRep rep = problem.createRep();
+        MocoProblem reducedProblem;
+        const auto reduction = rep.createReducedProblem(reducedProblem);
+        REQUIRE(reduction.weldedJoints == std::vector<std::string>{"j1"});
+        REQUIRE(reduction.removedCoordinates.size() == 1);
+        CHECK(reduction.removedCoordinates[0].first == "/jointset/j1/q1");
+        CHECK(reduction.removedCoordinates[0].second == Approx(0.5));
+        CHECK(reduction.removedMultipliers.size() == 1);
+        CHECK(reduction.reducedMultiplierNames.empty());
+        const MocoProblemRep reducedRep = reducedProblem.createRep();
+        CHECK(reducedRep.getNumStates() == 2);
+        CHECK(reducedRep.getNumKinematicConstraints() == 0);
+
+        // The welded body has the same pose as in the original model.
+        SimTK::State state = model.initSystem();
+        const auto& reducedModel = reducedRep.getModelBase();
+        const auto& reducedState = reducedRep.updStateBase();
+        reducedModel.realizePosition(reducedState);
+        model.realizePosition(state);
+        const Vec3 station(1, 0.2, 0);
+        CHECK((b1->findStationLocationInGround(state, station) -
+                      reducedModel.getComponent<Body>("/bodyset/b1")
+                              .findStationLocationInGround(
+                                      reducedState, station))
+                        .norm() < 1e-10);
+    }
+    SECTION("Solve") {
+        auto& solver = study.initCasADiSolver();
+        solver.set_num_mesh_intervals(20);
+        solver.set_enforce_constraint_derivatives(true);
+        const std::string mode = GENERATE(as<std::string>{}, "explicit",
+                "implicit");
+        solver.set_multibody_dynamics_mode(mode);
+        MocoSolution expected = study.solve();
+
+        solver.set_reduce_problem(true);
+        MocoSolution solution = study.solve();
+        REQUIRE(solution.success());
+        CHECK(solution.getObjective() ==
+                Approx(expected.getObjective()).epsilon(1e-3));
+        CHECK(solution.compareContinuousVariablesRMS(expected,
+                      {{"states", {}}, {"controls", {}}}) < 1e-3);
+        const auto q1Value = solution.getState("/jointset/j1/q1/value");
+        CHECK(SimTK::min(q1Value) == Approx(0.5));
+        CHECK(SimTK::max(q1Value) == Approx(0.5));
+        CHECK(solution.getMultiplierNames() == expected.getMultiplierNames());
+        if (mode == "implicit") {
+            CHECK(SimTK::max(solution.getDerivative("/jointset/j1/q1/accel")
+                                     .abs()) == 0);
+        }
+    }
+    SECTION("Goal on the removed states") {
+        // The reduced problem has no states for q1, but the objective must
+        // include them.
+        problem.addGoal<MocoSumSquaredStateGoal>("states", 0.1);
+        auto& solver = study.initCasADiSolver();
+        solver.set_num_mesh_intervals(20);
+        solver.set_enforce_constraint_derivatives(true);
+        MocoSolution expected = study.solve();
+
+        solver.set_reduce_problem(true);
+        MocoSolution solution = study.solve();
+        REQUIRE(solution.success());
+        CHECK(solution.getStateNames() == expected.getStateNames());
+        // The goals are evaluated with the trapezoidal rule on the mapped-back
+        // trajectory.
+        CHECK(solution.getObjectiveTerm("states") ==
+                Approx(expected.getObjectiveTerm("states")).epsilon(1e-2));
+        CHECK(solution.getObjective() ==
+                Approx(expected.getObjective()).epsilon(1e-2));
+    }
+}
+
 TEMPLATE_TEST_CASE("Solving an empty MocoProblem", "", MocoTropterSolver,
         MocoCasADiSolver) {
     MocoStudy study;
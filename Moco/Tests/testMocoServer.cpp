@@ -0,0 +1,132 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: testMocoServer.cpp                                           *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2026 Stanford University and the Authors                     *
+ *                                                                            *
+ * Author(s): agent                                                           *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#define CATCH_CONFIG_MAIN
+#include "MocoServer.h"
+#include "Testing.h"
+#include <Moco/osimMoco.h>
+#include <fstream>
+#include <thread>
+
+#include <OpenSim/Actuators/CoordinateActuator.h>
+#include <OpenSim/Simulation/SimbodyEngine/SliderJoint.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace OpenSim;
+
+namespace {
+std::unique_ptr<Model> createSlidingMassModel() {
+    auto model = make_unique<Model>();
+    model->setName("sliding_mass");
+    model->set_gravity(SimTK::Vec3(0, 0, 0));
+    auto* body = new Body("body", 10.0, SimTK::Vec3(0), SimTK::Inertia(0));
+    model->addComponent(body);
+
+    auto* joint = new SliderJoint("slider", model->getGround(), *body);
+    auto& coord = joint->updCoordinate(SliderJoint::Coord::TranslationX);
+    coord.setName("position");
+    model->addComponent(joint);
+
+    auto* actu = new CoordinateActuator();
+    actu->setCoordinate(&coord);
+    actu->setName("actuator");
+    actu->setOptimalForce(1);
+    model->addComponent(actu);
+
+    return model;
+}
+
+/// Send a single request to the server without waiting for a reply.
+void sendRequest(const std::string& socketPath, const std::string& request) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(fd >= 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+    REQUIRE(::connect(fd, reinterpret_cast<const sockaddr*>(&address),
+                    sizeof(address)) == 0);
+    const std::string line = request + "\n";
+    CHECK(::send(fd, line.data(), line.size(), MSG_NOSIGNAL) ==
+            (ssize_t)line.size());
+    ::close(fd);
+}
+} // anonymous namespace
+
+TEST_CASE("MocoServer solves a submitted study") {
+    const std::string socketPath = "testMocoServer.sock";
+    const std::string setupFile = "testMocoServer_sliding_mass.omoco";
+    const std::string solutionFile = "testMocoServer_sliding_mass.sto";
+    ::unlink(socketPath.c_str());
+    std::remove(solutionFile.c_str());
+
+    // Minimum time to move the mass by 1 m from rest to rest with an
+    // acceleration of at most 1 m/s^2: the control is bang-bang and the
+    // final time is 2 s.
+    {
+        MocoStudy study;
+        study.setName("sliding_mass");
+        MocoProblem& problem = study.updProblem();
+        problem.setModel(createSlidingMassModel());
+        problem.setTimeBounds(0, {0, 5});
+        problem.setStateInfo("/slider/position/value", {0, 1}, 0, 1);
+        problem.setStateInfo("/slider/position/speed", {-100, 100}, 0, 0);
+        problem.setControlInfo("/actuator", MocoBounds(-10, 10));
+        problem.addGoal<MocoFinalTimeGoal>();
+        auto& solver = study.initCasADiSolver();
+        solver.set_num_mesh_intervals(20);
+        study.print(setupFile);
+    }
+
+    MocoServer server(socketPath, 1, 1);
+
+    // Only the owner may connect to the server.
+    struct stat fileStatus;
+    REQUIRE(::lstat(socketPath.c_str(), &fileStatus) == 0);
+    CHECK(S_ISSOCK(fileStatus.st_mode));
+    CHECK((fileStatus.st_mode & 0777) == 0600);
+
+    std::thread serverThread(&MocoServer::run, &server);
+    const bool success =
+            submitToMocoServer(socketPath, setupFile, solutionFile);
+    sendRequest(socketPath, "shutdown");
+    serverThread.join();
+
+    CHECK(success);
+    MocoTrajectory solution(solutionFile);
+    CHECK(solution.getFinalTime() == Approx(2.0).epsilon(1e-2));
+    const auto& position = solution.getState("/slider/position/value");
+    CHECK(position[position.size() - 1] == Approx(1.0).margin(1e-6));
+}
+
+TEST_CASE("MocoServer does not remove files that are not sockets") {
+    const std::string socketPath = "testMocoServer_not_a_socket.txt";
+    {
+        std::ofstream file(socketPath);
+        file << "keep me" << std::endl;
+    }
+    CHECK_THROWS_WITH(MocoServer(socketPath, 1, 1),
+            Catch::Contains("a file that is not a socket"));
+    std::ifstream file(socketPath);
+    std::string contents;
+    std::getline(file, contents);
+    CHECK(contents == "keep me");
+}
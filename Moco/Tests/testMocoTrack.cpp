@@ -43,6 +43,43 @@ TEST_CASE("MocoTrack interface") {
     }
 }
 
+TEST_CASE("MocoTrack time range does not change references") {
+    MocoTrack track;
+    track.setName("testMocoTrack_time_range");
+    track.setModel(ModelProcessor("testGait10dof18musc_subject01.osim") |
+            ModOpRemoveMuscles());
+    track.setStatesReference(
+            TableProcessor("walk_gait1018_state_reference.mot"));
+    track.set_allow_unused_references(true);
+    // The speeds are computed from splines of the reference.
+    track.set_track_reference_position_derivatives(true);
+    const std::string trackedStatesFile =
+            "testMocoTrack_time_range_tracked_states.sto";
+
+    track.initialize();
+    const TimeSeriesTable full(trackedStatesFile);
+
+    track.set_initial_time(0.5);
+    track.set_final_time(0.8);
+    track.initialize();
+    const TimeSeriesTable windowed(trackedStatesFile);
+
+    REQUIRE(windowed.getColumnLabels() == full.getColumnLabels());
+    const auto& fullTime = full.getIndependentColumn();
+    int numRowsCompared = 0;
+    for (int irow = 0; irow < (int)fullTime.size(); ++irow) {
+        const double time = fullTime[irow];
+        if (time < 0.5 || time > 0.8) continue;
+        const auto expected = full.getRowAtIndex(irow);
+        const auto actual = windowed.getNearestRow(time);
+        for (int icol = 0; icol < expected.ncol(); ++icol) {
+            CHECK(actual[icol] == Approx(expected[icol]).margin(1e-10));
+        }
+        ++numRowsCompared;
+    }
+    CHECK(numRowsCompared > 0);
+}
+
 TEST_CASE("MocoTrack gait10dof18musc") {
 
     MocoTrack track;
@@ -56,6 +56,42 @@ TEST_CASE("TableProcessor") {
         CHECK(proc.process().getNumRows() == 4);
     }
 
+    SECTION("Select columns and rows") {
+        TimeSeriesTable source(std::vector<double>{0, 1, 2, 3, 4, 5},
+                SimTK::Test::randMatrix(6, 3),
+                std::vector<std::string>{"a", "b", "c"});
+        source.addTableMetaData<std::string>("inDegrees", "no");
+        {
+            // Rows at 1 and 4 are needed to interpolate within [1.5, 3.5].
+            TimeSeriesTable out = TableProcessor(source).process(
+                    "", nullptr, {"c", "a", "d"}, 1.5, 3.5);
+            CHECK(out.getColumnLabels() ==
+                    std::vector<std::string>{"a", "c"});
+            CHECK(out.getIndependentColumn() ==
+                    std::vector<double>{1, 2, 3, 4});
+            CHECK(out.getDependentColumn("c")[0] ==
+                    source.getDependentColumn("c")[1]);
+            CHECK(out.getTableMetaDataAsString("inDegrees") == "no");
+        }
+        {
+            TimeSeriesTable out =
+                    TableProcessor(source).process("", nullptr, {}, 2, 3);
+            CHECK(out.getNumColumns() == 3);
+            CHECK(out.getIndependentColumn() ==
+                    std::vector<double>{2, 3});
+        }
+        {
+            // The operator is not row-wise, so rows are selected after
+            // applying it.
+            TimeSeriesTable out =
+                    (TableProcessor(source) | MyTableOperator())
+                            .process("", nullptr, {"b"}, 4.5, 20);
+            CHECK(out.getColumnLabels() == std::vector<std::string>{"b"});
+            CHECK(out.getIndependentColumn() ==
+                    std::vector<double>{4, 5, 10});
+        }
+    }
+
     SECTION("Serialization") {
         writeTableToFile(table, "testTableProcessor_table.sto");
         {
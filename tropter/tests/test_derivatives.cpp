@@ -874,3 +874,90 @@ TEST_CASE("ProblemDecorator sparsity_detection") {
 }
 
 // TODO add test_derivatives_optimal_control
+
+template <typename T>
+class JacobianBlockSparsity : public tropter::Problem<T> {
+public:
+    JacobianBlockSparsity() {
+        this->set_time(0, {0.5, 1.5});
+        this->add_state("x", {-1.5, 1.5}, {0});
+        this->add_state("v", {-10, 10}, {0}, {0});
+        this->add_control("F", {-50, 50});
+        this->add_control("G", {-50, 50});
+        this->add_adjunct("l", {-10, 10});
+        this->add_parameter("p", {-1.5, 1.5});
+        this->add_path_constraint("c", 0);
+    }
+    void calc_differential_algebraic_equations(
+            const tropter::Input<T>& in,
+            tropter::Output<T> out) const override {
+        out.dynamics[0] = in.states[1];
+        out.dynamics[1] = in.parameters[0] * in.controls[0];
+        out.path[0] = in.controls[1] * in.adjuncts[0] - in.time;
+    }
+};
+
+TEST_CASE("Trapezoidal block-replicated Jacobian sparsity") {
+    // The sparsity pattern obtained by perturbing the DAE at one mesh point
+    // must match the pattern obtained by perturbing the entire NLP.
+    auto ocp = std::make_shared<JacobianBlockSparsity<double>>();
+    tropter::transcription::Trapezoidal<double> trapezoidal(ocp,
+            {0, 0.2, 0.5, 0.6, 1.0});
+    REQUIRE(trapezoidal.get_use_supplied_sparsity_jacobian());
+    const auto decorator = trapezoidal.make_decorator();
+    const VectorXd guess = decorator->make_random_iterate_within_bounds();
+
+    SparsityCoordinates block_sparsity, hes_sparsity;
+    decorator->calc_sparsity(guess, block_sparsity, false, hes_sparsity);
+
+    trapezoidal.set_use_supplied_sparsity_jacobian(false);
+    SparsityCoordinates full_sparsity;
+    decorator->calc_sparsity(guess, full_sparsity, false, hes_sparsity);
+
+    REQUIRE(block_sparsity.row == full_sparsity.row);
+    REQUIRE(block_sparsity.col == full_sparsity.col);
+}
+
+TEST_CASE("SparsityPattern compressed row storage") {
+    SparsityPattern s(3, 4);
+    s.set_nonzero(2, 3);
+    s.set_nonzero(0, 2);
+    s.set_nonzero(0, 1);
+    s.set_nonzero(0, 2);
+    REQUIRE(s.get_num_nonzeros() == 3);
+    REQUIRE(s.is_nonzero(0, 1));
+    REQUIRE(!s.is_nonzero(1, 1));
+    const auto crs = s.convert_to_CompressedRowSparsity();
+    REQUIRE(crs[0] == std::vector<unsigned int>{1, 2});
+    REQUIRE(crs[1].empty());
+    REQUIRE(crs[2] == std::vector<unsigned int>{3});
+
+    SparsityPattern other(3, 4);
+    other.set_nonzero(0, 0);
+    other.set_nonzero(0, 2);
+    s.add_in_nonzeros(other);
+    REQUIRE(s.get_num_nonzeros() == 4);
+    REQUIRE(s.get_nonzero_cols(0) == std::vector<unsigned int>{0, 1, 2});
+
+    SymmetricSparsityPattern block(2);
+    block.set_dense();
+    REQUIRE(block.get_num_nonzeros() == 3);
+    SymmetricSparsityPattern sym(4);
+    sym.set_nonzero(1, 3);
+    sym.set_nonzero_block(1, block);
+    REQUIRE(sym.get_num_nonzeros() == 4);
+    REQUIRE(sym.get_nonzero_cols(1) == std::vector<unsigned int>{1, 2, 3});
+}
+
+TEST_CASE("Hessian sparsity with perturbation") {
+    std::function<double(const VectorX<double>&)> f =
+            [](const VectorX<double>& x) {
+                return x[0] * x[0] + x[1] * x[2];
+            };
+    const auto sparsity = tropter::calc_hessian_sparsity_with_perturbation(
+            Vector3d(0.3, -0.2, 1.1), f);
+    const auto crs = sparsity.convert_to_CompressedRowSparsity();
+    REQUIRE(crs[0] == std::vector<unsigned int>{0});
+    REQUIRE(crs[1] == std::vector<unsigned int>{2});
+    REQUIRE(crs[2].empty());
+}
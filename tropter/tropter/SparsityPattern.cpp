@@ -20,12 +20,15 @@
 
 #include <Eigen/SparseCore>
 
+#include <algorithm>
+#include <numeric>
+
 using namespace tropter;
 
 SparsityPattern::SparsityPattern(int num_rows, int num_cols,
     const std::vector<unsigned int>& row_indices,
     const std::vector<unsigned int>& col_indices)
-    : m_num_rows(num_rows), m_num_cols(num_cols) {
+    : m_num_rows(num_rows), m_num_cols(num_cols), m_sparsity(num_rows) {
     TROPTER_THROW_IF(row_indices.size() != col_indices.size(),
         "Expected row_indices and col_indices to have the same size.");
     for (int inz = 0; inz < (int)row_indices.size(); ++inz)
@@ -34,17 +37,17 @@ SparsityPattern::SparsityPattern(int num_rows, int num_cols,
 
 SparsityPattern::SparsityPattern(int num_cols,
     const std::vector<unsigned int>& nonzero_col_indices)
-    : m_num_rows(1), m_num_cols(num_cols) {
+    : m_num_rows(1), m_num_cols(num_cols), m_sparsity(1) {
     for (const auto& icol : nonzero_col_indices)
         set_nonzero(0, icol);
 }
 
 void SparsityPattern::set_dense() {
     for (int irow = 0; irow < m_num_rows; ++irow) {
-        for (int icol = 0; icol < m_num_cols; ++icol) {
-            set_nonzero(irow, icol);
-        }
+        m_sparsity[irow].resize(m_num_cols);
+        std::iota(m_sparsity[irow].begin(), m_sparsity[irow].end(), 0u);
     }
+    m_num_nonzeros = m_num_rows * m_num_cols;
 }
 
 void SparsityPattern::set_nonzero(unsigned int row_index,
@@ -55,7 +58,31 @@ void SparsityPattern::set_nonzero(unsigned int row_index,
     TROPTER_THROW_IF(col_index >= (unsigned)m_num_cols,
         "Expected col_index to be in [0, %i), but it's %i.",
         m_num_cols, col_index);
-    m_sparsity.emplace(row_index, col_index);
+    auto& row = m_sparsity[row_index];
+    const auto it = std::lower_bound(row.begin(), row.end(), col_index);
+    if (it == row.end() || *it != col_index) {
+        row.insert(it, col_index);
+        ++m_num_nonzeros;
+    }
+}
+
+bool SparsityPattern::is_nonzero(unsigned int row_index,
+        unsigned int col_index) const {
+    if (row_index >= (unsigned)m_num_rows) return false;
+    const auto& row = m_sparsity[row_index];
+    return std::binary_search(row.begin(), row.end(), col_index);
+}
+
+void SparsityPattern::merge_into_row(unsigned int row_index,
+        const std::vector<unsigned int>& cols) {
+    if (cols.empty()) return;
+    auto& row = m_sparsity[row_index];
+    std::vector<unsigned int> merged;
+    merged.reserve(row.size() + cols.size());
+    std::set_union(row.begin(), row.end(), cols.begin(), cols.end(),
+            std::back_inserter(merged));
+    m_num_nonzeros += (int)(merged.size() - row.size());
+    row = std::move(merged);
 }
 
 void SparsityPattern::add_in_nonzeros(const SparsityPattern& other) {
@@ -63,23 +90,8 @@ void SparsityPattern::add_in_nonzeros(const SparsityPattern& other) {
         "Expected the same number of rows.");
     TROPTER_THROW_IF(get_num_cols() != other.get_num_cols(),
         "Expected the same number of columns.");
-    for (const auto& other_entry : other.m_sparsity)
-        set_nonzero(other_entry.first, other_entry.second);
-}
-
-CompressedRowSparsity
-SparsityPattern::convert_to_CompressedRowSparsity() const {
-    CompressedRowSparsity crs(m_num_rows);
-    for (int irow = 0; irow < m_num_rows; ++irow) {
-        std::vector<unsigned int> nonzeros_this_row;
-        for (const auto& nonzero : m_sparsity) {
-            if ((int)nonzero.first == irow)
-                nonzeros_this_row.push_back(nonzero.second);
-        }
-        std::sort(nonzeros_this_row.begin(), nonzeros_this_row.end());
-        crs[irow] = nonzeros_this_row;
-    }
-    return crs;
+    for (int irow = 0; irow < m_num_rows; ++irow)
+        merge_into_row(irow, other.m_sparsity[irow]);
 }
 
 void SparsityPattern::write(const std::string& filename) {
@@ -87,8 +99,10 @@ void SparsityPattern::write(const std::string& filename) {
     file << "num_rows=" << m_num_rows << std::endl;
     file << "num_cols=" << m_num_cols << std::endl;
     file << "row_indices,column_indices" << std::endl;
-    for (const auto& entry : m_sparsity)
-        file << entry.first << "," << entry.second << std::endl;
+    for (int irow = 0; irow < m_num_rows; ++irow) {
+        for (const auto& icol : m_sparsity[irow])
+            file << irow << "," << icol << std::endl;
+    }
     file.close();
 }
 
@@ -96,9 +110,11 @@ void SparsityPattern::write(const std::string& filename) {
 
 SparsityPattern SymmetricSparsityPattern::convert_full() const {
     SparsityPattern full(*this);
-    for (const auto& entry : m_sparsity)
-        // Swap row and col indicies.
-        full.set_nonzero(entry.second, entry.first);
+    for (int irow = 0; irow < m_num_rows; ++irow) {
+        for (const auto& icol : m_sparsity[irow])
+            // Swap row and col indicies.
+            full.set_nonzero(icol, irow);
+    }
     return full;
 }
 
@@ -112,8 +128,11 @@ SymmetricSparsityPattern::create_from_jacobian_sparsity(
             jac_sparsity.get_num_rows(), jac_sparsity.get_num_cols());
         S1.reserve(jac_sparsity.get_num_nonzeros());
         std::vector<Eigen::Triplet<short>> triplets;
-        for (const auto& entry : jac_sparsity.m_sparsity)
-            triplets.emplace_back(entry.first, entry.second, 1);
+        triplets.reserve(jac_sparsity.get_num_nonzeros());
+        for (int irow = 0; irow < jac_sparsity.get_num_rows(); ++irow) {
+            for (const auto& icol : jac_sparsity.m_sparsity[irow])
+                triplets.emplace_back(irow, icol, 1);
+        }
         S1.setFromTriplets(triplets.begin(), triplets.end());
         S1.makeCompressed();
 
@@ -131,10 +150,12 @@ SymmetricSparsityPattern::create_from_jacobian_sparsity(
 }
 
 void SymmetricSparsityPattern::set_dense() {
+    m_num_nonzeros = 0;
     for (int irow = 0; irow < m_num_rows; ++irow) {
-        for (int icol = irow; icol < m_num_cols; ++icol) {
-            set_nonzero(irow, icol);
-        }
+        m_sparsity[irow].resize(m_num_cols - irow);
+        std::iota(m_sparsity[irow].begin(), m_sparsity[irow].end(),
+                (unsigned)irow);
+        m_num_nonzeros += m_num_cols - irow;
     }
 }
 
@@ -157,9 +178,13 @@ void SymmetricSparsityPattern::set_nonzero_block(
         "Block does not fit within this matrix (number of columns: %i, "
         "required number of columns to set block: %i).", get_num_cols(),
             (int)startindex + block.get_num_cols());
-    for (const auto& block_entries : block.m_sparsity) {
-        set_nonzero(startindex + block_entries.first,
-            startindex + block_entries.second);
+    std::vector<unsigned int> shifted;
+    for (int irow = 0; irow < block.get_num_rows(); ++irow) {
+        const auto& block_row = block.m_sparsity[irow];
+        shifted.resize(block_row.size());
+        std::transform(block_row.begin(), block_row.end(), shifted.begin(),
+                [startindex](unsigned int icol) { return startindex + icol; });
+        merge_into_row(startindex + irow, shifted);
     }
 }
 
@@ -18,7 +18,6 @@
 
 #include "common.h"
 #include <vector>
-#include <set>
 
 namespace tropter {
 
@@ -34,10 +33,14 @@ using CompressedRowSparsity = std::vector<std::vector<unsigned int>>;
 
 
 /// This represents the sparsity pattern of a matrix.
+/// The nonzeros are stored in compressed row format: for each row, we hold a
+/// sorted vector of the column indices of the nonzeros in that row. This is
+/// much more compact than storing (row, col) pairs in a tree, and it makes
+/// conversion to CompressedRowSparsity a copy.
 class SparsityPattern {
 public:
     SparsityPattern(int num_rows, int num_cols)
-        : m_num_rows(num_rows), m_num_cols(num_cols) {}
+        : m_num_rows(num_rows), m_num_cols(num_cols), m_sparsity(num_rows) {}
     SparsityPattern(int num_rows, int num_cols,
         const std::vector<unsigned int>& row_indices,
         const std::vector<unsigned int>& col_indices);
@@ -57,19 +60,31 @@ public:
 
     int get_num_rows() const { return m_num_rows; }
     int get_num_cols() const { return m_num_cols; }
-    int get_num_nonzeros() const { return (int)m_sparsity.size(); }
+    int get_num_nonzeros() const { return m_num_nonzeros; }
+    /// Is the entry (row_index, col_index) a nonzero?
+    bool is_nonzero(unsigned int row_index, unsigned int col_index) const;
+    /// The sorted column indices of the nonzeros in the given row.
+    const std::vector<unsigned int>& get_nonzero_cols(int row_index) const
+    {   return m_sparsity[row_index]; }
 
-    CompressedRowSparsity convert_to_CompressedRowSparsity() const;
+    CompressedRowSparsity convert_to_CompressedRowSparsity() const
+    {   return m_sparsity; }
 
     /// Write the sparsity pattern to a file, which can be plotted with the
     /// plot_sparsity.py script that comes with tropter.
     void write(const std::string& filename);
 
 protected:
+    /// Add the sorted column indices in `cols` to row `row_index`, without
+    /// checking the indices.
+    void merge_into_row(unsigned int row_index,
+            const std::vector<unsigned int>& cols);
+
     int m_num_rows;
     int m_num_cols;
+    int m_num_nonzeros = 0;
     friend class SymmetricSparsityPattern;
-    std::set<std::pair<unsigned int, unsigned int>> m_sparsity;
+    CompressedRowSparsity m_sparsity;
 };
 
 
@@ -203,7 +218,7 @@ SparsityPattern
         x[j] = x0[j];
         diff = output - output0;
         for (int i = 0; i < (int)num_outputs; ++i) {
-            if (std::isnan(diff[i])) {
+            if (isnan(diff[i])) {
                 std::cout << "[tropter] Warning: NaN encountered when "
                     "detecting sparsity of Jacobian; entry (";
                 if (col_names.empty() || row_names.empty())
@@ -225,33 +240,39 @@ SparsityPattern
 
 /// Detect the sparsity pattern of a Hessian matrix by perturbing x and
 /// examining if the function value is affected by the perturbation.
+/// The single-perturbation evaluations f(x + eps e_i) are computed once and
+/// reused for every pair (i, j), so this requires 1 + n + n (n + 1) / 2
+/// function evaluations, where n is the size of x.
 template <typename T>
 SymmetricSparsityPattern
     calc_hessian_sparsity_with_perturbation(
         const Eigen::VectorXd& x0,
         const std::function<T(const VectorX<T>&)>& function) {
-    SymmetricSparsityPattern sparsity((int)x0.size());
+    const int n = (int)x0.size();
+    SymmetricSparsityPattern sparsity(n);
     VectorX<T> x = x0.cast<T>();
     double eps = 1e-5;
     T f0 = function(x);
-    // TODO cache evaluations.
-    for (int i = 0; i < (int)x0.size(); ++i) {
-        for (int j = i; j < (int)x0.size(); ++j) {
-            x[i] += eps;
-            T f_i = function(x);
+    std::vector<T> f_single(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] += eps;
+        f_single[i] = function(x);
+        x[i] = x0[i];
+    }
+    for (int i = 0; i < n; ++i) {
+        x[i] += eps;
+        for (int j = i; j < n; ++j) {
             x[j] += eps;
             T f_ij = function(x);
-            x[i] = x0[i];
-            T f_j = function(x);
-            x[j] = x0[j];
+            // Restore x[j], taking care for the diagonal (i == j), for which
+            // x[i] has been perturbed twice.
+            x[j] = x0[j] + (i == j ? eps : 0);
             // Finite difference numerator.
-            //std::cout << "DEBUG " << i << " " << j << " " <<
-            //        f_ij - f_i - f_j + f0 << std::endl;
-            if ((f_ij - f_i - f_j + f0) != 0)
+            if ((f_ij - f_single[i] - f_single[j] + f0) != 0)
                 sparsity.set_nonzero(i, j);
         }
+        x[i] = x0[i];
     }
-    // TODO std::cout << "DEBUG " << sparsity << std::endl;
     return sparsity;
 }
 
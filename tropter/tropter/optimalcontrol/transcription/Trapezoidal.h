@@ -62,6 +62,7 @@ public:
     Trapezoidal(std::shared_ptr<const OCProblem> ocproblem,
             std::vector<double> mesh) : m_mesh(mesh) {
         if (std::is_same<T, double>::value) {
+            this->set_use_supplied_sparsity_jacobian(true);
             this->set_use_supplied_sparsity_hessian_lagrangian(true);
         }
         set_ocproblem(ocproblem);
@@ -73,6 +74,14 @@ public:
     void calc_constraints(const VectorX<T>& x,
             Eigen::Ref<VectorX<T>> constr) const override;
     /// Use knowledge of the repeated structure of the optimization problem
+    /// to efficiently determine the sparsity pattern of the Jacobian of the
+    /// constraints. We perturb the differential-algebraic equations at one
+    /// mesh point and replicate the resulting block for the defects and path
+    /// constraints at all mesh points. Only the time variables and parameters
+    /// are perturbed in the entire NLP constraint function.
+    void calc_sparsity_jacobian(const Eigen::VectorXd& x,
+            SparsityPattern&) const override;
+    /// Use knowledge of the repeated structure of the optimization problem
     /// to efficiently determine the sparsity pattern of the entire Hessian.
     /// We only need to perturb the optimal control functions at one mesh point,
     /// not the entire NLP objective and constraint functions.
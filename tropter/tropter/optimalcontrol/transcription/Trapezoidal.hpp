@@ -330,6 +330,88 @@ void Trapezoidal<T>::calc_constraints(
     }
 }
 
+template <typename T>
+void Trapezoidal<T>::calc_sparsity_jacobian(const Eigen::VectorXd& x,
+        SparsityPattern& jacobian_sparsity) const {
+    const auto& num_con_vars = m_num_continuous_variables;
+
+    // Sparsity of the DAE at a single mesh point.
+    // -------------------------------------------
+    // The state derivatives and path constraints have the same dependence on
+    // the continuous variables at every mesh point, so we detect the Jacobian
+    // of the DAE with respect to the continuous variables at mesh point 0.
+    std::function<void(const VectorX<T>&, VectorX<T>&)> calc_dae =
+            [this, &x](const VectorX<T>& vars, VectorX<T>& outputs) {
+                T t = x[0]; // initial time.
+                VectorX<T> s = vars.head(m_num_states);
+                VectorX<T> c = vars.segment(m_num_states, m_num_controls);
+                VectorX<T> a = vars.tail(m_num_adjuncts);
+                VectorX<T> d; // empty
+                VectorX<T> p =
+                        x.segment(m_num_time_variables, m_num_parameters)
+                                .template cast<T>();
+                VectorX<T> deriv(m_num_states);
+                VectorX<T> path(m_num_path_constraints);
+                m_ocproblem->calc_differential_algebraic_equations(
+                        {0, t, s, c, a, d, p}, {deriv, path});
+                outputs << deriv, path;
+            };
+    const SparsityPattern dae_sparsity =
+            calc_jacobian_sparsity_with_perturbation(
+                    x.segment(m_num_dense_variables, num_con_vars),
+                    m_num_states + m_num_path_constraints, calc_dae);
+
+    // Replicate the DAE block.
+    // ------------------------
+    const auto mesh_start = [this](int imesh) {
+        return (unsigned)(m_num_dense_variables +
+                          imesh * m_num_continuous_variables);
+    };
+    // Defects depend on the state itself and on the state derivative at the
+    // two mesh points of each mesh interval.
+    for (int imesh = 1; imesh < m_num_mesh_points; ++imesh) {
+        for (int istate = 0; istate < m_num_states; ++istate) {
+            const auto irow = (imesh - 1) * m_num_states + istate;
+            for (const int jmesh : {imesh - 1, imesh}) {
+                const auto jstart = mesh_start(jmesh);
+                jacobian_sparsity.set_nonzero(irow, jstart + istate);
+                for (const auto& icol : dae_sparsity.get_nonzero_cols(istate))
+                    jacobian_sparsity.set_nonzero(irow, jstart + icol);
+            }
+        }
+    }
+    // Path constraints depend only on variables at their own mesh point.
+    for (int imesh = 0; imesh < m_num_mesh_points; ++imesh) {
+        const auto jstart = mesh_start(imesh);
+        for (int ipc = 0; ipc < m_num_path_constraints; ++ipc) {
+            const auto irow = m_num_dynamics_constraints +
+                              imesh * m_num_path_constraints + ipc;
+            const auto& cols = dae_sparsity.get_nonzero_cols(m_num_states + ipc);
+            for (const auto& icol : cols)
+                jacobian_sparsity.set_nonzero(irow, jstart + icol);
+        }
+    }
+
+    // Time variables and parameters.
+    // ------------------------------
+    // These affect the constraints at all mesh points, so we perturb them in
+    // the entire NLP constraint function.
+    std::function<void(const VectorX<T>&, VectorX<T>&)> calc_constraints =
+            [this, &x](const VectorX<T>& dense_vars, VectorX<T>& constr) {
+                VectorX<T> vars = x.template cast<T>();
+                vars.head(m_num_dense_variables) = dense_vars;
+                this->calc_constraints(vars, constr);
+            };
+    const SparsityPattern dense_sparsity =
+            calc_jacobian_sparsity_with_perturbation(
+                    x.head(m_num_dense_variables),
+                    this->get_num_constraints(), calc_constraints);
+    for (int irow = 0; irow < dense_sparsity.get_num_rows(); ++irow) {
+        for (const auto& icol : dense_sparsity.get_nonzero_cols(irow))
+            jacobian_sparsity.set_nonzero(irow, icol);
+    }
+}
+
 template <typename T>
 void Trapezoidal<T>::calc_sparsity_hessian_lagrangian(const Eigen::VectorXd& x,
         SymmetricSparsityPattern& hescon_sparsity,
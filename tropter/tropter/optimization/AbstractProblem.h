@@ -22,6 +22,7 @@
 
 namespace tropter {
 
+class SparsityPattern;
 class SymmetricSparsityPattern;
 
 namespace optimization {
@@ -88,6 +89,33 @@ public:
     /// This must be false if using automatic differentiation.
     void set_use_supplied_sparsity_hessian_lagrangian(bool value)
     {   m_use_supplied_sparsity_hessian_lagrangian = value; }
+    /// When using finite differences to compute derivatives, should we use
+    /// the user-supplied sparsity pattern of the Jacobian of the constraints
+    /// (provided by implementing calc_sparsity_jacobian())? If false, then we
+    /// detect the sparsity pattern by perturbing each variable of the full
+    /// problem, which can be slow for large problems.
+    bool get_use_supplied_sparsity_jacobian() const
+    {   return m_use_supplied_sparsity_jacobian; }
+    /// @copydoc get_use_supplied_sparsity_jacobian()
+    /// If this is true and calc_sparsity_jacobian() is not implemented, an
+    /// exception is thrown.
+    void set_use_supplied_sparsity_jacobian(bool value)
+    {   m_use_supplied_sparsity_jacobian = value; }
+    /// If using finite differences (double), we require the sparsity pattern
+    /// of the Jacobian of the constraints. By default, we detect this pattern
+    /// by perturbing every variable and examining which constraints change.
+    /// If the problem has a repeated structure (e.g., direct collocation),
+    /// implement this function to detect the sparsity of a single block and
+    /// replicate it. Call set_nonzero() on the supplied SparsityPattern
+    /// (dimensions num_constraints x num_variables) for each nonzero.
+    ///
+    /// An iterate is provided for use in detecting sparsity (see
+    /// calc_sparsity_hessian_lagrangian()).
+    virtual void calc_sparsity_jacobian(const Eigen::VectorXd& x,
+            SparsityPattern& jacobian_sparsity) const;
+
+    class CalcSparsityJacobianNotImplemented : public Exception {};
+
     /// If using finite differences (double) with a Newton method (exact
     /// Hessian in IPOPT), then we require the sparsity pattern of the
     /// Hessian of the Lagrangian. By default, we estimate the Hessian's
@@ -148,6 +176,7 @@ private:
     // TODO use safer types that will give exceptions for improper values.
     unsigned m_num_variables;
     unsigned m_num_constraints;
+    bool m_use_supplied_sparsity_jacobian = false;
     bool m_use_supplied_sparsity_hessian_lagrangian = false;
     Eigen::VectorXd m_variable_lower_bounds;
     Eigen::VectorXd m_variable_upper_bounds;
@@ -155,6 +184,10 @@ private:
     Eigen::VectorXd m_constraint_upper_bounds;
 };
 
+inline void AbstractProblem::calc_sparsity_jacobian(
+        const Eigen::VectorXd&, SparsityPattern&) const {
+    throw CalcSparsityJacobianNotImplemented();
+}
 inline void AbstractProblem::calc_sparsity_hessian_lagrangian(
         const Eigen::VectorXd&,
         SymmetricSparsityPattern&,
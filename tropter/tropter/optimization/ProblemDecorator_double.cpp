@@ -92,11 +92,30 @@ calc_sparsity(const Eigen::VectorXd& variables,
             [this](const VectorXd& vars, VectorXd& constr) {
                 m_problem.calc_constraints(vars, constr);
             };
-    const auto var_names = m_problem.get_variable_names();
-    const auto constr_names = m_problem.get_constraint_names();
-    SparsityPattern jacobian_sparsity =
-            calc_jacobian_sparsity_with_perturbation(variables,
-                    num_jac_rows, calc_constraints, constr_names, var_names);
+    SparsityPattern jacobian_sparsity((int)num_jac_rows, (int)num_vars);
+    if (m_problem.get_use_supplied_sparsity_jacobian()) {
+        using CalcSparsityJacobianNotImplemented =
+                AbstractProblem::CalcSparsityJacobianNotImplemented;
+        try {
+            m_problem.calc_sparsity_jacobian(variables, jacobian_sparsity);
+            TROPTER_THROW_IF(
+                    jacobian_sparsity.get_num_rows() != (int)num_jac_rows ||
+                    jacobian_sparsity.get_num_cols() != (int)num_vars,
+                    "Expected sparsity pattern of Jacobian to have "
+                    "dimensions %i x %i, but it has dimensions %i x %i.",
+                    num_jac_rows, num_vars, jacobian_sparsity.get_num_rows(),
+                    jacobian_sparsity.get_num_cols());
+        } catch (const CalcSparsityJacobianNotImplemented&) {
+            TROPTER_THROW("User requested use of user-supplied sparsity for "
+                "the Jacobian, but calc_sparsity_jacobian() is not "
+                "implemented.");
+        }
+    } else {
+        const auto var_names = m_problem.get_variable_names();
+        const auto constr_names = m_problem.get_constraint_names();
+        jacobian_sparsity = calc_jacobian_sparsity_with_perturbation(variables,
+                num_jac_rows, calc_constraints, constr_names, var_names);
+    }
 
     m_jacobian_coloring.reset(new JacobianColoring(jacobian_sparsity));
     m_jacobian_coloring->get_coordinate_format(jacobian_sparsity_coordinates);